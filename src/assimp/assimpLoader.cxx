@@ -35,6 +35,7 @@
 #include "animBundleNode.h"
 #include "animChannelMatrixXfmTable.h"
 #include "pvector.h"
+#include "workerPool.h"
 
 #include "pandaIOSystem.h"
 #include "pandaLogger.h"
@@ -55,6 +56,49 @@ struct BoneWeight {
 };
 typedef pvector<BoneWeight> BoneWeightList;
 
+/**
+ * Copies the per-vertex values of an Assimp array, each of which consists of
+ * num_components consecutive ai_reals, into the indicated column of the
+ * vertex data.  If the types agree, the values are copied directly into the
+ * array data, rather than one at a time through a GeomVertexWriter.
+ */
+static void
+copy_column(GeomVertexData *vdata, const InternalName *name,
+            const ai_real *source, int num_components) {
+  int array_index;
+  const GeomVertexColumn *column;
+  if (!vdata->get_format()->get_array_info(name, array_index, column)) {
+    nassertv(false);
+    return;
+  }
+
+  size_t num_rows = (size_t)vdata->get_num_rows();
+  if (sizeof(ai_real) == sizeof(PN_stdfloat) &&
+      column->get_num_components() == num_components) {
+    PT(GeomVertexArrayDataHandle) handle =
+      vdata->modify_array_handle(array_index);
+    size_t stride = handle->get_array_format()->get_stride();
+    size_t row_size = num_components * sizeof(ai_real);
+    unsigned char *dest = handle->get_write_pointer() + column->get_start();
+    for (size_t i = 0; i < num_rows; ++i) {
+      memcpy(dest, source, row_size);
+      dest += stride;
+      source += num_components;
+    }
+
+  } else {
+    GeomVertexWriter writer(vdata, name);
+    for (size_t i = 0; i < num_rows; ++i) {
+      if (num_components == 4) {
+        writer.set_data4(source[0], source[1], source[2], source[3]);
+      } else {
+        writer.set_data3(source[0], source[1], source[2]);
+      }
+      source += num_components;
+    }
+  }
+}
+
 /**
  *
  */
@@ -176,12 +220,32 @@ build_graph() {
     load_material(i);
   }
 
-  // And then the meshes.
+  // Index the nodes by name, so that the bones can be found quickly.
+  _nodemap.clear();
+  if (_scene->mRootNode != nullptr) {
+    index_nodes(*_scene->mRootNode);
+  }
+
+  // And then the meshes.  The characters are created first, in order, since
+  // they share the bone map.  The geometry of each mesh is independent of
+  // the others, so it may be converted on several threads at once.
   _geoms = new PT(Geom)[_scene->mNumMeshes];
   _geom_matindices = new unsigned int[_scene->mNumMeshes];
   _characters = new PT(Character)[_scene->mNumMeshes];
   for (size_t i = 0; i < _scene->mNumMeshes; ++i) {
-    load_mesh(i);
+    create_character(i);
+  }
+
+  WorkerPool pool(assimp_load_threads);
+  pool.run((int)_scene->mNumMeshes, &AssimpLoader::load_mesh_job, this);
+
+  for (size_t i = 0; i < _scene->mNumMeshes; ++i) {
+    if (_characters[i] != nullptr) {
+      PT(GeomNode) gnode = new GeomNode("");
+      gnode->add_geom(_geoms[i]);
+      gnode->set_state(_mat_states[_geom_matindices[i]]);
+      _characters[i]->add_child(gnode);
+    }
   }
 
   // And now the node structure.
@@ -199,26 +263,32 @@ build_graph() {
   delete[] _geoms;
   delete[] _geom_matindices;
   delete[] _characters;
+  _nodemap.clear();
 }
 
 /**
- * Finds a node by name.
+ * Adds the indicated node and all of the nodes below it to the name index.
+ * Where several nodes share a name, the first one in depth-first order wins.
  */
-const aiNode *AssimpLoader::
-find_node(const aiNode &root, const aiString &name) {
-  const aiNode *node;
+void AssimpLoader::
+index_nodes(const aiNode &node) {
+  string name(node.mName.data, node.mName.length);
+  _nodemap.insert(NodeMap::value_type(name, &node));
 
-  if (root.mName == name) {
-    return &root;
-  } else {
-    for (size_t i = 0; i < root.mNumChildren; ++i) {
-      node = find_node(*root.mChildren[i], name);
-      if (node) {
-          return node;
-      }
-    }
+  for (size_t i = 0; i < node.mNumChildren; ++i) {
+    index_nodes(*node.mChildren[i]);
   }
+}
 
+/**
+ * Finds a node by name, or returns NULL if there is no such node.
+ */
+const aiNode *AssimpLoader::
+find_node(const aiString &name) const {
+  NodeMap::const_iterator ni = _nodemap.find(string(name.data, name.length));
+  if (ni != _nodemap.end()) {
+    return (*ni).second;
+  }
   return nullptr;
 }
 
@@ -545,10 +615,11 @@ create_anim_channel(const aiAnimation &anim, AnimBundle *bundle, AnimGroup *pare
 }
 
 /**
- * Converts an aiMesh into a Geom.
+ * Creates the Character for an aiMesh that has bones, along with any
+ * animations that apply to it.
  */
 void AssimpLoader::
-load_mesh(size_t index) {
+create_character(size_t index) {
   const aiMesh &mesh = *_scene->mMeshes[index];
 
   // Check if we need to make a Character
@@ -563,7 +634,7 @@ load_mesh(size_t index) {
     // Find and add all bone nodes to the bone map
     for (size_t i = 0; i < mesh.mNumBones; ++i) {
       const aiBone &bone = *mesh.mBones[i];
-      const aiNode *node = find_node(*_scene->mRootNode, bone.mName);
+      const aiNode *node = find_node(bone.mName);
       _bonemap[bone.mName.C_Str()] = node;
     }
 
@@ -590,54 +661,6 @@ load_mesh(size_t index) {
     }
   }
 
-  // Create transform blend table
-  PT(TransformBlendTable) tbtable = new TransformBlendTable;
-  pvector<BoneWeightList> bone_weights(mesh.mNumVertices);
-  if (character) {
-    for (size_t i = 0; i < mesh.mNumBones; ++i) {
-      const aiBone &bone = *mesh.mBones[i];
-      CharacterJoint *joint = character->find_joint(bone.mName.C_Str());
-      if (joint == nullptr) {
-        if (assimp_cat.is_debug()) {
-          assimp_cat.debug()
-            << "Could not find joint for bone: " << bone.mName.C_Str() << "\n";
-        }
-        continue;
-      }
-
-      CPT(JointVertexTransform) jvt = new JointVertexTransform(joint);
-
-      for (size_t j = 0; j < bone.mNumWeights; ++j) {
-          const aiVertexWeight &weight = bone.mWeights[j];
-
-          bone_weights[weight.mVertexId].push_back(BoneWeight(jvt, weight.mWeight));
-      }
-    }
-  }
-
-  // Create the vertex format.
-  PT(GeomVertexArrayFormat) aformat = new GeomVertexArrayFormat;
-  aformat->add_column(InternalName::get_vertex(), 3, Geom::NT_stdfloat, Geom::C_point);
-  if (mesh.HasNormals()) {
-    aformat->add_column(InternalName::get_normal(), 3, Geom::NT_stdfloat, Geom::C_vector);
-  }
-  if (mesh.HasVertexColors(0)) {
-    aformat->add_column(InternalName::get_color(), 4, Geom::NT_stdfloat, Geom::C_color);
-  }
-  unsigned int num_uvs = mesh.GetNumUVChannels();
-  if (num_uvs > 0) {
-    // UV sets are named texcoord, texcoord.1, texcoord.2...
-    aformat->add_column(InternalName::get_texcoord(), 3, Geom::NT_stdfloat, Geom::C_texcoord);
-    for (unsigned int u = 1; u < num_uvs; ++u) {
-      ostringstream out;
-      out << u;
-      aformat->add_column(InternalName::get_texcoord_name(out.str()), 3, Geom::NT_stdfloat, Geom::C_texcoord);
-    }
-  }
-
-  PT(GeomVertexArrayFormat) tb_aformat = new GeomVertexArrayFormat;
-  tb_aformat->add_column(InternalName::make("transform_blend"), 1, Geom::NT_uint16, Geom::C_index);
-
   // Check to see if we need to convert any animations
   for (size_t i = 0; i < _scene->mNumAnimations; ++i) {
     aiAnimation &ai_anim = *_scene->mAnimations[i];
@@ -712,6 +735,66 @@ load_mesh(size_t index) {
     }
   }
 
+  _characters[index] = character;
+}
+
+/**
+ * Converts an aiMesh into a Geom.  This is called after create_character(),
+ * possibly on several threads at once for different meshes.
+ */
+void AssimpLoader::
+load_mesh(size_t index) {
+  const aiMesh &mesh = *_scene->mMeshes[index];
+  Character *character = _characters[index];
+
+  // Create transform blend table
+  PT(TransformBlendTable) tbtable = new TransformBlendTable;
+  pvector<BoneWeightList> bone_weights(mesh.mNumVertices);
+  if (character) {
+    for (size_t i = 0; i < mesh.mNumBones; ++i) {
+      const aiBone &bone = *mesh.mBones[i];
+      CharacterJoint *joint = character->find_joint(bone.mName.C_Str());
+      if (joint == nullptr) {
+        if (assimp_cat.is_debug()) {
+          assimp_cat.debug()
+            << "Could not find joint for bone: " << bone.mName.C_Str() << "\n";
+        }
+        continue;
+      }
+
+      CPT(JointVertexTransform) jvt = new JointVertexTransform(joint);
+
+      for (size_t j = 0; j < bone.mNumWeights; ++j) {
+          const aiVertexWeight &weight = bone.mWeights[j];
+
+          bone_weights[weight.mVertexId].push_back(BoneWeight(jvt, weight.mWeight));
+      }
+    }
+  }
+
+  // Create the vertex format.
+  PT(GeomVertexArrayFormat) aformat = new GeomVertexArrayFormat;
+  aformat->add_column(InternalName::get_vertex(), 3, Geom::NT_stdfloat, Geom::C_point);
+  if (mesh.HasNormals()) {
+    aformat->add_column(InternalName::get_normal(), 3, Geom::NT_stdfloat, Geom::C_vector);
+  }
+  if (mesh.HasVertexColors(0)) {
+    aformat->add_column(InternalName::get_color(), 4, Geom::NT_stdfloat, Geom::C_color);
+  }
+  unsigned int num_uvs = mesh.GetNumUVChannels();
+  if (num_uvs > 0) {
+    // UV sets are named texcoord, texcoord.1, texcoord.2...
+    aformat->add_column(InternalName::get_texcoord(), 3, Geom::NT_stdfloat, Geom::C_texcoord);
+    for (unsigned int u = 1; u < num_uvs; ++u) {
+      ostringstream out;
+      out << u;
+      aformat->add_column(InternalName::get_texcoord_name(out.str()), 3, Geom::NT_stdfloat, Geom::C_texcoord);
+    }
+  }
+
+  PT(GeomVertexArrayFormat) tb_aformat = new GeomVertexArrayFormat;
+  tb_aformat->add_column(InternalName::make("transform_blend"), 1, Geom::NT_uint16, Geom::C_index);
+
   // TODO: if there is only one UV set, hackily iterate over the texture
   // stages and clear the texcoord name things
 
@@ -734,46 +817,28 @@ load_mesh(size_t index) {
   vdata->unclean_set_num_rows(mesh.mNumVertices);
 
   // Read out the vertices.
-  GeomVertexWriter vertex (vdata, InternalName::get_vertex());
-  for (size_t i = 0; i < mesh.mNumVertices; ++i) {
-    const aiVector3D &vec = mesh.mVertices[i];
-    vertex.add_data3(vec.x, vec.y, vec.z);
-  }
+  copy_column(vdata, InternalName::get_vertex(), &mesh.mVertices[0].x, 3);
 
   // Now the normals, if any.
   if (mesh.HasNormals()) {
-    GeomVertexWriter normal (vdata, InternalName::get_normal());
-    for (size_t i = 0; i < mesh.mNumVertices; ++i) {
-      const aiVector3D &vec = mesh.mNormals[i];
-      normal.add_data3(vec.x, vec.y, vec.z);
-    }
+    copy_column(vdata, InternalName::get_normal(), &mesh.mNormals[0].x, 3);
   }
 
   // Vertex colors, if any.  We only import the first set.
   if (mesh.HasVertexColors(0)) {
-    GeomVertexWriter color (vdata, InternalName::get_color());
-    for (size_t i = 0; i < mesh.mNumVertices; ++i) {
-      const aiColor4D &col = mesh.mColors[0][i];
-      color.add_data4(col.r, col.g, col.b, col.a);
-    }
+    copy_column(vdata, InternalName::get_color(), &mesh.mColors[0][0].r, 4);
   }
 
   // Now the texture coordinates.
   if (num_uvs > 0) {
     // UV sets are named texcoord, texcoord.1, texcoord.2...
-    GeomVertexWriter texcoord0 (vdata, InternalName::get_texcoord());
-    for (size_t i = 0; i < mesh.mNumVertices; ++i) {
-      const aiVector3D &vec = mesh.mTextureCoords[0][i];
-      texcoord0.add_data3(vec.x, vec.y, vec.z);
-    }
+    copy_column(vdata, InternalName::get_texcoord(),
+                &mesh.mTextureCoords[0][0].x, 3);
     for (unsigned int u = 1; u < num_uvs; ++u) {
       ostringstream out;
       out << u;
-      GeomVertexWriter texcoord (vdata, InternalName::get_texcoord_name(out.str()));
-      for (size_t i = 0; i < mesh.mNumVertices; ++i) {
-        const aiVector3D &vec = mesh.mTextureCoords[u][i];
-        texcoord.add_data3(vec.x, vec.y, vec.z);
-      }
+      copy_column(vdata, InternalName::get_texcoord_name(out.str()),
+                  &mesh.mTextureCoords[u][0].x, 3);
     }
   }
 
@@ -835,15 +900,15 @@ load_mesh(size_t index) {
 
   _geoms[index] = geom;
   _geom_matindices[index] = mesh.mMaterialIndex;
+}
 
-  if (character) {
-    _characters[index] = character;
-
-    PT(GeomNode) gnode = new GeomNode("");
-    gnode->add_geom(geom);
-    gnode->set_state(_mat_states[mesh.mMaterialIndex]);
-    character->add_child(gnode);
-  }
+/**
+ * The WorkerPool job function for load_mesh().
+ */
+void AssimpLoader::
+load_mesh_job(int index, void *user_data) {
+  AssimpLoader *self = (AssimpLoader *)user_data;
+  self->load_mesh((size_t)index);
 }
 
 /**
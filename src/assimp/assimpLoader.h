@@ -19,6 +19,8 @@
 #include "modelRoot.h"
 #include "texture.h"
 #include "pmap.h"
+#include "phash_map.h"
+#include "stl_compares.h"
 
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
@@ -35,6 +37,7 @@ struct char_cmp {
   }
 };
 typedef pmap<const char *, const aiNode *, char_cmp> BoneMap;
+typedef phash_map<std::string, const aiNode *, string_hash> NodeMap;
 
 /**
  * Class that interfaces with Assimp and builds Panda nodes to represent the
@@ -66,16 +69,20 @@ private:
   PT(Geom) *_geoms;
   unsigned int *_geom_matindices;
   BoneMap _bonemap;
+  NodeMap _nodemap;
   PT(Character) *_characters;
 
-  const aiNode *find_node(const aiNode &root, const aiString &name);
+  void index_nodes(const aiNode &node);
+  const aiNode *find_node(const aiString &name) const;
 
   void load_texture(size_t index);
   void load_texture_stage(const aiMaterial &mat, const aiTextureType &ttype, CPT(TextureAttrib) &tattr);
   void load_material(size_t index);
   void create_joint(Character *character, CharacterJointBundle *bundle, PartGroup *parent, const aiNode &node);
   void create_anim_channel(const aiAnimation &anim, AnimBundle *bundle, AnimGroup *parent, const aiNode &node);
+  void create_character(size_t index);
   void load_mesh(size_t index);
+  static void load_mesh_job(int index, void *user_data);
   bool load_node(const aiNode &node, PandaNode *parent, bool under_joint = false);
   void load_light(const aiLight &light);
 };
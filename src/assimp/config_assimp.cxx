@@ -86,6 +86,13 @@ ConfigVariableDouble assimp_smooth_normal_angle
           "normals. Note that you may need to clear the model-cache after "
           "changing this."));
 
+ConfigVariableInt assimp_load_threads
+("assimp-load-threads", 1,
+ PRC_DESC("The number of threads to use for converting the meshes of a model "
+          "loaded via Assimp.  Large scenes with many meshes load faster when "
+          "this is set to the number of available CPU cores.  The default, 1, "
+          "converts the meshes one at a time on the loading thread."));
+
 /**
  * Initializes the library.  This must be called at least once before any of
  * the functions or classes in this library can be used.  Normally it will be
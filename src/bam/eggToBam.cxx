@@ -31,13 +31,21 @@
 #include "load_prc_file.h"
 #include "windowProperties.h"
 #include "frameBufferProperties.h"
+#include "workerPool.h"
+#include "mutexHolder.h"
+#include "trueClock.h"
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
 
 /**
  *
  */
 EggToBam::
 EggToBam() :
-  EggToSomething("Bam", ".bam", true, false)
+  EggToSomething("Bam", ".bam", true, false),
+  _texture_cvar(_texture_lock)
 {
   set_program_brief("convert .egg files to .bam files");
   set_program_description
@@ -199,6 +207,34 @@ EggToBam() :
      ,
      &EggToBam::dispatch_string, nullptr, &_load_display);
 
+  add_option
+    ("j", "threads", 0,
+     "Use the indicated number of threads to generate mipmaps, compress "
+     "textures and write texture object files concurrently, when using "
+     "-rawtex or -txo.  The default is 1, which processes the textures one "
+     "at a time."
+#ifndef HAVE_SQUISH
+     "  Since your Panda does not have libsquish compiled in, -ctex "
+     "requires the textures to be processed one at a time anyway."
+#endif  // HAVE_SQUISH
+     ,
+     &EggToBam::dispatch_int, nullptr, &_num_threads);
+
+  add_option
+    ("texmem", "megabytes", 0,
+     "Limits the amount of image memory that may be in use by the "
+     "textures being processed concurrently with -j.  A texture that would "
+     "exceed this budget waits until others have finished, although one "
+     "texture is always allowed to proceed, however large.  Specify 0 for "
+     "no limit.  The default is 1024.",
+     &EggToBam::dispatch_int, nullptr, &_tex_memory_budget);
+
+  add_option
+    ("textime", "", 0,
+     "Report the time spent processing each texture with -rawtex or -txo, "
+     "from slowest to fastest.",
+     &EggToBam::dispatch_none, &_tex_report);
+
   redescribe_option
     ("cs",
      "Specify the coordinate system of the resulting " + _format_name +
@@ -212,6 +248,9 @@ EggToBam() :
   _egg_suppress_hidden = 1;
   _tex_txopz = false;
   _ctex_quality = "best";
+  _num_threads = 1;
+  _tex_memory_budget = 1024;
+  _texture_memory = 0;
 }
 
 /**
@@ -273,41 +312,7 @@ run() {
 
   if (_tex_txo || _tex_txopz || (_tex_ctex && _tex_rawdata)) {
     collect_textures(root);
-    Textures::iterator ti;
-    for (ti = _textures.begin(); ti != _textures.end(); ++ti) {
-      Texture *tex = (*ti);
-      tex->get_ram_image();
-      bool want_mipmaps = (_tex_mipmap || tex->uses_mipmaps());
-      if (want_mipmaps) {
-  // Generate mipmap levels.
-  tex->generate_ram_mipmap_images();
-      }
-
-      if (_tex_ctex) {
-#ifdef HAVE_SQUISH
-        if (!tex->compress_ram_image()) {
-          nout << "  couldn't compress " << tex->get_name() << "\n";
-        }
-        tex->set_compression(Texture::CM_on);
-#else  // HAVE_SQUISH
-        tex->set_keep_ram_image(true);
-  bool has_mipmap_levels = (tex->get_num_ram_mipmap_images() > 1);
-        if (!_engine->extract_texture_data(tex, _gsg)) {
-          nout << "  couldn't compress " << tex->get_name() << "\n";
-        }
-  if (!has_mipmap_levels && !want_mipmaps) {
-    // Make sure we didn't accidentally introduce mipmap levels by
-    // rendezvousing through the graphics card.
-    tex->clear_ram_mipmap_images();
-  }
-        tex->set_keep_ram_image(false);
-#endif  // HAVE_SQUISH
-      }
-
-      if (_tex_txo || _tex_txopz) {
-        convert_txo(tex);
-      }
-    }
+    process_textures();
   }
 
   if (_ls) {
@@ -393,6 +398,194 @@ collect_textures(const RenderState *state) {
   }
 }
 
+/**
+ * Generates mipmaps for, compresses, and/or writes texture object files for
+ * all of the textures collected by collect_textures(), as requested on the
+ * command line.  The textures are independent of each other, so they are
+ * shared out among -j threads; the bam file is not written until they have
+ * all finished.
+ */
+void EggToBam::
+process_textures() {
+  int num_threads = _num_threads;
+#ifndef HAVE_SQUISH
+  if (_tex_ctex) {
+    // The graphics context can only be used from the main thread.
+    num_threads = 1;
+  }
+#endif  // HAVE_SQUISH
+
+  // Start the biggest textures first, so that a big texture near the end of
+  // the list doesn't leave the other threads idle while it finishes.
+  pvector<std::pair<size_t, Texture *> > sorted;
+  sorted.reserve(_textures.size());
+  Textures::iterator ti;
+  for (ti = _textures.begin(); ti != _textures.end(); ++ti) {
+    Texture *tex = (*ti);
+    size_t bytes = estimate_texture_memory(tex);
+    sorted.push_back(std::pair<size_t, Texture *>(bytes, tex));
+  }
+  std::sort(sorted.begin(), sorted.end(),
+            std::greater<std::pair<size_t, Texture *> >());
+
+  _texture_list.clear();
+  _texture_list.reserve(sorted.size());
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    _texture_list.push_back(sorted[i].second);
+  }
+  _texture_times.assign(_texture_list.size(), 0.0);
+  _texture_memory = 0;
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double start = clock->get_short_time();
+
+  WorkerPool pool(num_threads);
+  pool.run((int)_texture_list.size(), &EggToBam::process_texture_job, this);
+
+  if (_tex_report) {
+    nout << "Processed " << _texture_list.size() << " textures in "
+         << (int)((clock->get_short_time() - start) * 1000.0 + 0.5)
+         << " ms using " << pool.get_num_threads() << " thread(s).\n";
+    report_texture_times();
+  }
+}
+
+/**
+ * Generates mipmaps for, compresses, and/or writes a texture object file for
+ * the indicated texture.  This may be called from any of the worker threads
+ * in process_textures().
+ */
+void EggToBam::
+process_texture(Texture *tex) {
+  tex->get_ram_image();
+  bool want_mipmaps = (_tex_mipmap || tex->uses_mipmaps());
+  if (want_mipmaps) {
+    // Generate mipmap levels.
+    tex->generate_ram_mipmap_images();
+  }
+
+  if (_tex_ctex) {
+#ifdef HAVE_SQUISH
+    if (!tex->compress_ram_image()) {
+      write_message("  couldn't compress " + tex->get_name() + "\n");
+    }
+    tex->set_compression(Texture::CM_on);
+#else  // HAVE_SQUISH
+    tex->set_keep_ram_image(true);
+    bool has_mipmap_levels = (tex->get_num_ram_mipmap_images() > 1);
+    if (!_engine->extract_texture_data(tex, _gsg)) {
+      write_message("  couldn't compress " + tex->get_name() + "\n");
+    }
+    if (!has_mipmap_levels && !want_mipmaps) {
+      // Make sure we didn't accidentally introduce mipmap levels by
+      // rendezvousing through the graphics card.
+      tex->clear_ram_mipmap_images();
+    }
+    tex->set_keep_ram_image(false);
+#endif  // HAVE_SQUISH
+  }
+
+  if (_tex_txo || _tex_txopz) {
+    convert_txo(tex);
+  }
+}
+
+/**
+ * The WorkerPool callback for process_textures().  Waits until there is room
+ * in the memory budget for the indicated texture, then processes it and
+ * records how long that took.
+ */
+void EggToBam::
+process_texture_job(int job_index, void *user_data) {
+  EggToBam *self = (EggToBam *)user_data;
+  Texture *tex = self->_texture_list[job_index];
+
+  size_t budget = (size_t)-1;
+  if (self->_tex_memory_budget > 0) {
+    budget = (size_t)self->_tex_memory_budget << 20;
+  }
+  size_t need = self->estimate_texture_memory(tex);
+
+  {
+    MutexHolder holder(self->_texture_lock);
+    while (self->_texture_memory != 0 &&
+           self->_texture_memory + need > budget) {
+      self->_texture_cvar.wait();
+    }
+    self->_texture_memory += need;
+  }
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double start = clock->get_short_time();
+  self->process_texture(tex);
+  self->_texture_times[job_index] = clock->get_short_time() - start;
+
+  {
+    MutexHolder holder(self->_texture_lock);
+    self->_texture_memory -= need;
+    self->_texture_cvar.notify_all();
+  }
+}
+
+/**
+ * Returns a rough estimate of the number of bytes of image memory needed
+ * while processing the indicated texture: its uncompressed image, plus its
+ * mipmap levels if they will be generated, plus room for the compressed
+ * result.
+ */
+size_t EggToBam::
+estimate_texture_memory(Texture *tex) const {
+  size_t bytes = (size_t)tex->get_x_size() * (size_t)tex->get_y_size() *
+    (size_t)tex->get_z_size() * (size_t)tex->get_num_components() *
+    (size_t)tex->get_component_width();
+
+  if (_tex_mipmap || tex->uses_mipmaps()) {
+    bytes += bytes / 3;
+  }
+  if (_tex_ctex) {
+    bytes += bytes / 4;
+  }
+  return bytes;
+}
+
+/**
+ * Writes the time spent on each texture by process_textures(), slowest
+ * first.
+ */
+void EggToBam::
+report_texture_times() const {
+  pvector<std::pair<double, int> > order;
+  order.reserve(_texture_list.size());
+  for (size_t i = 0; i < _texture_list.size(); ++i) {
+    order.push_back(std::pair<double, int>(_texture_times[i], (int)i));
+  }
+  std::sort(order.begin(), order.end(),
+            std::greater<std::pair<double, int> >());
+
+  for (size_t i = 0; i < order.size(); ++i) {
+    Texture *tex = _texture_list[order[i].second];
+    nout << "  " << (int)(order[i].first * 1000.0 + 0.5) << " ms  "
+         << tex->get_name() << " (" << tex->get_x_size() << " x "
+         << tex->get_y_size();
+    if (tex->get_z_size() > 1) {
+      nout << " x " << tex->get_z_size();
+    }
+    nout << ")\n";
+  }
+}
+
+/**
+ * Writes the indicated message, which should be one or more complete lines,
+ * to nout.  Since this may be called from any of the worker threads in
+ * process_textures(), the message is written all at once while holding
+ * _texture_lock, so that lines from different threads are not interleaved.
+ */
+void EggToBam::
+write_message(const std::string &message) {
+  MutexHolder holder(_texture_lock);
+  nout << message << std::flush;
+}
+
 /**
  * If the indicated Texture was not already loaded from a txo file, writes it
  * to a txo file and updates the Texture object to reference the new file.
@@ -412,11 +605,13 @@ convert_txo(Texture *tex) {
     }
 
     if (tex->write(fullpath)) {
-      nout << "  Writing " << fullpath;
+      std::ostringstream message;
+      message << "  Writing " << fullpath;
       if (tex->get_ram_image_compression() != Texture::CM_off) {
-        nout << " (compressed " << tex->get_ram_image_compression() << ")";
+        message << " (compressed " << tex->get_ram_image_compression() << ")";
       }
-      nout << "\n";
+      message << "\n";
+      write_message(message.str());
       tex->set_loaded_from_txo();
       tex->set_fullpath(fullpath);
       tex->clear_alpha_fullpath();
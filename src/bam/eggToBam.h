@@ -18,7 +18,10 @@
 
 #include "eggToSomething.h"
 #include "pset.h"
+#include "pvector.h"
 #include "graphicsPipe.h"
+#include "pmutex.h"
+#include "conditionVar.h"
 
 class PandaNode;
 class RenderState;
@@ -44,6 +47,13 @@ private:
   void collect_textures(const RenderState *state);
   void convert_txo(Texture *tex);
 
+  void process_textures();
+  void process_texture(Texture *tex);
+  static void process_texture_job(int job_index, void *user_data);
+  size_t estimate_texture_memory(Texture *tex) const;
+  void report_texture_times() const;
+  void write_message(const std::string &message);
+
   bool make_buffer();
 
 private:
@@ -66,6 +76,19 @@ private:
   bool _tex_mipmap;
   std::string _ctex_quality;
   std::string _load_display;
+  int _num_threads;
+  int _tex_memory_budget;
+  bool _tex_report;
+
+  // These are used by process_textures() to share out the textures among the
+  // worker threads.  _texture_memory is the estimated number of bytes in use
+  // by the textures currently being processed; it is kept under the budget
+  // given by -texmem.
+  pvector<Texture *> _texture_list;
+  pvector<double> _texture_times;
+  Mutex _texture_lock;
+  ConditionVar _texture_cvar;
+  size_t _texture_memory;
 
   // The rest of this is required to support -ctex.
   PT(GraphicsPipe) _pipe;
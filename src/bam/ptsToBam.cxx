@@ -18,12 +18,114 @@
 #include "bamFile.h"
 #include "pandaNode.h"
 #include "geomNode.h"
+#include "lodNode.h"
+#include "boundingBox.h"
 #include "dcast.h"
 #include "string_utils.h"
+#include "pstrtod.h"
 #include "config_egg2pg.h"
 
+#include <limits>
+#include <string.h>
+
 using std::string;
 
+// The size of each block read from the pts file.
+static const size_t read_block_size = 1024 * 1024;
+
+// An interior node of the octree switches from its coarse sample to its
+// children when the camera comes within this many times its radius.
+static const double lod_switch_scale = 2.0;
+
+static const double powers_of_ten[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/**
+ * Returns true if the character separates numbers on a line of the pts file.
+ */
+static inline bool
+is_pts_space(char ch) {
+  return (ch == ' ' || ch == '\t' || ch == '\r');
+}
+
+/**
+ * Scans a floating-point number from the nul-terminated string at p, and
+ * advances p past it and any whitespace that follows.  Returns false if there
+ * is no number at p.
+ *
+ * Numbers with few enough digits to be represented exactly are converted
+ * directly; anything else is passed to pstrtod().
+ */
+static bool
+scan_number(const char *&p, double &result) {
+  const char *start = p;
+  const char *q = p;
+  bool negative = false;
+  if (*q == '-') {
+    negative = true;
+    ++q;
+  } else if (*q == '+') {
+    ++q;
+  }
+
+  uint64_t mantissa = 0;
+  int num_digits = 0;
+  int exponent = 0;
+  bool any_digits = false;
+  while (*q >= '0' && *q <= '9') {
+    mantissa = mantissa * 10 + (*q - '0');
+    if (mantissa != 0) {
+      ++num_digits;
+    }
+    any_digits = true;
+    ++q;
+  }
+  if (*q == '.') {
+    ++q;
+    while (*q >= '0' && *q <= '9') {
+      mantissa = mantissa * 10 + (*q - '0');
+      if (mantissa != 0) {
+        ++num_digits;
+      }
+      --exponent;
+      any_digits = true;
+      ++q;
+    }
+  }
+
+  if (any_digits && num_digits <= 15 && exponent >= -22 &&
+      (*q == '\0' || is_pts_space(*q))) {
+    result = (double)mantissa;
+    if (exponent < 0) {
+      result /= powers_of_ten[-exponent];
+    }
+    if (negative) {
+      result = -result;
+    }
+
+  } else {
+    // An exponent, too many digits, or something we don't understand; let
+    // pstrtod() sort it out.
+    char *endptr;
+    result = pstrtod(start, &endptr);
+    if (endptr == start) {
+      return false;
+    }
+    q = endptr;
+    if (*q != '\0' && !is_pts_space(*q)) {
+      return false;
+    }
+  }
+
+  while (is_pts_space(*q)) {
+    ++q;
+  }
+  p = q;
+  return true;
+}
+
 /**
  *
  */
@@ -53,7 +155,42 @@ PtsToBam() : WithOutputFile(true, false, true)
      "points.",
      &PtsToBam::dispatch_double, nullptr, &_decimate_divisor);
 
+  add_option
+    ("octree", "depth", 0,
+     "Rather than collecting the whole point cloud into a single node, streams "
+     "the points into an octree of the indicated depth (1 to 6).  Each leaf "
+     "cell of the octree is written to its own bam file beside the output "
+     "file, named for the output file with the cell coordinates appended.  "
+     "The output file itself receives a hierarchy of LODNodes, each of which "
+     "holds a reduced sample of the points within it for viewing from a "
+     "distance, and a placeholder node for each leaf cell whose \"cell\" tag "
+     "names the bam file to page in when that cell comes into view.  The "
+     "pts file is read twice: once to find its bounding box, and once to "
+     "distribute the points.",
+     &PtsToBam::dispatch_int, nullptr, &_octree_depth);
+
+  add_option
+    ("lodpts", "count", 0,
+     "Specifies the maximum number of points in the reduced sample kept for "
+     "each interior node of the octree, when -octree is in effect.  The "
+     "samples may be smaller than this on the deeper levels of the octree, "
+     "to keep within the -membuf limit.  The default is 16384.",
+     &PtsToBam::dispatch_int, nullptr, &_lod_points);
+
+  add_option
+    ("membuf", "count", 0,
+     "Specifies the number of points that may be held in memory while "
+     "distributing them into the octree, when -octree is in effect.  Up to "
+     "half of this is used by the reduced samples of the interior nodes; "
+     "whenever the rest has filled with points, the points in every cell "
+     "are appended to a temporary file for that cell on disk.  The default "
+     "is 16777216.",
+     &PtsToBam::dispatch_int, nullptr, &_buffer_points);
+
   _decimate_divisor = 1.0;
+  _octree_depth = 0;
+  _lod_points = 16384;
+  _buffer_points = 16 * 1024 * 1024;
 }
 
 /**
@@ -61,49 +198,39 @@ PtsToBam() : WithOutputFile(true, false, true)
  */
 void PtsToBam::
 run() {
+  _num_points_expected = 0;
+  _num_points_added = 0;
+  _decimate_factor = 1.0 / std::max(1.0, _decimate_divisor);
+  _num_vdatas = 0;
+
+  // This should be guaranteed because we pass false to the constructor,
+  // above.
+  nassertv(has_output_filename());
+
+  if (_octree_depth > 0) {
+    run_octree();
+    return;
+  }
+
   pifstream pts;
-  _pts_filename.set_text();
-  if (!_pts_filename.open_read(pts)) {
-    nout << "Cannot open " << _pts_filename << "\n";
+  if (!open_pts(pts)) {
     exit(1);
   }
 
   _gnode = new GeomNode(_pts_filename.get_basename());
 
-  _num_points_expected = 0;
-  _num_points_found = 0;
-  _num_points_added = 0;
-  _decimate_factor = 1.0 / std::max(1.0, _decimate_divisor);
-  _line_number = 0;
-  _point_number = 0;
-  _decimated_point_number = 0.0;
-  _num_vdatas = 0;
-  string line;
-  while (std::getline(pts, line)) {
-    process_line(line);
+  LPoint3d point;
+  while (read_point(pts, point)) {
+    add_point(point);
   }
   close_vertex_data();
 
   nout << "\nFound " << _num_points_found << " points of " << _num_points_expected << " expected.\n";
   nout << "Generated " << _num_points_added << " points to bam file.\n";
 
-  // This should be guaranteed because we pass false to the constructor,
-  // above.
-  nassertv(has_output_filename());
-
   Filename filename = get_output_filename();
-  filename.make_dir();
   nout << "Writing " << filename << "\n";
-  BamFile bam_file;
-  if (!bam_file.open_write(filename)) {
-    nout << "Error in writing.\n";
-    exit(1);
-  }
-
-  if (!bam_file.write_object(_gnode.p())) {
-    nout << "Error in writing.\n";
-    exit(1);
-  }
+  write_bam(filename, _gnode);
 }
 
 /**
@@ -121,69 +248,184 @@ handle_args(ProgramBase::Args &args) {
     return false;
   }
 
+  if (_octree_depth < 0 || _octree_depth > 6) {
+    nout << "The -octree depth must be between 1 and 6.\n";
+    return false;
+  }
+
+  if (_lod_points < 1 || _buffer_points < 1) {
+    nout << "The -lodpts and -membuf counts must be positive.\n";
+    return false;
+  }
+
   _pts_filename = Filename::from_os_specific(args[0]);
 
   return true;
 }
 
 /**
- * Reads a single line from the pts file.
+ * Opens the pts file for reading from the beginning.  Returns true on
+ * success, false on failure.
+ */
+bool PtsToBam::
+open_pts(pifstream &pts) {
+  // We handle the line endings ourselves.
+  Filename filename = _pts_filename;
+  filename.set_binary();
+  if (!filename.open_read(pts)) {
+    nout << "Cannot open " << _pts_filename << "\n";
+    return false;
+  }
+
+  reset_reader();
+  return true;
+}
+
+/**
+ * Resets the line-reading state in preparation for reading the pts file from
+ * the beginning.
  */
 void PtsToBam::
-process_line(const string &line) {
+reset_reader() {
+  _read_buffer.resize(read_block_size);
+  _read_pos = 0;
+  _read_end = 0;
+  _read_eof = false;
+
+  _line_number = 0;
+  _point_number = 0;
+  _num_points_found = 0;
+  _decimated_point_number = 0.0;
+}
+
+/**
+ * Reads lines from the pts file until the next point that survives
+ * decimation, and stores it in point.  Returns true if a point was read, or
+ * false at the end of the file.
+ */
+bool PtsToBam::
+read_point(std::istream &pts, LPoint3d &point) {
+  while (true) {
+    char *begin = &_read_buffer[0];
+    char *line = begin + _read_pos;
+    char *end = (char *)memchr(line, '\n', _read_end - _read_pos);
+    size_t next_pos;
+    if (end != nullptr) {
+      next_pos = (end - begin) + 1;
+
+    } else if (!_read_eof) {
+      fill_buffer(pts);
+      continue;
+
+    } else if (_read_pos < _read_end) {
+      // The last line has no newline; fill_buffer() always leaves room for
+      // the terminating nul.
+      end = begin + _read_end;
+      next_pos = _read_end;
+
+    } else {
+      return false;
+    }
+
+    *end = '\0';
+    _read_pos = next_pos;
+    if (process_line(line, point)) {
+      return true;
+    }
+  }
+}
+
+/**
+ * Moves any partial line to the start of the read buffer and reads the next
+ * block of the file after it.  Returns false if nothing more could be read.
+ */
+bool PtsToBam::
+fill_buffer(std::istream &pts) {
+  size_t remaining = _read_end - _read_pos;
+  if (_read_pos != 0) {
+    memmove(&_read_buffer[0], &_read_buffer[_read_pos], remaining);
+  }
+  _read_pos = 0;
+  _read_end = remaining;
+
+  if (_read_end + 1 >= _read_buffer.size()) {
+    // A single line fills the whole buffer.
+    _read_buffer.resize(_read_buffer.size() * 2);
+  }
+
+  size_t room = _read_buffer.size() - 1 - _read_end;
+  pts.read(&_read_buffer[_read_end], room);
+  size_t count = (size_t)pts.gcount();
+  _read_end += count;
+  if (count < room) {
+    _read_eof = true;
+  }
+  return (count != 0);
+}
+
+/**
+ * Processes a single nul-terminated line from the pts file.  Returns true if
+ * the line defines a point that survives decimation, in which case it is
+ * stored in point.
+ */
+bool PtsToBam::
+process_line(char *line, LPoint3d &point) {
   _line_number++;
 
   if (_line_number % 1000000 == 0) {
     std::cerr << "." << std::flush;
   }
 
-  if (line.empty() || !isdigit(line[0])) {
-    return;
+  const char *p = line;
+  while (is_pts_space(*p)) {
+    ++p;
+  }
+  if (!isdigit(*p) && *p != '-' && *p != '+' && *p != '.') {
+    return false;
+  }
+
+  double values[3];
+  int num_values = 0;
+  while (num_values < 3 && scan_number(p, values[num_values])) {
+    ++num_values;
   }
 
-  if (_line_number == 1) {
+  if (_line_number == 1 && num_values == 1 && *p == '\0') {
     // The first line might be just the number of points.
-    vector_string words;
-    tokenize(trim(line), words, " \t", true);
-    if (words.size() == 1) {
-      string tail;
-      _num_points_expected = string_to_int(words[0], tail);
+    if (_num_points_expected == 0) {
+      _num_points_expected = (uint64_t)values[0];
       nout << "Expecting " << _num_points_expected << " points, will generate "
-           << (int)(_num_points_expected * _decimate_factor) << "\n";
-      return;
+           << (uint64_t)(_num_points_expected * _decimate_factor) << "\n";
     }
+    return false;
   }
 
   // Here we might have a point.
   _num_points_found++;
   _decimated_point_number += _decimate_factor;
-  int point_number = int(_decimated_point_number);
-  if (point_number > _point_number) {
-    _point_number = point_number;
+  uint64_t point_number = (uint64_t)_decimated_point_number;
+  if (point_number <= _point_number) {
+    return false;
+  }
+  _point_number = point_number;
 
-    vector_string words;
-    tokenize(trim(line), words, " \t", true);
-    if (words.size() >= 3) {
-      add_point(words);
-    }
+  if (num_values < 3) {
+    return false;
   }
+  point.set(values[0], values[1], values[2]);
+  return true;
 }
 
 /**
  * Adds a point from the pts file.
  */
 void PtsToBam::
-add_point(const vector_string &words) {
+add_point(const LPoint3d &point) {
   if (_data == nullptr || _data->get_num_rows() >= egg_max_vertices) {
     open_vertex_data();
   }
 
-  string tail;
-  double x, y, z;
-  x = string_to_double(words[0], tail);
-  y = string_to_double(words[1], tail);
-  z = string_to_double(words[2], tail);
-  _vertex.add_data3d(x, y, z);
+  _vertex.add_data3d(point);
   _num_points_added++;
 }
 
@@ -230,6 +472,460 @@ close_vertex_data() {
   _data = nullptr;
 }
 
+/**
+ * Converts the pts file in octree mode.  The file is scanned once for its
+ * bounding box, and then again to distribute the points among the leaf cells
+ * of the octree, and to sample them for the interior nodes.  Only a bounded
+ * number of points is held in memory at any time; the rest wait in a
+ * temporary file per cell until the cell is written.
+ */
+void PtsToBam::
+run_octree() {
+  pifstream pts;
+  if (!open_pts(pts)) {
+    exit(1);
+  }
+
+  nout << "Scanning " << _pts_filename << " for bounds\n";
+  uint64_t num_points = 0;
+  LPoint3d point;
+  while (read_point(pts, point)) {
+    if (num_points == 0) {
+      _min_point = point;
+      _max_point = point;
+    } else {
+      for (int i = 0; i < 3; ++i) {
+        _min_point[i] = std::min(_min_point[i], point[i]);
+        _max_point[i] = std::max(_max_point[i], point[i]);
+      }
+    }
+    ++num_points;
+  }
+  pts.close();
+
+  nout << "\nFound " << _num_points_found << " points of "
+       << _num_points_expected << " expected.\n";
+
+  PT(PandaNode) root = new PandaNode(_pts_filename.get_basename());
+  if (num_points == 0) {
+    nout << "Writing " << get_output_filename() << "\n";
+    write_bam(get_output_filename(), root);
+    return;
+  }
+
+  _cells_per_axis = 1 << _octree_depth;
+  LVector3d size = _max_point - _min_point;
+  for (int i = 0; i < 3; ++i) {
+    if (size[i] <= 0.0) {
+      // A flat cloud; give the cells some thickness anyway.
+      size[i] = 1.0;
+      _max_point[i] = _min_point[i] + size[i];
+    }
+    _cell_scale[i] = _cells_per_axis / size[i];
+  }
+
+  _cells.clear();
+  _cells.resize((size_t)_cells_per_axis * _cells_per_axis * _cells_per_axis);
+  for (Cells::iterator ci = _cells.begin(); ci != _cells.end(); ++ci) {
+    (*ci)._num_points = 0;
+  }
+
+  // Each interior node keeps a random sample of up to _lod_points of the
+  // points within it.  The samples stay in memory until the end, so they
+  // count against the -membuf budget: half of it is shared equally among the
+  // levels, and divided among the nodes of each level, and whatever the
+  // samples don't use is left for buffering the leaf cells.  Only every nth
+  // point is offered to the nodes of each level, where n is chosen so that a
+  // node of average density is offered a few times as many points as it can
+  // keep.
+  uint64_t level_budget =
+    std::max((uint64_t)_buffer_points / 2 / _octree_depth, (uint64_t)1);
+  uint64_t num_sample_points = 0;
+  _samples.clear();
+  _samples.resize(_octree_depth);
+  _sample_sizes.clear();
+  _sample_strides.clear();
+  for (int level = 0; level < _octree_depth; ++level) {
+    size_t num_nodes = (size_t)1 << (3 * level);
+    _samples[level].resize(num_nodes);
+    for (Samples::iterator si = _samples[level].begin();
+         si != _samples[level].end();
+         ++si) {
+      (*si)._num_seen = 0;
+    }
+    uint64_t sample_size =
+      std::min((uint64_t)_lod_points, level_budget / num_nodes);
+    sample_size = std::max(sample_size, (uint64_t)1);
+    _sample_sizes.push_back((int)sample_size);
+    num_sample_points += sample_size * num_nodes;
+
+    double per_node = (double)num_points / (double)num_nodes;
+    uint64_t stride = (uint64_t)(per_node / (4.0 * sample_size));
+    _sample_strides.push_back(std::max(stride, (uint64_t)1));
+  }
+  _cell_buffer_points = 1;
+  if (num_sample_points < (uint64_t)_buffer_points) {
+    _cell_buffer_points = (uint64_t)_buffer_points - num_sample_points;
+  }
+
+  if (!open_pts(pts)) {
+    exit(1);
+  }
+
+  nout << "Distributing " << num_points << " points into "
+       << _cells.size() << " cells\n";
+  _num_buffered = 0;
+  _random_seed = 1;
+  while (read_point(pts, point)) {
+    bucket_point(point);
+  }
+  pts.close();
+
+  write_cells();
+
+  PT(PandaNode) octree = build_octree(0, 0, 0, 0);
+  if (octree != nullptr) {
+    root->add_child(octree);
+  }
+
+  nout << "\nGenerated " << _num_points_added << " points in "
+       << _num_cells_written << " cells.\n";
+
+  nout << "Writing " << get_output_filename() << "\n";
+  write_bam(get_output_filename(), root);
+}
+
+/**
+ * Files a point in its leaf cell, and offers it to the samples of the
+ * interior nodes that contain it.
+ */
+void PtsToBam::
+bucket_point(const LPoint3d &point) {
+  int coords[3];
+  for (int i = 0; i < 3; ++i) {
+    int c = (int)((point[i] - _min_point[i]) * _cell_scale[i]);
+    coords[i] = std::max(0, std::min(c, _cells_per_axis - 1));
+  }
+
+  LPoint3f fpoint = LCAST(float, point);
+  int index = get_index(_octree_depth, coords[0], coords[1], coords[2]);
+  Cell &cell = _cells[index];
+  cell._buffer.push_back(fpoint);
+  cell._num_points++;
+  _num_points_added++;
+
+  for (int level = 0; level < _octree_depth; ++level) {
+    if (_num_points_added % _sample_strides[level] != 0) {
+      continue;
+    }
+    int shift = _octree_depth - level;
+    Sample &sample = _samples[level][get_index(level, coords[0] >> shift,
+                                               coords[1] >> shift,
+                                               coords[2] >> shift)];
+    sample._num_seen++;
+    int sample_size = _sample_sizes[level];
+    if (sample._points.size() < (size_t)sample_size) {
+      sample._points.push_back(fpoint);
+    } else {
+      // Reservoir sampling: replace a random point, with decreasing
+      // probability as more points are seen.
+      _random_seed = _random_seed * 6364136223846793005ULL +
+        1442695040888963407ULL;
+      uint64_t r = (_random_seed >> 11) % sample._num_seen;
+      if (r < (uint64_t)sample_size) {
+        sample._points[r] = fpoint;
+      }
+    }
+  }
+
+  _num_buffered++;
+  if (_num_buffered >= _cell_buffer_points) {
+    spill_all_cells();
+  }
+}
+
+/**
+ * Appends the points buffered in the indicated cell to its temporary file,
+ * and releases the buffer.
+ */
+void PtsToBam::
+spill_cell(Cell &cell) {
+  if (cell._buffer.empty()) {
+    return;
+  }
+
+  if (cell._spill_filename.empty()) {
+    Filename dirname = get_output_filename().get_dirname();
+    if (dirname.empty()) {
+      dirname = ".";
+    }
+    cell._spill_filename = Filename::temporary(dirname, "pts_", ".tmp");
+    cell._spill_filename.set_binary();
+  }
+
+  pofstream out;
+  if (!cell._spill_filename.open_append(out)) {
+    nout << "Unable to write " << cell._spill_filename << "\n";
+    exit(1);
+  }
+  out.write((const char *)&cell._buffer[0],
+            cell._buffer.size() * sizeof(LPoint3f));
+  if (out.fail()) {
+    nout << "Error writing " << cell._spill_filename << "\n";
+    exit(1);
+  }
+
+  _num_buffered -= cell._buffer.size();
+  pvector<LPoint3f> empty;
+  cell._buffer.swap(empty);
+}
+
+/**
+ * Moves the points buffered in all of the cells out to disk.
+ */
+void PtsToBam::
+spill_all_cells() {
+  for (Cells::iterator ci = _cells.begin(); ci != _cells.end(); ++ci) {
+    spill_cell(*ci);
+  }
+}
+
+/**
+ * Writes each non-empty leaf cell to its own bam file, one cell at a time,
+ * and removes its temporary file.
+ */
+void PtsToBam::
+write_cells() {
+  _num_cells_written = 0;
+  for (int z = 0; z < _cells_per_axis; ++z) {
+    for (int y = 0; y < _cells_per_axis; ++y) {
+      for (int x = 0; x < _cells_per_axis; ++x) {
+        Cell &cell = _cells[get_index(_octree_depth, x, y, z)];
+        if (cell._num_points != 0) {
+          if (!write_cell(x, y, z, cell)) {
+            exit(1);
+          }
+          _num_cells_written++;
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Writes the points of the indicated leaf cell to its bam file.  Returns true
+ * on success, false on failure.
+ */
+bool PtsToBam::
+write_cell(int x, int y, int z, Cell &cell) {
+  PT(GeomNode) gnode = new GeomNode("cell_" + format_string(x) + "_" +
+                                    format_string(y) + "_" + format_string(z));
+
+  if (cell._spill_filename.empty()) {
+    make_points(gnode, &cell._buffer[0], cell._buffer.size());
+    pvector<LPoint3f> empty;
+    cell._buffer.swap(empty);
+
+  } else {
+    // Some of the points are on disk; put the rest with them, and read them
+    // back a vertex data's worth at a time.
+    spill_cell(cell);
+
+    pifstream in;
+    if (!cell._spill_filename.open_read(in)) {
+      nout << "Unable to read " << cell._spill_filename << "\n";
+      return false;
+    }
+
+    size_t chunk_size = (size_t)std::max((int)egg_max_vertices, 1);
+    pvector<LPoint3f> points(chunk_size);
+    while (true) {
+      in.read((char *)&points[0], chunk_size * sizeof(LPoint3f));
+      size_t count = (size_t)in.gcount() / sizeof(LPoint3f);
+      if (count == 0) {
+        break;
+      }
+      make_points(gnode, &points[0], count);
+    }
+    in.close();
+    cell._spill_filename.unlink();
+    cell._spill_filename = Filename();
+  }
+
+  write_bam(get_cell_filename(x, y, z), gnode);
+  return true;
+}
+
+/**
+ * Builds the scene graph for the octree node at the indicated level and
+ * coordinates, or returns NULL if it contains no points.  Leaf cells are
+ * represented by a placeholder node that names the cell's bam file; interior
+ * nodes by an LODNode that switches between the node's children, up close,
+ * and its sample of points, from a distance.
+ */
+PT(PandaNode) PtsToBam::
+build_octree(int level, int x, int y, int z) {
+  if (count_points(level, x, y, z) == 0) {
+    return nullptr;
+  }
+
+  LPoint3d min_point, max_point;
+  get_cell_bounds(level, x, y, z, min_point, max_point);
+  string suffix =
+    format_string(x) + "_" + format_string(y) + "_" + format_string(z);
+
+  if (level == _octree_depth) {
+    PT(PandaNode) node = new PandaNode("cell_" + suffix);
+    node->set_tag("cell", get_cell_filename(x, y, z).get_basename());
+    node->set_bounds(new BoundingBox(LCAST(PN_stdfloat, min_point),
+                                     LCAST(PN_stdfloat, max_point)));
+    return node;
+  }
+
+  PT(PandaNode) detail = new PandaNode("detail");
+  for (int i = 0; i < 8; ++i) {
+    PT(PandaNode) child = build_octree(level + 1, x * 2 + (i & 1),
+                                       y * 2 + ((i >> 1) & 1),
+                                       z * 2 + ((i >> 2) & 1));
+    if (child != nullptr) {
+      detail->add_child(child);
+    }
+  }
+
+  PT(GeomNode) coarse = new GeomNode("coarse");
+  Sample &sample = _samples[level][get_index(level, x, y, z)];
+  if (!sample._points.empty()) {
+    make_points(coarse, &sample._points[0], sample._points.size());
+  }
+  pvector<LPoint3f> empty;
+  sample._points.swap(empty);
+
+  LPoint3d center = (min_point + max_point) * 0.5;
+  PN_stdfloat radius = (PN_stdfloat)((max_point - min_point).length() * 0.5);
+  PN_stdfloat switch_distance = radius * (PN_stdfloat)lod_switch_scale;
+
+  PT(LODNode) lod = new LODNode("lod_" + format_string(level) + "_" + suffix);
+  lod->set_center(LCAST(PN_stdfloat, center));
+  lod->add_child(detail);
+  lod->add_switch(switch_distance, 0.0f);
+  lod->add_child(coarse);
+  lod->add_switch(std::numeric_limits<PN_stdfloat>::max(), switch_distance);
+  return lod;
+}
+
+/**
+ * Returns the name of the bam file that receives the indicated leaf cell.
+ */
+Filename PtsToBam::
+get_cell_filename(int x, int y, int z) const {
+  Filename filename = get_output_filename();
+  filename.set_basename_wo_extension
+    (filename.get_basename_wo_extension() + "_" + format_string(x) + "_" +
+     format_string(y) + "_" + format_string(z));
+  return filename;
+}
+
+/**
+ * Computes the bounding box of the octree node at the indicated level and
+ * coordinates.
+ */
+void PtsToBam::
+get_cell_bounds(int level, int x, int y, int z,
+                LPoint3d &min_point, LPoint3d &max_point) const {
+  int coords[3] = { x, y, z };
+  double num_nodes = (double)(1 << level);
+  for (int i = 0; i < 3; ++i) {
+    double size = (_max_point[i] - _min_point[i]) / num_nodes;
+    min_point[i] = _min_point[i] + coords[i] * size;
+    max_point[i] = min_point[i] + size;
+  }
+}
+
+/**
+ * Returns the total number of points in the leaf cells under the octree node
+ * at the indicated level and coordinates.
+ */
+uint64_t PtsToBam::
+count_points(int level, int x, int y, int z) const {
+  if (level == _octree_depth) {
+    return _cells[get_index(level, x, y, z)]._num_points;
+  }
+
+  uint64_t count = 0;
+  for (int i = 0; i < 8; ++i) {
+    count += count_points(level + 1, x * 2 + (i & 1),
+                          y * 2 + ((i >> 1) & 1),
+                          z * 2 + ((i >> 2) & 1));
+  }
+  return count;
+}
+
+/**
+ * Returns the index of the octree node at the indicated level and coordinates
+ * within the array for that level.
+ */
+int PtsToBam::
+get_index(int level, int x, int y, int z) const {
+  int num_nodes = 1 << level;
+  return (z * num_nodes + y) * num_nodes + x;
+}
+
+/**
+ * Adds the indicated points to the GeomNode, splitting them into as many
+ * vertex datas and primitives as the egg limits require.
+ */
+void PtsToBam::
+make_points(GeomNode *gnode, const LPoint3f *points, size_t num_points) {
+  CPT(GeomVertexFormat) format = GeomVertexFormat::get_v3();
+  size_t max_vertices = (size_t)std::max((int)egg_max_vertices, 1);
+
+  while (num_points > 0) {
+    size_t this_num_points = std::min(num_points, max_vertices);
+    PT(GeomVertexData) data =
+      new GeomVertexData("pts", format, GeomEnums::UH_static);
+    data->unclean_set_num_rows((int)this_num_points);
+    GeomVertexWriter vertex(data, "vertex");
+    for (size_t i = 0; i < this_num_points; ++i) {
+      vertex.set_data3f(points[i]);
+    }
+
+    PT(Geom) geom = new Geom(data);
+    int num_vertices = (int)this_num_points;
+    int vertices_so_far = 0;
+    while (num_vertices > 0) {
+      int this_num_vertices = std::min(num_vertices, (int)egg_max_indices);
+      PT(GeomPrimitive) prim = new GeomPoints(GeomEnums::UH_static);
+      prim->add_consecutive_vertices(vertices_so_far, this_num_vertices);
+      geom->add_primitive(prim);
+      vertices_so_far += this_num_vertices;
+      num_vertices -= this_num_vertices;
+    }
+    gnode->add_geom(geom);
+
+    points += this_num_points;
+    num_points -= this_num_points;
+  }
+}
+
+/**
+ * Writes the indicated node to a bam file, or exits on failure.
+ */
+void PtsToBam::
+write_bam(const Filename &filename, PandaNode *node) {
+  Filename bam_filename = filename;
+  bam_filename.make_dir();
+  BamFile bam_file;
+  if (!bam_file.open_write(bam_filename)) {
+    nout << "Error in writing.\n";
+    exit(1);
+  }
+
+  if (!bam_file.write_object(node)) {
+    nout << "Error in writing.\n";
+    exit(1);
+  }
+}
+
 int main(int argc, char *argv[]) {
   PtsToBam prog;
   prog.parse_command_line(argc, argv);
@@ -19,10 +19,12 @@
 #include "programBase.h"
 #include "withOutputFile.h"
 #include "filename.h"
-#include "vector_string.h"
 #include "geomVertexData.h"
 #include "geomVertexWriter.h"
 #include "geomNode.h"
+#include "pandaNode.h"
+#include "luse.h"
+#include "pvector.h"
 
 /**
  *
@@ -37,28 +39,85 @@ protected:
   virtual bool handle_args(Args &args);
 
 private:
-  void process_line(const std::string &line);
-  void add_point(const vector_string &words);
+  bool open_pts(pifstream &pts);
+  bool read_point(std::istream &pts, LPoint3d &point);
+  bool fill_buffer(std::istream &pts);
+  bool process_line(char *line, LPoint3d &point);
+  void reset_reader();
+
+  void add_point(const LPoint3d &point);
 
   void open_vertex_data();
   void close_vertex_data();
 
+  // The streaming octree mode.
+  class Cell {
+  public:
+    pvector<LPoint3f> _buffer;
+    Filename _spill_filename;
+    uint64_t _num_points;
+  };
+  class Sample {
+  public:
+    pvector<LPoint3f> _points;
+    uint64_t _num_seen;
+  };
+  typedef pvector<Cell> Cells;
+  typedef pvector<Sample> Samples;
+
+  void run_octree();
+  void bucket_point(const LPoint3d &point);
+  void spill_cell(Cell &cell);
+  void spill_all_cells();
+  void write_cells();
+  bool write_cell(int x, int y, int z, Cell &cell);
+  PT(PandaNode) build_octree(int level, int x, int y, int z);
+  Filename get_cell_filename(int x, int y, int z) const;
+  void get_cell_bounds(int level, int x, int y, int z,
+                       LPoint3d &min_point, LPoint3d &max_point) const;
+  uint64_t count_points(int level, int x, int y, int z) const;
+  int get_index(int level, int x, int y, int z) const;
+  void make_points(GeomNode *gnode, const LPoint3f *points, size_t num_points);
+  void write_bam(const Filename &filename, PandaNode *node);
+
 private:
   Filename _pts_filename;
   double _decimate_divisor;
   double _decimate_factor;
 
-  int _line_number;
-  int _point_number;
-  int _num_points_expected;
-  int _num_points_found;
-  int _num_points_added;
+  uint64_t _line_number;
+  uint64_t _point_number;
+  uint64_t _num_points_expected;
+  uint64_t _num_points_found;
+  uint64_t _num_points_added;
   int _num_vdatas;
 
   double _decimated_point_number;
   PT(GeomNode) _gnode;
   PT(GeomVertexData) _data;
   GeomVertexWriter _vertex;
+
+  // The input is read through this buffer, a block at a time.
+  pvector<char> _read_buffer;
+  size_t _read_pos;
+  size_t _read_end;
+  bool _read_eof;
+
+  int _octree_depth;
+  int _lod_points;
+  int _buffer_points;
+  LPoint3d _min_point;
+  LPoint3d _max_point;
+  LVector3d _cell_scale;
+  int _cells_per_axis;
+  Cells _cells;
+  pvector<Samples> _samples;
+  pvector<int> _sample_sizes;
+  pvector<uint64_t> _sample_strides;
+  uint64_t _cell_buffer_points;
+  uint64_t _num_buffered;
+  uint64_t _random_seed;
+  int _num_cells_written;
 };
 
 #endif
@@ -14,11 +14,167 @@
 #include "dxfFile.h"
 #include "string_utils.h"
 #include "virtualFileSystem.h"
+#include "pstrtod.h"
+#include "vector_int.h"
+
+#include <algorithm>
+#include <string.h>
 
 using std::istream;
 using std::ostream;
 using std::string;
 
+// The size of each block read from the DXF file.
+static const size_t dxf_buffer_size = 64 * 1024;
+
+// A binary DXF file begins with this sentinel, including the terminating
+// nul.
+static const char dxf_binary_sentinel[] = "AutoCAD Binary DXF\r\n\x1a";
+
+// The kinds of values that may follow a group code in a binary DXF file.
+enum DXFBinaryType {
+  DBT_string,
+  DBT_double,
+  DBT_int16,
+  DBT_int32,
+  DBT_int64,
+  DBT_bool,
+  DBT_binary,
+};
+
+/**
+ * Returns the kind of value that follows the indicated group code in a binary
+ * DXF file.
+ */
+static DXFBinaryType
+get_dxf_binary_type(int code) {
+  if ((code >= 10 && code <= 59) ||
+      (code >= 110 && code <= 149) ||
+      (code >= 210 && code <= 239) ||
+      (code >= 460 && code <= 469) ||
+      (code >= 1010 && code <= 1059)) {
+    return DBT_double;
+  }
+  if ((code >= 60 && code <= 79) ||
+      (code >= 170 && code <= 179) ||
+      (code >= 270 && code <= 289) ||
+      (code >= 370 && code <= 389) ||
+      (code >= 400 && code <= 409) ||
+      (code >= 1060 && code <= 1070)) {
+    return DBT_int16;
+  }
+  if ((code >= 90 && code <= 99) ||
+      (code >= 420 && code <= 429) ||
+      (code >= 440 && code <= 459) ||
+      code == 1071) {
+    return DBT_int32;
+  }
+  if (code >= 160 && code <= 169) {
+    return DBT_int64;
+  }
+  if (code >= 290 && code <= 299) {
+    return DBT_bool;
+  }
+  if ((code >= 310 && code <= 319) || code == 1004) {
+    return DBT_binary;
+  }
+  return DBT_string;
+}
+
+/**
+ * Decodes a little-endian unsigned integer of the indicated number of bytes.
+ */
+static uint64_t
+decode_dxf_le(const char *data, size_t num_bytes) {
+  const unsigned char *p = (const unsigned char *)data;
+  uint64_t value = 0;
+  for (size_t i = num_bytes; i > 0; --i) {
+    value = (value << 8) | p[i - 1];
+  }
+  return value;
+}
+
+/**
+ * A precomputed index used by find_color().  The RGB cube is divided into a
+ * grid of cells, and each cell lists the only AutoCAD colors that can
+ * possibly be nearest to a color within that cell.
+ */
+class DXFColorGrid {
+public:
+  enum { grid_size = 8 };
+
+  DXFColorGrid();
+  const vector_int &get_candidates(double r, double g, double b) const;
+
+private:
+  static int get_cell(double v);
+
+  vector_int _cells[grid_size * grid_size * grid_size];
+};
+
+/**
+ * Computes the candidate list of each cell.  A color is a candidate if its
+ * distance to the nearest point of the cell is no greater than the smallest
+ * distance, over all colors, to the farthest point of the cell.
+ */
+DXFColorGrid::
+DXFColorGrid() {
+  double cell_size = 1.0 / grid_size;
+  for (int ri = 0; ri < grid_size; ++ri) {
+    for (int gi = 0; gi < grid_size; ++gi) {
+      for (int bi = 0; bi < grid_size; ++bi) {
+        LPoint3d lo(ri * cell_size, gi * cell_size, bi * cell_size);
+        LPoint3d hi = lo + LVector3d(cell_size, cell_size, cell_size);
+
+        double min_dist[255];
+        double bound = 4.0;
+        for (int i = 0; i < 255; i++) {
+          const DXFFile::Color &color = DXFFile::_colors[i];
+          LPoint3d c(color.r, color.g, color.b);
+          double near_dist = 0.0;
+          double far_dist = 0.0;
+          for (int k = 0; k < 3; ++k) {
+            double d_near = std::max(std::max(lo[k] - c[k], c[k] - hi[k]), 0.0);
+            double d_far = std::max(fabs(c[k] - lo[k]), fabs(c[k] - hi[k]));
+            near_dist += d_near * d_near;
+            far_dist += d_far * d_far;
+          }
+          min_dist[i] = near_dist;
+          bound = std::min(bound, far_dist);
+        }
+
+        // Allow a little slop for roundoff.
+        bound += 1.0e-9;
+        vector_int &cell = _cells[(ri * grid_size + gi) * grid_size + bi];
+        for (int i = 0; i < 255; i++) {
+          if (min_dist[i] <= bound) {
+            cell.push_back(i);
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Returns the list of candidate colors, in increasing order, for the
+ * indicated color, which must be within the unit cube.
+ */
+const vector_int &DXFColorGrid::
+get_candidates(double r, double g, double b) const {
+  int index = (get_cell(r) * grid_size + get_cell(g)) * grid_size + get_cell(b);
+  return _cells[index];
+}
+
+/**
+ * Returns the grid coordinate of the indicated color component.
+ */
+int DXFColorGrid::
+get_cell(double v) {
+  int cell = (int)(v * grid_size);
+  return std::max(0, std::min(cell, (int)grid_size - 1));
+}
+
 DXFFile::Color DXFFile::_colors[DXF_num_colors] = {
   { 1, 1, 1 },        // Color 0 is not used.
   { 1, 0, 0 },        // Color 1 = Red
@@ -289,6 +445,14 @@ DXFFile() {
   _layer = nullptr;
   reset_entity();
   _color_index = -1;
+  _code = 0;
+  _has_number = false;
+  _number = 0.0;
+  _buffer_pos = 0;
+  _buffer_end = 0;
+  _buffer_eof = true;
+  _binary = false;
+  _short_codes = false;
 }
 
 /**
@@ -308,7 +472,9 @@ DXFFile::
  */
 void DXFFile::
 process(Filename filename) {
-  filename.set_text();
+  // We handle the line endings of an ASCII file ourselves, and a binary file
+  // must not be translated.
+  filename.set_binary();
 
   VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
   istream *in = vfs->open_read_file(filename, true);
@@ -333,6 +499,7 @@ process(istream *in, bool owns_in) {
   _in = in;
   _owns_in = owns_in;
   _state = ST_top;
+  reset_input();
 
   begin_file();
   while (_state != ST_done && _state != ST_error) {
@@ -445,6 +612,25 @@ find_color(double r, double g, double b) {
   double best_diff = 4.0;   // 4 is greater than our expected max, 3.
   int best_index = 7;
 
+  if (r >= 0.0 && r <= 1.0 && g >= 0.0 && g <= 1.0 && b >= 0.0 && b <= 1.0) {
+    // Only a handful of colors can be nearest to a color in this part of the
+    // cube.
+    static const DXFColorGrid grid;
+    const vector_int &candidates = grid.get_candidates(r, g, b);
+    vector_int::const_iterator ci;
+    for (ci = candidates.begin(); ci != candidates.end(); ++ci) {
+      int i = (*ci);
+      double diff = ((r - _colors[i].r) * (r - _colors[i].r) +
+                     (g - _colors[i].g) * (g - _colors[i].g) +
+                     (b - _colors[i].b) * (b - _colors[i].b));
+      if (diff < best_diff) {
+        best_diff = diff;
+        best_index = i;
+      }
+    }
+    return best_index;
+  }
+
   for (int i = 0; i < 255; i++) {
     double diff = ((r - _colors[i].r) * (r - _colors[i].r) +
                    (g - _colors[i].g) * (g - _colors[i].g) +
@@ -532,44 +718,311 @@ compute_ocs() {
 }
 
 
+/**
+ * Returns the value of the current group as a floating-point number.
+ */
+double DXFFile::
+get_double_value() const {
+  if (_has_number) {
+    return _number;
+  }
+  return pstrtod(_string.c_str(), nullptr);
+}
+
+/**
+ * Returns the value of the current group as an integer.
+ */
+int DXFFile::
+get_int_value() const {
+  if (_has_number) {
+    return (int)_number;
+  }
+  return (int)strtol(_string.c_str(), nullptr, 10);
+}
+
 /**
  * Reads the next code, string pair from the DXF file.  This is the basic unit
  * of data in a DXF file.
  */
 bool DXFFile::
 get_group() {
-  istream &in = *_in;
   do {
-    in >> _code;
-    if (!in) {
+    bool okflag = _binary ? get_binary_group() : get_ascii_group();
+    if (!okflag) {
       change_state(ST_error);
       return false;
     }
 
-    // Now skip past exactly one newline character and any number of other
-    // whitespace characters.
-    while (in && in.peek() != '\n') {
-      in.get();
+    // If we just read a comment, go back and get another one.
+  } while (_code == 999);
+
+  return true;
+}
+
+/**
+ * Reads the next group from an ASCII DXF file: a line with the group code,
+ * followed by a line with its value.  Returns true on success, false at EOF
+ * or on a malformed group code.
+ */
+bool DXFFile::
+get_ascii_group() {
+  _has_number = false;
+
+  // Skip any blank lines before the group code.
+  const char *line;
+  size_t length;
+  const char *p;
+  const char *end;
+  do {
+    if (!read_until('\n', line, length)) {
+      return false;
     }
-    in.get();
-    while (in && isspace(in.peek()) && in.peek() != '\n') {
-      in.get();
+    p = line;
+    end = line + length;
+    while (p < end && isspace((unsigned char)*p)) {
+      ++p;
     }
+  } while (p == end);
 
-    std::getline(in, _string);
-    _string = trim_right(_string);
+  bool negative = false;
+  if (*p == '-' || *p == '+') {
+    negative = (*p == '-');
+    ++p;
+  }
+  if (p == end || !isdigit((unsigned char)*p)) {
+    return false;
+  }
+  int code = 0;
+  while (p < end && isdigit((unsigned char)*p)) {
+    code = code * 10 + (*p - '0');
+    ++p;
+  }
+  _code = negative ? -code : code;
 
-    if (!in) {
-      change_state(ST_error);
+  // The value is the whole of the next line, less any surrounding
+  // whitespace.
+  if (!read_until('\n', line, length)) {
+    return false;
+  }
+  p = line;
+  end = line + length;
+  while (p < end && isspace((unsigned char)*p)) {
+    ++p;
+  }
+  while (end > p && isspace((unsigned char)end[-1])) {
+    --end;
+  }
+  _string.assign(p, end - p);
+  return true;
+}
+
+/**
+ * Reads the next group from a binary DXF file: a group code, followed by a
+ * value whose type depends on the code.  Returns true on success, false at
+ * EOF.
+ */
+bool DXFFile::
+get_binary_group() {
+  _has_number = false;
+
+  if (_short_codes) {
+    // Release 12 files use one-byte codes, with an escape for larger ones.
+    if (!fill_buffer(1)) {
       return false;
     }
+    _code = (unsigned char)_buffer[_buffer_pos];
+    _buffer_pos++;
+    if (_code == 255) {
+      if (!fill_buffer(2)) {
+        return false;
+      }
+      _code = (int16_t)decode_dxf_le(&_buffer[_buffer_pos], 2);
+      _buffer_pos += 2;
+    }
+  } else {
+    if (!fill_buffer(2)) {
+      return false;
+    }
+    _code = (int16_t)decode_dxf_le(&_buffer[_buffer_pos], 2);
+    _buffer_pos += 2;
+  }
 
-    // If we just read a comment, go back and get another one.
-  } while (_code == 999);
+  const char *start;
+  size_t length;
+  size_t num_bytes = 0;
+
+  switch (get_dxf_binary_type(_code)) {
+  case DBT_string:
+    if (!read_until('\0', start, length)) {
+      return false;
+    }
+    _string.assign(start, length);
+    return true;
+
+  case DBT_binary:
+    {
+      // A length byte, followed by that many bytes of data, which the ASCII
+      // format would represent in hexadecimal.
+      if (!fill_buffer(1)) {
+        return false;
+      }
+      length = (unsigned char)_buffer[_buffer_pos];
+      if (!fill_buffer(length + 1)) {
+        return false;
+      }
+      static const char hex_digits[] = "0123456789ABCDEF";
+      const unsigned char *data =
+        (const unsigned char *)&_buffer[_buffer_pos + 1];
+      _string.resize(length * 2);
+      for (size_t i = 0; i < length; ++i) {
+        _string[i * 2] = hex_digits[data[i] >> 4];
+        _string[i * 2 + 1] = hex_digits[data[i] & 0xf];
+      }
+      _buffer_pos += length + 1;
+    }
+    return true;
+
+  case DBT_double:
+    {
+      if (!fill_buffer(8)) {
+        return false;
+      }
+      uint64_t bits = decode_dxf_le(&_buffer[_buffer_pos], 8);
+      memcpy(&_number, &bits, sizeof(_number));
+      _buffer_pos += 8;
+    }
+    break;
+
+  case DBT_int16:
+    num_bytes = 2;
+    break;
+
+  case DBT_int32:
+    num_bytes = 4;
+    break;
+
+  case DBT_int64:
+    num_bytes = 8;
+    break;
+
+  case DBT_bool:
+    num_bytes = 1;
+    break;
+  }
+
+  if (num_bytes != 0) {
+    if (!fill_buffer(num_bytes)) {
+      return false;
+    }
+    uint64_t value = decode_dxf_le(&_buffer[_buffer_pos], num_bytes);
+    _buffer_pos += num_bytes;
 
+    // Sign-extend the integer to 64 bits.
+    int shift = 64 - (int)num_bytes * 8;
+    _number = (double)((int64_t)(value << shift) >> shift);
+  }
+
+  _has_number = true;
+  _string.clear();
   return true;
 }
 
+/**
+ * Reads bytes up to the next occurrence of the delimiter, and sets start and
+ * length to indicate them within the read buffer; they remain valid only
+ * until the next read.  The delimiter itself is consumed but not included.
+ * At the end of the file, the remaining bytes are returned even if they are
+ * not terminated.  Returns false if there are no more bytes.
+ */
+bool DXFFile::
+read_until(char delimiter, const char *&start, size_t &length) {
+  size_t scanned = 0;
+  while (true) {
+    const char *begin = &_buffer[0] + _buffer_pos;
+    size_t available = _buffer_end - _buffer_pos;
+    const char *found =
+      (const char *)memchr(begin + scanned, delimiter, available - scanned);
+    if (found != nullptr) {
+      start = begin;
+      length = found - begin;
+      _buffer_pos += length + 1;
+      return true;
+    }
+    scanned = available;
+
+    if (_buffer_eof) {
+      if (available == 0) {
+        return false;
+      }
+      start = begin;
+      length = available;
+      _buffer_pos = _buffer_end;
+      return true;
+    }
+
+    fill_buffer(available + 1);
+  }
+}
+
+/**
+ * Reads from the stream until there are at least the indicated number of
+ * unconsumed bytes in the buffer, growing it if necessary.  Returns true if
+ * successful, false if the end of the file is reached first.
+ */
+bool DXFFile::
+fill_buffer(size_t length) {
+  size_t remaining = _buffer_end - _buffer_pos;
+  if (remaining >= length) {
+    return true;
+  }
+
+  if (remaining != 0 && _buffer_pos != 0) {
+    memmove(&_buffer[0], &_buffer[0] + _buffer_pos, remaining);
+  }
+  _buffer_pos = 0;
+  _buffer_end = remaining;
+
+  if (length > _buffer.size()) {
+    _buffer.resize(std::max(length, _buffer.size() * 2));
+  }
+
+  while (_buffer_end < length && !_buffer_eof) {
+    _in->read(&_buffer[_buffer_end], _buffer.size() - _buffer_end);
+    size_t count = (size_t)_in->gcount();
+    _buffer_end += count;
+    if (count == 0 || _in->fail()) {
+      _buffer_eof = true;
+    }
+  }
+
+  return (_buffer_end >= length);
+}
+
+/**
+ * Prepares to read the newly-assigned input stream from the beginning, and
+ * determines whether it is an ASCII or a binary DXF file.
+ */
+void DXFFile::
+reset_input() {
+  _buffer.resize(dxf_buffer_size);
+  _buffer_pos = 0;
+  _buffer_end = 0;
+  _buffer_eof = (_in == nullptr);
+  _binary = false;
+  _short_codes = false;
+
+  size_t sentinel_length = sizeof(dxf_binary_sentinel);
+  if (fill_buffer(sentinel_length) &&
+      memcmp(&_buffer[0], dxf_binary_sentinel, sentinel_length) == 0) {
+    _binary = true;
+    _buffer_pos += sentinel_length;
+
+    // The first group is always code 0, with the string "SECTION".  If the
+    // code occupies only one byte, the second byte is already the 'S'.
+    _short_codes = (fill_buffer(2) && _buffer[_buffer_pos + 1] != 0);
+  }
+}
+
 
 /**
  * Called as new nodes are read to update the internal state correctly.
@@ -714,8 +1167,6 @@ state_top() {
  */
 void DXFFile::
 state_section() {
-  string tail;
-
   switch (_code) {
   case 0:
     if (_string == "ENDSEC") {
@@ -744,7 +1195,7 @@ state_section() {
     break;
 
   case 62:  // Color.
-    _color_index = string_to_int(_string, tail);
+    _color_index = get_int_value();
     break;
 
   default:
@@ -758,8 +1209,6 @@ state_section() {
  */
 void DXFFile::
 state_entity() {
-  string tail;
-
   switch (_code) {
   case 0:
     state_section();
@@ -770,75 +1219,75 @@ state_entity() {
     break;
 
   case 10:
-    _p[0] = string_to_double(_string, tail);
+    _p[0] = get_double_value();
     break;
 
   case 11:
-    _q[0] = string_to_double(_string, tail);
+    _q[0] = get_double_value();
     break;
 
   case 12:
-    _r[0] = string_to_double(_string, tail);
+    _r[0] = get_double_value();
     break;
 
   case 13:
-    _s[0] = string_to_double(_string, tail);
+    _s[0] = get_double_value();
     break;
 
   case 20:
-    _p[1] = string_to_double(_string, tail);
+    _p[1] = get_double_value();
     break;
 
   case 21:
-    _q[1] = string_to_double(_string, tail);
+    _q[1] = get_double_value();
     break;
 
   case 22:
-    _r[1] = string_to_double(_string, tail);
+    _r[1] = get_double_value();
     break;
 
   case 23:
-    _s[1] = string_to_double(_string, tail);
+    _s[1] = get_double_value();
     break;
 
   case 30:
-    _p[2] = string_to_double(_string, tail);
+    _p[2] = get_double_value();
     break;
 
   case 31:
-    _q[2] = string_to_double(_string, tail);
+    _q[2] = get_double_value();
     break;
 
   case 32:
-    _r[2] = string_to_double(_string, tail);
+    _r[2] = get_double_value();
     break;
 
   case 33:
-    _s[2] = string_to_double(_string, tail);
+    _s[2] = get_double_value();
     break;
 
   case 62:  // Color.
-    _color_index = string_to_int(_string, tail);
+    _color_index = get_int_value();
     break;
 
   case 66:  // Vertices-follow.
-    _vertices_follow = (string_to_int(_string, tail) != 0);
+    _vertices_follow = (get_int_value() != 0);
     break;
 
   case 70:  // Polyline flags.
-    _flags = string_to_int(_string, tail);
+    _flags = get_int_value();
     break;
 
   case 210:
-    _z[0] = string_to_double(_string, tail);
+    _z[0] = get_double_value();
     break;
 
   case 220:
-    _z[1] = string_to_double(_string, tail);
+    _z[1] = get_double_value();
     break;
 
   case 230:
-    _z[2] = string_to_double(_string, tail);
+    _z[2] = get_double_value();
     break;
 
   default:
@@ -853,8 +1302,6 @@ state_entity() {
  */
 void DXFFile::
 state_verts() {
-  string tail;
-
   switch (_code) {
   case 0:
     state_section();
@@ -865,15 +1312,15 @@ state_verts() {
     break;
 
   case 10:
-    _p[0] = string_to_double(_string, tail);
+    _p[0] = get_double_value();
     break;
 
   case 20:
-    _p[1] = string_to_double(_string, tail);
+    _p[1] = get_double_value();
     break;
 
   case 30:
-    _p[2] = string_to_double(_string, tail);
+    _p[2] = get_double_value();
     break;
 
   default:
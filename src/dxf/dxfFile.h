@@ -22,6 +22,7 @@
 
 #include "luse.h"
 #include "filename.h"
+#include "pvector.h"
 
 
 static const int DXF_max_line = 256;
@@ -31,6 +32,9 @@ static const int DXF_num_colors = 256;
  * A generic DXF-reading class.  This class can read a DXF file but doesn't
  * actually do anything with the data; it's intended to be inherited from and
  * the appropriate functions overridden (particularly DoneEntity()).
+ *
+ * Both ASCII and binary DXF files are supported; the format is detected
+ * automatically.
  */
 class DXFFile : public MemoryBase {
 public:
@@ -143,12 +147,24 @@ protected:
   std::istream *_in;
   bool _owns_in;
 
+  // The most recently read group.  The value of a numeric group read from a
+  // binary file is stored in _number, and _string is left empty; use
+  // get_double_value() and get_int_value() to read either kind.
   int _code;
   std::string _string;
+  bool _has_number;
+  double _number;
+
+  double get_double_value() const;
+  int get_int_value() const;
 
   void compute_ocs();
 
   bool get_group();
+  bool get_ascii_group();
+  bool get_binary_group();
+  bool read_until(char delimiter, const char *&start, size_t &length);
+  bool fill_buffer(size_t length);
   void change_state(State new_state);
   void change_section(Section new_section);
   void change_layer(const std::string &layer_name);
@@ -159,6 +175,18 @@ protected:
   void state_section();
   void state_entity();
   void state_verts();
+
+private:
+  void reset_input();
+
+  // The file is read through this buffer, a block at a time.
+  pvector<char> _buffer;
+  size_t _buffer_pos;
+  size_t _buffer_end;
+  bool _buffer_eof;
+
+  bool _binary;
+  bool _short_codes;
 };
 
 std::ostream &operator << (std::ostream &out, const DXFFile::State &state);
@@ -48,6 +48,7 @@ EggOptchar() {
   add_normals_options();
   add_transform_options();
   add_fixrest_option();
+  add_threads_option();
 
   set_program_brief("optimizes character models and animations in .egg files");
   set_program_description
@@ -20,11 +20,14 @@
 #include "dcast.h"
 #include "eggData.h"
 #include "bamFile.h"
+#include "virtualFileSystem.h"
 #include "pnotify.h"
 #include "notifyCategory.h"
 #include "notifySeverity.h"
 
 #include <stdio.h>
+#include <sstream>
+#include <fstream>
 
 /**
  *
@@ -51,7 +54,9 @@ EggPalettize() : EggMultiFilter(true) {
      "textures.txa); a complete record of every egg file and every texture "
      "that has been referenced is kept here.  This allows the program "
      "to intelligently manage the multiple egg files that may reference "
-     "the textures in question.");
+     "the textures in question.  The way each egg file uses its textures "
+     "is kept separately, in a journal named textures.jnl, and is only "
+     "read when it is needed.");
 
 
   clear_runlines();
@@ -195,6 +200,22 @@ EggPalettize() : EggMultiFilter(true) {
      "of keeping every texture as a separate image (which is convenient for "
      "development).",
      &EggPalettize::dispatch_none, &_omitall);
+  add_option
+    ("j", "threads", 0,
+     "Use the indicated number of threads to regenerate palette images, "
+     "and to read and rewrite egg files, concurrently.  No more than one "
+     "egg file per thread is held in memory at a time.  The default is 1, "
+     "which does everything one at a time.",
+     &EggPalettize::dispatch_int, nullptr, &_num_threads);
+  add_option
+    ("cache", "dirname", 0,
+     "Keep copies of the source textures, scaled to their placed size, in "
+     "the indicated directory, and reuse them in future sessions instead "
+     "of reading and scaling the source images again.  The copies are "
+     "keyed on the contents of each source image, so they remain valid "
+     "even if the textures are renamed or touched.  The cache's hit rate "
+     "over all sessions is reported by -s, if -cache is also given.",
+     &EggPalettize::dispatch_filename, &_got_cache_dirname, &_cache_dirname);
 
   // This isn't even implemented yet.  Presently, we never lock anyway.
   // Dangerous, but hard to implement reliable file locking across NFSSamba
@@ -214,6 +235,7 @@ EggPalettize() : EggMultiFilter(true) {
      "Describe the syntax of the attributes file.",
      &EggPalettize::dispatch_none, &_describe_input_file);
 
+  _num_threads = 1;
   _txa_filename = "textures.txa";
 }
 
@@ -577,7 +599,9 @@ run() {
   }
 
   Filename state_filename;
+  Filename journal_filename;
   BamFile state_file;
+  std::string state_data;
 
   if (_got_txa_script) {
     // If we got a command-line script instead of a .txa file, we won't be
@@ -607,6 +631,8 @@ run() {
 
     state_filename = _txa_filename;
     state_filename.set_extension("boo");
+    journal_filename = _txa_filename;
+    journal_filename.set_extension("jnl");
   }
 
   if (_nodb) {
@@ -631,7 +657,16 @@ run() {
     nout << "Reading " << FilenameUnifier::make_user_filename(state_filename)
          << "\n";
 
-    if (!state_file.open_read(state_filename)) {
+    // We keep the contents of the file, so that we can tell at the end of
+    // the session whether it needs to be written again.
+    VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+    std::istringstream state_in;
+    if (vfs->read_file(state_filename, state_data, true)) {
+      state_in.str(state_data);
+    }
+
+    if (state_data.empty() ||
+        !state_file.open_read(state_in, state_filename)) {
       nout << FilenameUnifier::make_user_filename(state_filename)
            << " exists, but cannot be read.  Perhaps you should "
            << "remove it so a new one can be created.\n";
@@ -681,9 +716,27 @@ run() {
     }
   }
 
+  if (!_nodb) {
+    // The egg files' texture references are not in the state file, but in
+    // the journal beside it, which is read as they are needed.
+    if (!pal->_journal.open(journal_filename, pal->_journal_serial)) {
+      nout << FilenameUnifier::make_user_filename(journal_filename)
+           << " is missing or does not match "
+           << FilenameUnifier::make_user_filename(state_filename)
+           << ".  Perhaps you should remove them both so new ones can be "
+           << "created.\n";
+      exit(1);
+    }
+  }
+
   pal->set_noabs(_noabs);
+  pal->set_num_threads(_num_threads);
+  if (_got_cache_dirname) {
+    pal->_scaled_image_cache.set_dirname(_cache_dirname);
+  }
 
   if (_report_pi) {
+    pal->load_all_references();
     pal->report_pi();
     exit(0);
   }
@@ -830,32 +883,84 @@ run() {
   }
 
   if (!_nodb) {
-    // Make up a temporary filename to write the state file to, then move the
-    // state file into place.  We do this in case the user interrupts us (or
-    // we core dump) before we're done; that way we won't leave the state file
-    // incompletely written.
-    std::string dirname = state_filename.get_dirname();
-    if (dirname.empty()) {
-      dirname = ".";
-    }
-    Filename temp_filename = Filename::temporary(dirname, "pi");
-
-    if (!state_file.open_write(temp_filename) ||
-        !state_file.write_object(pal)) {
+    // The egg files' changed texture references are appended to the journal
+    // first, then the state file is replaced if it has changed, and then the
+    // journal is committed.  If we are interrupted (or we core dump) partway
+    // through, the next session will still find the two files consistent,
+    // with either this session or the previous one.
+    unsigned int serial = pal->_journal.get_serial() + 1;
+    if (!pal->write_references()) {
       nout << "Unable to write palettization information to "
-           << FilenameUnifier::make_user_filename(temp_filename)
+           << FilenameUnifier::make_user_filename(journal_filename)
            << "\n";
       exit(1);
     }
 
-    state_file.close();
-    state_filename.unlink();
-    if (!temp_filename.rename_to(state_filename)) {
-      nout << "Unable to rename temporary file "
-           << FilenameUnifier::make_user_filename(temp_filename) << " to "
-           << FilenameUnifier::make_user_filename(state_filename) << "\n";
+    std::string new_state_data;
+    if (!encode_state(new_state_data)) {
+      nout << "Unable to encode palettization information.\n";
       exit(1);
     }
+
+    bool state_changed = (new_state_data != state_data);
+    if (!state_changed) {
+      // The rest of the state is no different from what is on disk, so
+      // there's no need to rewrite the file; we just touch it, so its
+      // timestamp still reflects this session.
+      nout << FilenameUnifier::make_user_filename(state_filename)
+           << " is unchanged.\n";
+      state_filename.touch();
+
+    } else {
+      pal->_journal_serial = serial;
+      if (!encode_state(new_state_data)) {
+        nout << "Unable to encode palettization information.\n";
+        exit(1);
+      }
+
+      // Make up a temporary filename to write the state file to, then move
+      // the state file into place.  We do this in case the user interrupts
+      // us (or we core dump) before we're done; that way we won't leave the
+      // state file incompletely written.
+      std::string dirname = state_filename.get_dirname();
+      if (dirname.empty()) {
+        dirname = ".";
+      }
+      Filename temp_filename = Filename::temporary(dirname, "pi");
+      temp_filename.set_binary();
+
+      std::ofstream temp_file;
+      bool wrote = false;
+      if (temp_filename.open_write(temp_file)) {
+        temp_file.write(new_state_data.data(), new_state_data.size());
+        temp_file.close();
+        wrote = !temp_file.fail();
+      }
+      if (!wrote) {
+        nout << "Unable to write palettization information to "
+             << FilenameUnifier::make_user_filename(temp_filename)
+             << "\n";
+        temp_filename.unlink();
+        exit(1);
+      }
+
+      state_filename.unlink();
+      if (!temp_filename.rename_to(state_filename)) {
+        nout << "Unable to rename temporary file "
+             << FilenameUnifier::make_user_filename(temp_filename) << " to "
+             << FilenameUnifier::make_user_filename(state_filename) << "\n";
+        exit(1);
+      }
+    }
+
+    if (state_changed || pal->_journal.has_uncommitted()) {
+      if (!pal->_journal.commit(serial)) {
+        nout << "Unable to write palettization information to "
+             << FilenameUnifier::make_user_filename(journal_filename)
+             << "\n";
+        exit(1);
+      }
+    }
   }
 
   if (!okflag) {
@@ -863,6 +968,23 @@ run() {
   }
 }
 
+/**
+ * Encodes the Palettizer into the indicated string, in the form in which it
+ * is written to the state file.  Returns true on success.
+ */
+bool EggPalettize::
+encode_state(std::string &data) {
+  std::ostringstream out;
+  BamFile bam_file;
+  if (!bam_file.open_write(out) || !bam_file.write_object(pal)) {
+    return false;
+  }
+  bam_file.close();
+
+  data = out.str();
+  return true;
+}
+
 int
 main(int argc, char *argv[]) {
   EggPalettize prog;
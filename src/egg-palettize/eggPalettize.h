@@ -53,6 +53,8 @@ public:
   bool _got_default_groupdir;
 
 private:
+  static bool encode_state(std::string &data);
+
   // The following values control behavior specific to this session.  They're
   // not saved for future sessions.
   bool _report_pi;
@@ -62,6 +64,9 @@ private:
   bool _omitall;
   bool _redo_all;
   bool _redo_eggs;
+  int _num_threads;
+  Filename _cache_dirname;
+  bool _got_cache_dirname;
 
   bool _describe_input_file;
   bool _remove_eggs;
@@ -30,6 +30,13 @@ Configure(config_eggcharbase);
 
 // NotifyCategoryDef(eggcharbase, "");
 
+ConfigVariableInt egg_character_db_max_ram
+("egg-character-db-max-ram", 1024,
+ PRC_DESC("The maximum amount of RAM, in megabytes, that the interim joint "
+          "computations of egg-optchar and similar tools may occupy.  Beyond "
+          "this, the data is paged to a temporary file on disk.  Set this "
+          "to -1 to keep everything in RAM."));
+
 ConfigureFn(config_eggcharbase) {
   init_libeggcharbase();
 }
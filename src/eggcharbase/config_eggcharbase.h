@@ -15,10 +15,13 @@
 #define CONFIG_EGGCHARBASE_H
 
 #include "pandabase.h"
+#include "configVariableInt.h"
 
 // Commented out to resolve link problem #include "notifyCategoryProxy.h"
 // NotifyCategoryDecl(eggcharbase, EXPCL_MISC, EXPTP_MISC);
 
+extern ConfigVariableInt egg_character_db_max_ram;
+
 extern void init_libeggcharbase();
 
 #endif
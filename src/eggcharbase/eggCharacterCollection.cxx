@@ -38,6 +38,7 @@ using std::string;
 EggCharacterCollection::
 EggCharacterCollection() {
   _next_model_index = 0;
+  _num_threads = 1;
 }
 
 /**
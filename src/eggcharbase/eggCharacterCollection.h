@@ -49,6 +49,9 @@ public:
 
   void rename_char(int i, const std::string &name);
 
+  INLINE void set_num_threads(int num_threads);
+  INLINE int get_num_threads() const;
+
   virtual void write(std::ostream &out, int indent_level = 0) const;
   void check_errors(std::ostream &out, bool force_initial_rest_frame);
 
@@ -105,6 +108,7 @@ private:
   TopEggNodesByName _top_egg_nodes;
 
   int _next_model_index;
+  int _num_threads;
 
   void match_egg_nodes(EggCharacterData *char_Data, EggJointData *joint_data,
                        EggNodeList &egg_nodes, int egg_index, int model_index);
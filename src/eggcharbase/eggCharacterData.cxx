@@ -15,8 +15,12 @@
 #include "eggCharacterCollection.h"
 #include "eggCharacterDb.h"
 #include "eggJointData.h"
+#include "eggJointPointer.h"
 #include "eggSliderData.h"
 #include "indent.h"
+#include "dcast.h"
+#include "workerPool.h"
+#include "mutexHolder.h"
 
 #include <algorithm>
 
@@ -29,6 +33,24 @@ public:
   }
 };
 
+/**
+ * This is used by do_reparent() to compute the reparented transforms for
+ * several ranges of frames of one model in parallel.
+ */
+class EggCharacterData::ComputeReparentJob {
+public:
+  static void do_job(int job_index, void *user_data);
+
+  EggCharacterData *_char_data;
+  int _model_index;
+  int _num_frames;
+  int _frames_per_job;
+  EggCharacterDb *_db;
+
+  Mutex _lock;
+  InvalidSet _invalid_set;
+};
+
 
 /**
  *
@@ -181,19 +203,19 @@ check_num_frames(int model_index) {
  */
 bool EggCharacterData::
 do_reparent() {
-  typedef pset<EggJointData *> InvalidSet;
   InvalidSet invalid_set;
 
-  // To begin, make sure the list of new_children is accurate.
+  // To begin, make sure the list of new_children is accurate.  This also
+  // assigns each joint its index into the per-frame ReparentCaches.
   Joints::const_iterator ji;
   for (ji = _joints.begin(); ji != _joints.end(); ++ji) {
     EggJointData *joint_data = (*ji);
-    joint_data->do_begin_reparent();
+    joint_data->do_begin_reparent(ji - _joints.begin());
   }
   // We also need to clear the children on the root joint, but the root joint
   // doesn't get any of the other operations (including finish_reparent)
   // applied to it.
-  _root_joint->do_begin_reparent();
+  _root_joint->do_begin_reparent(_joints.size());
 
 
   // Now, check for cycles in the new parenting hierarchy, and also sort the
@@ -211,7 +233,11 @@ do_reparent() {
 
   // Now compute the new transforms for the joints' new positions.  This is
   // done recursively through the new parent hierarchy, so we can take
-  // advantage of caching the net value for a particular frame.
+  // advantage of caching the net value for a particular frame.  Each frame is
+  // independent of the others, so the frames are divided among the threads.
+  int num_threads = _collection->get_num_threads();
+  WorkerPool pool(num_threads);
+
   Models::const_iterator mi;
   for (mi = _models.begin(); mi != _models.end(); ++mi) {
     EggCharacterDb db;
@@ -221,31 +247,35 @@ do_reparent() {
          << " of " << _models.size()
          << ": " << (*mi)._egg_data->get_egg_filename()
          << " (" << num_frames << " frames)\n";
-    for (int f = 0; f < num_frames; f++) {
-      // First, walk through all the joints and flush the computed net
-      // transforms from before.
-      for (ji = _joints.begin(); ji != _joints.end(); ++ji) {
-        EggJointData *joint_data = (*ji);
-        joint_data->do_begin_compute_reparent();
-      }
-      _root_joint->do_begin_compute_reparent();
-
-      // Now go back through and compute the reparented transforms, caching
-      // net transforms as necessary.
-      for (ji = _joints.begin(); ji != _joints.end(); ++ji) {
-        EggJointData *joint_data = (*ji);
-        if (!joint_data->do_compute_reparent(model_index, f, db)) {
-          // Oops, we got an invalid transform.
-          invalid_set.insert(joint_data);
-        }
-      }
-    }
+
+    ComputeReparentJob job;
+    job._char_data = this;
+    job._model_index = model_index;
+    job._num_frames = num_frames;
+    job._frames_per_job = EggJointData::frames_per_job;
+    job._db = &db;
+    pool.run((num_frames + job._frames_per_job - 1) / job._frames_per_job,
+             &ComputeReparentJob::do_job, &job);
+    invalid_set.insert(job._invalid_set.begin(), job._invalid_set.end());
 
     // Finally, apply the computations to the joints.
+    EggJointData::JointPointers joints;
+    Joints joint_datas;
     for (ji = _joints.begin(); ji != _joints.end(); ++ji) {
       EggJointData *joint_data = (*ji);
-      if (!joint_data->do_joint_rebuild(model_index, db)) {
-        invalid_set.insert(joint_data);
+      if (joint_data->has_model(model_index)) {
+        EggJointPointer *joint;
+        DCAST_INTO_R(joint, joint_data->get_model(model_index), false);
+        joints.push_back(joint);
+        joint_datas.push_back(joint_data);
+      }
+    }
+
+    vector_int results;
+    EggJointData::do_rebuild_pointers(joints, db, num_threads, results);
+    for (size_t i = 0; i < results.size(); ++i) {
+      if (!results[i]) {
+        invalid_set.insert(joint_datas[i]);
       }
     }
   }
@@ -280,6 +310,39 @@ do_reparent() {
   return invalid_set.empty();
 }
 
+/**
+ * Computes the reparented transforms for all joints for frames first_frame
+ * up to but not including end_frame of the indicated model.  Any joints that
+ * fail are added to invalid_set.  This may be called from any thread, so long
+ * as no two threads are given overlapping frames of the same model.
+ */
+void EggCharacterData::
+compute_reparent_frames(int model_index, int first_frame, int end_frame,
+                        EggCharacterDb &db, InvalidSet &invalid_set) {
+  EggJointData::ReparentCaches caches(_joints.size() + 1);
+
+  Joints::const_iterator ji;
+  for (int f = first_frame; f < end_frame; f++) {
+    // First, walk through all the joints and flush the computed net
+    // transforms from before.
+    for (ji = _joints.begin(); ji != _joints.end(); ++ji) {
+      EggJointData *joint_data = (*ji);
+      joint_data->do_begin_compute_reparent(caches);
+    }
+    _root_joint->do_begin_compute_reparent(caches);
+
+    // Now go back through and compute the reparented transforms, caching
+    // net transforms as necessary.
+    for (ji = _joints.begin(); ji != _joints.end(); ++ji) {
+      EggJointData *joint_data = (*ji);
+      if (!joint_data->do_compute_reparent(model_index, f, db, caches)) {
+        // Oops, we got an invalid transform.
+        invalid_set.insert(joint_data);
+      }
+    }
+  }
+}
+
 /**
  * Chooses the best possible parent joint for each of the joints in the
  * hierarchy, based on the score computed by
@@ -408,3 +471,23 @@ write(std::ostream &out, int indent_level) const {
     slider->write(out, indent_level + 2);
   }
 }
+
+/**
+ * Computes the reparented transforms for one range of frames.  This may be
+ * called from any thread.
+ */
+void EggCharacterData::ComputeReparentJob::
+do_job(int job_index, void *user_data) {
+  ComputeReparentJob *job = (ComputeReparentJob *)user_data;
+  int first_frame = job_index * job->_frames_per_job;
+  int end_frame = std::min(first_frame + job->_frames_per_job, job->_num_frames);
+
+  InvalidSet invalid_set;
+  job->_char_data->compute_reparent_frames(job->_model_index, first_frame,
+                                           end_frame, *job->_db, invalid_set);
+
+  if (!invalid_set.empty()) {
+    MutexHolder holder(job->_lock);
+    job->_invalid_set.insert(invalid_set.begin(), invalid_set.end());
+  }
+}
@@ -87,6 +87,13 @@ public:
   virtual void write(std::ostream &out, int indent_level = 0) const;
 
 private:
+  typedef pset<EggJointData *> InvalidSet;
+  class ComputeReparentJob;
+
+  void compute_reparent_frames(int model_index, int first_frame,
+                               int end_frame, EggCharacterDb &db,
+                               InvalidSet &invalid_set);
+
   class Model {
   public:
     int _model_index;
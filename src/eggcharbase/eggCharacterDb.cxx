@@ -13,30 +13,51 @@
 
 #include "eggCharacterDb.h"
 #include "eggCharacterData.h"
+#include "config_eggcharbase.h"
+#include "mutexHolder.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 /**
  * Constructs a database for storing the interim work for the indicated
- * EggCharacterData.  The parameter max_ram_mb indicates the maximum amount of
- * RAM (in MB) that the database should consume; if it the database would
- * roughly fit within this limit, it will be stored in RAM; otherwise, it will
- * be written to disk (if Berkeley DB is available).
+ * EggCharacterData.  The config variable egg-character-db-max-ram indicates
+ * the maximum amount of RAM (in MB) that the database should consume; once
+ * it grows beyond this limit, further data will be written to a temporary
+ * file on disk instead.
  */
 EggCharacterDb::
 EggCharacterDb() {
-  /*
-#ifdef HAVE_BDB
-  _db = NULL;
+  _blocks_per_segment = segment_size / sizeof(Block);
+  _next_block = _blocks_per_segment;
+  _ram_bytes = 0;
 
-  _db = new Db(NULL, 0);
-  _db_filename = Filename::temporary("", "eggc_", ".db");
-
-  string os_db_filename = _db_filename.to_os_specific();
-  _db->open(NULL, os_db_filename.c_str(), NULL,
-            DB_BTREE, DB_CREATE | DB_EXCL, 0);
+  int max_ram_mb = egg_character_db_max_ram;
+  if (max_ram_mb < 0) {
+    _max_ram_bytes = (size_t)-1;
+  } else {
+    _max_ram_bytes = (size_t)max_ram_mb * 1024 * 1024;
+  }
 
-  nout << "Using " << os_db_filename << " for rebuild database.\n";
-#endif  // HAVE_BDB
-  */
+  _spill_open = false;
+  _spill_failed = false;
+  _spill_bytes = 0;
+#ifdef _WIN32
+  _spill_handle = INVALID_HANDLE_VALUE;
+#else
+  _spill_fd = -1;
+#endif
 }
 
 /**
@@ -44,19 +65,23 @@ EggCharacterDb() {
  */
 EggCharacterDb::
 ~EggCharacterDb() {
-  /*
-#ifdef HAVE_BDB
-  if (_db != (Db *)NULL){
-    _db->close(0);
-    delete _db;
-    _db = NULL;
-
-    string os_db_filename = _db_filename.to_os_specific();
-    Db rmdb(NULL, 0);
-    rmdb.remove(os_db_filename.c_str(), NULL, 0);
+  Segments::iterator si;
+  for (si = _segments.begin(); si != _segments.end(); ++si) {
+    Segment &segment = (*si);
+    if (!segment._mapped) {
+      PANDA_FREE_ARRAY(segment._data);
+    } else {
+#ifdef _WIN32
+      UnmapViewOfFile(segment._data);
+      CloseHandle((HANDLE)segment._mapping);
+#else
+      munmap(segment._data, segment_size);
+#endif
+    }
   }
-#endif  // HAVE_BDB
-  */
+  _segments.clear();
+
+  close_spill_file();
 }
 
 /**
@@ -67,33 +92,31 @@ EggCharacterDb::
 bool EggCharacterDb::
 get_matrix(const EggJointPointer *joint, TableType type,
            int frame, LMatrix4d &mat) const {
-  Key key(joint, type, frame);
-
-  /*
-#ifdef HAVE_BDB
-  if (_db != (Db *)NULL){
-    Dbt db_key(&key, sizeof(Key));
-    Dbt db_data(&mat, sizeof(LMatrix4d));
-    db_data.set_ulen(sizeof(LMatrix4d));
-    db_data.set_flags(DB_DBT_USERMEM);
-
-    int result = _db->get(NULL, &db_key, &db_data, 0);
-    if (result == DB_NOTFOUND) {
-      return false;
-    }
-    nassertr(result == 0, false);
-    return true;
+  nassertr(type >= 0 && type < num_table_types, false);
+  if (frame < 0) {
+    return false;
+  }
+
+  MutexHolder holder(_lock);
+  Joints::const_iterator ji;
+  ji = _joints.find(joint);
+  if (ji == _joints.end()) {
+    return false;
+  }
+
+  const Blocks &blocks = (*ji).second._tables[type];
+  size_t bi = (size_t)(frame / frames_per_block);
+  if (bi >= blocks.size() || blocks[bi] == nullptr) {
+    return false;
   }
-#endif  // HAVE_BDB
-  */
 
-  Table::const_iterator ti;
-  ti = _table.find(key);
-  if (ti == _table.end()) {
+  const Block *block = blocks[bi];
+  int i = frame % frames_per_block;
+  if (!block->has_frame(i)) {
     return false;
   }
 
-  mat = (*ti).second;
+  block->get_frame(i, mat);
   return true;
 }
 
@@ -105,21 +128,155 @@ get_matrix(const EggJointPointer *joint, TableType type,
 void EggCharacterDb::
 set_matrix(const EggJointPointer *joint, TableType type,
            int frame, const LMatrix4d &mat) {
-  Key key(joint, type, frame);
-
-  /*
-#ifdef HAVE_BDB
-  if (_db != (Db *)NULL){
-    Dbt db_key(&key, sizeof(Key));
-    Dbt db_data((void *)&mat, sizeof(LMatrix4d));
-    int result = _db->put(NULL, &db_key, &db_data, DB_NOOVERWRITE);
-    nassertv(result != DB_KEYEXIST);
-    nassertv(result == 0);
+  nassertv(type >= 0 && type < num_table_types);
+  nassertv(frame >= 0);
+
+  MutexHolder holder(_lock);
+  Blocks &blocks = _joints[joint]._tables[type];
+  size_t bi = (size_t)(frame / frames_per_block);
+  if (bi >= blocks.size()) {
+    blocks.resize(bi + 1, nullptr);
+  }
+
+  Block *block = blocks[bi];
+  if (block == nullptr) {
+    block = alloc_block();
+    blocks[bi] = block;
+  }
+
+  int i = frame % frames_per_block;
+  nassertv(!block->has_frame(i));
+  block->set_frame(i, mat);
+}
+
+/**
+ * Returns a new, empty Block.  Blocks are never freed individually; they are
+ * all released when the EggCharacterDb is destructed.
+ */
+EggCharacterDb::Block *EggCharacterDb::
+alloc_block() {
+  if (_next_block >= _blocks_per_segment) {
+    Segment segment;
+    segment._data = alloc_segment(segment._mapped, segment._mapping);
+    _segments.push_back(segment);
+    _next_block = 0;
+  }
+
+  Block *block = (Block *)_segments.back()._data + _next_block;
+  ++_next_block;
+  memset(block->_valid, 0, sizeof(block->_valid));
+  return block;
+}
+
+/**
+ * Allocates a new segment of segment_size bytes, either from RAM or, if we
+ * have exceeded our RAM budget, by mapping another piece of the spill file.
+ */
+char *EggCharacterDb::
+alloc_segment(bool &mapped, void *&mapping) {
+  mapped = false;
+  mapping = nullptr;
+
+  if (_ram_bytes + segment_size > _max_ram_bytes && !_spill_failed) {
+    if (!_spill_open && !open_spill_file()) {
+      nout << "Unable to create " << _spill_filename.to_os_specific()
+           << "; keeping rebuild database in RAM.\n";
+      _spill_failed = true;
+
+    } else {
+      size_t offset = _spill_bytes;
+      char *data = nullptr;
+#ifdef _WIN32
+      unsigned long long end = (unsigned long long)offset + segment_size;
+      HANDLE handle = CreateFileMappingA((HANDLE)_spill_handle, nullptr,
+                                         PAGE_READWRITE, (DWORD)(end >> 32),
+                                         (DWORD)end, nullptr);
+      if (handle != nullptr) {
+        data = (char *)MapViewOfFile(handle, FILE_MAP_ALL_ACCESS,
+                                     (DWORD)((unsigned long long)offset >> 32),
+                                     (DWORD)offset, segment_size);
+        if (data == nullptr) {
+          CloseHandle(handle);
+        } else {
+          mapping = (void *)handle;
+        }
+      }
+#else
+      if (ftruncate(_spill_fd, (off_t)(offset + segment_size)) == 0) {
+        void *ptr = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, _spill_fd, (off_t)offset);
+        if (ptr != MAP_FAILED) {
+          data = (char *)ptr;
+        }
+      }
+#endif
+      if (data != nullptr) {
+        _spill_bytes += segment_size;
+        mapped = true;
+        return data;
+      }
+
+      nout << "Unable to extend " << _spill_filename.to_os_specific()
+           << "; keeping rest of rebuild database in RAM.\n";
+      _spill_failed = true;
+    }
+  }
+
+  _ram_bytes += segment_size;
+  return (char *)PANDA_MALLOC_ARRAY(segment_size);
+}
+
+/**
+ * Creates the temporary file used to hold the part of the database that does
+ * not fit in RAM.  Returns true on success, false on failure.
+ */
+bool EggCharacterDb::
+open_spill_file() {
+  _spill_filename = Filename::temporary("", "eggc_", ".db");
+  std::string os_spill_filename = _spill_filename.to_os_specific();
+
+#ifdef _WIN32
+  // The file is deleted automatically when we close it.
+  HANDLE handle = CreateFileA(os_spill_filename.c_str(),
+                              GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                              CREATE_NEW,
+                              FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE,
+                              nullptr);
+  if (handle == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  _spill_handle = (void *)handle;
+#else
+  _spill_fd = open(os_spill_filename.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (_spill_fd < 0) {
+    return false;
+  }
+
+  // Unlink the file right away; it remains accessible through our file
+  // descriptor, and goes away by itself when we close it (or if we crash).
+  unlink(os_spill_filename.c_str());
+#endif
+
+  _spill_open = true;
+  nout << "Using " << os_spill_filename << " for rebuild database.\n";
+  return true;
+}
+
+/**
+ * Closes the spill file, if it was opened, which also deletes it.
+ */
+void EggCharacterDb::
+close_spill_file() {
+  if (!_spill_open) {
     return;
   }
-#endif  // HAVE_BDB
-  */
 
-  bool inserted = _table.insert(Table::value_type(key, mat)).second;
-  nassertv(inserted);
+#ifdef _WIN32
+  CloseHandle((HANDLE)_spill_handle);
+  _spill_handle = INVALID_HANDLE_VALUE;
+#else
+  close(_spill_fd);
+  _spill_fd = -1;
+#endif
+  _spill_open = false;
 }
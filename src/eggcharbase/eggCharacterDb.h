@@ -16,20 +16,12 @@
 
 #include "pandatoolbase.h"
 #include "pmap.h"
-
-/*
-#ifdef HAVE_BDB
-
-// Apparently, we have to define this to make db_cxx files include the modern
-// header files.
-#define HAVE_CXX_STDHEADERS 1
-#include <db_cxx.h>
-
-#endif  // HAVE_BDB
-*/
+#include "pvector.h"
+#include "filename.h"
+#include "luse.h"
+#include "pmutex.h"
 
 class EggJointPointer;
-class LMatrix4d;
 
 /**
  * This class is used during joint optimization or restructuring to store the
@@ -37,6 +29,15 @@ class LMatrix4d;
  *
  * That is to say, this class provides an temporary data store for three
  * tables of matrices per each EggJointPointer per frame.
+ *
+ * The matrices for each joint and table are stored densely by frame number,
+ * in fixed-size blocks of frames, each with a bitmap recording which of its
+ * frames have been filled in.  Blocks are carved out of large segments,
+ * which are allocated from RAM until egg-character-db-max-ram is exceeded,
+ * and thereafter memory-mapped from a temporary file on disk.
+ *
+ * get_matrix() and set_matrix() may be called from multiple threads at once,
+ * so long as no two threads store the same joint, type, and frame.
  */
 class EggCharacterDb {
 public:
@@ -55,28 +56,67 @@ public:
                   int frame, const LMatrix4d &mat);
 
 private:
-  class Key {
+  enum {
+    num_table_types = 3,
+    frames_per_block = 128,
+    segment_size = 4 * 1024 * 1024,
+  };
+
+  // A Block holds the matrices for frames_per_block consecutive frames of
+  // one table of one joint.  It is plain data, so that it may live in a
+  // memory-mapped file.
+  class Block {
   public:
-    INLINE Key(const EggJointPointer *joint,
-               TableType table_type,
-               int frame);
-    INLINE bool operator < (const Key &other) const;
-
-  private:
-    const EggJointPointer *_joint;
-    TableType _table_type;
-    int _frame;
+    INLINE bool has_frame(int i) const;
+    INLINE void set_frame(int i, const LMatrix4d &mat);
+    INLINE void get_frame(int i, LMatrix4d &mat) const;
+
+    uint32_t _valid[frames_per_block / 32];
+    double _data[frames_per_block][16];
   };
 
-  /*
-#ifdef HAVE_BDB
-  Db *_db;
-  Filename _db_filename;
-#endif  // HAVE_BDB
-  */
+  typedef pvector<Block *> Blocks;
 
-  typedef pmap<Key, LMatrix4d> Table;
-  Table _table;
+  class JointTables {
+  public:
+    Blocks _tables[num_table_types];
+  };
+
+  // A Segment is a large allocation from which Blocks are handed out.
+  class Segment {
+  public:
+    char *_data;
+    bool _mapped;
+    void *_mapping;
+  };
+
+  Block *alloc_block();
+  char *alloc_segment(bool &mapped, void *&mapping);
+  bool open_spill_file();
+  void close_spill_file();
+
+  typedef pmap<const EggJointPointer *, JointTables> Joints;
+  Joints _joints;
+
+  typedef pvector<Segment> Segments;
+  Segments _segments;
+  size_t _blocks_per_segment;
+  size_t _next_block;
+  size_t _ram_bytes;
+  size_t _max_ram_bytes;
+
+  // Protects all of the above, as well as the contents of the Blocks.
+  mutable Mutex _lock;
+
+  Filename _spill_filename;
+  bool _spill_open;
+  bool _spill_failed;
+  size_t _spill_bytes;
+#ifdef _WIN32
+  void *_spill_handle;
+#else
+  int _spill_fd;
+#endif
 };
 
 #include "eggCharacterDb.I"
@@ -24,6 +24,7 @@ EggCharacterFilter() : EggMultiFilter(false) {
   _collection = nullptr;
 
   _force_initial_rest_frame = false;
+  _num_threads = 1;
 }
 
 /**
@@ -49,6 +50,19 @@ add_fixrest_option() {
      &EggCharacterFilter::dispatch_none, &_force_initial_rest_frame);
 }
 
+/**
+ *
+ */
+void EggCharacterFilter::
+add_threads_option() {
+  add_option
+    ("j", "threads", 0,
+     "Use the indicated number of threads to compute the per-frame joint "
+     "transforms when the joint hierarchy is rebuilt or reorganized.  The "
+     "default is 1, which computes them one at a time.",
+     &EggCharacterFilter::dispatch_int, nullptr, &_num_threads);
+}
+
 
 /**
  *
@@ -58,6 +72,7 @@ post_command_line() {
   if (_collection == nullptr) {
     _collection = make_collection();
   }
+  _collection->set_num_threads(_num_threads);
 
   if (!EggMultiFilter::post_command_line()) {
     return false;
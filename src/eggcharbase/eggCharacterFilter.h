@@ -35,6 +35,7 @@ public:
   virtual ~EggCharacterFilter();
 
   void add_fixrest_option();
+  void add_threads_option();
 
 protected:
   virtual bool post_command_line();
@@ -44,6 +45,7 @@ protected:
 
   EggCharacterCollection *_collection;
   bool _force_initial_rest_frame;
+  int _num_threads;
 };
 
 #endif
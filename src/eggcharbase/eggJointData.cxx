@@ -13,6 +13,7 @@
 
 #include "eggJointData.h"
 
+#include "eggCharacterCollection.h"
 #include "eggCharacterDb.h"
 #include "eggJointNodePointer.h"
 #include "eggMatrixTablePointer.h"
@@ -23,11 +24,54 @@
 #include "indent.h"
 #include "fftCompressor.h"
 #include "zStream.h"
+#include "workerPool.h"
 
 using std::string;
 
 TypeHandle EggJointData::_type_handle;
 
+/**
+ * This is used by score_reparent_to() to compute the transforms a joint would
+ * receive in each frame, were it reparented, in several threads at once.
+ * Each job fills in the rows for a range of frames of one model.
+ */
+class ScoreReparentJob {
+public:
+  class Range {
+  public:
+    int _model_index;
+    EggJointPointer *_joint;
+    int _first_frame;
+    int _num_frames;
+    int _first_row;
+    bool _ok;
+  };
+  typedef pvector<Range> Ranges;
+
+  static void do_job(int job_index, void *user_data);
+
+  EggJointData *_parent;
+  EggJointData *_new_parent;
+  EggCharacterDb *_db;
+  Ranges _ranges;
+
+  vector_stdfloat _i, _j, _k, _a, _b, _c, _x, _y, _z;
+  pvector<LVecBase3> _hprs;
+};
+
+/**
+ * This is used by do_rebuild_pointers() to call do_rebuild() on each of a
+ * list of animation tables, in several threads at once.
+ */
+class RebuildJob {
+public:
+  static void do_job(int job_index, void *user_data);
+
+  const pvector<EggJointPointer *> *_joints;
+  EggCharacterDb *_db;
+  vector_int *_results;
+};
+
 
 /**
  *
@@ -41,6 +85,7 @@ EggJointData(EggCharacterCollection *collection,
   _new_parent = nullptr;
   _has_rest_frame = false;
   _rest_frames_differ = false;
+  _reparent_index = 0;
 }
 
 /**
@@ -180,9 +225,12 @@ score_reparent_to(EggJointData *new_parent, EggCharacterDb &db) {
 
   // First, build up a big array of the new transforms this joint would
   // receive in all frames of all models, were it reparented to the indicated
-  // joint.
-  vector_stdfloat i, j, k, a, b, c, x, y, z;
-  pvector<LVecBase3> hprs;
+  // joint.  The frames are independent of each other, so we divide them into
+  // ranges and compute them in parallel.
+  ScoreReparentJob job;
+  job._parent = _parent;
+  job._new_parent = new_parent;
+  job._db = &db;
   int num_rows = 0;
 
   int num_models = get_num_models();
@@ -193,44 +241,16 @@ score_reparent_to(EggJointData *new_parent, EggCharacterDb &db) {
       DCAST_INTO_R(joint, back, false);
 
       int num_frames = get_num_frames(model_index);
-      for (int n = 0; n < num_frames; n++) {
-        LMatrix4d transform;
-        if (_parent == new_parent) {
-          // We already have this parent.
-          transform = LMatrix4d::ident_mat();
-
-        } else if (_parent == nullptr) {
-          // We are moving from outside the joint hierarchy to within it.
-          transform = new_parent->get_net_frame_inv(model_index, n, db);
-
-        } else if (new_parent == nullptr) {
-          // We are moving from within the hierarchy to outside it.
-          transform = _parent->get_net_frame(model_index, n, db);
-
-        } else {
-          // We are changing parents within the hierarchy.
-          transform =
-            _parent->get_net_frame(model_index, n, db) *
-            new_parent->get_net_frame_inv(model_index, n, db);
-        }
-
-        transform = joint->get_frame(n) * transform;
-        LVecBase3d scale, shear, hpr, translate;
-        if (!decompose_matrix(transform, scale, shear, hpr, translate)) {
-          // Invalid transform.
-          return -1;
-        }
-        i.push_back(scale[0]);
-        j.push_back(scale[1]);
-        k.push_back(scale[2]);
-        a.push_back(shear[0]);
-        b.push_back(shear[1]);
-        c.push_back(shear[2]);
-        hprs.push_back(LCAST(PN_stdfloat, hpr));
-        x.push_back(translate[0]);
-        y.push_back(translate[1]);
-        z.push_back(translate[2]);
-        num_rows++;
+      for (int n = 0; n < num_frames; n += frames_per_job) {
+        ScoreReparentJob::Range range;
+        range._model_index = model_index;
+        range._joint = joint;
+        range._first_frame = n;
+        range._num_frames = std::min((int)frames_per_job, num_frames - n);
+        range._first_row = num_rows;
+        range._ok = false;
+        job._ranges.push_back(range);
+        num_rows += range._num_frames;
       }
     }
   }
@@ -240,21 +260,43 @@ score_reparent_to(EggJointData *new_parent, EggCharacterDb &db) {
     return -1;
   }
 
+  job._i.resize(num_rows);
+  job._j.resize(num_rows);
+  job._k.resize(num_rows);
+  job._a.resize(num_rows);
+  job._b.resize(num_rows);
+  job._c.resize(num_rows);
+  job._hprs.resize(num_rows);
+  job._x.resize(num_rows);
+  job._y.resize(num_rows);
+  job._z.resize(num_rows);
+
+  WorkerPool pool(_collection->get_num_threads());
+  pool.run(job._ranges.size(), &ScoreReparentJob::do_job, &job);
+
+  ScoreReparentJob::Ranges::const_iterator ri;
+  for (ri = job._ranges.begin(); ri != job._ranges.end(); ++ri) {
+    if (!(*ri)._ok) {
+      // Invalid transform.
+      return -1;
+    }
+  }
+
   // Now, we derive a score, by the simple expedient of using the
   // FFTCompressor to compress the generated transforms, and measuring the
   // length of the resulting bitstream.
   FFTCompressor compressor;
   Datagram dg;
-  compressor.write_reals(dg, &i[0], num_rows);
-  compressor.write_reals(dg, &j[0], num_rows);
-  compressor.write_reals(dg, &k[0], num_rows);
-  compressor.write_reals(dg, &a[0], num_rows);
-  compressor.write_reals(dg, &b[0], num_rows);
-  compressor.write_reals(dg, &c[0], num_rows);
-  compressor.write_hprs(dg, &hprs[0], num_rows);
-  compressor.write_reals(dg, &x[0], num_rows);
-  compressor.write_reals(dg, &y[0], num_rows);
-  compressor.write_reals(dg, &z[0], num_rows);
+  compressor.write_reals(dg, &job._i[0], num_rows);
+  compressor.write_reals(dg, &job._j[0], num_rows);
+  compressor.write_reals(dg, &job._k[0], num_rows);
+  compressor.write_reals(dg, &job._a[0], num_rows);
+  compressor.write_reals(dg, &job._b[0], num_rows);
+  compressor.write_reals(dg, &job._c[0], num_rows);
+  compressor.write_hprs(dg, &job._hprs[0], num_rows);
+  compressor.write_reals(dg, &job._x[0], num_rows);
+  compressor.write_reals(dg, &job._y[0], num_rows);
+  compressor.write_reals(dg, &job._z[0], num_rows);
 
 
 #ifndef HAVE_ZLIB
@@ -277,29 +319,22 @@ score_reparent_to(EggJointData *new_parent, EggCharacterDb &db) {
  */
 bool EggJointData::
 do_rebuild_all(EggCharacterDb &db) {
-  bool all_ok = true;
-
-  BackPointers::iterator bpi;
-  for (bpi = _back_pointers.begin(); bpi != _back_pointers.end(); ++bpi) {
-    EggBackPointer *back = (*bpi);
-    if (back != nullptr) {
-      EggJointPointer *joint;
-      DCAST_INTO_R(joint, back, false);
-      if (!joint->do_rebuild(db)) {
-        all_ok = false;
-      }
-    }
-  }
-
-  Children::iterator ci;
-  for (ci = _children.begin(); ci != _children.end(); ++ci) {
-    EggJointData *child = (*ci);
-    if (!child->do_rebuild_all(db)) {
-      all_ok = false;
+  // The list is collected in the same order the joints were visited before,
+  // parents ahead of their children; do_rebuild_pointers() relies on this.
+  JointPointers joints;
+  collect_joint_pointers(joints);
+
+  vector_int results;
+  do_rebuild_pointers(joints, db, _collection->get_num_threads(), results);
+
+  vector_int::const_iterator ri;
+  for (ri = results.begin(); ri != results.end(); ++ri) {
+    if (!(*ri)) {
+      return false;
     }
   }
 
-  return all_ok;
+  return true;
 }
 
 /**
@@ -471,7 +506,8 @@ write(std::ostream &out, int indent_level) const {
  * _new_parent information.
  */
 void EggJointData::
-do_begin_reparent() {
+do_begin_reparent(int reparent_index) {
+  _reparent_index = reparent_index;
   _got_new_parent_depth = false;
   _children.clear();
 }
@@ -512,10 +548,12 @@ calc_new_parent_depth(pset<EggJointData *> &chain) {
  * for do_compute_reparent(), for a given model/frame.
  */
 void EggJointData::
-do_begin_compute_reparent() {
-  _got_new_net_frame = false;
-  _got_new_net_frame_inv = false;
-  _computed_reparent = false;
+do_begin_compute_reparent(ReparentCaches &caches) {
+  nassertv(_reparent_index >= 0 && _reparent_index < (int)caches.size());
+  ReparentCache &cache = caches[_reparent_index];
+  cache._got_new_net_frame = false;
+  cache._got_new_net_frame_inv = false;
+  cache._computed_reparent = false;
 }
 
 /**
@@ -524,26 +562,29 @@ do_begin_compute_reparent() {
  * is moved to its new parent.  Returns true on success, false on failure.
  */
 bool EggJointData::
-do_compute_reparent(int model_index, int n, EggCharacterDb &db) {
-  if (_computed_reparent) {
+do_compute_reparent(int model_index, int n, EggCharacterDb &db,
+                    ReparentCaches &caches) {
+  nassertr(_reparent_index >= 0 && _reparent_index < (int)caches.size(), false);
+  ReparentCache &cache = caches[_reparent_index];
+  if (cache._computed_reparent) {
     // We've already done this joint.  This is possible because we have to
     // recursively compute joints upwards, so we might visit the same joint
     // more than once.
-    return _computed_ok;
+    return cache._computed_ok;
   }
-  _computed_reparent = true;
+  cache._computed_reparent = true;
 
   if (_parent == _new_parent) {
     // Trivial (and most common) case: we are not moving the joint.  No
     // recomputation necessary.
-    _computed_ok = true;
+    cache._computed_ok = true;
     return true;
   }
 
   EggBackPointer *back = get_model(model_index);
   if (back == nullptr) {
     // This joint doesn't have any data to modify.
-    _computed_ok = true;
+    cache._computed_ok = true;
     return true;
   }
 
@@ -553,7 +594,7 @@ do_compute_reparent(int model_index, int n, EggCharacterDb &db) {
   LMatrix4d transform;
   if (_parent == nullptr) {
     // We are moving from outside the joint hierarchy to within it.
-    transform = _new_parent->get_new_net_frame_inv(model_index, n, db);
+    transform = _new_parent->get_new_net_frame_inv(model_index, n, db, caches);
 
   } else if (_new_parent == nullptr) {
     // We are moving from within the hierarchy to outside it.
@@ -563,38 +604,61 @@ do_compute_reparent(int model_index, int n, EggCharacterDb &db) {
     // We are changing parents within the hierarchy.
     transform =
       _parent->get_net_frame(model_index, n, db) *
-      _new_parent->get_new_net_frame_inv(model_index, n, db);
+      _new_parent->get_new_net_frame_inv(model_index, n, db, caches);
   }
 
   db.set_matrix(joint, EggCharacterDb::TT_rebuild_frame, n,
                 joint->get_frame(n) * transform);
-  _computed_ok = true;
+  cache._computed_ok = true;
 
-  return _computed_ok;
+  return cache._computed_ok;
 }
 
 /**
- * Calls do_rebuild() on the joint for the indicated model index.  Returns
- * true on success, false on failure (false shouldn't be possible).
+ * Calls do_rebuild() on each of the indicated joints, in the order given.  On
+ * return, results contains one entry for each joint, which is nonzero if the
+ * corresponding do_rebuild() succeeded.
+ *
+ * Rebuilding a joint in the egg hierarchy resets its transform, which also
+ * recomputes the cached frames of every group beneath it, so these are done
+ * one at a time on the current thread; the list must name each parent before
+ * its children.  Only the animation tables, which are independent of each
+ * other, are rebuilt using up to num_threads threads.
  */
-bool EggJointData::
-do_joint_rebuild(int model_index, EggCharacterDb &db) {
-  bool all_ok = true;
-
-  EggJointPointer *parent_joint = nullptr;
-  if (_new_parent != nullptr && _new_parent->has_model(model_index)) {
-    DCAST_INTO_R(parent_joint, _new_parent->get_model(model_index), false);
+void EggJointData::
+do_rebuild_pointers(const JointPointers &joints, EggCharacterDb &db,
+                    int num_threads, vector_int &results) {
+  results.assign(joints.size(), 0);
+
+  JointPointers tables;
+  vector_int table_indices;
+  for (size_t i = 0; i < joints.size(); ++i) {
+    EggJointPointer *joint = joints[i];
+    if (joint->is_of_type(EggMatrixTablePointer::get_class_type())) {
+      tables.push_back(joint);
+      table_indices.push_back((int)i);
+    } else {
+      results[i] = joint->do_rebuild(db) ? 1 : 0;
+    }
   }
 
-  if (has_model(model_index)) {
-    EggJointPointer *joint;
-    DCAST_INTO_R(joint, get_model(model_index), false);
-    if (!joint->do_rebuild(db)) {
-      all_ok = false;
-    }
+  if (tables.empty()) {
+    return;
   }
 
-  return all_ok;
+  vector_int table_results(tables.size(), 0);
+
+  RebuildJob job;
+  job._joints = &tables;
+  job._db = &db;
+  job._results = &table_results;
+
+  WorkerPool pool(num_threads);
+  pool.run(tables.size(), &RebuildJob::do_job, &job);
+
+  for (size_t i = 0; i < tables.size(); ++i) {
+    results[table_indices[i]] = table_results[i];
+  }
 }
 
 /**
@@ -715,30 +779,34 @@ is_new_ancestor(EggJointData *child) const {
  * useful only when called within do_compute_reparent().
  */
 const LMatrix4d &EggJointData::
-get_new_net_frame(int model_index, int n, EggCharacterDb &db) {
-  if (!_got_new_net_frame) {
-    _new_net_frame = get_new_frame(model_index, n, db);
+get_new_net_frame(int model_index, int n, EggCharacterDb &db,
+                  ReparentCaches &caches) {
+  ReparentCache &cache = caches[_reparent_index];
+  if (!cache._got_new_net_frame) {
+    cache._new_net_frame = get_new_frame(model_index, n, db, caches);
     if (_new_parent != nullptr) {
-      _new_net_frame = _new_net_frame * _new_parent->get_new_net_frame(model_index, n, db);
+      cache._new_net_frame = cache._new_net_frame * _new_parent->get_new_net_frame(model_index, n, db, caches);
     }
-    _got_new_net_frame = true;
+    cache._got_new_net_frame = true;
   }
-  return _new_net_frame;
+  return cache._new_net_frame;
 }
 
 /**
  * Returns the inverse of get_new_net_frame().
  */
 const LMatrix4d &EggJointData::
-get_new_net_frame_inv(int model_index, int n, EggCharacterDb &db) {
-  if (!_got_new_net_frame_inv) {
-    _new_net_frame_inv.invert_from(get_new_frame(model_index, n, db));
+get_new_net_frame_inv(int model_index, int n, EggCharacterDb &db,
+                      ReparentCaches &caches) {
+  ReparentCache &cache = caches[_reparent_index];
+  if (!cache._got_new_net_frame_inv) {
+    cache._new_net_frame_inv.invert_from(get_new_frame(model_index, n, db, caches));
     if (_new_parent != nullptr) {
-      _new_net_frame_inv = _new_parent->get_new_net_frame_inv(model_index, n, db) * _new_net_frame_inv;
+      cache._new_net_frame_inv = _new_parent->get_new_net_frame_inv(model_index, n, db, caches) * cache._new_net_frame_inv;
     }
-    _got_new_net_frame_inv = true;
+    cache._got_new_net_frame_inv = true;
   }
-  return _new_net_frame_inv;
+  return cache._new_net_frame_inv;
 }
 
 /**
@@ -747,8 +815,9 @@ get_new_net_frame_inv(int model_index, int n, EggCharacterDb &db) {
  * do_finish_reparent() is called.
  */
 LMatrix4d EggJointData::
-get_new_frame(int model_index, int n, EggCharacterDb &db) {
-  do_compute_reparent(model_index, n, db);
+get_new_frame(int model_index, int n, EggCharacterDb &db,
+              ReparentCaches &caches) {
+  do_compute_reparent(model_index, n, db, caches);
 
   EggBackPointer *back = get_model(model_index);
   if (back == nullptr) {
@@ -767,3 +836,93 @@ get_new_frame(int model_index, int n, EggCharacterDb &db) {
   // Return the rebuild frame, as computed.
   return mat;
 }
+
+/**
+ * Appends the joint pointers of all models for this joint, and recursively
+ * for all joints below, to the indicated list.
+ */
+void EggJointData::
+collect_joint_pointers(JointPointers &joints) const {
+  BackPointers::const_iterator bpi;
+  for (bpi = _back_pointers.begin(); bpi != _back_pointers.end(); ++bpi) {
+    EggBackPointer *back = (*bpi);
+    if (back != nullptr) {
+      EggJointPointer *joint;
+      DCAST_INTO_V(joint, back);
+      joints.push_back(joint);
+    }
+  }
+
+  Children::const_iterator ci;
+  for (ci = _children.begin(); ci != _children.end(); ++ci) {
+    (*ci)->collect_joint_pointers(joints);
+  }
+}
+
+/**
+ * Computes the decomposed transforms for one range of frames.  This may be
+ * called from any thread.
+ */
+void ScoreReparentJob::
+do_job(int job_index, void *user_data) {
+  ScoreReparentJob *job = (ScoreReparentJob *)user_data;
+  Range &range = job->_ranges[job_index];
+  EggCharacterDb &db = *job->_db;
+  EggJointData *parent = job->_parent;
+  EggJointData *new_parent = job->_new_parent;
+  int model_index = range._model_index;
+
+  int row = range._first_row;
+  int end_frame = range._first_frame + range._num_frames;
+  for (int n = range._first_frame; n < end_frame; n++) {
+    LMatrix4d transform;
+    if (parent == new_parent) {
+      // We already have this parent.
+      transform = LMatrix4d::ident_mat();
+
+    } else if (parent == nullptr) {
+      // We are moving from outside the joint hierarchy to within it.
+      transform = new_parent->get_net_frame_inv(model_index, n, db);
+
+    } else if (new_parent == nullptr) {
+      // We are moving from within the hierarchy to outside it.
+      transform = parent->get_net_frame(model_index, n, db);
+
+    } else {
+      // We are changing parents within the hierarchy.
+      transform =
+        parent->get_net_frame(model_index, n, db) *
+        new_parent->get_net_frame_inv(model_index, n, db);
+    }
+
+    transform = range._joint->get_frame(n) * transform;
+    LVecBase3d scale, shear, hpr, translate;
+    if (!decompose_matrix(transform, scale, shear, hpr, translate)) {
+      // Invalid transform.
+      return;
+    }
+    job->_i[row] = scale[0];
+    job->_j[row] = scale[1];
+    job->_k[row] = scale[2];
+    job->_a[row] = shear[0];
+    job->_b[row] = shear[1];
+    job->_c[row] = shear[2];
+    job->_hprs[row] = LCAST(PN_stdfloat, hpr);
+    job->_x[row] = translate[0];
+    job->_y[row] = translate[1];
+    job->_z[row] = translate[2];
+    ++row;
+  }
+
+  range._ok = true;
+}
+
+/**
+ * Rebuilds one animation table.  This may be called from any thread.
+ */
+void RebuildJob::
+do_job(int job_index, void *user_data) {
+  RebuildJob *job = (RebuildJob *)user_data;
+  EggJointPointer *joint = (*job->_joints)[job_index];
+  (*job->_results)[job_index] = joint->do_rebuild(*job->_db) ? 1 : 0;
+}
@@ -19,8 +19,11 @@
 #include "eggGroup.h"
 #include "luse.h"
 #include "pset.h"
+#include "pvector.h"
+#include "vector_int.h"
 
 class EggCharacterDb;
+class EggJointPointer;
 
 /**
  * This is one node of a hierarchy of EggJointData nodes, each of which
@@ -62,33 +65,58 @@ public:
   virtual void write(std::ostream &out, int indent_level = 0) const;
 
 protected:
-  void do_begin_reparent();
+  // The number of consecutive frames of a model that are handed to a single
+  // worker thread at a time by score_reparent_to() and
+  // EggCharacterData::do_reparent().
+  enum { frames_per_job = 64 };
+
+  // These are used to cache intermediate results for optimizing
+  // do_compute_reparent().  There is one ReparentCache per joint for each
+  // frame being computed, indexed by _reparent_index, so that several frames
+  // may be computed at once in different threads.
+  class ReparentCache {
+  public:
+    INLINE ReparentCache();
+
+    LMatrix4d _new_net_frame, _new_net_frame_inv;
+    bool _got_new_net_frame, _got_new_net_frame_inv;
+    bool _computed_reparent;
+    bool _computed_ok;
+  };
+  typedef pvector<ReparentCache> ReparentCaches;
+
+  typedef pvector<EggJointPointer *> JointPointers;
+
+  void do_begin_reparent(int reparent_index);
   bool calc_new_parent_depth(pset<EggJointData *> &chain);
-  void do_begin_compute_reparent();
-  bool do_compute_reparent(int model_index, int n, EggCharacterDb &db);
-  bool do_joint_rebuild(int model_index, EggCharacterDb &db);
+  void do_begin_compute_reparent(ReparentCaches &caches);
+  bool do_compute_reparent(int model_index, int n, EggCharacterDb &db,
+                           ReparentCaches &caches);
   void do_finish_reparent();
 
+  static void do_rebuild_pointers(const JointPointers &joints,
+                                  EggCharacterDb &db, int num_threads,
+                                  vector_int &results);
+
 private:
   EggJointData *make_new_joint(const std::string &name);
   EggJointData *find_joint_exact(const std::string &name);
   EggJointData *find_joint_matches(const std::string &name);
 
   bool is_new_ancestor(EggJointData *child) const;
-  const LMatrix4d &get_new_net_frame(int model_index, int n, EggCharacterDb &db);
-  const LMatrix4d &get_new_net_frame_inv(int model_index, int n, EggCharacterDb &db);
-  LMatrix4d get_new_frame(int model_index, int n, EggCharacterDb &db);
+  const LMatrix4d &get_new_net_frame(int model_index, int n, EggCharacterDb &db,
+                                     ReparentCaches &caches);
+  const LMatrix4d &get_new_net_frame_inv(int model_index, int n, EggCharacterDb &db,
+                                         ReparentCaches &caches);
+  LMatrix4d get_new_frame(int model_index, int n, EggCharacterDb &db,
+                          ReparentCaches &caches);
+  void collect_joint_pointers(JointPointers &joints) const;
 
   bool _has_rest_frame;
   bool _rest_frames_differ;
   LMatrix4d _rest_frame;
 
-  // These are used to cache the above results for optimizing
-  // do_compute_reparent().
-  LMatrix4d _new_net_frame, _new_net_frame_inv;
-  bool _got_new_net_frame, _got_new_net_frame_inv;
-  bool _computed_reparent;
-  bool _computed_ok;
+  int _reparent_index;
 
 protected:
   typedef pvector<EggJointData *> Children;
@@ -29,6 +29,7 @@ EggRetargetAnim::
 EggRetargetAnim() {
   add_path_replace_options();
   add_path_store_options();
+  add_threads_option();
 
   set_program_brief("remove transformations from animation data in .egg files");
   set_program_description
@@ -29,6 +29,7 @@ EggTopstrip::
 EggTopstrip() {
   add_path_replace_options();
   add_path_store_options();
+  add_threads_option();
 
   set_program_brief("unapplies animation from a joint in an .egg file");
   set_program_description
@@ -59,6 +59,15 @@ ConfigVariableBool flt_error_abort
 
           "file failed."));
 
+ConfigVariableInt flt_load_threads
+("flt-load-threads", 1,
+ PRC_DESC("The number of threads to use for reading the external references "
+          "of a flt file when they are being merged into the converted "
+          "model.  If this is greater than 1, all of the referenced files are "
+          "located and read up front, this many at a time, before the "
+          "conversion begins.  The default, 1, reads each one only as it is "
+          "reached, and frees it again before reading the next."));
+
 
 ConfigureFn(config_flt) {
   init_libflt();
@@ -18,10 +18,12 @@
 
 #include "notifyCategoryProxy.h"
 #include "configVariableBool.h"
+#include "configVariableInt.h"
 
 NotifyCategoryDeclNoExport(flt);
 
 extern ConfigVariableBool flt_error_abort;
+extern ConfigVariableInt flt_load_threads;
 
 extern void init_libflt();
 
@@ -17,6 +17,11 @@
 #include "datagramIterator.h"
 
 #include <assert.h>
+#include <string.h>
+
+// The size of the block buffer.  This is large enough to hold the largest
+// possible record, whose length must fit in 16 bits.
+static const size_t flt_buffer_size = 0x10000;
 
 /**
  *
@@ -27,7 +32,9 @@ FltRecordReader(std::istream &in) :
 {
   _opcode = FO_none;
   _record_length = 0;
-  _iterator = nullptr;
+  _buffer.resize(flt_buffer_size);
+  _buffer_pos = 0;
+  _buffer_end = 0;
   _state = S_begin;
   _next_error = FE_ok;
   _next_opcode = FO_none;
@@ -42,8 +49,6 @@ FltRecordReader(std::istream &in) :
  */
 FltRecordReader::
 ~FltRecordReader() {
-  delete _iterator;
-  _iterator = nullptr;
 }
 
 /**
@@ -60,8 +65,8 @@ get_opcode() const {
  */
 DatagramIterator &FltRecordReader::
 get_iterator() {
-  nassertr(_state == S_normal, *_iterator);
-  return *_iterator;
+  nassertr(_state == S_normal, _iterator);
+  return _iterator;
 }
 
 /**
@@ -74,7 +79,7 @@ get_datagram() {
   static Datagram bogus_datagram;
   nassertr(_state == S_normal, bogus_datagram);
 #endif
-  return _iterator->get_datagram();
+  return _datagram;
 }
 
 /**
@@ -99,11 +104,6 @@ advance(bool ok_eof) {
     assert(!flt_error_abort);
     return FE_read_error;
   }
-  if (_iterator != nullptr) {
-    delete _iterator;
-    _iterator = nullptr;
-  }
-
   if (_next_error == FE_end_of_file) {
     _state = S_eof;
     if (ok_eof) {
@@ -129,15 +129,7 @@ advance(bool ok_eof) {
 
   // And now read the full record based on the length.
   int length = _next_record_length - header_size;
-  if (length > 0) {
-    vector_uchar data((size_t)length);
-    _in.read((char *)&data[0], length);
-    _datagram = Datagram(std::move(data));
-  } else {
-    _datagram = Datagram();
-  }
-
-  if (_in.fail()) {
+  if (_buffer_end - _buffer_pos < (size_t)length && !fill_buffer(length)) {
     if (_in.eof()) {
       _state = S_eof;
       assert(!flt_error_abort);
@@ -148,6 +140,8 @@ advance(bool ok_eof) {
     assert(!flt_error_abort);
     return FE_read_error;
   }
+  _datagram = Datagram(&_buffer[0] + _buffer_pos, length);
+  _buffer_pos += length;
 
   // Check out the next header in case it's a continuation.
   read_next_header();
@@ -161,14 +155,7 @@ advance(bool ok_eof) {
     _record_length += _next_record_length;
     length = _next_record_length - header_size;
 
-    if (length > 0) {
-      char *buffer = new char[length];
-      _in.read(buffer, length);
-      _datagram.append_data(buffer, length);
-      delete[] buffer;
-    }
-
-    if (_in.fail()) {
+    if (_buffer_end - _buffer_pos < (size_t)length && !fill_buffer(length)) {
       if (_in.eof()) {
         _state = S_eof;
         assert(!flt_error_abort);
@@ -179,12 +166,14 @@ advance(bool ok_eof) {
       assert(!flt_error_abort);
       return FE_read_error;
     }
+    _datagram.append_data(&_buffer[0] + _buffer_pos, length);
+    _buffer_pos += length;
 
     read_next_header();
   }
 
-  // Finally, create a new iterator to read this record.
-  _iterator = new DatagramIterator(_datagram);
+  // Finally, reset the iterator to read this record.
+  _iterator.assign(_datagram);
   _state = S_normal;
 
   return FE_ok;
@@ -217,10 +206,8 @@ error() const {
  */
 void FltRecordReader::
 read_next_header() {
-  char bytes[header_size];
-  _in.read(bytes, header_size);
-
-  if (_in.fail()) {
+  if (_buffer_end - _buffer_pos < (size_t)header_size &&
+      !fill_buffer(header_size)) {
     if (_in.eof()) {
       _next_error = FE_end_of_file;
       return;
@@ -229,14 +216,46 @@ read_next_header() {
     return;
   }
 
-  // Now extract out the opcode and length.
-  Datagram dg(bytes, header_size);
-  DatagramIterator dgi(dg);
-  _next_opcode = (FltOpcode)dgi.get_be_int16();
-  _next_record_length = dgi.get_be_uint16();
+  // Now extract out the opcode and length, both big-endian.
+  const unsigned char *bytes = &_buffer[0] + _buffer_pos;
+  _next_opcode = (FltOpcode)(int16_t)((bytes[0] << 8) | bytes[1]);
+  _next_record_length = (bytes[2] << 8) | bytes[3];
+  _buffer_pos += header_size;
 
   if (_next_record_length < header_size) {
     _next_error = FE_invalid_record;
     return;
   }
 }
+
+/**
+ * Reads from the stream until at least the indicated number of unconsumed
+ * bytes are in the buffer.  Returns true if successful, or false if the end
+ * of the file was reached first or some other error occurred, in which case
+ * the stream's state indicates which.
+ */
+bool FltRecordReader::
+fill_buffer(size_t length) {
+  nassertr(length <= _buffer.size(), false);
+
+  size_t remaining = _buffer_end - _buffer_pos;
+  if (remaining != 0 && _buffer_pos != 0) {
+    memmove(&_buffer[0], &_buffer[0] + _buffer_pos, remaining);
+  }
+  _buffer_pos = 0;
+  _buffer_end = remaining;
+
+  while (_buffer_end < length) {
+    if (_in.fail()) {
+      return false;
+    }
+    _in.read((char *)&_buffer[0] + _buffer_end, _buffer.size() - _buffer_end);
+    size_t count = (size_t)_in.gcount();
+    _buffer_end += count;
+    if (count == 0 && !_in.fail()) {
+      _in.setstate(std::ios::failbit);
+    }
+  }
+
+  return true;
+}
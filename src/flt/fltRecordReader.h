@@ -21,11 +21,15 @@
 
 #include "datagram.h"
 #include "datagramIterator.h"
+#include "pvector.h"
 
 /**
  * This class turns an istream into a sequence of FltRecords by reading a
  * sequence of Datagrams and extracting the opcode from each one.  It
  * remembers where it is in the file and what the current record is.
+ *
+ * The stream is read a large block at a time, and each record is extracted
+ * directly from the block buffer.
  */
 class FltRecordReader {
 public:
@@ -44,12 +48,20 @@ public:
 
 private:
   void read_next_header();
+  bool fill_buffer(size_t length);
 
   std::istream &_in;
   Datagram _datagram;
   FltOpcode _opcode;
   int _record_length;
-  DatagramIterator *_iterator;
+  DatagramIterator _iterator;
+
+  // The bytes between _buffer_pos and _buffer_end have been read from the
+  // stream but not yet consumed.  The buffer is always large enough to hold
+  // one complete record.
+  pvector<unsigned char> _buffer;
+  size_t _buffer_pos;
+  size_t _buffer_end;
 
   FltError _next_error;
   FltOpcode _next_opcode;
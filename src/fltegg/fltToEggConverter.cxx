@@ -23,6 +23,8 @@
 #include "fltVertex.h"
 #include "fltVertexList.h"
 #include "fltExternalReference.h"
+#include "config_flt.h"
+#include "workerPool.h"
 #include "dcast.h"
 #include "eggData.h"
 #include "eggGroup.h"
@@ -37,6 +39,16 @@
 
 using std::string;
 
+/**
+ * The data shared by the read_external_job() calls for one batch of external
+ * references.
+ */
+class FltExternalReads {
+public:
+  PathReplace *_path_replace;
+  pvector<Filename> _filenames;
+  pvector<PT(FltHeader) > _headers;
+};
 
 /**
  *
@@ -53,7 +65,8 @@ FltToEggConverter() {
 FltToEggConverter::
 FltToEggConverter(const FltToEggConverter &copy) :
   SomethingToEggConverter(copy),
-  _compose_transforms(copy._compose_transforms)
+  _compose_transforms(copy._compose_transforms),
+  _ext_headers(copy._ext_headers)
 {
 }
 
@@ -109,13 +122,28 @@ supports_compressed() const {
  */
 bool FltToEggConverter::
 convert_file(const Filename &filename) {
-  PT(FltHeader) header = new FltHeader(_path_replace);
+  PT(FltHeader) header;
 
   nout << "Reading " << filename << "\n";
-  FltError result = header->read_flt(filename);
-  if (result != FE_ok) {
-    nout << "Unable to read: " << result << "\n";
-    return false;
+  if (_ext_headers != nullptr) {
+    ExternalHeaders::Headers &headers = _ext_headers->_headers;
+    ExternalHeaders::Headers::iterator hi = headers.find(filename);
+    if (hi != headers.end()) {
+      // This file has already been read by prefetch_externals().  We take it
+      // out of the table, so it is freed as soon as we are done with it; if
+      // it is referenced again, it will simply be read again.
+      header = (*hi).second;
+      (*hi).second = nullptr;
+    }
+  }
+
+  if (header == nullptr) {
+    header = new FltHeader(_path_replace);
+    FltError result = header->read_flt(filename);
+    if (result != FE_ok) {
+      nout << "Unable to read: " << result << "\n";
+      return false;
+    }
   }
 
   header->check_version();
@@ -148,6 +176,10 @@ convert_flt(const FltHeader *flt_header) {
   clear_error();
   _flt_header = flt_header;
 
+  if (get_merge_externals() && flt_load_threads > 1) {
+    prefetch_externals(_flt_header);
+  }
+
   // Generate a default vertex pool.
   _main_egg_vpool = new EggVertexPool("vpool");
   _egg_data->add_child(_main_egg_vpool.p());
@@ -181,6 +213,87 @@ cleanup() {
   _flt_header.clear();
   _main_egg_vpool.clear();
   _textures.clear();
+  _ext_headers.clear();
+}
+
+/**
+ * Locates all of the files referenced, directly or indirectly, by the
+ * indicated header, and reads each one into its own FltHeader, several at a
+ * time according to flt-load-threads.  The headers are saved for
+ * convert_file() to pick up when the references are merged in.
+ */
+void FltToEggConverter::
+prefetch_externals(const FltHeader *flt_header) {
+  pvector<Filename> filenames;
+  collect_externals(flt_header, filenames);
+
+  if (_ext_headers == nullptr) {
+    _ext_headers = new ExternalHeaders;
+  }
+  ExternalHeaders::Headers &headers = _ext_headers->_headers;
+
+  WorkerPool pool(flt_load_threads);
+
+  while (!filenames.empty()) {
+    // Skip the files we have already read, or failed to read.
+    FltExternalReads reads;
+    reads._path_replace = _path_replace;
+    pvector<Filename>::const_iterator fi;
+    for (fi = filenames.begin(); fi != filenames.end(); ++fi) {
+      if (headers.find(*fi) == headers.end()) {
+        headers[*fi] = nullptr;
+        reads._filenames.push_back(*fi);
+      }
+    }
+    if (reads._filenames.empty()) {
+      break;
+    }
+    reads._headers.resize(reads._filenames.size());
+
+    pool.run((int)reads._filenames.size(), &read_external_job, &reads);
+
+    // The files we just read may reference still more files.
+    filenames.clear();
+    for (size_t i = 0; i < reads._filenames.size(); ++i) {
+      if (reads._headers[i] != nullptr) {
+        headers[reads._filenames[i]] = reads._headers[i];
+        collect_externals(reads._headers[i], filenames);
+      }
+    }
+  }
+}
+
+/**
+ * Appends the filenames of all of the external references at or below the
+ * indicated record to the vector.
+ */
+void FltToEggConverter::
+collect_externals(const FltRecord *flt_record, pvector<Filename> &filenames) {
+  if (flt_record->is_of_type(FltExternalReference::get_class_type())) {
+    const FltExternalReference *flt_ext =
+      DCAST(FltExternalReference, flt_record);
+    filenames.push_back(flt_ext->get_ref_filename());
+  }
+
+  int num_children = flt_record->get_num_children();
+  for (int i = 0; i < num_children; i++) {
+    collect_externals(flt_record->get_child(i), filenames);
+  }
+}
+
+/**
+ * The WorkerPool job function for prefetch_externals().  Reads one external
+ * reference file.  Failures are not reported here; the file will be read
+ * again, and the error reported, when the reference is converted.
+ */
+void FltToEggConverter::
+read_external_job(int job_index, void *user_data) {
+  FltExternalReads *reads = (FltExternalReads *)user_data;
+
+  PT(FltHeader) header = new FltHeader(reads->_path_replace);
+  if (header->read_flt(reads->_filenames[job_index]) == FE_ok) {
+    reads->_headers[job_index] = header;
+  }
 }
 
 /**
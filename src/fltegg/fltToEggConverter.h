@@ -25,6 +25,8 @@
 #include "pt_EggTexture.h"
 #include "pt_EggVertex.h"
 #include "pointerTo.h"
+#include "referenceCount.h"
+#include "pmap.h"
 #include "distanceUnit.h"
 
 class FltRecord;
@@ -70,6 +72,11 @@ public:
 private:
   void cleanup();
 
+  void prefetch_externals(const FltHeader *flt_header);
+  static void collect_externals(const FltRecord *flt_record,
+                                pvector<Filename> &filenames);
+  static void read_external_job(int job_index, void *user_data);
+
   typedef pvector< PT_EggVertex > EggVertices;
 
   void convert_record(const FltRecord *flt_record, FltToEggLevelState &state);
@@ -104,6 +111,17 @@ private:
 
   typedef pmap<const FltTexture *, PT(EggTexture) > Textures;
   Textures _textures;
+
+  // The external reference files that have already been read by
+  // prefetch_externals(), or NULL for those that could not be read or have
+  // already been converted.  The copies of the converter that handle the
+  // references share this same table.
+  class ExternalHeaders : public ReferenceCount {
+  public:
+    typedef pmap<Filename, PT(FltHeader) > Headers;
+    Headers _headers;
+  };
+  PT(ExternalHeaders) _ext_headers;
 };
 
 #include "fltToEggConverter.I"
@@ -213,6 +213,14 @@ idle() {
     char buffer[128];
     sprintf(buffer, "%0.1f ms / %0.1f Hz", 1000.0f / frame_rate, frame_rate);
 
+    // If the reader couldn't keep up with the client, say so, so the missing
+    // frames don't go unnoticed.
+    int num_dropped_frames = get_num_dropped_frames();
+    if (num_dropped_frames != 0) {
+      size_t len = strlen(buffer);
+      sprintf(buffer + len, " (%d frames dropped)", num_dropped_frames);
+    }
+
     gtk_label_set_text(GTK_LABEL(_frame_rate_label), buffer);
   }
 }
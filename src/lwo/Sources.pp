@@ -86,3 +86,12 @@
     lwoVertexMap.h
 
 #end ss_lib_target
+
+#begin test_bin_target
+  #define TARGET test_lwoparse
+  #define LOCAL_LIBS p3lwo p3pandatoolbase
+
+  #define SOURCES \
+    test_lwoparse.cxx
+
+#end test_bin_target
@@ -14,11 +14,16 @@
 #include "iffInputFile.h"
 #include "iffGenericChunk.h"
 #include "datagram.h"
-#include "datagramIterator.h"
 #include "virtualFileSystem.h"
 
+#include <algorithm>
+#include <string.h>
+
 TypeHandle IffInputFile::_type_handle;
 
+// The size of each block read from the input stream.
+static const size_t iff_buffer_size = 64 * 1024;
+
 /**
  *
  */
@@ -29,6 +34,9 @@ IffInputFile() {
   _eof = true;
   _unexpected_eof = false;
   _bytes_read = 0;
+  _buffer.resize(iff_buffer_size);
+  _buffer_pos = 0;
+  _buffer_end = 0;
 }
 
 /**
@@ -78,97 +86,39 @@ set_input(std::istream *input, bool owns_istream) {
   _eof = false;
   _unexpected_eof = false;
   _bytes_read = 0;
+  _buffer_pos = 0;
+  _buffer_end = 0;
 }
 
 /**
- * Extracts a signed 8-bit integer.
- */
-int8_t IffInputFile::
-get_int8() {
-  Datagram dg;
-  if (!read_bytes(dg, 1)) {
-    return 0;
-  }
-  DatagramIterator dgi(dg);
-  return dgi.get_int8();
-}
-
-/**
- * Extracts an unsigned 8-bit integer.
- */
-uint8_t IffInputFile::
-get_uint8() {
-  Datagram dg;
-  if (!read_bytes(dg, 1)) {
-    return 0;
-  }
-  DatagramIterator dgi(dg);
-  return dgi.get_int8();
-}
-
-/**
- * Extracts a signed 16-bit big-endian integer.
- */
-int16_t IffInputFile::
-get_be_int16() {
-  Datagram dg;
-  if (!read_bytes(dg, 2)) {
-    return 0;
-  }
-  DatagramIterator dgi(dg);
-  return dgi.get_be_int16();
-}
-
-/**
- * Extracts a signed 32-bit big-endian integer.
+ * Extracts count consecutive 32-bit big-endian floating-point numbers into
+ * the indicated array.  Returns true if successful, false if EOF was reached
+ * first.
  */
-int32_t IffInputFile::
-get_be_int32() {
-  Datagram dg;
-  if (!read_bytes(dg, 4)) {
-    return 0;
-  }
-  DatagramIterator dgi(dg);
-  return dgi.get_be_int32();
-}
-
-/**
- * Extracts an unsigned 16-bit big-endian integer.
- */
-uint16_t IffInputFile::
-get_be_uint16() {
-  Datagram dg;
-  if (!read_bytes(dg, 2)) {
-    return 0;
-  }
-  DatagramIterator dgi(dg);
-  return dgi.get_be_uint16();
-}
+bool IffInputFile::
+get_be_float32_array(PN_stdfloat *data, size_t count) {
+  while (count > 0) {
+    if (_buffer_end - _buffer_pos < 4 && !fill_buffer(4)) {
+      return false;
+    }
 
-/**
- * Extracts an unsigned 32-bit big-endian integer.
- */
-uint32_t IffInputFile::
-get_be_uint32() {
-  Datagram dg;
-  if (!read_bytes(dg, 4)) {
-    return 0;
-  }
-  DatagramIterator dgi(dg);
-  return dgi.get_be_uint32();
-}
+    // Decode as many as are already in the buffer in one go.
+    size_t available = std::min((_buffer_end - _buffer_pos) / 4, count);
+    const unsigned char *p = &_buffer[0] + _buffer_pos;
+    for (size_t i = 0; i < available; ++i) {
+      uint32_t bits = decode_be_uint32(p);
+      float value;
+      memcpy(&value, &bits, sizeof(value));
+      data[i] = value;
+      p += 4;
+    }
 
-/**
- * Extracts a 32-bit big-endian single-precision floating-point number.
- */
-PN_stdfloat IffInputFile::
-get_be_float32() {
-  Datagram dg;
-  if (!read_bytes(dg, 4)) {
-    return 0;
+    _buffer_pos += available * 4;
+    _bytes_read += available * 4;
+    data += available;
+    count -= available;
   }
-  DatagramIterator dgi(dg);
-  return dgi.get_be_float32();
+  return true;
 }
 
 /**
@@ -194,12 +144,11 @@ get_string() {
  */
 IffId IffInputFile::
 get_id() {
-  Datagram dg;
-  if (!read_bytes(dg, 4)) {
+  const unsigned char *p = get_raw(4);
+  if (p == nullptr) {
     return IffId();
   }
-  const char *id = (const char *)dg.get_data();
-  return IffId(id);
+  return IffId((const char *)p);
 }
 
 /**
@@ -302,41 +251,34 @@ get_subchunk(IffChunk *context) {
   return nullptr;
 }
 
-/**
- * Reads a single byte.  Returns true if successful, false otherwise.
- */
-bool IffInputFile::
-read_byte(char &byte) {
-  if (is_eof()) {
-    return false;
-  }
-
-  _input->get(byte);
-  _bytes_read++;
-  _eof = _input->eof() || _input->fail();
-  return !is_eof();
-}
-
 /**
  * Reads a series of bytes, and stores them in the indicated Datagram.
  * Returns true if successful, false otherwise.
  */
 bool IffInputFile::
 read_bytes(Datagram &datagram, int length) {
-  if (is_eof()) {
+  if (is_eof() || length < 0) {
     return false;
   }
 
-  char *buffer = new char[length];
-  _input->read(buffer, length);
-  _eof = (_input->gcount() != length);
-  if (is_eof()) {
-    return false;
+  // Take whatever is already in the buffer, and read the rest directly from
+  // the stream.
+  size_t available = std::min(_buffer_end - _buffer_pos, (size_t)length);
+  pvector<unsigned char> data(length);
+  if (available != 0) {
+    memcpy(&data[0], &_buffer[0] + _buffer_pos, available);
+    _buffer_pos += available;
+  }
+  if (available < (size_t)length) {
+    _input->read((char *)&data[available], length - available);
+    if ((size_t)_input->gcount() != length - available) {
+      _eof = true;
+      return false;
+    }
   }
 
   _bytes_read += length;
-  datagram = Datagram(buffer, length);
-  delete[] buffer;
+  datagram = Datagram(data.empty() ? nullptr : &data[0], length);
   return true;
 }
 
@@ -346,17 +288,57 @@ read_bytes(Datagram &datagram, int length) {
  */
 bool IffInputFile::
 skip_bytes(int length) {
-  if (is_eof()) {
+  while (length > 0) {
+    if (_buffer_pos == _buffer_end && !fill_buffer(1)) {
+      return false;
+    }
+    size_t count = std::min(_buffer_end - _buffer_pos, (size_t)length);
+    _buffer_pos += count;
+    _bytes_read += count;
+    length -= (int)count;
+  }
+
+  return !is_eof();
+}
+
+/**
+ * Reads from the stream until at least the indicated number of unconsumed
+ * bytes are in the buffer, which must be no larger than the buffer itself.
+ * Returns true if successful.  If the end of the file is reached first, sets
+ * the EOF flag, discards whatever is left in the buffer, and returns false.
+ */
+bool IffInputFile::
+fill_buffer(size_t length) {
+  nassertr(length <= _buffer.size(), false);
+  if (_eof || _input == nullptr) {
     return false;
   }
 
-  char byte;
-  while (length > 0 && !is_eof()) {
-    read_byte(byte);
-    length--;
+  size_t remaining = _buffer_end - _buffer_pos;
+  if (remaining != 0 && _buffer_pos != 0) {
+    memmove(&_buffer[0], &_buffer[0] + _buffer_pos, remaining);
+  }
+  _buffer_pos = 0;
+  _buffer_end = remaining;
+
+  while (_buffer_end < length) {
+    _input->read((char *)&_buffer[0] + _buffer_end,
+                 _buffer.size() - _buffer_end);
+    size_t count = (size_t)_input->gcount();
+    _buffer_end += count;
+    if (count == 0 || _input->fail()) {
+      if (_buffer_end >= length) {
+        // A short read at the end of the file, but we got what we needed.
+        _input->clear();
+        break;
+      }
+      _eof = true;
+      _buffer_end = 0;
+      return false;
+    }
   }
 
-  return !is_eof();
+  return true;
 }
 
 /**
@@ -21,6 +21,9 @@
 
 #include "typedObject.h"
 #include "pointerTo.h"
+#include "pvector.h"
+
+#include <string.h>
 
 class Datagram;
 
@@ -43,14 +46,16 @@ public:
 
   INLINE void align();
 
-  int8_t get_int8();
-  uint8_t get_uint8();
+  INLINE int8_t get_int8();
+  INLINE uint8_t get_uint8();
+
+  INLINE int16_t get_be_int16();
+  INLINE int32_t get_be_int32();
+  INLINE uint16_t get_be_uint16();
+  INLINE uint32_t get_be_uint32();
+  INLINE PN_stdfloat get_be_float32();
 
-  int16_t get_be_int16();
-  int32_t get_be_int32();
-  uint16_t get_be_uint16();
-  uint32_t get_be_uint32();
-  PN_stdfloat get_be_float32();
+  bool get_be_float32_array(PN_stdfloat *data, size_t count);
 
   std::string get_string();
 
@@ -59,13 +64,21 @@ public:
   PT(IffChunk) get_chunk();
   PT(IffChunk) get_subchunk(IffChunk *context);
 
-  bool read_byte(char &byte);
+  INLINE bool read_byte(char &byte);
   bool read_bytes(Datagram &datagram, int length);
   bool skip_bytes(int length);
 
 protected:
   virtual IffChunk *make_new_chunk(IffId id);
 
+private:
+  INLINE const unsigned char *get_raw(size_t length);
+  bool fill_buffer(size_t length);
+
+  INLINE static uint16_t decode_be_uint16(const unsigned char *p);
+  INLINE static uint32_t decode_be_uint32(const unsigned char *p);
+
+protected:
   std::istream *_input;
   Filename _filename;
   bool _owns_istream;
@@ -73,6 +86,13 @@ protected:
   bool _unexpected_eof;
   size_t _bytes_read;
 
+  // The file is read through this buffer, a block at a time.  The bytes
+  // between _buffer_pos and _buffer_end have been read from the stream but
+  // not yet consumed.
+  pvector<unsigned char> _buffer;
+  size_t _buffer_pos;
+  size_t _buffer_end;
+
 public:
   virtual TypeHandle get_type() const {
     return get_class_type();
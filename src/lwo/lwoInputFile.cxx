@@ -42,23 +42,6 @@ LwoInputFile::
 ~LwoInputFile() {
 }
 
-/**
- * Reads a Lightwave variable-length index.  This is either a 2-byte or 4-byte
- * integer.
- */
-int LwoInputFile::
-get_vx() {
-  uint16_t top = get_be_uint16();
-  if ((top & 0xff00) == 0xff00) {
-    // The first byte is 0xff, which indicates we have a 4-byte integer.
-    uint16_t bottom = get_be_uint16();
-    return ((int)(top & 0xff) << 16) | bottom;
-  }
-
-  // The first byte is not 0xff, which indicates we have a 2-byte integer.
-  return top;
-}
-
 /**
  * Reads a three-component vector of floats.
  */
@@ -31,7 +31,7 @@ public:
   INLINE double get_lwo_version() const;
   INLINE void set_lwo_version(double version);
 
-  int get_vx();
+  INLINE int get_vx();
   LVecBase3 get_vec3();
   Filename get_filename();
 
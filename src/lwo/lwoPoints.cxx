@@ -17,6 +17,8 @@
 #include "dcast.h"
 #include "indent.h"
 
+#include <algorithm>
+
 TypeHandle LwoPoints::_type_handle;
 
 /**
@@ -46,6 +48,29 @@ bool LwoPoints::
 read_iff(IffInputFile *in, size_t stop_at) {
   LwoInputFile *lin = DCAST(LwoInputFile, in);
 
+  // The chunk is nothing but an array of points, so we can read them in
+  // large batches.  The chunk length comes from the file and might be bogus,
+  // so we don't allocate room for all of them up front.
+  static const size_t batch_size = 4096;
+  size_t num_points = 0;
+  if (stop_at > lin->get_bytes_read()) {
+    num_points = (stop_at - lin->get_bytes_read()) / 12;
+  }
+  pvector<PN_stdfloat> values(std::min(num_points, batch_size) * 3);
+  while (num_points != 0) {
+    size_t num_batch = std::min(num_points, batch_size);
+    if (!lin->get_be_float32_array(&values[0], num_batch * 3)) {
+      return false;
+    }
+    for (size_t i = 0; i < num_batch; ++i) {
+      const PN_stdfloat *v = &values[i * 3];
+      _points.push_back(LPoint3(v[0], v[1], v[2]));
+    }
+    num_points -= num_batch;
+  }
+
+  // Any bytes left over don't make a whole point; reading them one point at
+  // a time fails the chunk just as it always did.
   while (lin->get_bytes_read() < stop_at && !lin->is_eof()) {
     LPoint3 point = lin->get_vec3();
     _points.push_back(point);
@@ -60,6 +60,7 @@ read_iff(IffInputFile *in, size_t stop_at) {
       poly->_flags = nf & ~PF_numverts_mask;
       poly->_surface_index = -1;
 
+      poly->_vertices.reserve(num_vertices);
       for (int i = 0; i < num_vertices; i++) {
         int vindex = lin->get_vx();
         poly->_vertices.push_back(vindex);
@@ -80,6 +81,7 @@ read_iff(IffInputFile *in, size_t stop_at) {
       PT(Polygon) poly = new Polygon;
       poly->_flags = 0;
 
+      poly->_vertices.reserve(num_vertices);
       for (int i = 0; i < num_vertices; i++) {
         int vindex = lin->get_vx();
         poly->_vertices.push_back(vindex);
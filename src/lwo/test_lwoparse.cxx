@@ -0,0 +1,296 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_lwoparse.cxx
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#include "pandatoolbase.h"
+#include "lwoInputFile.h"
+#include "lwoHeader.h"
+#include "lwoPoints.h"
+#include "lwoPolygons.h"
+#include "config_lwo.h"
+#include "filename.h"
+#include "trueClock.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// This program times the reading of an LWO2 file through LwoInputFile, which
+// is most of the work of lwo2egg on a large model, and reports the throughput
+// in MB/s.  If no file is named, it generates a grid of quads with a point
+// list, a uv map, a polygon list and polygon tags, large enough that the
+// point and polygon indices need both the short and the long form.
+
+/**
+ * Appends a big-endian 16-bit integer to the indicated buffer.
+ */
+static void
+add_be_uint16(std::string &buffer, uint16_t value) {
+  buffer += (char)(value >> 8);
+  buffer += (char)value;
+}
+
+/**
+ * Appends a big-endian 32-bit integer to the indicated buffer.
+ */
+static void
+add_be_uint32(std::string &buffer, uint32_t value) {
+  buffer += (char)(value >> 24);
+  buffer += (char)(value >> 16);
+  buffer += (char)(value >> 8);
+  buffer += (char)value;
+}
+
+/**
+ * Appends a big-endian 32-bit float to the indicated buffer.
+ */
+static void
+add_be_float32(std::string &buffer, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  add_be_uint32(buffer, bits);
+}
+
+/**
+ * Appends a Lightwave variable-length index to the indicated buffer.
+ */
+static void
+add_vx(std::string &buffer, int index) {
+  if (index < 0xff00) {
+    add_be_uint16(buffer, (uint16_t)index);
+  } else {
+    add_be_uint32(buffer, 0xff000000 | (uint32_t)index);
+  }
+}
+
+/**
+ * Appends a null-terminated string, padded to an even length, to the
+ * indicated buffer.
+ */
+static void
+add_string(std::string &buffer, const std::string &str) {
+  buffer += str;
+  buffer += '\0';
+  if ((str.length() & 1) == 0) {
+    buffer += '\0';
+  }
+}
+
+/**
+ * Writes a chunk with the indicated id and data to the file.  Returns true
+ * on success.
+ */
+static bool
+write_chunk(FILE *file, const char *id, const std::string &data) {
+  std::string header(id, 4);
+  add_be_uint32(header, (uint32_t)data.length());
+  return fwrite(header.data(), 1, header.length(), file) == header.length() &&
+    fwrite(data.data(), 1, data.length(), file) == data.length();
+}
+
+/**
+ * Writes an LWO2 file holding a grid of size x size quads to the indicated
+ * file.  Returns true on success.
+ */
+static bool
+write_grid(const Filename &filename, int size) {
+  Filename binary_filename = Filename::binary_filename(filename);
+  std::string os_filename = binary_filename.to_os_specific();
+  FILE *file = fopen(os_filename.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+
+  int num_verts = size + 1;
+
+  std::string tags;
+  add_string(tags, "grid");
+
+  std::string layer;
+  add_be_uint16(layer, 0);
+  add_be_uint16(layer, 0);
+  add_be_float32(layer, 0.0f);
+  add_be_float32(layer, 0.0f);
+  add_be_float32(layer, 0.0f);
+  add_string(layer, "grid");
+
+  std::string points;
+  points.reserve((size_t)num_verts * num_verts * 12);
+  for (int y = 0; y < num_verts; ++y) {
+    for (int x = 0; x < num_verts; ++x) {
+      add_be_float32(points, x * 0.01f);
+      add_be_float32(points, 0.01f * ((x * 7 + y * 13) % 17));
+      add_be_float32(points, y * 0.01f);
+    }
+  }
+
+  std::string uvs("TXUV", 4);
+  add_be_uint16(uvs, 2);
+  add_string(uvs, "uv");
+  for (int y = 0; y < num_verts; ++y) {
+    for (int x = 0; x < num_verts; ++x) {
+      add_vx(uvs, y * num_verts + x);
+      add_be_float32(uvs, (float)x / size);
+      add_be_float32(uvs, (float)y / size);
+    }
+  }
+
+  std::string polygons("FACE", 4);
+  std::string polygon_tags("SURF", 4);
+  int num_polygons = 0;
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      int a = y * num_verts + x;
+      add_be_uint16(polygons, 4);
+      add_vx(polygons, a);
+      add_vx(polygons, a + num_verts);
+      add_vx(polygons, a + num_verts + 1);
+      add_vx(polygons, a + 1);
+
+      add_vx(polygon_tags, num_polygons);
+      add_be_uint16(polygon_tags, 0);
+      ++num_polygons;
+    }
+  }
+
+  size_t length = 4;
+  length += 8 + tags.length() + 8 + layer.length() + 8 + points.length();
+  length += 8 + uvs.length() + 8 + polygons.length();
+  length += 8 + polygon_tags.length();
+
+  std::string form("FORM", 4);
+  add_be_uint32(form, (uint32_t)length);
+  form += "LWO2";
+
+  bool okflag =
+    fwrite(form.data(), 1, form.length(), file) == form.length() &&
+    write_chunk(file, "TAGS", tags) &&
+    write_chunk(file, "LAYR", layer) &&
+    write_chunk(file, "PNTS", points) &&
+    write_chunk(file, "VMAP", uvs) &&
+    write_chunk(file, "POLS", polygons) &&
+    write_chunk(file, "PTAG", polygon_tags);
+
+  if (fclose(file) != 0) {
+    okflag = false;
+  }
+  return okflag;
+}
+
+/**
+ * Reads the indicated file through LwoInputFile, and returns the header
+ * chunk, or NULL on failure.
+ */
+static PT(IffChunk)
+read_file(const Filename &filename) {
+  LwoInputFile in;
+  if (!in.open_read(filename)) {
+    return nullptr;
+  }
+
+  PT(IffChunk) chunk = in.get_chunk();
+  if (chunk == nullptr || !chunk->is_of_type(LwoHeader::get_class_type())) {
+    return nullptr;
+  }
+  return chunk;
+}
+
+int
+main(int argc, char *argv[]) {
+  if (argc > 3) {
+    nout << "test_lwoparse [grid_size | filename.lwo] [num_passes]\n";
+    exit(1);
+  }
+
+  init_liblwo();
+
+  Filename filename;
+  bool generated = false;
+  std::string arg = (argc > 1) ? argv[1] : "";
+  int num_passes = (argc > 2) ? atoi(argv[2]) : 3;
+  if (num_passes < 1) {
+    nout << "Invalid number of passes.\n";
+    exit(1);
+  }
+
+  if (!arg.empty() && Filename(arg).get_extension() == "lwo") {
+    filename = Filename::from_os_specific(arg);
+
+  } else {
+    int size = arg.empty() ? 1000 : atoi(arg.c_str());
+    if (size < 1) {
+      nout << "Invalid grid size.\n";
+      exit(1);
+    }
+    filename = Filename::temporary("", "lwoparse_", ".lwo");
+    nout << "Writing a " << size << "x" << size << " grid to "
+         << filename << "\n";
+    if (!write_grid(filename, size)) {
+      nout << "Unable to write " << filename << "\n";
+      filename.unlink();
+      exit(1);
+    }
+    generated = true;
+  }
+
+  std::streamsize file_size = filename.get_file_size();
+  nout << "Reading " << filename << ", "
+       << file_size / (1024 * 1024) << " MB, " << num_passes
+       << " times.\n";
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  bool okflag = true;
+  double best = 0.0;
+  PT(IffChunk) header;
+  for (int pass = 0; pass < num_passes && okflag; ++pass) {
+    header = nullptr;
+    double start = clock->get_short_time();
+    header = read_file(filename);
+    double elapsed = clock->get_short_time() - start;
+    if (header == nullptr) {
+      nout << "Unable to read " << filename << "\n";
+      okflag = false;
+    } else if (pass == 0 || elapsed < best) {
+      best = elapsed;
+    }
+  }
+
+  if (okflag) {
+    int num_points = 0;
+    int num_polygons = 0;
+    LwoHeader *lwo_header = DCAST(LwoHeader, header.p());
+    for (int i = 0; i < lwo_header->get_num_chunks(); ++i) {
+      IffChunk *chunk = lwo_header->get_chunk(i);
+      if (chunk->is_of_type(LwoPoints::get_class_type())) {
+        num_points += DCAST(LwoPoints, chunk)->get_num_points();
+      } else if (chunk->is_of_type(LwoPolygons::get_class_type())) {
+        num_polygons += DCAST(LwoPolygons, chunk)->get_num_polygons();
+      }
+    }
+    nout << "  " << num_points << " points, " << num_polygons
+         << " polygons\n";
+
+    double mb = (double)file_size / (1024.0 * 1024.0);
+    nout << "  best of " << num_passes << ": " << best << " s, ";
+    if (best > 0.0) {
+      nout << mb / best << " MB/s\n";
+    } else {
+      nout << "too fast to measure\n";
+    }
+  }
+
+  if (generated) {
+    filename.unlink();
+  }
+
+  return okflag ? 0 : 1;
+}
@@ -16,10 +16,25 @@
   #define SOURCES \
     config_objegg.cxx config_objegg.h \
     objToEggConverter.cxx objToEggConverter.h objToEggConverter.I \
-    eggToObjConverter.cxx eggToObjConverter.h
+    eggToObjConverter.cxx eggToObjConverter.h eggToObjConverter.I
 
   #define INSTALL_HEADERS \
     objToEggConverter.h objToEggConverter.I \
-    eggToObjConverter.h
+    eggToObjConverter.h eggToObjConverter.I
 
 #end ss_lib_target
+
+#begin test_bin_target
+  #define TARGET test_objparse
+  #define LOCAL_LIBS p3objegg p3converter p3pandatoolbase
+  #define OTHER_LIBS \
+    p3egg:c pandaegg:m \
+    p3pipeline:c p3event:c p3pstatclient:c panda:m \
+    p3pandabase:c p3pnmimage:c p3mathutil:c p3linmath:c p3putil:c p3express:c \
+    p3interrogatedb p3prc  \
+    p3dtoolutil:c p3dtoolbase:c p3dtool:m
+
+  #define SOURCES \
+    test_objparse.cxx
+
+#end test_bin_target
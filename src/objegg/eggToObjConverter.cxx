@@ -22,6 +22,12 @@
 #include "eggPoint.h"
 #include "eggLine.h"
 #include "dcast.h"
+#include "workerPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+#include <string.h>
 
 using std::ostream;
 using std::string;
@@ -30,7 +36,14 @@ using std::string;
  *
  */
 EggToObjConverter::
-EggToObjConverter() {
+EggToObjConverter() :
+  _unique_vert3(3),
+  _unique_vert4(4),
+  _unique_uv2(2),
+  _unique_uv3(3),
+  _unique_norm(3),
+  _num_threads(1)
+{
 }
 
 /**
@@ -38,7 +51,13 @@ EggToObjConverter() {
  */
 EggToObjConverter::
 EggToObjConverter(const EggToObjConverter &copy) :
-  EggToSomethingConverter(copy)
+  EggToSomethingConverter(copy),
+  _unique_vert3(3),
+  _unique_vert4(4),
+  _unique_uv2(2),
+  _unique_uv3(3),
+  _unique_norm(3),
+  _num_threads(copy._num_threads)
 {
 }
 
@@ -116,12 +135,11 @@ process(const Filename &filename) {
   if (file == nullptr) {
     return false;
   }
+  int precision = (int)file->precision();
   if (egg_precision != 0) {
-    file->precision(egg_precision);
+    precision = egg_precision;
   }
 
-  _current_group = nullptr;
-
   /*
   (*file) << "\n#\n"
           << "# obj file generated by the following command:\n"
@@ -129,13 +147,15 @@ process(const Filename &filename) {
           << "#\n\n";
   */
 
-  write_vertices(*file, "v", 3, _unique_vert3);
-  write_vertices(*file, "v", 4, _unique_vert4);
-  write_vertices(*file, "vt", 2, _unique_uv2);
-  write_vertices(*file, "vt", 3, _unique_uv3);
-  write_vertices(*file, "vn", 3, _unique_norm);
+  OutputBuffer buf(precision);
+  write_vertices(buf, *file, "v", _unique_vert3);
+  write_vertices(buf, *file, "v", _unique_vert4);
+  write_vertices(buf, *file, "vt", _unique_uv2);
+  write_vertices(buf, *file, "vt", _unique_uv3);
+  write_vertices(buf, *file, "vn", _unique_norm);
+  buf.flush(*file);
 
-  write_faces(*file, _egg_data);
+  write_faces(*file, precision);
 
   bool success = (file != nullptr);
   vfs->close_write_file(file);
@@ -146,7 +166,8 @@ process(const Filename &filename) {
 /**
  * Recursively walks the egg structure, looking for vertices referenced by
  * polygons or points.  Any such vertices are added to the vertex tables for
- * writing to the obj file.
+ * writing to the obj file, and the polygons, points and lines are listed in
+ * _faces, in the order they will be written.
  */
 void EggToObjConverter::
 collect_vertices(EggNode *egg_node) {
@@ -157,6 +178,12 @@ collect_vertices(EggNode *egg_node) {
       record_vertex(*pi);
     }
 
+    if (egg_node->is_of_type(EggPolygon::get_class_type()) ||
+        egg_node->is_of_type(EggPoint::get_class_type()) ||
+        egg_node->is_of_type(EggLine::get_class_type())) {
+      _faces.push_back(egg_prim);
+    }
+
   } else if (egg_node->is_of_type(EggGroupNode::get_class_type())) {
     EggGroupNode *egg_group = DCAST(EggGroupNode, egg_node);
 
@@ -168,85 +195,144 @@ collect_vertices(EggNode *egg_node) {
 }
 
 /**
- * Recursively walks the egg structure again, this time writing out the face
- * records for any polygons, points, or lines encountered.
+ * Writes out the face records for all of the polygons, points, and lines
+ * collected by collect_vertices().  If more than one thread has been
+ * requested, the records are formatted in parallel, a block of faces at a
+ * time, and then written in their original order.
  */
 void EggToObjConverter::
-write_faces(ostream &out, EggNode *egg_node) {
-  if (egg_node->is_of_type(EggPrimitive::get_class_type())) {
-    const char *prim_type = nullptr;
-    if (egg_node->is_of_type(EggPolygon::get_class_type())) {
-      prim_type = "f";
-    } else if (egg_node->is_of_type(EggPoint::get_class_type())) {
-      prim_type = "p";
-    } else if (egg_node->is_of_type(EggLine::get_class_type())) {
-      prim_type = "l";
+write_faces(ostream &out, int precision) {
+  size_t num_faces = _faces.size();
+
+  if (_num_threads <= 1) {
+    OutputBuffer buf(precision);
+    for (size_t fi = 0; fi < num_faces; ++fi) {
+      write_face(buf, fi);
+      if (buf.is_full()) {
+        buf.flush(out);
+      }
     }
+    buf.flush(out);
+    return;
+  }
 
-    if (prim_type != nullptr) {
-      write_group_reference(out, egg_node);
-
-      EggPrimitive *egg_prim = DCAST(EggPrimitive, egg_node);
-
-      out << prim_type;
-      EggPrimitive::iterator pi;
-      for (pi = egg_prim->begin(); pi != egg_prim->end(); ++pi) {
-        VertexDef &vdef = _vmap[(*pi)];
-        int vert_index = -1;
-        int uv_index = -1;
-        int norm_index = -1;
-
-        if (vdef._vert3_index != -1) {
-          vert_index = vdef._vert3_index + 1;
-        } else if (vdef._vert4_index != -1) {
-          vert_index = vdef._vert4_index + 1 + (int)_unique_vert3.size();
-        }
-
-        if (vdef._uv2_index != -1) {
-          uv_index = vdef._uv2_index + 1;
-        } else if (vdef._uv3_index != -1) {
-          uv_index = vdef._uv3_index + 1 + (int)_unique_uv2.size();
-        }
-
-        if (vdef._norm_index != -1) {
-          norm_index = vdef._norm_index + 1;
-        }
-
-        if (vert_index == -1) {
-          continue;
-        }
-
-        if (norm_index != -1) {
-          if (uv_index != -1) {
-            out << " " << vert_index << "/" << uv_index << "/" << norm_index;
-          } else {
-            out << " " << vert_index << "//" << norm_index;
-          }
-        } else if (uv_index != -1) {
-          out << " " << vert_index << "/" << uv_index;
-        } else {
-          out << " " << vert_index;
-        }
-      }
-      out << "\n";
+  // Each job formats this many faces into its own buffer.  A batch of jobs
+  // is run at a time, so that only a batch's worth of text need be held in
+  // memory.
+  static const size_t faces_per_job = 16384;
+
+  WorkerPool pool(_num_threads);
+  OutputBuffers buffers(pool.get_num_threads() * 2, OutputBuffer(precision));
+
+  FaceJobs jobs;
+  jobs._converter = this;
+  jobs._faces_per_job = faces_per_job;
+  jobs._buffers = &buffers;
+
+  size_t batch_size = faces_per_job * buffers.size();
+  for (size_t first = 0; first < num_faces; first += batch_size) {
+    jobs._first_face = first;
+    jobs._end_face = std::min(first + batch_size, num_faces);
+    int num_jobs =
+      (int)((jobs._end_face - first + faces_per_job - 1) / faces_per_job);
+    pool.run(num_jobs, &write_faces_job, &jobs);
+
+    for (int i = 0; i < num_jobs; ++i) {
+      buffers[i].flush(out);
     }
-  } else if (egg_node->is_of_type(EggGroupNode::get_class_type())) {
-    EggGroupNode *egg_group = DCAST(EggGroupNode, egg_node);
+  }
+}
 
-    EggGroupNode::iterator ci;
-    for (ci = egg_group->begin(); ci != egg_group->end(); ++ci) {
-      write_faces(out, *ci);
+/**
+ * Formats one block of faces into its buffer.  This is called by the
+ * WorkerPool in write_faces().
+ */
+void EggToObjConverter::
+write_faces_job(int job_index, void *user_data) {
+  FaceJobs *jobs = (FaceJobs *)user_data;
+  OutputBuffer &buf = (*jobs->_buffers)[job_index];
+
+  size_t begin = jobs->_first_face + (size_t)job_index * jobs->_faces_per_job;
+  size_t end = std::min(begin + jobs->_faces_per_job, jobs->_end_face);
+  for (size_t fi = begin; fi < end; ++fi) {
+    jobs->_converter->write_face(buf, fi);
+  }
+}
+
+/**
+ * Formats the face record for the nth polygon, point, or line, preceded by
+ * its group reference if needed.
+ */
+void EggToObjConverter::
+write_face(OutputBuffer &buf, size_t fi) const {
+  EggPrimitive *egg_prim = _faces[fi];
+
+  char prim_type = 'l';
+  if (egg_prim->is_of_type(EggPolygon::get_class_type())) {
+    prim_type = 'f';
+  } else if (egg_prim->is_of_type(EggPoint::get_class_type())) {
+    prim_type = 'p';
+  }
+
+  write_group_reference(buf, fi);
+
+  buf.add_char(prim_type);
+  EggPrimitive::iterator pi;
+  for (pi = egg_prim->begin(); pi != egg_prim->end(); ++pi) {
+    VertexMap::const_iterator vi = _vmap.find(*pi);
+    if (vi == _vmap.end()) {
+      continue;
+    }
+    const VertexDef &vdef = (*vi).second;
+    int vert_index = -1;
+    int uv_index = -1;
+    int norm_index = -1;
+
+    if (vdef._vert3_index != -1) {
+      vert_index = vdef._vert3_index + 1;
+    } else if (vdef._vert4_index != -1) {
+      vert_index = vdef._vert4_index + 1 + _unique_vert3.size();
+    }
+
+    if (vdef._uv2_index != -1) {
+      uv_index = vdef._uv2_index + 1;
+    } else if (vdef._uv3_index != -1) {
+      uv_index = vdef._uv3_index + 1 + _unique_uv2.size();
+    }
+
+    if (vdef._norm_index != -1) {
+      norm_index = vdef._norm_index + 1;
+    }
+
+    if (vert_index == -1) {
+      continue;
+    }
+
+    buf.add_char(' ');
+    buf.add_int(vert_index);
+    if (norm_index != -1) {
+      buf.add_char('/');
+      if (uv_index != -1) {
+        buf.add_int(uv_index);
+      }
+      buf.add_char('/');
+      buf.add_int(norm_index);
+    } else if (uv_index != -1) {
+      buf.add_char('/');
+      buf.add_int(uv_index);
     }
   }
+  buf.add_char('\n');
 }
 
 /**
- * Writes the "g" tag to describe this polygon's group, if needed.
+ * Writes the "g" tag to describe the nth face's group, if it is not the same
+ * group as the face before it.
  */
 void EggToObjConverter::
-write_group_reference(ostream &out, EggNode *egg_node) {
-  EggGroupNode *egg_group = egg_node->get_parent();
-  if (egg_group == _current_group) {
+write_group_reference(OutputBuffer &buf, size_t fi) const {
+  EggGroupNode *egg_group = _faces[fi]->get_parent();
+  if (fi != 0 && _faces[fi - 1]->get_parent() == egg_group) {
     // Same group we wrote last time.
     return;
   }
@@ -254,11 +340,13 @@ write_group_reference(ostream &out, EggNode *egg_node) {
   string group_name;
   get_group_name(group_name, egg_group);
   if (group_name.empty()) {
-    out << "g default\n";
+    static const char default_group[] = "g default\n";
+    buf.add_string(default_group, sizeof(default_group) - 1);
   } else {
-    out << "g" << group_name << "\n";
+    buf.add_char('g');
+    buf.add_string(group_name.data(), group_name.length());
+    buf.add_char('\n');
   }
-  _current_group = egg_group;
 }
 
 /**
@@ -266,7 +354,7 @@ write_group_reference(ostream &out, EggNode *egg_node) {
  * describe a particular EggGroupNode.
  */
 void EggToObjConverter::
-get_group_name(string &group_name, EggGroupNode *egg_group) {
+get_group_name(string &group_name, EggGroupNode *egg_group) const {
   string name = trim(egg_group->get_name());
   if (!name.empty()) {
     group_name += ' ';
@@ -296,105 +384,219 @@ void EggToObjConverter::
 record_vertex(EggVertex *vertex) {
   VertexDef &vdef = _vmap[vertex];
 
+  // Positions of fewer than three dimensions are padded out with zeroes, and
+  // share the same table as the three-dimensional positions.
   switch (vertex->get_num_dimensions()) {
   case 1:
-    vdef._vert3_index = record_unique(_unique_vert3, vertex->get_pos1());
+    {
+      LVecBase3d pos(vertex->get_pos1(), 0.0, 0.0);
+      vdef._vert3_index = _unique_vert3.record(pos.get_data());
+    }
     break;
   case 2:
-    vdef._vert3_index = record_unique(_unique_vert3, vertex->get_pos2());
+    {
+      LVecBase3d pos(vertex->get_pos2(), 0.0);
+      vdef._vert3_index = _unique_vert3.record(pos.get_data());
+    }
     break;
   case 3:
-    vdef._vert3_index = record_unique(_unique_vert3, vertex->get_pos3());
+    vdef._vert3_index = _unique_vert3.record(vertex->get_pos3().get_data());
     break;
   case 4:
-    vdef._vert4_index = record_unique(_unique_vert4, vertex->get_pos4());
+    vdef._vert4_index = _unique_vert4.record(vertex->get_pos4().get_data());
     break;
   }
 
   if (vertex->has_uv("")) {
-    vdef._uv2_index = record_unique(_unique_uv2, vertex->get_uv(""));
+    vdef._uv2_index = _unique_uv2.record(vertex->get_uv("").get_data());
   } else if (vertex->has_uvw("")) {
-    vdef._uv3_index = record_unique(_unique_uv3, vertex->get_uvw(""));
+    vdef._uv3_index = _unique_uv3.record(vertex->get_uvw("").get_data());
   }
 
   if (vertex->has_normal()) {
-    vdef._norm_index = record_unique(_unique_norm, vertex->get_normal());
+    vdef._norm_index = _unique_norm.record(vertex->get_normal().get_data());
   }
 }
 
 /**
- * Records the indicated vertex value, returning the shared index if this
- * value already appears elsewhere in the table, or the new unique index if
- * this is the first time this value appears.
+ * Actually writes the vertex values recorded in the indicated table to the
+ * obj output stream, in the order of their indices.
  */
-int EggToObjConverter::
-record_unique(UniqueVertices &unique, const LVecBase4d &vec) {
+void EggToObjConverter::
+write_vertices(OutputBuffer &buf, ostream &out, const char *prefix,
+               const UniqueVertices &unique) {
+  size_t prefix_length = strlen(prefix);
+  int num_components = unique._num_components;
+  int num_vertices = unique.size();
+
+  for (int i = 0; i < num_vertices; ++i) {
+    buf.add_string(prefix, prefix_length);
+    const double *values = unique.get_values(i);
+    for (int ci = 0; ci < num_components; ++ci) {
+      buf.add_char(' ');
+      buf.add_double(values[ci]);
+    }
+    buf.add_char('\n');
+    if (buf.is_full()) {
+      buf.flush(out);
+    }
+  }
+}
+
+/**
+ *
+ */
+EggToObjConverter::UniqueVertices::
+UniqueVertices(int num_components) :
+  _num_components(num_components),
+  _slots(64, -1),
+  _size(0)
+{
+  nassertv(num_components >= 1 && num_components <= 4);
+}
+
+/**
+ * Records the indicated value, which has _num_components components,
+ * returning the shared index if this value already appears elsewhere in the
+ * table, or the new unique index if this is the first time this value
+ * appears.
+ */
+int EggToObjConverter::UniqueVertices::
+record(const double *values) {
+  // Negative zero is folded into positive zero, so that the two are not
+  // written as separate vertices.
+  double key[4];
+  for (int i = 0; i < _num_components; ++i) {
+    key[i] = (values[i] == 0.0) ? 0.0 : values[i];
+  }
+
+  if ((_slots.size() >> 1) <= (size_t)_size) {
+    grow();
+  }
+
+  size_t mask = _slots.size() - 1;
+  size_t si = hash_values(key, _num_components) & mask;
+  while (_slots[si] != -1) {
+    if (memcmp(get_values(_slots[si]), key,
+               _num_components * sizeof(double)) == 0) {
+      return _slots[si];
+    }
+    si = (si + 1) & mask;
+  }
+
   // We record a zero-based index.  Note that we will actually write out a
   // one-based index to the obj file, as required by the standard.
-  int index = unique.size();
-  UniqueVertices::iterator ui = unique.insert(UniqueVertices::value_type(vec, index)).first;
-  return (*ui).second;
+  int index = _size;
+  ++_size;
+  _slots[si] = index;
+  _values.insert(_values.end(), key, key + _num_components);
+  return index;
 }
 
 /**
- * Records the indicated vertex value, returning the shared index if this
- * value already appears elsewhere in the table, or the new unique index if
- * this is the first time this value appears.
+ * Doubles the size of the hash table, and re-files all of the values.
  */
-int EggToObjConverter::
-record_unique(UniqueVertices &unique, const LVecBase3d &vec) {
-  return record_unique(unique, LVecBase4d(vec[0], vec[1], vec[2], 0.0));
+void EggToObjConverter::UniqueVertices::
+grow() {
+  vector_int slots(_slots.size() * 2, -1);
+  size_t mask = slots.size() - 1;
+  for (int index = 0; index < _size; ++index) {
+    size_t si = hash_values(get_values(index), _num_components) & mask;
+    while (slots[si] != -1) {
+      si = (si + 1) & mask;
+    }
+    slots[si] = index;
+  }
+  _slots.swap(slots);
 }
 
 /**
- * Records the indicated vertex value, returning the shared index if this
- * value already appears elsewhere in the table, or the new unique index if
- * this is the first time this value appears.
+ * Returns a hash of the exact bits of the indicated components.
  */
-int EggToObjConverter::
-record_unique(UniqueVertices &unique, const LVecBase2d &vec) {
-  return record_unique(unique, LVecBase4d(vec[0], vec[1], 0.0, 0.0));
+size_t EggToObjConverter::UniqueVertices::
+hash_values(const double *values, int num_components) {
+  uint64_t hash = 0;
+  for (int i = 0; i < num_components; ++i) {
+    uint64_t bits;
+    memcpy(&bits, &values[i], sizeof(bits));
+    hash = (hash ^ bits) * 0x9e3779b97f4a7c15ULL;
+    hash ^= (hash >> 32);
+  }
+  hash ^= (hash >> 29);
+  hash *= 0xbf58476d1ce4e5b9ULL;
+  hash ^= (hash >> 32);
+  return (size_t)hash;
 }
 
 /**
- * Records the indicated vertex value, returning the shared index if this
- * value already appears elsewhere in the table, or the new unique index if
- * this is the first time this value appears.
+ *
  */
-int EggToObjConverter::
-record_unique(UniqueVertices &unique, double pos) {
-  return record_unique(unique, LVecBase4d(pos, 0.0, 0.0, 0.0));
+EggToObjConverter::OutputBuffer::
+OutputBuffer(int precision) :
+  _precision(precision)
+{
+  // An integer with no more digits than the precision is written by %g
+  // exactly as it would be in plain decimal notation.
+  _int_limit = 1.0;
+  for (int i = 0; i < precision && i < 9; ++i) {
+    _int_limit *= 10.0;
+  }
 }
 
 /**
- * Actually writes the vertex values recorded in the indicated table to the
- * obj output stream.
+ * Appends the decimal representation of the indicated integer.
  */
-void EggToObjConverter::
-write_vertices(ostream &out, const string &prefix, int num_components,
-               const UniqueVertices &unique) {
-  // First, sort the list into numeric order.
-  int num_vertices = (int)unique.size();
-  const LVecBase4d **vertices = (const LVecBase4d **)PANDA_MALLOC_ARRAY(num_vertices * sizeof(LVecBase4d *));
-  memset(vertices, 0, num_vertices * sizeof(LVecBase4d *));
-  UniqueVertices::const_iterator ui;
-  for (ui = unique.begin(); ui != unique.end(); ++ui) {
-    int index = (*ui).second;
-    const LVecBase4d &vec = (*ui).first;
-    nassertv(index >= 0 && index < num_vertices);
-    nassertv(vertices[index] == nullptr);
-    vertices[index] = &vec;
+void EggToObjConverter::OutputBuffer::
+add_int(int value) {
+  char text[16];
+  char *end = text + sizeof(text);
+  char *p = end;
+  unsigned int u = (unsigned int)value;
+  if (value < 0) {
+    u = 0u - u;
   }
+  do {
+    *(--p) = (char)('0' + (u % 10));
+    u /= 10;
+  } while (u != 0);
+  if (value < 0) {
+    *(--p) = '-';
+  }
+  add_string(p, end - p);
+}
 
-  for (int i = 0; i < num_vertices; ++i) {
-    out << prefix;
-    const LVecBase4d &vec = *(vertices[i]);
-    for (int ci = 0; ci < num_components; ++ci) {
-      out << " " << vec[ci];
-    }
-    out << "\n";
+/**
+ * Appends the indicated floating-point value, formatted exactly as an
+ * ostream with the buffer's precision would format it.
+ */
+void EggToObjConverter::OutputBuffer::
+add_double(double value) {
+  if (value > -_int_limit && value < _int_limit &&
+      value == std::floor(value) && !(value == 0.0 && std::signbit(value))) {
+    // Whole numbers, which are common in models, don't need the general
+    // formatting.
+    add_int((int)value);
+    return;
+  }
+
+  char text[64];
+  int length = snprintf(text, sizeof(text), "%.*g", _precision, value);
+  if (length < 0) {
+    return;
+  }
+  add_string(text, std::min((size_t)length, sizeof(text) - 1));
+}
+
+/**
+ * Writes all of the accumulated text to the indicated stream, and empties the
+ * buffer.
+ */
+void EggToObjConverter::OutputBuffer::
+flush(ostream &out) {
+  if (!_data.empty()) {
+    out.write(&_data[0], _data.size());
+    _data.clear();
   }
-  PANDA_FREE_ARRAY(vertices);
 }
 
 /**
@@ -19,6 +19,9 @@
 #include "eggToSomethingConverter.h"
 #include "eggVertexPool.h"
 #include "eggGroup.h"
+#include "eggPrimitive.h"
+#include "vector_int.h"
+#include "pvector.h"
 
 /**
  * Convert an obj file to egg data.
@@ -37,8 +40,49 @@ public:
 
   virtual bool write_file(const Filename &filename);
 
+  INLINE void set_num_threads(int num_threads);
+  INLINE int get_num_threads() const;
+
 private:
-  typedef pmap<LVecBase4d, int> UniqueVertices;
+  // This is a table of the distinct values of one vertex attribute, each of
+  // which has the same number of components.  Values are compared by their
+  // exact bits, and are numbered in the order they were first recorded.
+  class UniqueVertices {
+  public:
+    UniqueVertices(int num_components);
+
+    INLINE int size() const;
+    INLINE const double *get_values(int index) const;
+    int record(const double *values);
+
+    void grow();
+    static size_t hash_values(const double *values, int num_components);
+
+    int _num_components;
+    pvector<double> _values;
+    vector_int _slots;
+    int _size;
+  };
+
+  // This accumulates formatted text to be written to the obj file in large
+  // blocks.
+  class OutputBuffer {
+  public:
+    OutputBuffer(int precision);
+
+    INLINE bool is_full() const;
+    INLINE void add_char(char ch);
+    INLINE void add_string(const char *str, size_t length);
+    void add_int(int value);
+    void add_double(double value);
+    void flush(std::ostream &out);
+
+    pvector<char> _data;
+    int _precision;
+    double _int_limit;
+  };
+  typedef pvector<OutputBuffer> OutputBuffers;
+
   class VertexDef {
   public:
     VertexDef();
@@ -49,27 +93,39 @@ private:
     int _norm_index;
   };
   typedef pmap<EggVertex *, VertexDef> VertexMap;
+  typedef pvector<EggPrimitive *> Faces;
+
+  // The data shared by the threads formatting the face records.
+  class FaceJobs {
+  public:
+    const EggToObjConverter *_converter;
+    size_t _first_face;
+    size_t _end_face;
+    size_t _faces_per_job;
+    OutputBuffers *_buffers;
+  };
 
   bool process(const Filename &filename);
 
   void collect_vertices(EggNode *egg_node);
-  void write_faces(std::ostream &out, EggNode *egg_node);
-  void write_group_reference(std::ostream &out, EggNode *egg_node);
-  void get_group_name(std::string &group_name, EggGroupNode *egg_group);
+  void write_faces(std::ostream &out, int precision);
+  static void write_faces_job(int job_index, void *user_data);
+  void write_face(OutputBuffer &buf, size_t fi) const;
+  void write_group_reference(OutputBuffer &buf, size_t fi) const;
+  void get_group_name(std::string &group_name, EggGroupNode *egg_group) const;
 
   void record_vertex(EggVertex *vertex);
-  int record_unique(UniqueVertices &unique, const LVecBase4d &vec);
-  int record_unique(UniqueVertices &unique, const LVecBase3d &vec);
-  int record_unique(UniqueVertices &unique, const LVecBase2d &vec);
-  int record_unique(UniqueVertices &unique, double pos);
 
-  void write_vertices(std::ostream &out, const std::string &prefix, int num_components,
-                      const UniqueVertices &unique);
+  void write_vertices(OutputBuffer &buf, std::ostream &out,
+                      const char *prefix, const UniqueVertices &unique);
 
 private:
   UniqueVertices _unique_vert3, _unique_vert4, _unique_uv2, _unique_uv3, _unique_norm;
   VertexMap _vmap;
-  EggGroupNode *_current_group;
+  Faces _faces;
+  int _num_threads;
 };
 
+#include "eggToObjConverter.I"
+
 #endif
@@ -15,7 +15,7 @@
 #include "config_objegg.h"
 #include "eggData.h"
 #include "string_utils.h"
-#include "streamReader.h"
+#include "pstrtod.h"
 #include "virtualFileSystem.h"
 #include "eggPolygon.h"
 #include "nodePath.h"
@@ -27,8 +27,121 @@
 #include "triangulator3.h"
 #include "config_egg2pg.h"
 
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
 using std::string;
 
+// The obj file is read in blocks of this size.  Lines are parsed in place
+// within the block.
+static const size_t obj_read_block_size = 4 * 1024 * 1024;
+
+// These powers of ten are all exactly representable as a double.
+static const double exact_powers_of_ten[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/**
+ * Parses the indicated NUL-terminated string as a floating-point number, in
+ * the manner of string_to_double().  Numbers of up to 15 significant digits
+ * with a modest exponent, which is to say practically every number in an obj
+ * file, are converted directly without rounding error; anything else is
+ * passed to pstrtod().
+ */
+static bool
+parse_double(const char *str, double &result) {
+  const char *p = str;
+  bool negative = false;
+  if (*p == '-') {
+    negative = true;
+    ++p;
+  } else if (*p == '+') {
+    ++p;
+  }
+
+  uint64_t mantissa = 0;
+  int num_digits = 0;
+  int exponent = 0;
+  bool any_digits = false;
+  while (*p >= '0' && *p <= '9') {
+    mantissa = mantissa * 10 + (*p - '0');
+    if (mantissa != 0) {
+      ++num_digits;
+    }
+    any_digits = true;
+    ++p;
+  }
+  if (*p == '.') {
+    ++p;
+    while (*p >= '0' && *p <= '9') {
+      mantissa = mantissa * 10 + (*p - '0');
+      if (mantissa != 0) {
+        ++num_digits;
+      }
+      --exponent;
+      any_digits = true;
+      ++p;
+    }
+  }
+  if (any_digits && (*p == 'e' || *p == 'E')) {
+    ++p;
+    bool exp_negative = false;
+    if (*p == '-') {
+      exp_negative = true;
+      ++p;
+    } else if (*p == '+') {
+      ++p;
+    }
+    int exp_value = 0;
+    bool any_exp_digits = false;
+    while (*p >= '0' && *p <= '9' && exp_value < 10000) {
+      exp_value = exp_value * 10 + (*p - '0');
+      any_exp_digits = true;
+      ++p;
+    }
+    if (!any_exp_digits) {
+      any_digits = false;
+    }
+    exponent += exp_negative ? -exp_value : exp_value;
+  }
+
+  if (!any_digits || *p != '\0' || num_digits > 15 ||
+      exponent < -22 || exponent > 22) {
+    // Let pstrtod() sort it out.
+    char *endptr;
+    result = pstrtod(str, &endptr);
+    return (*endptr == '\0');
+  }
+
+  double value = (double)mantissa;
+  if (exponent < 0) {
+    value /= exact_powers_of_ten[-exponent];
+  } else {
+    value *= exact_powers_of_ten[exponent];
+  }
+  result = negative ? -value : value;
+  return true;
+}
+
+/**
+ * Parses the characters from begin to end as an integer, in the manner of
+ * string_to_int().  Returns 0 if the string is empty or is not an integer.
+ */
+static int
+parse_index(const char *begin, const char *end) {
+  if (begin == end) {
+    return 0;
+  }
+  char *endptr;
+  long value = strtol(begin, &endptr, 10);
+  if (endptr != end) {
+    return 0;
+  }
+  return (int)value;
+}
+
 /**
  *
  */
@@ -172,42 +285,29 @@ process(const Filename &filename) {
   _egg_data->add_child(_root_group);
   _current_group = _root_group;
 
-  StreamReader sr(strm, true);
-  string line = sr.readline();
-  _line_number = 1;
-  while (!line.empty()) {
-    line = trim(line);
-    if (line.empty()) {
-      line = sr.readline();
+  Words words;
+  LineReader reader(strm);
+  char *line;
+  while ((line = reader.next_line()) != nullptr) {
+    _line_number = reader.get_line_number();
+    if (line[0] == '\0') {
       continue;
     }
 
-    while (line[line.length() - 1] == '\\') {
-      // If it ends on a backslash, it's a continuation character.
-      string line2 = sr.readline();
-      ++_line_number;
-      if (line2.empty()) {
-        break;
-      }
-      line = line.substr(0, line.length() - 1) + trim(line2);
-    }
-
-    if (line.substr(0, 15) == "#_ref_plane_res") {
-      process_ref_plane_res(line);
-      line = sr.readline();
+    if (strncmp(line, "#_ref_plane_res", 15) == 0) {
+      tokenize_line(line, words);
+      process_ref_plane_res(words);
       continue;
     }
 
     if (line[0] == '#') {
-      line = sr.readline();
       continue;
     }
 
-    if (!process_line(line)) {
+    tokenize_line(line, words);
+    if (!process_line(words)) {
       return false;
     }
-    line = sr.readline();
-    ++_line_number;
   }
 
   if (!_f_given) {
@@ -221,28 +321,26 @@ process(const Filename &filename) {
  *
  */
 bool ObjToEggConverter::
-process_line(const string &line) {
-  vector_string words;
-  tokenize(line, words, " \t", true);
+process_line(Words &words) {
   nassertr(!words.empty(), false);
 
-  string tag = words[0];
-  if (tag == "v") {
+  const char *tag = words[0];
+  if (strcmp(tag, "v") == 0) {
     return process_v(words);
-  } else if (tag == "vt") {
+  } else if (strcmp(tag, "f") == 0) {
+    return process_f(words);
+  } else if (strcmp(tag, "vt") == 0) {
     return process_vt(words);
-  } else if (tag == "xvt") {
+  } else if (strcmp(tag, "vn") == 0) {
+    return process_vn(words);
+  } else if (strcmp(tag, "xvt") == 0) {
     return process_xvt(words);
-  } else if (tag == "xvc") {
+  } else if (strcmp(tag, "xvc") == 0) {
     return process_xvc(words);
-  } else if (tag == "vn") {
-    return process_vn(words);
-  } else if (tag == "f") {
-    return process_f(words);
-  } else if (tag == "g") {
+  } else if (strcmp(tag, "g") == 0) {
     return process_g(words);
   } else {
-    bool inserted = _ignored_tags.insert(tag).second;
+    bool inserted = _ignored_tags.insert(string(tag)).second;
     if (inserted) {
       objegg_cat.info()
         << "Ignoring tag " << tag << "\n";
@@ -256,13 +354,11 @@ process_line(const string &line) {
  *
  */
 bool ObjToEggConverter::
-process_ref_plane_res(const string &line) {
+process_ref_plane_res(Words &words) {
   // the #_ref_plane_res line is a DRZ extension that defines the pixel
   // resolution of the projector device.  It's needed to properly scale the
   // xvt lines.
 
-  vector_string words;
-  tokenize(line, words, " \t", true);
   nassertr(!words.empty(), false);
 
   if (words.size() != 3) {
@@ -272,8 +368,8 @@ process_ref_plane_res(const string &line) {
   }
 
   bool okflag = true;
-  okflag &= string_to_double(words[1], _ref_plane_res[0]);
-  okflag &= string_to_double(words[2], _ref_plane_res[1]);
+  okflag &= parse_double(words[1], _ref_plane_res[0]);
+  okflag &= parse_double(words[2], _ref_plane_res[1]);
 
   if (!okflag) {
     objegg_cat.error()
@@ -288,7 +384,7 @@ process_ref_plane_res(const string &line) {
  *
  */
 bool ObjToEggConverter::
-process_v(vector_string &words) {
+process_v(Words &words) {
   if (words.size() != 4 && words.size() != 5 &&
       words.size() != 7 && words.size() != 8) {
     objegg_cat.error()
@@ -298,11 +394,11 @@ process_v(vector_string &words) {
 
   bool okflag = true;
   LPoint4d pos;
-  okflag &= string_to_double(words[1], pos[0]);
-  okflag &= string_to_double(words[2], pos[1]);
-  okflag &= string_to_double(words[3], pos[2]);
+  okflag &= parse_double(words[1], pos[0]);
+  okflag &= parse_double(words[2], pos[1]);
+  okflag &= parse_double(words[3], pos[2]);
   if (words.size() == 5 || words.size() == 8) {
-    okflag &= string_to_double(words[4], pos[3]);
+    okflag &= parse_double(words[4], pos[3]);
     _v4_given = true;
   } else {
     pos[3] = 1.0;
@@ -320,9 +416,9 @@ process_v(vector_string &words) {
   if (words.size() == 7 && words.size() == 8) {
     size_t si = words.size();
     LVecBase3d rgb;
-    okflag &= string_to_double(words[si - 3], rgb[0]);
-    okflag &= string_to_double(words[si - 2], rgb[1]);
-    okflag &= string_to_double(words[si - 1], rgb[2]);
+    okflag &= parse_double(words[si - 3], rgb[0]);
+    okflag &= parse_double(words[si - 2], rgb[1]);
+    okflag &= parse_double(words[si - 1], rgb[2]);
 
     if (!okflag) {
       objegg_cat.error()
@@ -342,7 +438,7 @@ process_v(vector_string &words) {
  *
  */
 bool ObjToEggConverter::
-process_vt(vector_string &words) {
+process_vt(Words &words) {
   if (words.size() != 3 && words.size() != 4) {
     objegg_cat.error()
       << "Wrong number of tokens at line " << _line_number << "\n";
@@ -351,10 +447,10 @@ process_vt(vector_string &words) {
 
   bool okflag = true;
   LTexCoord3d uvw;
-  okflag &= string_to_double(words[1], uvw[0]);
-  okflag &= string_to_double(words[2], uvw[1]);
+  okflag &= parse_double(words[1], uvw[0]);
+  okflag &= parse_double(words[2], uvw[1]);
   if (words.size() == 4) {
-    okflag &= string_to_double(words[3], uvw[2]);
+    okflag &= parse_double(words[3], uvw[2]);
     _vt3_given = true;
   } else {
     uvw[2] = 0.0;
@@ -377,7 +473,7 @@ process_vt(vector_string &words) {
  * camera.  We map it to the nominal texture coordinates here.
  */
 bool ObjToEggConverter::
-process_xvt(vector_string &words) {
+process_xvt(Words &words) {
   if (words.size() < 3) {
     objegg_cat.error()
       << "Wrong number of tokens at line " << _line_number << "\n";
@@ -386,8 +482,8 @@ process_xvt(vector_string &words) {
 
   bool okflag = true;
   LTexCoordd uv;
-  okflag &= string_to_double(words[1], uv[0]);
-  okflag &= string_to_double(words[2], uv[1]);
+  okflag &= parse_double(words[1], uv[0]);
+  okflag &= parse_double(words[2], uv[1]);
 
   if (!okflag) {
     objegg_cat.error()
@@ -407,7 +503,7 @@ process_xvt(vector_string &words) {
  * "xvc" is another extended column invented by DRZ.  We quietly ignore it.
  */
 bool ObjToEggConverter::
-process_xvc(vector_string &words) {
+process_xvc(Words &words) {
   return true;
 }
 
@@ -415,7 +511,7 @@ process_xvc(vector_string &words) {
  *
  */
 bool ObjToEggConverter::
-process_vn(vector_string &words) {
+process_vn(Words &words) {
   if (words.size() != 4) {
     objegg_cat.error()
       << "Wrong number of tokens at line " << _line_number << "\n";
@@ -424,9 +520,9 @@ process_vn(vector_string &words) {
 
   bool okflag = true;
   LVector3d normal;
-  okflag &= string_to_double(words[1], normal[0]);
-  okflag &= string_to_double(words[2], normal[1]);
-  okflag &= string_to_double(words[3], normal[2]);
+  okflag &= parse_double(words[1], normal[0]);
+  okflag &= parse_double(words[2], normal[1]);
+  okflag &= parse_double(words[3], normal[2]);
 
   if (!okflag) {
     objegg_cat.error()
@@ -444,7 +540,7 @@ process_vn(vector_string &words) {
  * Defines a face in the obj file.
  */
 bool ObjToEggConverter::
-process_f(vector_string &words) {
+process_f(Words &words) {
   _f_given = true;
 
   PT(EggPolygon) poly = new EggPolygon;
@@ -464,7 +560,7 @@ process_f(vector_string &words) {
  * Defines a group in the obj file.
  */
 bool ObjToEggConverter::
-process_g(vector_string &words) {
+process_g(Words &words) {
   EggGroup *group = _root_group;
 
   // We assume the group names define a hierarchy of more-specific to less-
@@ -492,7 +588,7 @@ process_g(vector_string &words) {
  * reference.
  */
 EggVertex *ObjToEggConverter::
-get_face_vertex(const string &reference) {
+get_face_vertex(const char *reference) {
   VertexEntry entry(this, reference);
 
   // Synthesize a vertex.
@@ -571,32 +667,29 @@ process_node(const Filename &filename) {
   _vt3_given = false;
   _f_given = false;
 
-  StreamReader sr(strm, true);
-  string line = sr.readline();
-  _line_number = 1;
-  while (!line.empty()) {
-    line = trim(line);
-    if (line.empty()) {
-      line = sr.readline();
+  Words words;
+  LineReader reader(strm);
+  char *line;
+  while ((line = reader.next_line()) != nullptr) {
+    _line_number = reader.get_line_number();
+    if (line[0] == '\0') {
       continue;
     }
 
-    if (line.substr(0, 15) == "#_ref_plane_res") {
-      process_ref_plane_res(line);
-      line = sr.readline();
+    if (strncmp(line, "#_ref_plane_res", 15) == 0) {
+      tokenize_line(line, words);
+      process_ref_plane_res(words);
       continue;
     }
 
     if (line[0] == '#') {
-      line = sr.readline();
       continue;
     }
 
-    if (!process_line_node(line)) {
+    tokenize_line(line, words);
+    if (!process_line_node(words)) {
       return false;
     }
-    line = sr.readline();
-    ++_line_number;
   }
 
   if (!_f_given) {
@@ -610,28 +703,26 @@ process_node(const Filename &filename) {
  *
  */
 bool ObjToEggConverter::
-process_line_node(const string &line) {
-  vector_string words;
-  tokenize(line, words, " \t", true);
+process_line_node(Words &words) {
   nassertr(!words.empty(), false);
 
-  string tag = words[0];
-  if (tag == "v") {
+  const char *tag = words[0];
+  if (strcmp(tag, "v") == 0) {
     return process_v(words);
-  } else if (tag == "vt") {
+  } else if (strcmp(tag, "f") == 0) {
+    return process_f_node(words);
+  } else if (strcmp(tag, "vt") == 0) {
     return process_vt(words);
-  } else if (tag == "xvt") {
+  } else if (strcmp(tag, "vn") == 0) {
+    return process_vn(words);
+  } else if (strcmp(tag, "xvt") == 0) {
     return process_xvt(words);
-  } else if (tag == "xvc") {
+  } else if (strcmp(tag, "xvc") == 0) {
     return process_xvc(words);
-  } else if (tag == "vn") {
-    return process_vn(words);
-  } else if (tag == "f") {
-    return process_f_node(words);
-  } else if (tag == "g") {
+  } else if (strcmp(tag, "g") == 0) {
     return process_g_node(words);
   } else {
-    bool inserted = _ignored_tags.insert(tag).second;
+    bool inserted = _ignored_tags.insert(string(tag)).second;
     if (inserted) {
       objegg_cat.info()
         << "Ignoring tag " << tag << "\n";
@@ -645,14 +736,16 @@ process_line_node(const string &line) {
  * Defines a face in the obj file.
  */
 bool ObjToEggConverter::
-process_f_node(vector_string &words) {
+process_f_node(Words &words) {
   _f_given = true;
 
   bool all_vn = true;
   //int non_vn_index = -1;
 
-  pvector<VertexEntry> verts;
-  verts.reserve(words.size() - 1);
+  // We reuse the same array from face to face, rather than reallocating it
+  // each time.
+  VertexEntries &verts = _face_verts;
+  verts.clear();
   for (size_t i = 1; i < words.size(); ++i) {
     VertexEntry entry(this, words[i]);
     verts.push_back(entry);
@@ -733,7 +826,7 @@ process_f_node(vector_string &words) {
  * Defines a group in the obj file.
  */
 bool ObjToEggConverter::
-process_g_node(vector_string &words) {
+process_g_node(Words &words) {
   _current_vertex_data->close_geom(this);
   delete _current_vertex_data;
   _current_vertex_data = nullptr;
@@ -814,30 +907,199 @@ add_synth_normal(const LVecBase3d &normal) {
   return index + 1;
 }
 
+/**
+ * Splits the indicated line into words separated by spaces and tabs.  The
+ * line is modified in place: a NUL character is written at the end of each
+ * word, and the words vector is filled with pointers into the line.
+ */
+void ObjToEggConverter::
+tokenize_line(char *line, Words &words) {
+  words.clear();
+  char *p = line;
+  while (true) {
+    while (*p == ' ' || *p == '\t') {
+      ++p;
+    }
+    if (*p == '\0') {
+      return;
+    }
+    words.push_back(p);
+    while (*p != '\0' && *p != ' ' && *p != '\t') {
+      ++p;
+    }
+    if (*p == '\0') {
+      return;
+    }
+    *p = '\0';
+    ++p;
+  }
+}
+
+/**
+ * Takes ownership of the indicated stream, which should have been opened via
+ * VirtualFileSystem::open_read_file().
+ */
+ObjToEggConverter::LineReader::
+LineReader(std::istream *in) :
+  _in(in),
+  _start(0),
+  _end(0),
+  _eof(false),
+  _line_number(0)
+{
+  // We always keep one spare byte at the end of the buffer, so that we can
+  // NUL-terminate a final line that has no newline.
+  _buffer.resize(obj_read_block_size + 1);
+}
+
+/**
+ *
+ */
+ObjToEggConverter::LineReader::
+~LineReader() {
+  VirtualFileSystem::close_read_file(_in);
+}
+
+/**
+ * Returns the next logical line of the file, with leading and trailing
+ * whitespace removed and any backslash continuation lines joined on.  Returns
+ * NULL at the end of the file.
+ *
+ * The returned string may be freely modified by the caller, but it is only
+ * valid until the next call to next_line().
+ */
+char *ObjToEggConverter::LineReader::
+next_line() {
+  size_t length;
+  char *line = read_line(length);
+  if (line == nullptr) {
+    return nullptr;
+  }
+  line = trim_line(line, length);
+
+  if (length == 0 || line[length - 1] != '\\') {
+    return line;
+  }
+
+  // If it ends on a backslash, it's a continuation character.  The following
+  // line may not be in the buffer yet, so we have to copy this one out first.
+  _joined.assign(line, length);
+  while (!_joined.empty() && _joined[_joined.length() - 1] == '\\') {
+    char *line2 = read_line(length);
+    if (line2 == nullptr) {
+      break;
+    }
+    line2 = trim_line(line2, length);
+    _joined.erase(_joined.length() - 1);
+    _joined.append(line2, length);
+  }
+
+  return &_joined[0];
+}
+
+/**
+ * Returns the next physical line of the file, NUL-terminated in place within
+ * the buffer, and fills in its length.  Returns NULL at the end of the file.
+ */
+char *ObjToEggConverter::LineReader::
+read_line(size_t &length) {
+  size_t scan = _start;
+  while (true) {
+    char *begin = &_buffer[0] + scan;
+    char *newline = (char *)memchr(begin, '\n', _end - scan);
+    if (newline != nullptr) {
+      *newline = '\0';
+      char *line = &_buffer[0] + _start;
+      length = newline - line;
+      _start = (newline - &_buffer[0]) + 1;
+      ++_line_number;
+      return line;
+    }
+
+    if (_eof) {
+      if (_start == _end) {
+        return nullptr;
+      }
+      // The last line of the file has no newline.
+      _buffer[_end] = '\0';
+      char *line = &_buffer[0] + _start;
+      length = _end - _start;
+      _start = _end;
+      ++_line_number;
+      return line;
+    }
+
+    // We don't have a complete line in the buffer.  Read some more, taking
+    // care not to scan the part we have already scanned again.
+    size_t scanned = _end - _start;
+    fill_buffer();
+    scan = _start + scanned;
+  }
+}
+
+/**
+ * Moves the unread part of the buffer to the front and reads as much more of
+ * the file as will fit, growing the buffer first if it is already full of an
+ * incomplete line.
+ */
+void ObjToEggConverter::LineReader::
+fill_buffer() {
+  size_t remaining = _end - _start;
+  if (remaining != 0 && _start != 0) {
+    memmove(&_buffer[0], &_buffer[0] + _start, remaining);
+  }
+  _start = 0;
+  _end = remaining;
+
+  if (_end + 1 >= _buffer.size()) {
+    // This must be an exceptionally long line.
+    _buffer.resize(_buffer.size() * 2);
+  }
+
+  _in->read(&_buffer[0] + _end, _buffer.size() - 1 - _end);
+  std::streamsize count = _in->gcount();
+  _end += (size_t)count;
+  if (count == 0 || _in->eof() || _in->fail()) {
+    _eof = true;
+  }
+}
+
+/**
+ * Removes leading and trailing whitespace from the indicated line in place,
+ * and returns the new beginning of the line.  Length is updated accordingly.
+ */
+char *ObjToEggConverter::LineReader::
+trim_line(char *line, size_t &length) {
+  char *end = line + length;
+  while (line < end && isspace((unsigned char)*line)) {
+    ++line;
+  }
+  while (end > line && isspace((unsigned char)end[-1])) {
+    --end;
+  }
+  *end = '\0';
+  length = end - line;
+  return line;
+}
+
 /**
  * Creates a VertexEntry from the n/n/n string format in the obj file face
  * reference.
  */
 ObjToEggConverter::VertexEntry::
-VertexEntry(const ObjToEggConverter *converter, const string &obj_vertex) {
+VertexEntry(const ObjToEggConverter *converter, const char *obj_vertex) {
   _vi = 0;
   _vti = 0;
   _vni = 0;
   _synth_vni = 0;
 
-  vector_string words;
-  tokenize(obj_vertex, words, "/", false);
-  nassertv(!words.empty());
-
-  for (size_t i = 0; i < words.size(); ++i) {
-    int index;
-    if (trim(words[i]).empty()) {
-      index = 0;
-    } else {
-      if (!string_to_int(words[i], index)) {
-        index = 0;
-      }
+  const char *p = obj_vertex;
+  for (int i = 0; ; ++i) {
+    const char *field_end = p;
+    while (*field_end != '\0' && *field_end != '/') {
+      ++field_end;
     }
+    int index = parse_index(p, field_end);
 
     switch (i) {
     case 0:
@@ -870,6 +1132,11 @@ VertexEntry(const ObjToEggConverter *converter, const string &obj_vertex) {
       }
       break;
     }
+
+    if (*field_end == '\0') {
+      break;
+    }
+    p = field_end + 1;
   }
 }
 
@@ -47,26 +47,56 @@ public:
   virtual PT(PandaNode) convert_to_node(const LoaderOptions &options, const Filename &filename);
 
 protected:
+  // The words of a line, as returned by tokenize_line().  Each word is a
+  // NUL-terminated string pointing directly into the LineReader's buffer,
+  // and is valid only until the next line is read.
+  typedef pvector<char *> Words;
+
+  // This reads the obj file a large block at a time, and returns each line in
+  // place within its buffer, so that the line need not be copied.
+  class LineReader {
+  public:
+    LineReader(std::istream *in);
+    ~LineReader();
+
+    char *next_line();
+    INLINE int get_line_number() const;
+
+  private:
+    char *read_line(size_t &length);
+    void fill_buffer();
+    static char *trim_line(char *line, size_t &length);
+
+    std::istream *_in;
+    pvector<char> _buffer;
+    size_t _start, _end;
+    bool _eof;
+    int _line_number;
+    std::string _joined;
+  };
+
+  static void tokenize_line(char *line, Words &words);
+
   bool process(const Filename &filename);
-  bool process_line(const std::string &line);
-  bool process_ref_plane_res(const std::string &line);
-
-  bool process_v(vector_string &words);
-  bool process_vt(vector_string &words);
-  bool process_xvt(vector_string &words);
-  bool process_xvc(vector_string &words);
-  bool process_vn(vector_string &words);
-  bool process_f(vector_string &words);
-  bool process_g(vector_string &words);
-
-  EggVertex *get_face_vertex(const std::string &face_reference);
+  bool process_line(Words &words);
+  bool process_ref_plane_res(Words &words);
+
+  bool process_v(Words &words);
+  bool process_vt(Words &words);
+  bool process_xvt(Words &words);
+  bool process_xvc(Words &words);
+  bool process_vn(Words &words);
+  bool process_f(Words &words);
+  bool process_g(Words &words);
+
+  EggVertex *get_face_vertex(const char *face_reference);
   void generate_egg_points();
 
   bool process_node(const Filename &filename);
-  bool process_line_node(const std::string &line);
+  bool process_line_node(Words &words);
 
-  bool process_f_node(vector_string &words);
-  bool process_g_node(vector_string &words);
+  bool process_f_node(Words &words);
+  bool process_g_node(Words &words);
 
   void generate_points();
   int add_synth_normal(const LVecBase3d &normal);
@@ -101,7 +131,7 @@ protected:
   class VertexEntry {
   public:
     VertexEntry();
-    VertexEntry(const ObjToEggConverter *converter, const std::string &obj_vertex);
+    VertexEntry(const ObjToEggConverter *converter, const char *obj_vertex);
 
     INLINE bool operator < (const VertexEntry &other) const;
     INLINE bool operator == (const VertexEntry &other) const;
@@ -140,6 +170,7 @@ protected:
   };
 
   VertexData *_current_vertex_data;
+  VertexEntries _face_verts;
 
   friend class VertexData;
 };
@@ -0,0 +1,170 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_objparse.cxx
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#include "pandatoolbase.h"
+#include "objToEggConverter.h"
+#include "config_objegg.h"
+#include "eggData.h"
+#include "loaderOptions.h"
+#include "pandaNode.h"
+#include "filename.h"
+#include "trueClock.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+// This program times ObjToEggConverter on an obj file, both through
+// convert_file(), which builds egg data, and through convert_to_node(), which
+// builds a PandaNode directly, and reports the throughput of each in MB/s.
+// If no file is named, it generates a grid mesh with positions, texture
+// coordinates and normals, in the manner of a photogrammetry scan.
+
+/**
+ * Writes a grid of size x size quads, each split into two triangles, to the
+ * indicated file.  Returns true on success.
+ */
+static bool
+write_grid(const Filename &filename, int size) {
+  Filename text_filename = Filename::text_filename(filename);
+  std::string os_filename = text_filename.to_os_specific();
+  FILE *file = fopen(os_filename.c_str(), "w");
+  if (file == nullptr) {
+    return false;
+  }
+
+  int num_verts = size + 1;
+  for (int y = 0; y < num_verts; ++y) {
+    for (int x = 0; x < num_verts; ++x) {
+      double h = 0.01 * ((x * 7 + y * 13) % 17);
+      fprintf(file, "v %.6f %.6f %.6f\n", x * 0.01, y * 0.01, h);
+    }
+  }
+  for (int y = 0; y < num_verts; ++y) {
+    for (int x = 0; x < num_verts; ++x) {
+      fprintf(file, "vt %.6f %.6f\n", (double)x / size, (double)y / size);
+    }
+  }
+  for (int y = 0; y < num_verts; ++y) {
+    for (int x = 0; x < num_verts; ++x) {
+      fprintf(file, "vn %.6f %.6f %.6f\n", 0.0, 0.0, 1.0);
+    }
+  }
+
+  fprintf(file, "g grid\n");
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      int a = y * num_verts + x + 1;
+      int b = a + 1;
+      int c = a + num_verts + 1;
+      int d = a + num_verts;
+      fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n",
+              a, a, a, b, b, b, c, c, c);
+      fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n",
+              a, a, a, c, c, c, d, d, d);
+    }
+  }
+
+  bool okflag = (ferror(file) == 0);
+  if (fclose(file) != 0) {
+    okflag = false;
+  }
+  return okflag;
+}
+
+/**
+ * Reports the time taken to convert a file of the indicated size.
+ */
+static void
+report(const char *label, double elapsed, std::streamsize file_size) {
+  double mb = (double)file_size / (1024.0 * 1024.0);
+  nout << "  " << label << elapsed << " s, ";
+  if (elapsed > 0.0) {
+    nout << mb / elapsed << " MB/s\n";
+  } else {
+    nout << "too fast to measure\n";
+  }
+}
+
+int
+main(int argc, char *argv[]) {
+  if (argc > 2) {
+    nout << "test_objparse [grid_size | filename.obj]\n";
+    exit(1);
+  }
+
+  init_libobjegg();
+
+  Filename filename;
+  bool generated = false;
+  std::string arg = (argc > 1) ? argv[1] : "";
+  if (!arg.empty() && Filename(arg).get_extension() == "obj") {
+    filename = Filename::from_os_specific(arg);
+
+  } else {
+    int size = arg.empty() ? 1000 : atoi(arg.c_str());
+    if (size < 1) {
+      nout << "Invalid grid size.\n";
+      exit(1);
+    }
+    filename = Filename::temporary("", "objparse_", ".obj");
+    nout << "Writing a " << size << "x" << size << " grid to "
+         << filename << "\n";
+    if (!write_grid(filename, size)) {
+      nout << "Unable to write " << filename << "\n";
+      filename.unlink();
+      exit(1);
+    }
+    generated = true;
+  }
+
+  std::streamsize file_size = filename.get_file_size();
+  nout << "Converting " << filename << ", "
+       << file_size / (1024 * 1024) << " MB.\n";
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  bool okflag = true;
+
+  {
+    PT(EggData) data = new EggData;
+    ObjToEggConverter converter;
+    converter.set_egg_data(data);
+
+    double start = clock->get_short_time();
+    if (!converter.convert_file(filename)) {
+      nout << "convert_file() failed.\n";
+      okflag = false;
+    }
+    report("convert_file():    ", clock->get_short_time() - start,
+           file_size);
+  }
+
+  {
+    LoaderOptions options;
+    ObjToEggConverter converter;
+
+    double start = clock->get_short_time();
+    PT(PandaNode) node = converter.convert_to_node(options, filename);
+    if (node == nullptr) {
+      nout << "convert_to_node() failed.\n";
+      okflag = false;
+    }
+    report("convert_to_node(): ", clock->get_short_time() - start,
+           file_size);
+  }
+
+  if (generated) {
+    filename.unlink();
+  }
+
+  return okflag ? 0 : 1;
+}
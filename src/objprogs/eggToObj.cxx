@@ -40,6 +40,13 @@ EggToObj() :
      "Clean out higher-order polygons by subdividing into triangles.",
      &EggToObj::dispatch_none, &_triangulate_polygons);
 
+  add_option
+    ("j", "threads", 0,
+     "Use the indicated number of threads to format the face records of the "
+     "obj file.  The output is the same regardless; the default is 1.",
+     &EggToObj::dispatch_int, nullptr, &_num_threads);
+
+  _num_threads = 1;
   _coordinate_system = CS_zup_right;
   _got_coordinate_system = true;
 }
@@ -57,6 +64,7 @@ run() {
 
   EggToObjConverter saver;
   saver.set_egg_data(_data);
+  saver.set_num_threads(_num_threads);
 
   if (!saver.write_file(get_output_filename())) {
     nout << "An error occurred while writing.\n";
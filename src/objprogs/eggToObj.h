@@ -32,6 +32,7 @@ protected:
 
 private:
   bool _triangulate_polygons;
+  int _num_threads;
 };
 
 #endif
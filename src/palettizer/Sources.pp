@@ -14,24 +14,40 @@
 
   #define SOURCES \
      config_palettizer.h destTextureImage.h eggFile.h \
-     filenameUnifier.h imageFile.h omitReason.h \
+     filenameUnifier.h imageFile.h occupancyGrid.h omitReason.h \
      pal_string_utils.h paletteGroup.h \
      paletteGroups.h paletteImage.h \
-     palettePage.h palettizer.h sourceTextureImage.h \
-     textureImage.h textureMemoryCounter.h texturePlacement.h \
+     palettePage.h palettizer.h scaledImageCache.h sourceTextureImage.h \
+     stateJournal.h textureImage.h textureMemoryCounter.h \
+     texturePlacement.h \
      texturePosition.h textureProperties.h \
      textureReference.h textureRequest.h \
-     txaFile.h txaLine.h
+     txaFile.h txaLine.h txaPatternIndex.h
 
   #define COMPOSITE_SOURCES \
      config_palettizer.cxx destTextureImage.cxx eggFile.cxx \
      filenameUnifier.cxx imageFile.cxx \
-     omitReason.cxx pal_string_utils.cxx paletteGroup.cxx \
+     occupancyGrid.cxx omitReason.cxx pal_string_utils.cxx paletteGroup.cxx \
      paletteGroups.cxx paletteImage.cxx palettePage.cxx \
-     palettizer.cxx sourceTextureImage.cxx textureImage.cxx \
-     textureMemoryCounter.cxx texturePlacement.cxx \
+     palettizer.cxx scaledImageCache.cxx sourceTextureImage.cxx \
+     stateJournal.cxx textureImage.cxx textureMemoryCounter.cxx \
+     texturePlacement.cxx \
      texturePosition.cxx textureProperties.cxx \
      textureReference.cxx textureRequest.cxx txaFile.cxx \
-     txaLine.cxx
+     txaLine.cxx txaPatternIndex.cxx
 
 #end ss_lib_target
+
+#begin test_bin_target
+  #define TARGET test_placement
+  #define LOCAL_LIBS \
+    p3palettizer p3pandatoolbase
+
+  #define OTHER_LIBS \
+    p3express:c p3pandabase:c \
+    p3dtoolutil:c p3dtoolbase:c p3dtool:m p3prc
+
+  #define SOURCES \
+    test_placement.cxx
+
+#end test_bin_target
@@ -19,6 +19,7 @@
 #include "sourceTextureImage.h"
 #include "palettizer.h"
 #include "filenameUnifier.h"
+#include "stateJournal.h"
 
 #include "eggData.h"
 #include "eggGroup.h"
@@ -47,6 +48,7 @@ EggFile() {
   _is_surprise = true;
   _is_stale = true;
   _had_data = false;
+  _references_loaded = true;
 }
 
 /**
@@ -102,6 +104,10 @@ void EggFile::
 scan_textures() {
   nassertv(_data != nullptr);
 
+  // The references from the previous session are merged with the new ones,
+  // so we need to have them.
+  load_references();
+
   // Extract the set of textures referenced by this egg file.
   EggTextureCollection tc;
   tc.find_used_textures(_data);
@@ -212,6 +218,94 @@ get_textures(pset<TextureImage *> &result) const {
   for (ti = _textures.begin(); ti != _textures.end(); ++ti) {
     result.insert((*ti)->get_texture());
   }
+
+  LazyReferences::const_iterator li;
+  for (li = _lazy_references.begin(); li != _lazy_references.end(); ++li) {
+    result.insert((*li)._source->get_texture());
+  }
+}
+
+/**
+ * Reads the egg file's texture references from the StateJournal, if they
+ * have not already been read.  Since most sessions involve only a few of the
+ * egg files, the references are read only when something needs them.
+ *
+ * This is not thread-safe, since it adds the references back to their
+ * placements.
+ */
+void EggFile::
+load_references() {
+  if (_references_loaded) {
+    return;
+  }
+  _references_loaded = true;
+
+  StateJournal &journal = pal->_journal;
+  Datagram record;
+  if (!journal.read_record(get_name(), record)) {
+    nout << FilenameUnifier::make_user_filename(journal.get_filename())
+         << " has no readable record for " << get_name()
+         << ".  Perhaps you should remove it, along with the .boo file, "
+         << "so new ones can be created.\n";
+    exit(1);
+  }
+
+  DatagramIterator scan(record);
+  size_t num_references = scan.get_uint32();
+  if (num_references != _lazy_references.size()) {
+    nout << FilenameUnifier::make_user_filename(journal.get_filename())
+         << " does not match the .boo file for " << get_name()
+         << ".  Perhaps you should remove them both "
+         << "so new ones can be created.\n";
+    exit(1);
+  }
+
+  LazyReferences::const_iterator li;
+  for (li = _lazy_references.begin(); li != _lazy_references.end(); ++li) {
+    if ((*li)._placement != nullptr) {
+      (*li)._placement->forget_lazy_egg(this);
+    }
+  }
+
+  _textures.reserve(num_references);
+  for (li = _lazy_references.begin(); li != _lazy_references.end(); ++li) {
+    TextureReference *reference = new TextureReference;
+    reference->read_record(this, (*li)._source, (*li)._placement, scan);
+    _textures.push_back(reference);
+  }
+  _lazy_references.clear();
+
+  _record = record.get_message();
+}
+
+/**
+ * Writes the egg file's texture references to the StateJournal, if they have
+ * been read in this session and have changed since.  Returns true on
+ * success, false on failure.
+ */
+bool EggFile::
+write_references(StateJournal &journal) {
+  if (!_references_loaded) {
+    return true;
+  }
+
+  Datagram record;
+  record.add_uint32(_textures.size());
+  Textures::const_iterator ti;
+  for (ti = _textures.begin(); ti != _textures.end(); ++ti) {
+    (*ti)->write_record(record);
+  }
+
+  std::string data = record.get_message();
+  if (data == _record) {
+    return true;
+  }
+
+  if (!journal.write_record(get_name(), record)) {
+    return false;
+  }
+  _record.swap(data);
+  return true;
 }
 
 /**
@@ -347,6 +441,15 @@ build_cross_links() {
     reference->get_source()->increment_egg_count();
   }
 
+  // The references we haven't read yet need the same, which we can do
+  // without reading them.
+  LazyReferences::const_iterator li;
+  for (li = _lazy_references.begin(); li != _lazy_references.end(); ++li) {
+    SourceTextureImage *source = (*li)._source;
+    source->get_texture()->note_egg_file(this);
+    source->increment_egg_count();
+  }
+
   PaletteGroups::const_iterator gi;
   for (gi = _complete_groups.begin();
        gi != _complete_groups.end();
@@ -362,6 +465,8 @@ build_cross_links() {
  */
 void EggFile::
 apply_properties_to_source() {
+  load_references();
+
   Textures::const_iterator ti;
   for (ti = _textures.begin(); ti != _textures.end(); ++ti) {
     TextureReference *reference = (*ti);
@@ -379,6 +484,25 @@ apply_properties_to_source() {
  */
 void EggFile::
 choose_placements() {
+  if (!_references_loaded) {
+    // If each reference we haven't read yet is already using a suitable
+    // TexturePlacement, which is the usual case, there's nothing to change,
+    // and no need to read them.
+    LazyReferences::const_iterator li;
+    for (li = _lazy_references.begin(); li != _lazy_references.end(); ++li) {
+      TextureImage *texture = (*li)._source->get_texture();
+      TexturePlacement *placement = (*li)._placement;
+      if (placement == nullptr ||
+          texture->get_groups().count(placement->get_group()) == 0) {
+        break;
+      }
+    }
+    if (li == _lazy_references.end()) {
+      return;
+    }
+    load_references();
+  }
+
   Textures::const_iterator ti;
   for (ti = _textures.begin(); ti != _textures.end(); ++ti) {
     TextureReference *reference = (*ti);
@@ -460,6 +584,8 @@ update_egg() {
  */
 void EggFile::
 remove_egg() {
+  load_references();
+
   Textures::iterator ti;
   for (ti = _textures.begin(); ti != _textures.end(); ++ti) {
     TextureReference *reference = (*ti);
@@ -485,7 +611,8 @@ read_egg(bool noabs) {
     FilenameUnifier::make_user_filename(_source_filename);
 
   if (!_source_filename.exists()) {
-    nout << user_source_filename << " does not exist.\n";
+    pal->write_message(user_source_filename.get_fullpath() +
+                       " does not exist.\n");
     return false;
   }
 
@@ -496,8 +623,8 @@ read_egg(bool noabs) {
   }
 
   if (noabs && data->original_had_absolute_pathnames()) {
-    nout << _source_filename.get_basename()
-         << " references textures using absolute pathnames!\n";
+    pal->write_message(_source_filename.get_basename() +
+                       " references textures using absolute pathnames!\n");
     return false;
   }
 
@@ -538,6 +665,10 @@ read_egg(bool noabs) {
   PT(EggNode) comment = new EggComment("", _egg_comment);
   _data->insert(_data->begin(), comment);
 
+  // When the egg files are read on several threads, their references must
+  // already have been read by the caller.
+  load_references();
+
   if (!_textures.empty()) {
     // If we already have textures, assume we're re-reading the file.
     rescan_textures();
@@ -571,8 +702,9 @@ write_egg() {
   nassertr(!_dest_filename.empty(), false);
 
   _dest_filename.make_dir();
-  nout << "Writing " << FilenameUnifier::make_user_filename(_dest_filename)
-       << "\n";
+  Filename user_dest_filename =
+    FilenameUnifier::make_user_filename(_dest_filename);
+  pal->write_message("Writing " + user_dest_filename.get_fullpath() + "\n");
   if (!_data->write_egg(_dest_filename)) {
     // Some error while writing.  Most unusual.
     _is_stale = true;
@@ -679,9 +811,9 @@ rescan_textures() {
     ByTRefName::const_iterator tni = by_tref_name.find(egg_tex->get_name());
     if (tni == by_tref_name.end()) {
       // We didn't find this TRef name last time around!
-      nout << _source_filename.get_basename()
-           << " modified during session--TRef " << egg_tex->get_name()
-           << " is new!\n";
+      pal->write_message(_source_filename.get_basename() +
+                         " modified during session--TRef " +
+                         egg_tex->get_name() + " is new!\n");
 
     } else {
       TextureReference *ref = (*tni).second;
@@ -715,10 +847,24 @@ write_datagram(BamWriter *writer, Datagram &datagram) {
   datagram.add_string(FilenameUnifier::make_bam_filename(_dest_filename));
   datagram.add_string(_egg_comment);
 
-  datagram.add_uint32(_textures.size());
-  Textures::iterator ti;
-  for (ti = _textures.begin(); ti != _textures.end(); ++ti) {
-    writer->write_pointer(datagram, (*ti));
+  // The references themselves are kept in the StateJournal.  Here we write
+  // only the source texture and placement of each, in the order of the
+  // record, so they need not be read in a session that doesn't change them.
+  if (_references_loaded) {
+    datagram.add_uint32(_textures.size());
+    Textures::iterator ti;
+    for (ti = _textures.begin(); ti != _textures.end(); ++ti) {
+      writer->write_pointer(datagram, (*ti)->get_source());
+      writer->write_pointer(datagram, (*ti)->get_placement());
+    }
+
+  } else {
+    datagram.add_uint32(_lazy_references.size());
+    LazyReferences::iterator li;
+    for (li = _lazy_references.begin(); li != _lazy_references.end(); ++li) {
+      writer->write_pointer(datagram, (*li)._source);
+      writer->write_pointer(datagram, (*li)._placement);
+    }
   }
 
   _explicitly_assigned_groups.write_datagram(writer, datagram);
@@ -741,12 +887,32 @@ complete_pointers(TypedWritable **p_list, BamReader *manager) {
   int pi = TypedWritable::complete_pointers(p_list, manager);
 
   int i;
-  _textures.reserve(_num_textures);
-  for (i = 0; i < _num_textures; i++) {
-    TextureReference *texture;
-    DCAST_INTO_R(texture, p_list[pi], pi);
-    _textures.push_back(texture);
-    pi++;
+  if (Palettizer::_read_pi_version < 22) {
+    _textures.reserve(_num_textures);
+    for (i = 0; i < _num_textures; i++) {
+      TextureReference *texture;
+      DCAST_INTO_R(texture, p_list[pi], pi);
+      _textures.push_back(texture);
+      pi++;
+    }
+
+  } else {
+    _lazy_references.reserve(_num_textures);
+    for (i = 0; i < _num_textures; i++) {
+      LazyReference lazy;
+      lazy._source = nullptr;
+      lazy._placement = nullptr;
+      if (p_list[pi] != nullptr) {
+        DCAST_INTO_R(lazy._source, p_list[pi], pi);
+      }
+      pi++;
+      if (p_list[pi] != nullptr) {
+        DCAST_INTO_R(lazy._placement, p_list[pi], pi);
+        lazy._placement->note_lazy_egg(this);
+      }
+      pi++;
+      _lazy_references.push_back(lazy);
+    }
   }
 
   pi += _explicitly_assigned_groups.complete_pointers(p_list + pi, manager);
@@ -791,7 +957,14 @@ fillin(DatagramIterator &scan, BamReader *manager) {
   }
 
   _num_textures = scan.get_uint32();
-  manager->read_pointers(scan, _num_textures);
+  if (Palettizer::_read_pi_version < 22) {
+    manager->read_pointers(scan, _num_textures);
+  } else {
+    // These are the source texture and placement of each reference; the
+    // references themselves are read from the StateJournal when needed.
+    manager->read_pointers(scan, _num_textures * 2);
+    _references_loaded = false;
+  }
 
   _explicitly_assigned_groups.fillin(scan, manager);
   manager->read_pointer(scan);  // _default_group
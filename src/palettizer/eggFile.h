@@ -26,6 +26,9 @@
 #include "pset.h"
 
 class TextureImage;
+class SourceTextureImage;
+class TexturePlacement;
+class StateJournal;
 
 /**
  * This represents a single egg file known to the palettizer.  It may
@@ -47,6 +50,9 @@ public:
   void scan_textures();
   void get_textures(pset<TextureImage *> &result) const;
 
+  void load_references();
+  bool write_references(StateJournal &journal);
+
   void pre_txa_file();
   void match_txa_groups(const PaletteGroups &groups);
   void post_txa_file();
@@ -90,6 +96,22 @@ private:
   typedef pvector<TextureReference *> Textures;
   Textures _textures;
 
+  // Until the references have been read from the StateJournal, this records
+  // the source texture and placement of each, in the order of the record.
+  // That's enough to build the cross links and check the placements.
+  class LazyReference {
+  public:
+    SourceTextureImage *_source;
+    TexturePlacement *_placement;
+  };
+  typedef pvector<LazyReference> LazyReferences;
+  LazyReferences _lazy_references;
+  bool _references_loaded;
+
+  // This is the record last read from or written to the StateJournal, so
+  // that it need not be written again if it hasn't changed.
+  std::string _record;
+
   bool _first_txa_match;
   PaletteGroups _explicitly_assigned_groups;
   PaletteGroup *_default_group;
@@ -14,12 +14,14 @@
 #include "filenameUnifier.h"
 
 #include "executionEnvironment.h"
+#include "mutexHolder.h"
 
 Filename FilenameUnifier::_txa_filename;
 Filename FilenameUnifier::_txa_dir;
 Filename FilenameUnifier::_rel_dirname;
 
 FilenameUnifier::CanonicalFilenames FilenameUnifier::_canonical_filenames;
+Mutex FilenameUnifier::_canonical_lock;
 
 /**
  * Notes the filename the .txa file was found in.  This may have come from the
@@ -115,6 +117,7 @@ make_canonical(Filename &filename) {
 
   Filename orig_dirname = filename.get_dirname();
 
+  MutexHolder holder(_canonical_lock);
   CanonicalFilenames::iterator fi;
   fi = _canonical_filenames.find(orig_dirname);
   if (fi != _canonical_filenames.end()) {
@@ -0,0 +1,215 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file occupancyGrid.cxx
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#include "occupancyGrid.h"
+#include "pnotify.h"
+
+#include <algorithm>
+
+/**
+ *
+ */
+OccupancyGrid::
+OccupancyGrid() {
+  _x_size = 0;
+  _y_size = 0;
+  _cell_size = 1;
+  _num_x_cells = 0;
+  _num_y_cells = 0;
+}
+
+/**
+ * Empties the grid and sizes it to cover an image of the indicated size.
+ */
+void OccupancyGrid::
+reset(int x_size, int y_size) {
+  _x_size = x_size;
+  _y_size = y_size;
+
+  // Choose a cell size so that the grid is no more than about 64 cells on a
+  // side, but don't bother with cells smaller than 16 pixels; textures
+  // smaller than that are rarely palettized in quantity.
+  int max_size = std::max(x_size, y_size);
+  _cell_size = std::max(16, (max_size + 63) / 64);
+  _num_x_cells = std::max(1, (x_size + _cell_size - 1) / _cell_size);
+  _num_y_cells = std::max(1, (y_size + _cell_size - 1) / _cell_size);
+
+  _cells.clear();
+  _cells.resize(_num_x_cells * _num_y_cells);
+  _bottom_edges.clear();
+}
+
+/**
+ * Returns true if the grid has been reset to the indicated image size, false
+ * if it must be reset (and refilled) before it can be used.
+ */
+bool OccupancyGrid::
+is_valid_for(int x_size, int y_size) const {
+  return (_x_size == x_size && _y_size == y_size && !_cells.empty());
+}
+
+/**
+ * Records the indicated rectangle as occupied, in each cell it overlaps.
+ */
+void OccupancyGrid::
+add(int x, int y, int x_size, int y_size) {
+  Rect rect;
+  rect._x = x;
+  rect._y = y;
+  rect._x_size = x_size;
+  rect._y_size = y_size;
+
+  int cx0, cy0, cx1, cy1;
+  get_cell_range(x, y, x_size, y_size, cx0, cy0, cx1, cy1);
+  for (int cy = cy0; cy <= cy1; ++cy) {
+    for (int cx = cx0; cx <= cx1; ++cx) {
+      _cells[cy * _num_x_cells + cx].push_back(rect);
+    }
+  }
+
+  ++_bottom_edges[y + y_size];
+}
+
+/**
+ * Removes the indicated rectangle, which must have been previously added
+ * with the same position and size.
+ */
+void OccupancyGrid::
+remove(int x, int y, int x_size, int y_size) {
+  int cx0, cy0, cx1, cy1;
+  get_cell_range(x, y, x_size, y_size, cx0, cy0, cx1, cy1);
+  bool found = false;
+  for (int cy = cy0; cy <= cy1; ++cy) {
+    for (int cx = cx0; cx <= cx1; ++cx) {
+      Rects &cell = _cells[cy * _num_x_cells + cx];
+      Rects::iterator ri;
+      for (ri = cell.begin(); ri != cell.end(); ++ri) {
+        const Rect &rect = (*ri);
+        if (rect._x == x && rect._y == y &&
+            rect._x_size == x_size && rect._y_size == y_size) {
+          cell.erase(ri);
+          found = true;
+          break;
+        }
+      }
+    }
+  }
+
+  if (found) {
+    BottomEdges::iterator ei = _bottom_edges.find(y + y_size);
+    if (ei != _bottom_edges.end()) {
+      if (--(*ei).second <= 0) {
+        _bottom_edges.erase(ei);
+      }
+    }
+  }
+}
+
+/**
+ * Searches for a hole of at least x_size by y_size pixels somewhere within
+ * the image.  If a suitable hole is found, sets x and y to the top left
+ * corner and returns true; otherwise, returns false.
+ *
+ * The hole returned is the topmost one available, and the leftmost one
+ * within that row.
+ */
+bool OccupancyGrid::
+find_hole(int &x, int &y, int x_size, int y_size) const {
+  // A hole can only begin at the top of the image, or immediately below the
+  // bottom edge of some rectangle already placed (any other hole could be
+  // slid upward until it reached one of those rows), so those are the only
+  // rows we need to consider.
+  BottomEdges::const_iterator ei = _bottom_edges.begin();
+
+  y = 0;
+  while (y + y_size <= _y_size) {
+    // Scan along the row at 'y'.
+    x = 0;
+    while (x + x_size <= _x_size) {
+      // Consider the spot at x, y.
+      int next_x;
+      if (!find_overlap(x, y, x_size, y_size, next_x)) {
+        // Hooray!
+        return true;
+      }
+
+      // Every spot between here and the right edge of the overlapping
+      // rectangle must overlap it too, so we can skip directly past it.
+      nassertr(next_x > x, false);
+      x = next_x;
+    }
+
+    while (ei != _bottom_edges.end() && (*ei).first <= y) {
+      ++ei;
+    }
+    if (ei == _bottom_edges.end()) {
+      break;
+    }
+    y = (*ei).first;
+  }
+
+  // Nope, wouldn't fit anywhere.
+  return false;
+}
+
+/**
+ * If the indicated rectangle overlaps any rectangle recorded in the grid,
+ * sets overlap_right to the right edge of one such rectangle (not
+ * necessarily the first one added) and returns true; otherwise, returns
+ * false.
+ */
+bool OccupancyGrid::
+find_overlap(int x, int y, int x_size, int y_size, int &overlap_right) const {
+  int cx0, cy0, cx1, cy1;
+  get_cell_range(x, y, x_size, y_size, cx0, cy0, cx1, cy1);
+  for (int cy = cy0; cy <= cy1; ++cy) {
+    for (int cx = cx0; cx <= cx1; ++cx) {
+      const Rects &cell = _cells[cy * _num_x_cells + cx];
+      Rects::const_iterator ri;
+      for (ri = cell.begin(); ri != cell.end(); ++ri) {
+        const Rect &rect = (*ri);
+        if (rect.intersects(x, y, x_size, y_size)) {
+          overlap_right = rect._x + rect._x_size;
+          return true;
+        }
+      }
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Computes the inclusive range of cells touched by the indicated rectangle,
+ * clamped to the grid.
+ */
+void OccupancyGrid::
+get_cell_range(int x, int y, int x_size, int y_size,
+               int &cx0, int &cy0, int &cx1, int &cy1) const {
+  cx0 = std::max(0, std::min(x / _cell_size, _num_x_cells - 1));
+  cy0 = std::max(0, std::min(y / _cell_size, _num_y_cells - 1));
+  cx1 = (x + std::max(x_size, 1) - 1) / _cell_size;
+  cy1 = (y + std::max(y_size, 1) - 1) / _cell_size;
+  cx1 = std::max(cx0, std::min(cx1, _num_x_cells - 1));
+  cy1 = std::max(cy0, std::min(cy1, _num_y_cells - 1));
+}
+
+/**
+ * Returns true if this rectangle overlaps the rectangle whose top left corner
+ * is at x, y and whose size is given by x_size, y_size, or false otherwise.
+ */
+bool OccupancyGrid::Rect::
+intersects(int x, int y, int x_size, int y_size) const {
+  return !(x >= _x + _x_size || x + x_size <= _x ||
+           y >= _y + _y_size || y + y_size <= _y);
+}
@@ -0,0 +1,69 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file occupancyGrid.h
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#ifndef OCCUPANCYGRID_H
+#define OCCUPANCYGRID_H
+
+#include "pandatoolbase.h"
+
+#include "pvector.h"
+#include "pmap.h"
+
+/**
+ * A spatial index over the rectangles already occupied within a palette
+ * image, so that find_hole() need not test every placed texture for each
+ * candidate position.  The image is divided into uniform cells, each of which
+ * lists the rectangles that overlap it; we also keep the set of distinct
+ * bottom edges, which are the only rows (besides the top) at which a new hole
+ * may begin.
+ *
+ * The rectangles within one image never overlap, so each one is identified
+ * by its position and size alone.
+ */
+class OccupancyGrid {
+public:
+  OccupancyGrid();
+
+  void reset(int x_size, int y_size);
+  bool is_valid_for(int x_size, int y_size) const;
+
+  void add(int x, int y, int x_size, int y_size);
+  void remove(int x, int y, int x_size, int y_size);
+
+  bool find_hole(int &x, int &y, int x_size, int y_size) const;
+  bool find_overlap(int x, int y, int x_size, int y_size,
+                    int &overlap_right) const;
+
+private:
+  class Rect {
+  public:
+    bool intersects(int x, int y, int x_size, int y_size) const;
+
+    int _x, _y;
+    int _x_size, _y_size;
+  };
+  typedef pvector<Rect> Rects;
+
+  void get_cell_range(int x, int y, int x_size, int y_size,
+                      int &cx0, int &cy0, int &cx1, int &cy1) const;
+
+  int _x_size, _y_size;
+  int _cell_size;
+  int _num_x_cells, _num_y_cells;
+  pvector<Rects> _cells;
+
+  typedef pmap<int, int> BottomEdges;
+  BottomEdges _bottom_edges;
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include "eggFile.cxx"
 #include "filenameUnifier.cxx"
 #include "imageFile.cxx"
+#include "occupancyGrid.cxx"
 #include "omitReason.cxx"
 #include "pal_string_utils.cxx"
 #include "paletteGroup.cxx"
@@ -11,7 +12,9 @@
 #include "paletteImage.cxx"
 #include "palettePage.cxx"
 #include "palettizer.cxx"
+#include "scaledImageCache.cxx"
 #include "sourceTextureImage.cxx"
+#include "stateJournal.cxx"
 #include "textureImage.cxx"
 #include "textureMemoryCounter.cxx"
 #include "texturePlacement.cxx"
@@ -21,4 +24,5 @@
 #include "textureRequest.cxx"
 #include "txaFile.cxx"
 #include "txaLine.cxx"
+#include "txaPatternIndex.cxx"
 
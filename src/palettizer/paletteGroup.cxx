@@ -554,6 +554,19 @@ update_images(bool redo_all) {
   }
 }
 
+/**
+ * Appends each PaletteImage on each page of this group to the indicated
+ * vector.
+ */
+void PaletteGroup::
+get_images(pvector<PaletteImage *> &images) const {
+  Pages::const_iterator pai;
+  for (pai = _pages.begin(); pai != _pages.end(); ++pai) {
+    PalettePage *page = (*pai).second;
+    page->get_images(images);
+  }
+}
+
 /**
  * Registers the current object as something that can be read from a Bam file.
  */
@@ -578,16 +591,37 @@ write_datagram(BamWriter *writer, Datagram &datagram) {
   datagram.add_int32(_dependency_order);
   datagram.add_int32(_dirname_order);
 
-  datagram.add_uint32(_placements.size());
+  // The placements and pages are written in order by name, rather than in
+  // pointer order, so that an unchanged state file is written out identically
+  // each session.
+  pvector<TexturePlacement *> placement_vector;
+  placement_vector.reserve(_placements.size());
   Placements::const_iterator pli;
   for (pli = _placements.begin(); pli != _placements.end(); ++pli) {
-    writer->write_pointer(datagram, (*pli));
+    placement_vector.push_back(*pli);
   }
+  sort(placement_vector.begin(), placement_vector.end(),
+       IndirectCompareNames<TexturePlacement>());
 
-  datagram.add_uint32(_pages.size());
+  datagram.add_uint32(placement_vector.size());
+  pvector<TexturePlacement *>::const_iterator pvi;
+  for (pvi = placement_vector.begin(); pvi != placement_vector.end(); ++pvi) {
+    writer->write_pointer(datagram, (*pvi));
+  }
+
+  pvector<PalettePage *> page_vector;
+  page_vector.reserve(_pages.size());
   Pages::const_iterator pai;
   for (pai = _pages.begin(); pai != _pages.end(); ++pai) {
-    writer->write_pointer(datagram, (*pai).second);
+    page_vector.push_back((*pai).second);
+  }
+  sort(page_vector.begin(), page_vector.end(),
+       IndirectCompareNames<PalettePage>());
+
+  datagram.add_uint32(page_vector.size());
+  pvector<PalettePage *>::const_iterator pgi;
+  for (pgi = page_vector.begin(); pgi != page_vector.end(); ++pgi) {
+    writer->write_pointer(datagram, (*pgi));
   }
   datagram.add_bool(_has_margin_override);
   datagram.add_int16(_margin_override);
@@ -29,6 +29,7 @@
 class EggFile;
 class TexturePlacement;
 class PalettePage;
+class PaletteImage;
 class TextureImage;
 class TxaFile;
 
@@ -85,6 +86,7 @@ public:
   void reset_images();
   void setup_shadow_images();
   void update_images(bool redo_all);
+  void get_images(pvector<PaletteImage *> &images) const;
 
   void add_texture_swap_info(const std::string sourceTextureName, const vector_string &swapTextures);
   bool is_none_texture_swap() const;
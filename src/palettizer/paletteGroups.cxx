@@ -292,9 +292,20 @@ write_datagram(BamWriter *writer, Datagram &datagram) {
   TypedWritable::write_datagram(writer, datagram);
   datagram.add_uint32(_groups.size());
 
+  // Write the groups in order by name, rather than in pointer order, so that
+  // an unchanged state file is written out identically each session.
+  pvector<PaletteGroup *> group_vector;
+  group_vector.reserve(_groups.size());
   Groups::const_iterator gi;
   for (gi = _groups.begin(); gi != _groups.end(); ++gi) {
-    writer->write_pointer(datagram, *gi);
+    group_vector.push_back(*gi);
+  }
+  sort(group_vector.begin(), group_vector.end(),
+       IndirectCompareNames<PaletteGroup>());
+
+  pvector<PaletteGroup *>::const_iterator gvi;
+  for (gvi = group_vector.begin(); gvi != group_vector.end(); ++gvi) {
+    writer->write_pointer(datagram, *gvi);
   }
 }
 
@@ -134,6 +134,7 @@ PaletteImage() {
   _index = 0;
   _new_image = false;
   _got_image = false;
+  _grid_stale = true;
 
   _swapped_image = 0;
 }
@@ -152,6 +153,7 @@ PaletteImage(PalettePage *page, int index) :
   _y_size = pal->_pal_y_size;
   _new_image = true;
   _got_image = false;
+  _grid_stale = true;
   _swapped_image = 0;
 
   setup_filename();
@@ -172,6 +174,7 @@ PaletteImage(PalettePage *page, int index, unsigned swapIndex) :
   _y_size = pal->_pal_y_size;
   _new_image = true;
   _got_image = false;
+  _grid_stale = true;
 
   setup_filename();
 }
@@ -277,6 +280,8 @@ place(TexturePlacement *placement) {
   if (find_hole(x, y, placement->get_x_size(), placement->get_y_size())) {
     placement->place_at(this, x, y);
     _placements.push_back(placement);
+    _grid.add(x, y, placement->get_placed_x_size(),
+              placement->get_placed_y_size());
 
     // [gjeon] create swappedImages
     TexturePlacement::TextureSwaps::iterator tsi;
@@ -307,6 +312,11 @@ unplace(TexturePlacement *placement) {
     _placements.erase(pi);
     pi = find(_placements.begin(), _placements.end(), placement);
   }
+  if (!_grid_stale) {
+    _grid.remove(placement->get_placed_x(), placement->get_placed_y(),
+                 placement->get_placed_x_size(),
+                 placement->get_placed_y_size());
+  }
   _cleared_regions.push_back(ClearedRegion(placement));
 }
 
@@ -519,6 +529,39 @@ setup_shadow_image() {
   }
 }
 
+/**
+ * Performs the parts of update_image() that may modify objects shared with
+ * other PaletteImages: renaming the image files, which may mark egg files
+ * stale, and choosing the preferred source image for each texture.  Once this
+ * has been called, update_image() touches only this image and its swapped
+ * images, and may be run on several PaletteImages at once.
+ */
+void PaletteImage::
+prepare_update() {
+  if (is_empty() && pal->_aggressively_clean_mapdir) {
+    return;
+  }
+
+  update_filename();
+
+  Placements::iterator pi;
+  for (pi = _placements.begin(); pi != _placements.end(); ++pi) {
+    TexturePlacement *placement = (*pi);
+    placement->get_texture()->get_preferred_source();
+
+    TexturePlacement::TextureSwaps::iterator tsi;
+    for (tsi = placement->_textureSwaps.begin(); tsi != placement->_textureSwaps.end(); ++tsi) {
+      (*tsi)->get_preferred_source();
+    }
+  }
+
+  SwappedImages::iterator si;
+  for (si = _swappedImages.begin(); si != _swappedImages.end(); ++si) {
+    PaletteImage *swappedImage = (*si);
+    swappedImage->update_filename();
+  }
+}
+
 /**
  * If the palette has changed since it was last written out, updates the image
  * and writes out a new one.  If redo_all is true, regenerates the image from
@@ -780,58 +823,37 @@ setup_filename() {
  * Searches for a hole of at least x_size by y_size pixels somewhere within
  * the PaletteImage.  If a suitable hole is found, sets x and y to the top
  * left corner and returns true; otherwise, returns false.
+ *
+ * The hole returned is the topmost one available, and the leftmost one
+ * within that row.
  */
 bool PaletteImage::
-find_hole(int &x, int &y, int x_size, int y_size) const {
-  y = 0;
-  while (y + y_size <= _y_size) {
-    int next_y = _y_size;
-    // Scan along the row at 'y'.
-    x = 0;
-    while (x + x_size <= _x_size) {
-      int next_x = x;
-
-      // Consider the spot at x, y.
-      TexturePlacement *overlap = find_overlap(x, y, x_size, y_size);
-
-      if (overlap == nullptr) {
-        // Hooray!
-        return true;
-      }
-
-      next_x = overlap->get_placed_x() + overlap->get_placed_x_size();
-      next_y = std::min(next_y, overlap->get_placed_y() + overlap->get_placed_y_size());
-      nassertr(next_x > x, false);
-      x = next_x;
-    }
-
-    nassertr(next_y > y, false);
-    y = next_y;
-  }
-
-  // Nope, wouldn't fit anywhere.
-  return false;
+find_hole(int &x, int &y, int x_size, int y_size) {
+  update_grid();
+  return _grid.find_hole(x, y, x_size, y_size);
 }
 
 /**
- * If the rectangle whose top left corner is x, y and whose size is x_size,
- * y_size describes an empty hole that does not overlap any placed images,
- * returns NULL; otherwise, returns the first placed texture that the image
- * does overlap.  It is assumed the rectangle lies completely within the
- * boundaries of the image itself.
+ * Ensures the OccupancyGrid reflects the current set of placements and the
+ * current size of the image, rebuilding it from scratch if necessary.
  */
-TexturePlacement *PaletteImage::
-find_overlap(int x, int y, int x_size, int y_size) const {
+void PaletteImage::
+update_grid() {
+  if (!_grid_stale && _grid.is_valid_for(_x_size, _y_size)) {
+    return;
+  }
+
+  _grid.reset(_x_size, _y_size);
   Placements::const_iterator pi;
   for (pi = _placements.begin(); pi != _placements.end(); ++pi) {
     TexturePlacement *placement = (*pi);
-    if (placement->is_placed() &&
-        placement->intersects(x, y, x_size, y_size)) {
-      return placement;
+    if (placement->is_placed()) {
+      _grid.add(placement->get_placed_x(), placement->get_placed_y(),
+                placement->get_placed_x_size(),
+                placement->get_placed_y_size());
     }
   }
-
-  return nullptr;
+  _grid_stale = false;
 }
 
 /**
@@ -1024,6 +1046,7 @@ complete_pointers(TypedWritable **p_list, BamReader *manager) {
     _placements.push_back(placement);
     index++;
   }
+  _grid_stale = true;
 
   if (p_list[index] != nullptr) {
     DCAST_INTO_R(_page, p_list[index], index);
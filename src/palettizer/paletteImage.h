@@ -17,6 +17,7 @@
 #include "pandatoolbase.h"
 
 #include "imageFile.h"
+#include "occupancyGrid.h"
 
 #include "pnmImage.h"
 
@@ -54,14 +55,15 @@ public:
   void write_placements(std::ostream &out, int indent_level = 0) const;
   void reset_image();
   void setup_shadow_image();
+  void prepare_update();
   void update_image(bool redo_all);
 
   bool update_filename();
 
 private:
   bool setup_filename();
-  bool find_hole(int &x, int &y, int x_size, int y_size) const;
-  TexturePlacement *find_overlap(int x, int y, int x_size, int y_size) const;
+  bool find_hole(int &x, int &y, int x_size, int y_size);
+  void update_grid();
   void get_image();
   void release_image();
   void remove_image();
@@ -92,6 +94,9 @@ private:
   typedef pvector<TexturePlacement *> Placements;
   Placements _placements;
 
+  OccupancyGrid _grid;
+  bool _grid_stale;
+
   Placements *_masterPlacements;
 
   PalettePage *_page;
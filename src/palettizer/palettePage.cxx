@@ -208,6 +208,14 @@ update_images(bool redo_all) {
   }
 }
 
+/**
+ * Appends each PaletteImage on this page to the indicated vector.
+ */
+void PalettePage::
+get_images(pvector<PaletteImage *> &images) const {
+  images.insert(images.end(), _images.begin(), _images.end());
+}
+
 /**
  * Registers the current object as something that can be read from a Bam file.
  */
@@ -50,6 +50,7 @@ public:
   void reset_images();
   void setup_shadow_images();
   void update_images(bool redo_all);
+  void get_images(pvector<PaletteImage *> &images) const;
 
 private:
   PaletteGroup *_group;
@@ -16,8 +16,10 @@
 #include "textureImage.h"
 #include "pal_string_utils.h"
 #include "paletteGroup.h"
+#include "paletteImage.h"
 #include "filenameUnifier.h"
 #include "textureMemoryCounter.h"
+#include "workerPool.h"
 
 #include "pnmImage.h"
 #include "pnmFileTypeRegistry.h"
@@ -28,6 +30,8 @@
 #include "bamReader.h"
 #include "bamWriter.h"
 #include "indent.h"
+#include "pmutex.h"
+#include "mutexHolder.h"
 
 using std::cout;
 using std::string;
@@ -39,7 +43,7 @@ Palettizer *pal = nullptr;
 // update egg-palettize to write out additional information to its pi file,
 // without having it increment the bam version number for all bam and boo
 // files anywhere in the world.
-int Palettizer::_pi_version = 20;
+int Palettizer::_pi_version = 22;
 /*
  * Updated to version 8 on 32003 to remove extensions from texture key names.
  * Updated to version 9 on 41303 to add a few properties in various places.
@@ -53,7 +57,9 @@ int Palettizer::_pi_version = 20;
  * TextureImage::_txa_wrap_u etc.  Updated to version 18 on 51308 to add
  * TextureProperties::_quality_level.  Updated to version 19 on 71609 to add
  * PaletteGroup::_override_margin Updated to version 20 on 72709 to add
- * TexturePlacement::_swapTextures
+ * TexturePlacement::_swapTextures.  Updated to version 21 on 101626 to add
+ * TextureImage::_txa_matches.  Updated to version 22 on 101626 to move the
+ * TextureReferences into the StateJournal.
  */
 
 int Palettizer::_min_pi_version = 8;
@@ -101,6 +107,82 @@ public:
   }
 };
 
+// This is the job data for regenerating palette images in parallel, in
+// generate_images().
+class UpdateImagesJob {
+public:
+  static void update_image(int job_index, void *user_data) {
+    UpdateImagesJob *job = (UpdateImagesJob *)user_data;
+    job->_images[job_index]->update_image(job->_redo_all);
+  }
+
+  pvector<PaletteImage *> _images;
+  bool _redo_all;
+};
+
+// This is the job data for reading the stale egg files in parallel, in
+// read_stale_eggs().  Reading each egg file is independent, but scanning its
+// textures and choosing placements updates the shared texture and group
+// state, so that part is done while holding _lock.  Each egg file's data is
+// released as soon as it has been scanned, so that no more than one egg file
+// per thread is held in memory at once.
+class ReadStaleEggsJob {
+public:
+  static void read_egg(int job_index, void *user_data) {
+    ReadStaleEggsJob *job = (ReadStaleEggsJob *)user_data;
+    EggFile *egg_file = job->_egg_files[job_index];
+    if (!egg_file->read_egg(job->_noabs)) {
+      job->_valid[job_index] = false;
+      return;
+    }
+
+    {
+      MutexHolder holder(job->_lock);
+      egg_file->scan_textures();
+      egg_file->choose_placements();
+    }
+    egg_file->release_egg_data();
+  }
+
+  // These are chars rather than bools, since each is written by a different
+  // thread, and pvector<bool> packs its elements together.
+  pvector<EggFile *> _egg_files;
+  pvector<char> _valid;
+  bool _noabs;
+  Mutex _lock;
+};
+
+// This is the job data for updating and writing the egg files in parallel,
+// in write_eggs().  By this point all the placements have been decided, so
+// each egg file may be updated and written independently of the others.
+class WriteEggsJob {
+public:
+  static void write_egg(int job_index, void *user_data) {
+    WriteEggsJob *job = (WriteEggsJob *)user_data;
+    EggFile *egg_file = job->_egg_files[job_index];
+    if (!egg_file->has_data()) {
+      // Re-read the egg file.
+      bool read_ok = egg_file->read_egg(job->_noabs);
+      if (!read_ok) {
+        pal->write_message("Error!  Unable to re-read egg file.\n");
+        job->_ok[job_index] = false;
+      }
+    }
+
+    if (egg_file->has_data()) {
+      egg_file->update_egg();
+      if (!egg_file->write_egg()) {
+        job->_ok[job_index] = false;
+      }
+      egg_file->release_egg_data();
+    }
+  }
+
+  pvector<EggFile *> _egg_files;
+  pvector<char> _ok;
+  bool _noabs;
+};
+
 /**
  *
  */
@@ -108,6 +190,7 @@ Palettizer::
 Palettizer() {
   _is_valid = true;
   _noabs = false;
+  _num_threads = 1;
 
   _generated_image_pattern = "%g_palette_%p_%i";
   _map_dirname = "%g";
@@ -126,6 +209,7 @@ Palettizer() {
   _background.set(0.0, 0.0, 0.0, 0.0);
   _cutout_mode = EggRenderMode::AM_dual;
   _cutout_ratio = 0.3;
+  _journal_serial = 0;
 
   _round_uvs = true;
   _round_unit = 0.1;
@@ -159,6 +243,26 @@ set_noabs(bool noabs) {
   _noabs = noabs;
 }
 
+/**
+ * Returns the number of threads that will be used to regenerate palette
+ * images and to read and write egg files.  See set_num_threads().
+ */
+int Palettizer::
+get_num_threads() const {
+  return _num_threads;
+}
+
+/**
+ * Specifies the number of threads that generate_images() may use to
+ * regenerate several palette images at once, and that read_stale_eggs() and
+ * write_eggs() may use to process several egg files at once.  The default is
+ * 1, which does everything one at a time.
+ */
+void Palettizer::
+set_num_threads(int num_threads) {
+  _num_threads = num_threads;
+}
+
 /**
  * Returns true if the palette information file was read correctly, or false
  * if there was some error and the palettization can't continue.
@@ -341,6 +445,18 @@ report_statistics() const {
   cout << "\nOverall:\n";
   compute_statistics(cout, 2, overall_placements);
 
+  // The cache counts are accumulated on disk by generate_images(), since no
+  // images are generated in a session that reports statistics.
+  uint64_t cache_hits, cache_misses;
+  if (_scaled_image_cache.read_totals(cache_hits, cache_misses) &&
+      cache_hits + cache_misses != 0) {
+    uint64_t cache_lookups = cache_hits + cache_misses;
+    cout << "\nScaled image cache, all sessions:\n";
+    indent(cout, 2)
+      << cache_hits << " hits, " << cache_misses << " misses ("
+      << (100 * cache_hits / cache_lookups) << "% hit rate)\n";
+  }
+
   cout << "\n";
 }
 
@@ -631,10 +747,32 @@ reset_images() {
  */
 void Palettizer::
 generate_images(bool redo_all) {
+  WorkerPool pool(_num_threads);
+
   Groups::iterator gi;
-  for (gi = _groups.begin(); gi != _groups.end(); ++gi) {
-    PaletteGroup *group = (*gi).second;
-    group->update_images(redo_all);
+  if (!pool.is_threaded()) {
+    for (gi = _groups.begin(); gi != _groups.end(); ++gi) {
+      PaletteGroup *group = (*gi).second;
+      group->update_images(redo_all);
+    }
+
+  } else {
+    // The palette images are independent of each other, so we can regenerate
+    // them concurrently, once we have done the part of the work that touches
+    // shared state up front.
+    UpdateImagesJob job;
+    job._redo_all = redo_all;
+    for (gi = _groups.begin(); gi != _groups.end(); ++gi) {
+      PaletteGroup *group = (*gi).second;
+      group->get_images(job._images);
+    }
+
+    pvector<PaletteImage *>::iterator ii;
+    for (ii = job._images.begin(); ii != job._images.end(); ++ii) {
+      (*ii)->prepare_update();
+    }
+
+    pool.run((int)job._images.size(), &UpdateImagesJob::update_image, &job);
   }
 
   Textures::iterator ti;
@@ -642,6 +780,13 @@ generate_images(bool redo_all) {
     TextureImage *texture = (*ti).second;
     texture->copy_unplaced(redo_all);
   }
+
+  if (_scaled_image_cache.is_enabled()) {
+    nout << "Scaled image cache: " << _scaled_image_cache.get_num_hits()
+         << " hits, " << _scaled_image_cache.get_num_misses()
+         << " misses.\n";
+    _scaled_image_cache.write_totals();
+  }
 }
 
 /**
@@ -656,21 +801,30 @@ bool Palettizer::
 read_stale_eggs(bool redo_all) {
   bool okflag = true;
 
-  pvector<EggFiles::iterator> invalid_eggs;
+  ReadStaleEggsJob job;
+  job._noabs = _noabs;
+  pvector<EggFiles::iterator> stale_eggs;
 
   EggFiles::iterator ei;
   for (ei = _egg_files.begin(); ei != _egg_files.end(); ++ei) {
     EggFile *egg_file = (*ei).second;
     if (!egg_file->had_data() &&
         (egg_file->is_stale() || redo_all)) {
-      if (!egg_file->read_egg(_noabs)) {
-        invalid_eggs.push_back(ei);
+      // The references are read here, rather than on the worker threads.
+      egg_file->load_references();
+      stale_eggs.push_back(ei);
+      job._egg_files.push_back(egg_file);
+    }
+  }
+  job._valid.assign(job._egg_files.size(), true);
 
-      } else {
-        egg_file->scan_textures();
-        egg_file->choose_placements();
-        egg_file->release_egg_data();
-      }
+  WorkerPool pool(_num_threads);
+  pool.run((int)job._egg_files.size(), &ReadStaleEggsJob::read_egg, &job);
+
+  pvector<EggFiles::iterator> invalid_eggs;
+  for (size_t i = 0; i < stale_eggs.size(); ++i) {
+    if (!job._valid[i]) {
+      invalid_eggs.push_back(stale_eggs[i]);
     }
   }
 
@@ -714,32 +868,67 @@ bool Palettizer::
 write_eggs() {
   bool okflag = true;
 
+  WriteEggsJob job;
+  job._noabs = _noabs;
+
   EggFiles::iterator ei;
   for (ei = _egg_files.begin(); ei != _egg_files.end(); ++ei) {
     EggFile *egg_file = (*ei).second;
     if (egg_file->had_data()) {
-      if (!egg_file->has_data()) {
-        // Re-read the egg file.
-        bool read_ok = egg_file->read_egg(_noabs);
-        if (!read_ok) {
-          nout << "Error!  Unable to re-read egg file.\n";
-          okflag = false;
-        }
-      }
+      job._egg_files.push_back(egg_file);
+    }
+  }
+  job._ok.assign(job._egg_files.size(), true);
 
-      if (egg_file->has_data()) {
-        egg_file->update_egg();
-        if (!egg_file->write_egg()) {
-          okflag = false;
-        }
-        egg_file->release_egg_data();
-      }
+  WorkerPool pool(_num_threads);
+  pool.run((int)job._egg_files.size(), &WriteEggsJob::write_egg, &job);
+
+  for (size_t i = 0; i < job._ok.size(); ++i) {
+    if (!job._ok[i]) {
+      okflag = false;
     }
   }
 
   return okflag;
 }
 
+/**
+ * Reads the texture references of every egg file from the StateJournal, for
+ * the benefit of report_pi().
+ */
+void Palettizer::
+load_all_references() {
+  EggFiles::iterator ei;
+  for (ei = _egg_files.begin(); ei != _egg_files.end(); ++ei) {
+    (*ei).second->load_references();
+  }
+}
+
+/**
+ * Writes the texture references of each egg file that has changed in this
+ * session to the StateJournal.  This should be called before the
+ * textures.boo file is written, and the journal committed afterwards.
+ * Returns true if successful, or false if there was some error.
+ */
+bool Palettizer::
+write_references() {
+  vector_string names;
+  EggFiles::const_iterator ei;
+  for (ei = _egg_files.begin(); ei != _egg_files.end(); ++ei) {
+    names.push_back((*ei).first);
+  }
+  if (!_journal.prepare_write(names)) {
+    return false;
+  }
+
+  for (ei = _egg_files.begin(); ei != _egg_files.end(); ++ei) {
+    if (!(*ei).second->write_references(_journal)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 /**
  * Returns the EggFile with the given name.  If there is no EggFile with the
  * indicated name, creates one.  This is the key name used to sort the egg
@@ -785,6 +974,17 @@ add_command_line_egg(EggFile *egg_file) {
   _command_line_eggs.push_back(egg_file);
 }
 
+/**
+ * Writes the indicated message, which should be one or more complete lines,
+ * to nout.  This may be called from any thread; the message is written all at
+ * once, so that it is not interleaved with those from other threads.
+ */
+void Palettizer::
+write_message(const string &message) {
+  MutexHolder holder(_output_lock);
+  nout << message << std::flush;
+}
+
 /**
  * Returns the PaletteGroup with the given name.  If there is no PaletteGroup
  * with the indicated name, creates one.
@@ -947,6 +1147,7 @@ write_datagram(BamWriter *writer, Datagram &datagram) {
   datagram.add_int32((int)_remap_char_uv);
   datagram.add_uint8((int)_cutout_mode);
   datagram.add_float64(_cutout_ratio);
+  datagram.add_uint32(_journal_serial);
 
   writer->write_pointer(datagram, _color_type);
   writer->write_pointer(datagram, _alpha_type);
@@ -1157,6 +1358,9 @@ fillin(DatagramIterator &scan, BamReader *manager) {
     _cutout_mode = (EggRenderMode::AlphaMode)scan.get_uint8();
     _cutout_ratio = scan.get_float64();
   }
+  if (_read_pi_version >= 22) {
+    _journal_serial = scan.get_uint32();
+  }
 
   manager->read_pointer(scan);  // _color_type
   manager->read_pointer(scan);  // _alpha_type
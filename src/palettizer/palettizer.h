@@ -17,12 +17,15 @@
 #include "pandatoolbase.h"
 
 #include "txaFile.h"
+#include "scaledImageCache.h"
+#include "stateJournal.h"
 
 #include "typedWritable.h"
 #include "eggRenderMode.h"
 #include "pvector.h"
 #include "pset.h"
 #include "pmap.h"
+#include "pmutex.h"
 
 class PNMFileType;
 class EggFile;
@@ -43,6 +46,9 @@ public:
   bool get_noabs() const;
   void set_noabs(bool noabs);
 
+  int get_num_threads() const;
+  void set_num_threads(int num_threads);
+
   bool is_valid() const;
   void report_pi() const;
   void report_statistics() const;
@@ -57,11 +63,16 @@ public:
   bool read_stale_eggs(bool redo_all);
   bool write_eggs();
 
+  void load_all_references();
+  bool write_references();
+
   EggFile *get_egg_file(const std::string &name);
   bool remove_egg_file(const std::string &name);
 
   void add_command_line_egg(EggFile *egg_file);
 
+  void write_message(const std::string &message);
+
   PaletteGroup *get_palette_group(const std::string &name);
   PaletteGroup *test_palette_group(const std::string &name) const;
   PaletteGroup *get_default_group();
@@ -92,6 +103,9 @@ public:
   std::string _default_groupname;
   std::string _default_groupdir;
   bool _noabs;
+  int _num_threads;
+  ScaledImageCache _scaled_image_cache;
+  StateJournal _journal;
 
   // The following parameter values specifically relate to textures and
   // palettes.  These values are stored in the textures.boo file for future
@@ -119,7 +133,16 @@ public:
   EggRenderMode::AlphaMode _cutout_mode;
   double _cutout_ratio;
 
+  // This is the serial number of the session that last wrote the
+  // textures.boo file, which identifies the records it goes with in the
+  // StateJournal.
+  unsigned int _journal_serial;
+
 private:
+  // This protects nout while the egg files are read and written on several
+  // threads.
+  Mutex _output_lock;
+
   typedef pvector<TexturePlacement *> Placements;
   void compute_statistics(std::ostream &out, int indent_level,
                           const Placements &placements) const;
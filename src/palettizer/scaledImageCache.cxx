@@ -0,0 +1,367 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file scaledImageCache.cxx
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#include "scaledImageCache.h"
+#include "imageFile.h"
+
+#include "pnmImage.h"
+#include "datagram.h"
+#include "datagramIterator.h"
+#include "mutexHolder.h"
+#include "string_utils.h"
+#include "pvector.h"
+
+#include <stdio.h>
+#include <fstream>
+#include <sstream>
+
+// This identifies the filter used to scale the images.  It should be changed
+// whenever TextureImage::read_scaled_source_image() changes the way it scales
+// the source image, so that stale entries are not reused.
+static const char *const scaled_image_filter = "quick1";
+
+// The first bytes of each cache file.
+static const std::string scaled_image_magic = "pscl";
+
+/**
+ *
+ */
+ScaledImageCache::
+ScaledImageCache() {
+  _num_hits = 0;
+  _num_misses = 0;
+  _next_temp = 0;
+}
+
+/**
+ * Specifies the directory in which the cached images are stored.  If this is
+ * empty, the cache is disabled.
+ */
+void ScaledImageCache::
+set_dirname(const Filename &dirname) {
+  _dirname = dirname;
+}
+
+/**
+ * Returns the directory in which the cached images are stored, or the empty
+ * string if the cache is disabled.
+ */
+const Filename &ScaledImageCache::
+get_dirname() const {
+  return _dirname;
+}
+
+/**
+ * Returns true if a cache directory has been specified, false otherwise.
+ */
+bool ScaledImageCache::
+is_enabled() const {
+  return !_dirname.empty();
+}
+
+/**
+ * Computes the key for the indicated source image, scaled to the indicated
+ * size.  Returns true on success, or false if the source image could not be
+ * read (in which case it should not be cached).
+ */
+bool ScaledImageCache::
+make_key(std::string &key, const ImageFile *source,
+         int x_size, int y_size) const {
+  uint64_t color_hash;
+  if (!hash_file(source->get_filename(), color_hash)) {
+    return false;
+  }
+
+  uint64_t alpha_hash = 0;
+  const Filename &alpha_filename = source->get_alpha_filename();
+  if (!alpha_filename.empty() && alpha_filename.exists()) {
+    if (!hash_file(alpha_filename, alpha_hash)) {
+      return false;
+    }
+  }
+
+  char buffer[128];
+  sprintf(buffer, "%016llx_%016llx_%d_%dx%d_%s",
+          (unsigned long long)color_hash, (unsigned long long)alpha_hash,
+          source->get_alpha_file_channel(), x_size, y_size,
+          scaled_image_filter);
+  key = buffer;
+  return true;
+}
+
+/**
+ * Looks up the image with the indicated key in the cache.  If it is found,
+ * fills in image and returns true; otherwise, returns false.  Either way, the
+ * lookup is counted in the hit/miss statistics.
+ */
+bool ScaledImageCache::
+read(const std::string &key, PNMImage &image) {
+  Filename filename = get_cache_filename(key);
+  filename.set_binary();
+
+  std::string data;
+  bool got_data = false;
+  {
+    std::ifstream in;
+    if (filename.open_read(in)) {
+      std::ostringstream strm;
+      strm << in.rdbuf();
+      data = strm.str();
+      got_data = !in.fail() || in.eof();
+    }
+  }
+
+  bool valid = false;
+  if (got_data && data.size() > scaled_image_magic.size() &&
+      data.compare(0, scaled_image_magic.size(), scaled_image_magic) == 0) {
+    Datagram datagram(data.data() + scaled_image_magic.size(),
+                      data.size() - scaled_image_magic.size());
+    DatagramIterator scan(datagram);
+
+    int x_size = scan.get_int32();
+    int y_size = scan.get_int32();
+    int num_channels = scan.get_uint8();
+    xelval maxval = scan.get_uint16();
+
+    size_t num_pixels = (size_t)x_size * (size_t)y_size;
+    size_t expected = num_pixels * num_channels * 2;
+    if (x_size >= 0 && y_size >= 0 && num_channels >= 1 &&
+        num_channels <= 4 && scan.get_remaining_size() == expected) {
+      image.clear(x_size, y_size, num_channels, maxval);
+      bool has_color = (num_channels >= 3);
+      bool has_alpha = (num_channels == 2 || num_channels == 4);
+      for (int y = 0; y < y_size; ++y) {
+        for (int x = 0; x < x_size; ++x) {
+          if (has_color) {
+            xelval r = scan.get_uint16();
+            xelval g = scan.get_uint16();
+            xelval b = scan.get_uint16();
+            image.set_xel_val(x, y, r, g, b);
+          } else {
+            image.set_gray_val(x, y, scan.get_uint16());
+          }
+          if (has_alpha) {
+            image.set_alpha_val(x, y, scan.get_uint16());
+          }
+        }
+      }
+      valid = true;
+    }
+  }
+
+  MutexHolder holder(_lock);
+  if (valid) {
+    ++_num_hits;
+  } else {
+    ++_num_misses;
+  }
+  return valid;
+}
+
+/**
+ * Stores the indicated image in the cache under the indicated key.  Failure
+ * to write the cache is not an error; the image simply won't be found next
+ * time.
+ */
+void ScaledImageCache::
+write(const std::string &key, const PNMImage &image) {
+  Datagram datagram;
+  datagram.append_data(scaled_image_magic.data(), scaled_image_magic.size());
+
+  int x_size = image.get_x_size();
+  int y_size = image.get_y_size();
+  int num_channels = image.get_num_channels();
+  datagram.add_int32(x_size);
+  datagram.add_int32(y_size);
+  datagram.add_uint8(num_channels);
+  datagram.add_uint16(image.get_maxval());
+
+  bool has_color = !image.is_grayscale();
+  bool has_alpha = image.has_alpha();
+  for (int y = 0; y < y_size; ++y) {
+    for (int x = 0; x < x_size; ++x) {
+      if (has_color) {
+        datagram.add_uint16(image.get_red_val(x, y));
+        datagram.add_uint16(image.get_green_val(x, y));
+        datagram.add_uint16(image.get_blue_val(x, y));
+      } else {
+        datagram.add_uint16(image.get_gray_val(x, y));
+      }
+      if (has_alpha) {
+        datagram.add_uint16(image.get_alpha_val(x, y));
+      }
+    }
+  }
+
+  // Write to a temporary file first, and then rename it into place, so that
+  // a concurrent reader (or a later session, if we are interrupted) never
+  // sees a partially-written entry.
+  Filename filename = get_cache_filename(key);
+  Filename temp_filename;
+  {
+    MutexHolder holder(_lock);
+    temp_filename = Filename(filename.get_fullpath() + ".tmp" + format_string(_next_temp));
+    ++_next_temp;
+  }
+  temp_filename.set_binary();
+  temp_filename.make_dir();
+
+  std::ofstream out;
+  if (!temp_filename.open_write(out)) {
+    return;
+  }
+  out.write((const char *)datagram.get_data(), datagram.get_length());
+  out.close();
+  if (out.fail()) {
+    temp_filename.unlink();
+    return;
+  }
+
+  if (!temp_filename.rename_to(filename)) {
+    temp_filename.unlink();
+  }
+}
+
+/**
+ * Returns the number of lookups this session that found a usable image in the
+ * cache.
+ */
+int ScaledImageCache::
+get_num_hits() const {
+  return _num_hits;
+}
+
+/**
+ * Returns the number of lookups this session that did not find a usable
+ * image in the cache, and had to read and scale the source image instead.
+ */
+int ScaledImageCache::
+get_num_misses() const {
+  return _num_misses;
+}
+
+/**
+ * Reads the cumulative hit and miss counts, over all the sessions that have
+ * used this cache directory, as recorded by write_totals().  Returns true on
+ * success, or false if the counts have not been recorded or could not be
+ * read.
+ */
+bool ScaledImageCache::
+read_totals(uint64_t &hits, uint64_t &misses) const {
+  hits = 0;
+  misses = 0;
+  if (!is_enabled()) {
+    return false;
+  }
+
+  Filename filename = get_totals_filename();
+  filename.set_text();
+  std::ifstream in;
+  if (!filename.open_read(in)) {
+    return false;
+  }
+
+  std::string hits_word, misses_word;
+  in >> hits_word >> hits >> misses_word >> misses;
+  if (in.fail() || hits_word != "hits" || misses_word != "misses") {
+    hits = 0;
+    misses = 0;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Adds this session's hit and miss counts to the cumulative counts stored in
+ * the cache directory, so that they may be reported later by
+ * Palettizer::report_statistics().  This should be called once, after all the
+ * images have been generated.
+ *
+ * The file is replaced by rename, so it is never seen half-written, but two
+ * sessions that finish at the same moment may lose one another's counts;
+ * they are for the user's information only.
+ */
+void ScaledImageCache::
+write_totals() {
+  if (!is_enabled() || (_num_hits == 0 && _num_misses == 0)) {
+    return;
+  }
+
+  uint64_t hits, misses;
+  read_totals(hits, misses);
+  hits += _num_hits;
+  misses += _num_misses;
+
+  Filename filename = get_totals_filename();
+  Filename temp_filename = Filename::temporary(_dirname, "stats");
+  temp_filename.set_text();
+  temp_filename.make_dir();
+
+  std::ofstream out;
+  if (!temp_filename.open_write(out)) {
+    return;
+  }
+  out << "hits " << hits << "\n"
+      << "misses " << misses << "\n";
+  out.close();
+  if (out.fail() || !temp_filename.rename_to(filename)) {
+    temp_filename.unlink();
+  }
+}
+
+/**
+ * Computes a 64-bit FNV-1a hash of the contents of the indicated file.
+ * Returns true on success, false if the file could not be read.
+ */
+bool ScaledImageCache::
+hash_file(const Filename &filename, uint64_t &hash) {
+  Filename binary_filename = Filename::binary_filename(filename);
+  std::ifstream in;
+  if (!binary_filename.open_read(in)) {
+    return false;
+  }
+
+  hash = 14695981039346656037ULL;
+  static const size_t buffer_size = 65536;
+  pvector<char> buffer(buffer_size);
+  while (in) {
+    in.read(&buffer[0], buffer_size);
+    size_t count = (size_t)in.gcount();
+    for (size_t i = 0; i < count; ++i) {
+      hash ^= (unsigned char)buffer[i];
+      hash *= 1099511628211ULL;
+    }
+  }
+
+  return !in.bad();
+}
+
+/**
+ * Returns the name of the file in the cache directory that stores the image
+ * with the indicated key.  The entries are spread among subdirectories by the
+ * first two characters of the key, to keep any one directory from growing too
+ * large.
+ */
+Filename ScaledImageCache::
+get_cache_filename(const std::string &key) const {
+  return Filename(_dirname, key.substr(0, 2) + "/" + key + ".pscl");
+}
+
+/**
+ * Returns the name of the file in the cache directory that stores the
+ * cumulative hit and miss counts.
+ */
+Filename ScaledImageCache::
+get_totals_filename() const {
+  return Filename(_dirname, "stats.txt");
+}
@@ -0,0 +1,67 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file scaledImageCache.h
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#ifndef SCALEDIMAGECACHE_H
+#define SCALEDIMAGECACHE_H
+
+#include "pandatoolbase.h"
+
+#include "filename.h"
+#include "pmutex.h"
+
+class ImageFile;
+class PNMImage;
+
+/**
+ * This is an on-disk cache of source texture images that have already been
+ * scaled to the size at which they are placed on a palette.  It persists
+ * between sessions, so that an incremental egg-palettize run need not decode
+ * and filter every source image again just to repaint a palette.
+ *
+ * Each entry is keyed on the contents of the source image file (and its
+ * alpha file, if any), rather than on the filename or timestamp, along with
+ * the target size and the filter used to scale it.
+ */
+class ScaledImageCache {
+public:
+  ScaledImageCache();
+
+  void set_dirname(const Filename &dirname);
+  const Filename &get_dirname() const;
+  bool is_enabled() const;
+
+  bool make_key(std::string &key, const ImageFile *source,
+                int x_size, int y_size) const;
+  bool read(const std::string &key, PNMImage &image);
+  void write(const std::string &key, const PNMImage &image);
+
+  int get_num_hits() const;
+  int get_num_misses() const;
+
+  bool read_totals(uint64_t &hits, uint64_t &misses) const;
+  void write_totals();
+
+private:
+  static bool hash_file(const Filename &filename, uint64_t &hash);
+  Filename get_cache_filename(const std::string &key) const;
+  Filename get_totals_filename() const;
+
+  Filename _dirname;
+
+  Mutex _lock;
+  int _num_hits;
+  int _num_misses;
+  int _next_temp;
+};
+
+#endif
@@ -0,0 +1,502 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file stateJournal.cxx
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#include "stateJournal.h"
+
+#include "datagramIterator.h"
+
+// The first bytes of the journal file, followed by its version number.
+static const std::string journal_magic = "pjnl";
+static const uint32_t journal_version = 1;
+static const std::streamoff journal_header_size = 8;
+
+// Each entry in the file is a header giving the size and checksum of its
+// payload, followed by the payload itself, which begins with one of these
+// type codes.  A record entry continues with the egg file's name and then
+// its data; a commit entry continues with the session's serial number.
+static const std::streamoff entry_header_size = 8;
+enum EntryType {
+  ET_record = 1,
+  ET_commit = 2,
+};
+
+// The file is rewritten once the superseded entries take up more than this
+// many bytes, and more than the current ones do.
+static const std::streamoff min_rewrite_waste = 1024 * 1024;
+
+/**
+ *
+ */
+StateJournal::
+StateJournal() {
+  _out_open = false;
+  _end = 0;
+  _serial = 0;
+  _needs_rewrite = false;
+  _uncommitted = false;
+}
+
+/**
+ *
+ */
+StateJournal::
+~StateJournal() {
+  close();
+}
+
+/**
+ * Opens the journal that goes with a textures.boo file that recorded the
+ * indicated serial number, and indexes the records within it.  The records
+ * themselves are not read until read_record() asks for them.  Returns true
+ * on success, or false if the journal is missing or unreadable, or does not
+ * contain the session that wrote textures.boo.
+ *
+ * A serial number of 0 means that textures.boo was written without a
+ * journal, either because it is new or because it was written by an older
+ * version of egg-palettize.  In this case any existing file is ignored, and
+ * will be replaced by prepare_write().
+ */
+bool StateJournal::
+open(const Filename &filename, unsigned int state_serial) {
+  close();
+  _filename = Filename::binary_filename(filename);
+
+  if (state_serial == 0) {
+    _needs_rewrite = true;
+    return true;
+  }
+
+  if (!_filename.open_read(_in)) {
+    return false;
+  }
+
+  char header[journal_header_size];
+  _in.read(header, journal_header_size);
+  if (_in.gcount() != journal_header_size) {
+    return false;
+  }
+  Datagram header_data(header, journal_header_size);
+  DatagramIterator header_scan(header_data);
+  if (header_scan.extract_bytes(journal_magic.size()) != journal_magic ||
+      header_scan.get_uint32() != journal_version) {
+    return false;
+  }
+
+  // The records that follow the last commit marker are held aside until we
+  // know whether they belong with textures.boo.
+  Entries uncommitted;
+  std::streamoff file_size = _filename.get_file_size();
+  std::streamoff pos = journal_header_size;
+  while (pos < file_size) {
+    char entry_header[entry_header_size + 3];
+    _in.seekg(pos);
+    _in.read(entry_header, entry_header_size + 3);
+    if (_in.gcount() != entry_header_size + 3) {
+      break;
+    }
+    Datagram entry_data(entry_header, entry_header_size + 3);
+    DatagramIterator scan(entry_data);
+
+    Entry entry;
+    entry._offset = pos;
+    entry._size = scan.get_uint32();
+    scan.skip_bytes(4);
+    std::streamoff next =
+      pos + entry_header_size + (std::streamoff)entry._size;
+    if (entry._size < 3 || next > file_size) {
+      // This entry was cut short, presumably by an interrupted session.
+      break;
+    }
+
+    int type = scan.get_uint8();
+    if (type == ET_record) {
+      size_t name_length = scan.get_uint16();
+      if (3 + name_length > entry._size) {
+        break;
+      }
+      std::string name(name_length, '\0');
+      _in.read(&name[0], name_length);
+      if (_in.gcount() != (std::streamsize)name_length) {
+        break;
+      }
+      uncommitted[name] = entry;
+
+    } else if (type == ET_commit) {
+      Datagram payload;
+      if (!read_payload(entry, payload)) {
+        break;
+      }
+      DatagramIterator payload_scan(payload);
+      payload_scan.skip_bytes(1);
+      _serial = payload_scan.get_uint32();
+
+      Entries::const_iterator ei;
+      for (ei = uncommitted.begin(); ei != uncommitted.end(); ++ei) {
+        _records[(*ei).first] = (*ei).second;
+      }
+      uncommitted.clear();
+
+    } else {
+      break;
+    }
+
+    pos = next;
+  }
+  _in.clear();
+
+  if (pos < file_size) {
+    // Whatever follows is incomplete or unreadable.  It is dropped when the
+    // file is next written.
+    _needs_rewrite = true;
+  }
+
+  if (state_serial == _serial + 1) {
+    // textures.boo was written by a session that was interrupted before it
+    // could append its commit marker, so its records are good.
+    Entries::const_iterator ei;
+    for (ei = uncommitted.begin(); ei != uncommitted.end(); ++ei) {
+      _records[(*ei).first] = (*ei).second;
+    }
+    _serial = state_serial;
+
+  } else if (!uncommitted.empty()) {
+    // These were written by a session that was interrupted before it could
+    // write textures.boo, so they don't go with the state we have.
+    _needs_rewrite = true;
+  }
+
+  if (state_serial > _serial) {
+    return false;
+  }
+
+  _end = pos;
+  return true;
+}
+
+/**
+ * Closes the journal file, and forgets its records.
+ */
+void StateJournal::
+close() {
+  _in.close();
+  _in.clear();
+  if (_out_open) {
+    _out.close();
+    _out.clear();
+    _out_open = false;
+  }
+
+  _records.clear();
+  _end = 0;
+  _serial = 0;
+  _needs_rewrite = false;
+  _uncommitted = false;
+}
+
+/**
+ * Returns the name of the journal file.
+ */
+const Filename &StateJournal::
+get_filename() const {
+  return _filename;
+}
+
+/**
+ * Returns the serial number of the last session whose records are in the
+ * journal.  The next session to save its state should use the following
+ * number.
+ */
+unsigned int StateJournal::
+get_serial() const {
+  return _serial;
+}
+
+/**
+ * Returns true if any records have been written by write_record() since the
+ * last commit().
+ */
+bool StateJournal::
+has_uncommitted() const {
+  return _uncommitted;
+}
+
+/**
+ * Reads the current record for the named egg file into the indicated
+ * datagram.  Returns true on success, or false if there is no such record
+ * or it could not be read.
+ */
+bool StateJournal::
+read_record(const std::string &name, Datagram &data) {
+  Entries::const_iterator ei = _records.find(name);
+  if (ei == _records.end()) {
+    return false;
+  }
+
+  Datagram payload;
+  if (!read_payload((*ei).second, payload)) {
+    return false;
+  }
+
+  DatagramIterator scan(payload);
+  if (scan.get_uint8() != ET_record || scan.get_string() != name) {
+    return false;
+  }
+
+  data.clear();
+  data.append_data((const unsigned char *)payload.get_data() +
+                   scan.get_current_index(),
+                   scan.get_remaining_size());
+  return true;
+}
+
+/**
+ * Called before the first write_record() of a session, with the names of
+ * all the egg files whose records are still wanted.  If the file needs to be
+ * rewritten, because it is new, because it ends with something that must be
+ * dropped, or because it is mostly records that have been superseded or
+ * whose egg files have been removed, it is rewritten here with only the
+ * wanted records.  Returns true on success.
+ */
+bool StateJournal::
+prepare_write(const vector_string &names) {
+  if (!_needs_rewrite) {
+    std::streamoff live = journal_header_size;
+    vector_string::const_iterator ni;
+    for (ni = names.begin(); ni != names.end(); ++ni) {
+      Entries::const_iterator ei = _records.find(*ni);
+      if (ei != _records.end()) {
+        live += entry_header_size + (std::streamoff)(*ei).second._size;
+      }
+    }
+
+    std::streamoff waste = _end - live;
+    if (waste > live && waste > min_rewrite_waste) {
+      _needs_rewrite = true;
+    }
+  }
+
+  if (_needs_rewrite) {
+    return rewrite(names);
+  }
+  return true;
+}
+
+/**
+ * Appends a new record for the named egg file, which supersedes any previous
+ * record for it.  It is not used by a future session until commit() has been
+ * called, or textures.boo has been written with the new serial number.
+ * Returns true on success.
+ */
+bool StateJournal::
+write_record(const std::string &name, const Datagram &data) {
+  nassertr(!_needs_rewrite, false);
+  if (!_out_open) {
+    if (!_filename.open_append(_out)) {
+      return false;
+    }
+    _out_open = true;
+  }
+
+  Datagram payload;
+  payload.add_uint8(ET_record);
+  payload.add_string(name);
+  payload.append_data(data.get_data(), data.get_length());
+  if (!write_entry(_out, payload)) {
+    return false;
+  }
+
+  Entry entry;
+  entry._offset = _end;
+  entry._size = payload.get_length();
+  _records[name] = entry;
+  _end += entry_header_size + (std::streamoff)entry._size;
+  _uncommitted = true;
+  return true;
+}
+
+/**
+ * Appends a commit marker with the indicated serial number, which makes the
+ * records written since the last one permanent, and flushes the file.  This
+ * should be called after textures.boo has been written, if it needed to be.
+ * Returns true on success.
+ */
+bool StateJournal::
+commit(unsigned int serial) {
+  nassertr(!_needs_rewrite, false);
+  if (!_out_open) {
+    if (!_filename.open_append(_out)) {
+      return false;
+    }
+    _out_open = true;
+  }
+
+  Datagram payload;
+  payload.add_uint8(ET_commit);
+  payload.add_uint32(serial);
+  if (!write_entry(_out, payload)) {
+    return false;
+  }
+  _out.flush();
+  if (_out.fail()) {
+    return false;
+  }
+
+  _end += entry_header_size + (std::streamoff)payload.get_length();
+  _serial = serial;
+  _uncommitted = false;
+  return true;
+}
+
+/**
+ * Reads the payload of the indicated entry, and checks it against the
+ * checksum in its header.  Returns true on success.
+ */
+bool StateJournal::
+read_payload(const Entry &entry, Datagram &payload) {
+  _in.clear();
+  _in.seekg(entry._offset);
+
+  char header[entry_header_size];
+  _in.read(header, entry_header_size);
+  if (_in.gcount() != entry_header_size) {
+    return false;
+  }
+  Datagram header_data(header, entry_header_size);
+  DatagramIterator scan(header_data);
+  size_t size = scan.get_uint32();
+  uint32_t checksum = scan.get_uint32();
+  if (size != entry._size) {
+    return false;
+  }
+
+  std::string buffer(size, '\0');
+  _in.read(&buffer[0], size);
+  if (_in.gcount() != (std::streamsize)size) {
+    return false;
+  }
+
+  payload.clear();
+  payload.append_data(buffer.data(), size);
+  return compute_checksum(payload) == checksum;
+}
+
+/**
+ * Writes an entry with the indicated payload to the stream.  Returns true on
+ * success.
+ */
+bool StateJournal::
+write_entry(std::ostream &out, const Datagram &payload) {
+  Datagram header;
+  header.add_uint32(payload.get_length());
+  header.add_uint32(compute_checksum(payload));
+  out.write((const char *)header.get_data(), header.get_length());
+  out.write((const char *)payload.get_data(), payload.get_length());
+  return !out.fail();
+}
+
+/**
+ * Writes a new journal file with the current records of the named egg files,
+ * followed by a commit marker with the current serial number, and moves it
+ * into place of the old one.  Returns true on success.
+ */
+bool StateJournal::
+rewrite(const vector_string &names) {
+  std::string dirname = _filename.get_dirname();
+  if (dirname.empty()) {
+    dirname = ".";
+  }
+  Filename temp_filename = Filename::temporary(dirname, "jnl");
+  temp_filename.set_binary();
+
+  std::ofstream out;
+  if (!temp_filename.open_write(out)) {
+    return false;
+  }
+
+  Datagram header;
+  header.append_data(journal_magic.data(), journal_magic.size());
+  header.add_uint32(journal_version);
+  out.write((const char *)header.get_data(), header.get_length());
+  bool okflag = !out.fail();
+
+  Entries records;
+  std::streamoff pos = journal_header_size;
+  vector_string::const_iterator ni;
+  for (ni = names.begin(); ni != names.end() && okflag; ++ni) {
+    Entries::const_iterator ei = _records.find(*ni);
+    if (ei != _records.end()) {
+      Datagram payload;
+      if (!read_payload((*ei).second, payload) ||
+          !write_entry(out, payload)) {
+        okflag = false;
+
+      } else {
+        Entry entry;
+        entry._offset = pos;
+        entry._size = payload.get_length();
+        records[*ni] = entry;
+        pos += entry_header_size + (std::streamoff)entry._size;
+      }
+    }
+  }
+
+  if (okflag) {
+    Datagram payload;
+    payload.add_uint8(ET_commit);
+    payload.add_uint32(_serial);
+    okflag = write_entry(out, payload);
+    pos += entry_header_size + (std::streamoff)payload.get_length();
+  }
+
+  out.close();
+  if (!okflag || out.fail()) {
+    temp_filename.unlink();
+    return false;
+  }
+
+  _in.close();
+  _in.clear();
+  if (_out_open) {
+    _out.close();
+    _out.clear();
+    _out_open = false;
+  }
+
+  if (!temp_filename.rename_to(_filename)) {
+    temp_filename.unlink();
+    return false;
+  }
+  if (!_filename.open_read(_in)) {
+    return false;
+  }
+
+  _records.swap(records);
+  _end = pos;
+  _needs_rewrite = false;
+  return true;
+}
+
+/**
+ * Returns a 32-bit FNV-1a hash of the payload.  This is only meant to catch
+ * an entry that was not completely written.
+ */
+uint32_t StateJournal::
+compute_checksum(const Datagram &payload) {
+  const unsigned char *p = (const unsigned char *)payload.get_data();
+  const unsigned char *end = p + payload.get_length();
+  uint32_t hash = 2166136261U;
+  for (; p != end; ++p) {
+    hash = (hash ^ *p) * 16777619U;
+  }
+  return hash;
+}
@@ -0,0 +1,85 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file stateJournal.h
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#ifndef STATEJOURNAL_H
+#define STATEJOURNAL_H
+
+#include "pandatoolbase.h"
+
+#include "filename.h"
+#include "datagram.h"
+#include "vector_string.h"
+#include "pmap.h"
+
+#include <fstream>
+
+/**
+ * This is the file, kept alongside textures.boo, that holds the texture
+ * references of each egg file as a separate record.  Since textures.boo no
+ * longer holds them, a session reads only the records of the egg files it
+ * actually involves, and appends new records only for the egg files whose
+ * references have changed.
+ *
+ * The file is only ever appended to.  Each session that saves its state
+ * appends its changed records, and then a commit marker with a serial
+ * number; textures.boo records the serial number of the session that last
+ * wrote it.  Records that follow the last commit marker are used only if
+ * textures.boo was written by the same session, so that a session that is
+ * interrupted partway through saving leaves the two files consistent.  When
+ * most of the file is taken up by records that have since been superseded,
+ * it is rewritten with only the current ones.
+ */
+class StateJournal {
+public:
+  StateJournal();
+  ~StateJournal();
+
+  bool open(const Filename &filename, unsigned int state_serial);
+  void close();
+
+  const Filename &get_filename() const;
+  unsigned int get_serial() const;
+  bool has_uncommitted() const;
+
+  bool read_record(const std::string &name, Datagram &data);
+
+  bool prepare_write(const vector_string &names);
+  bool write_record(const std::string &name, const Datagram &data);
+  bool commit(unsigned int serial);
+
+private:
+  class Entry {
+  public:
+    std::streamoff _offset;
+    size_t _size;
+  };
+  typedef pmap<std::string, Entry> Entries;
+
+  bool read_payload(const Entry &entry, Datagram &payload);
+  bool write_entry(std::ostream &out, const Datagram &payload);
+  bool rewrite(const vector_string &names);
+  static uint32_t compute_checksum(const Datagram &payload);
+
+  Filename _filename;
+  std::ifstream _in;
+  std::ofstream _out;
+  bool _out_open;
+
+  Entries _records;
+  std::streamoff _end;
+  unsigned int _serial;
+  bool _needs_rewrite;
+  bool _uncommitted;
+};
+
+#endif
@@ -0,0 +1,250 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_placement.cxx
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#include "occupancyGrid.h"
+#include "trueClock.h"
+#include "pvector.h"
+#include "pnotify.h"
+
+#include <stdlib.h>
+#include <algorithm>
+
+// This program times the placement of many randomly-sized textures onto
+// palette images, using OccupancyGrid as PaletteImage does, and for
+// comparison using the original packer, which tested each candidate position
+// against every texture already placed.  The textures are placed in the same
+// order as PalettePage::place_all(), biggest first, each one on the first
+// image where it fits, starting a new image when it fits on none of them.
+
+class Rect {
+public:
+  int _x, _y;
+  int _x_size, _y_size;
+};
+typedef pvector<Rect> Rects;
+
+/**
+ * Sorts rectangles from biggest to smallest, in the manner of
+ * SortPlacementBySize.
+ */
+class SortRectBySize {
+public:
+  bool operator ()(const Rect &a, const Rect &b) const {
+    if (a._y_size != b._y_size) {
+      return a._y_size > b._y_size;
+    }
+    return a._x_size > b._x_size;
+  }
+};
+
+/**
+ * One palette image, as packed by the original PaletteImage::find_hole().
+ */
+class LinearImage {
+public:
+  LinearImage(int pal_size);
+
+  bool place(Rect &rect);
+  bool find_hole(int &x, int &y, int x_size, int y_size) const;
+  const Rect *find_overlap(int x, int y, int x_size, int y_size) const;
+
+  int _x_size, _y_size;
+  Rects _placed;
+};
+
+/**
+ * One palette image, as packed by OccupancyGrid.
+ */
+class GridImage {
+public:
+  GridImage(int pal_size);
+
+  bool place(Rect &rect);
+
+  OccupancyGrid _grid;
+};
+
+/**
+ *
+ */
+LinearImage::
+LinearImage(int pal_size) :
+  _x_size(pal_size),
+  _y_size(pal_size)
+{
+}
+
+/**
+ * Places the rectangle on the image, if it fits.
+ */
+bool LinearImage::
+place(Rect &rect) {
+  if (!find_hole(rect._x, rect._y, rect._x_size, rect._y_size)) {
+    return false;
+  }
+  _placed.push_back(rect);
+  return true;
+}
+
+/**
+ * The original search for a hole: each row is scanned from the left, and the
+ * next row considered is the nearest bottom edge of any texture that blocked
+ * this one.
+ */
+bool LinearImage::
+find_hole(int &x, int &y, int x_size, int y_size) const {
+  y = 0;
+  while (y + y_size <= _y_size) {
+    int next_y = _y_size;
+    x = 0;
+    while (x + x_size <= _x_size) {
+      const Rect *overlap = find_overlap(x, y, x_size, y_size);
+      if (overlap == nullptr) {
+        return true;
+      }
+
+      next_y = std::min(next_y, overlap->_y + overlap->_y_size);
+      x = overlap->_x + overlap->_x_size;
+    }
+    y = next_y;
+  }
+
+  return false;
+}
+
+/**
+ * Returns the first placed rectangle that overlaps the indicated one, or
+ * NULL if there is none.
+ */
+const Rect *LinearImage::
+find_overlap(int x, int y, int x_size, int y_size) const {
+  Rects::const_iterator ri;
+  for (ri = _placed.begin(); ri != _placed.end(); ++ri) {
+    const Rect &rect = (*ri);
+    if (!(x >= rect._x + rect._x_size || x + x_size <= rect._x ||
+          y >= rect._y + rect._y_size || y + y_size <= rect._y)) {
+      return &rect;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ *
+ */
+GridImage::
+GridImage(int pal_size) {
+  _grid.reset(pal_size, pal_size);
+}
+
+/**
+ * Places the rectangle on the image, if it fits.
+ */
+bool GridImage::
+place(Rect &rect) {
+  if (!_grid.find_hole(rect._x, rect._y, rect._x_size, rect._y_size)) {
+    return false;
+  }
+  _grid.add(rect._x, rect._y, rect._x_size, rect._y_size);
+  return true;
+}
+
+/**
+ * Places each of the rectangles on the first of the images on which it fits,
+ * creating new images of the indicated size as needed.  Returns the number of
+ * images used.
+ */
+template<class Image>
+static int
+place_all(Rects &rects, pvector<Image> &images, int pal_size) {
+  Rects::iterator ri;
+  for (ri = rects.begin(); ri != rects.end(); ++ri) {
+    bool placed = false;
+    for (size_t i = 0; i < images.size() && !placed; ++i) {
+      placed = images[i].place(*ri);
+    }
+    if (!placed) {
+      images.push_back(Image(pal_size));
+      placed = images.back().place(*ri);
+      nassertr(placed, (int)images.size());
+    }
+  }
+  return (int)images.size();
+}
+
+int
+main(int argc, char *argv[]) {
+  if (argc > 4) {
+    nout << "test_placement [num_textures [palette_size [seed]]]\n";
+    exit(1);
+  }
+
+  int num_textures = (argc > 1) ? atoi(argv[1]) : 2000;
+  int pal_size = (argc > 2) ? atoi(argv[2]) : 2048;
+  unsigned int seed = (argc > 3) ? (unsigned int)atoi(argv[3]) : 1;
+  if (num_textures < 1 || pal_size < 16) {
+    nout << "Invalid parameters.\n";
+    exit(1);
+  }
+
+  // Mostly small textures, with the occasional big one, as in a typical
+  // character palette.
+  srand(seed);
+  Rects rects(num_textures);
+  int max_size = std::max(pal_size / 8, 4);
+  int64_t total_area = 0;
+  for (int i = 0; i < num_textures; ++i) {
+    int scale = (rand() % 16 == 0) ? max_size : max_size / 4;
+    rects[i]._x_size = 4 + rand() % std::max(scale - 3, 1);
+    rects[i]._y_size = 4 + rand() % std::max(scale - 3, 1);
+    rects[i]._x = rects[i]._y = 0;
+    total_area += (int64_t)rects[i]._x_size * rects[i]._y_size;
+  }
+  std::sort(rects.begin(), rects.end(), SortRectBySize());
+
+  nout << "Placing " << num_textures << " textures on " << pal_size << "x"
+       << pal_size << " palettes.\n";
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  int64_t pal_area = (int64_t)pal_size * pal_size;
+
+  Rects linear_rects = rects;
+  pvector<LinearImage> linear_images;
+  double start = clock->get_short_time();
+  int num_linear = place_all(linear_rects, linear_images, pal_size);
+  double linear_time = clock->get_short_time() - start;
+
+  Rects grid_rects = rects;
+  pvector<GridImage> grid_images;
+  start = clock->get_short_time();
+  int num_grid = place_all(grid_rects, grid_images, pal_size);
+  double grid_time = clock->get_short_time() - start;
+
+  int num_moved = 0;
+  for (int i = 0; i < num_textures; ++i) {
+    if (linear_rects[i]._x != grid_rects[i]._x ||
+        linear_rects[i]._y != grid_rects[i]._y) {
+      ++num_moved;
+    }
+  }
+
+  nout << "  linear scan:    " << linear_time << " s, " << num_linear
+       << " images, " << 100.0 * total_area / (pal_area * num_linear)
+       << "% utilization\n"
+       << "  occupancy grid: " << grid_time << " s, " << num_grid
+       << " images, " << 100.0 * total_area / (pal_area * num_grid)
+       << "% utilization\n"
+       << "  " << num_moved << " textures placed differently.\n";
+
+  return (0);
+}
@@ -19,6 +19,7 @@
 #include "paletteImage.h"
 #include "texturePlacement.h"
 #include "filenameUnifier.h"
+#include "palettizer.h"
 #include "string_utils.h"
 #include "indent.h"
 #include "datagram.h"
@@ -28,6 +29,7 @@
 #include "pnmFileType.h"
 #include "indirectCompareNames.h"
 #include "pvector.h"
+#include "mutexHolder.h"
 
 #include <iterator>
 
@@ -54,6 +56,7 @@ TextureImage() {
   _txa_wrap_v = EggTexture::WM_unspecified;
   _texture_named = false;
   _got_txa_file = false;
+  _txa_matches_known = false;
 }
 
 /**
@@ -278,6 +281,7 @@ pre_txa_file() {
 
   _request.pre_txa_file();
   _is_surprise = true;
+  _txa_matches.clear();
 }
 
 /**
@@ -288,6 +292,7 @@ pre_txa_file() {
 void TextureImage::
 post_txa_file() {
   _got_txa_file = true;
+  _txa_matches_known = true;
 
   // First, get the actual size of the texture.
   SourceTextureImage *source = get_preferred_source();
@@ -413,6 +418,26 @@ got_txa_file() const {
   return _got_txa_file;
 }
 
+/**
+ * Records that the indicated .txa line was found to match this texture.  This
+ * is called by the TxaFile while the texture is being matched, and is used
+ * only for reporting.
+ */
+void TextureImage::
+add_txa_match(const string &description) {
+  _txa_matches.push_back(description);
+}
+
+/**
+ * Returns the list of .txa lines that matched this texture, in the order they
+ * were applied.  Normally this is just one line, unless some lines specified
+ * the "cont" keyword.
+ */
+const vector_string &TextureImage::
+get_txa_matches() const {
+  return _txa_matches;
+}
+
 /**
  * Calls determine_size() on each TexturePlacement for the texture, to ensure
  * that each TexturePlacement is still requesting the best possible size for
@@ -733,6 +758,51 @@ release_source_image() {
   }
 }
 
+/**
+ * Reads in the original image, scales it to the indicated size, and stores
+ * the result in the indicated PNMImage.  Returns true on success, or false if
+ * the source image could not be read.
+ *
+ * Unlike read_source_image(), this may safely be called for the same texture
+ * from several threads at once, as it is when generate_images() is
+ * regenerating several palette images concurrently.
+ */
+bool TextureImage::
+read_scaled_source_image(PNMImage &image, int x_size, int y_size) {
+  MutexHolder holder(_source_image_lock);
+
+  // If the scaled image cache is in use, we may be able to avoid reading the
+  // source image altogether.  We don't bother if the source image was
+  // supplied directly rather than read from disk.
+  ScaledImageCache &cache = pal->_scaled_image_cache;
+  std::string key;
+  if (cache.is_enabled() &&
+      !(_read_source_image && !_allow_release_source_image)) {
+    SourceTextureImage *source = get_preferred_source();
+    if (source != nullptr && cache.make_key(key, source, x_size, y_size)) {
+      if (cache.read(key, image)) {
+        return true;
+      }
+    }
+  }
+
+  const PNMImage &source_full = read_source_image();
+  if (!source_full.is_valid()) {
+    return false;
+  }
+
+  image.clear(x_size, y_size, source_full.get_num_channels(),
+              source_full.get_maxval());
+  image.quick_filter_from(source_full);
+
+  release_source_image();
+
+  if (!key.empty()) {
+    cache.write(key, image);
+  }
+  return true;
+}
+
 /**
  * Accepts the indicated source image as if it had been read from disk.  This
  * image is copied into the structure, and will be returned by future calls to
@@ -837,6 +907,18 @@ write_source_pathnames(std::ostream &out, int indent_level) const {
       out << ")\n";
     }
   }
+  if (_txa_matches_known) {
+    if (_txa_matches.empty()) {
+      indent(out, indent_level)
+        << "Not matched by any line in .txa\n";
+    } else {
+      vector_string::const_iterator mi;
+      for (mi = _txa_matches.begin(); mi != _txa_matches.end(); ++mi) {
+        indent(out, indent_level)
+          << "Matched by " << (*mi) << "\n";
+      }
+    }
+  }
   if (!_explicitly_assigned_groups.empty()) {
     indent(out, indent_level)
       << "Explicitly assigned to " << _explicitly_assigned_groups << " in .txa\n";
@@ -1263,6 +1345,13 @@ write_datagram(BamWriter *writer, Datagram &datagram) {
   datagram.add_uint8((int)_txa_wrap_u);
   datagram.add_uint8((int)_txa_wrap_v);
 
+  datagram.add_bool(_txa_matches_known);
+  datagram.add_uint32(_txa_matches.size());
+  vector_string::const_iterator mi;
+  for (mi = _txa_matches.begin(); mi != _txa_matches.end(); ++mi) {
+    datagram.add_string(*mi);
+  }
+
   // We don't write out _explicitly_assigned_groups; this is re-read from the
   // .txa file each time.
 
@@ -1270,9 +1359,21 @@ write_datagram(BamWriter *writer, Datagram &datagram) {
 
   // We don't write out _egg_files; this is redetermined each session.
 
-  datagram.add_uint32(_placement.size());
+  // _placement is keyed by pointer; write it in order by group name instead,
+  // so that an unchanged state file is written out identically each session.
+  pvector<PaletteGroup *> group_vector;
+  group_vector.reserve(_placement.size());
   Placement::const_iterator pi;
   for (pi = _placement.begin(); pi != _placement.end(); ++pi) {
+    group_vector.push_back((*pi).first);
+  }
+  sort(group_vector.begin(), group_vector.end(),
+       IndirectCompareNames<PaletteGroup>());
+
+  datagram.add_uint32(group_vector.size());
+  pvector<PaletteGroup *>::const_iterator gvi;
+  for (gvi = group_vector.begin(); gvi != group_vector.end(); ++gvi) {
+    pi = _placement.find(*gvi);
     writer->write_pointer(datagram, (*pi).first);
     writer->write_pointer(datagram, (*pi).second);
   }
@@ -1381,6 +1482,13 @@ fillin(DatagramIterator &scan, BamReader *manager) {
     _txa_wrap_u = (EggTexture::WrapMode)scan.get_uint8();
     _txa_wrap_v = (EggTexture::WrapMode)scan.get_uint8();
   }
+  if (pal->_read_pi_version >= 21) {
+    _txa_matches_known = scan.get_bool();
+    size_t num_matches = scan.get_uint32();
+    for (size_t i = 0; i < num_matches && scan.get_remaining_size() > 0; ++i) {
+      _txa_matches.push_back(scan.get_string());
+    }
+  }
 
   _actual_assigned_groups.fillin(scan, manager);
 
@@ -23,6 +23,8 @@
 #include "namable.h"
 #include "filename.h"
 #include "pnmImage.h"
+#include "vector_string.h"
+#include "pmutex.h"
 #include "eggRenderMode.h"
 
 #include "pmap.h"
@@ -61,6 +63,8 @@ public:
   void pre_txa_file();
   void post_txa_file();
   bool got_txa_file() const;
+  void add_txa_match(const std::string &description);
+  const vector_string &get_txa_matches() const;
   void determine_placement_size();
 
   bool get_omit() const;
@@ -84,6 +88,7 @@ public:
 
   const PNMImage &read_source_image();
   void release_source_image();
+  bool read_scaled_source_image(PNMImage &image, int x_size, int y_size);
   void set_source_image(const PNMImage &image);
   void read_header();
   bool is_newer_than(const Filename &reference_filename);
@@ -149,9 +154,17 @@ private:
   bool _read_source_image;
   bool _allow_release_source_image;
   PNMImage _source_image;
+  Mutex _source_image_lock;
   bool _texture_named;
   bool _got_txa_file;
 
+  // The .txa lines that matched this texture the last time it was looked up
+  // in the .txa file, for diagnostics.  These are written to the bam file so
+  // that egg-palettize -R, which does not read the .txa file, can report
+  // them.
+  bool _txa_matches_known;
+  vector_string _txa_matches;
+
 
   // The TypedWritable interface follows.
 public:
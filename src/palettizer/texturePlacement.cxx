@@ -27,6 +27,9 @@
 #include "bamWriter.h"
 #include "pnmImage.h"
 
+#include <algorithm>
+#include <string.h>
+
 using std::max;
 using std::min;
 
@@ -76,6 +79,9 @@ TexturePlacement(TextureImage *texture, PaletteGroup *group) :
 TexturePlacement::
 ~TexturePlacement() {
   // Make sure we tell all our egg references they're not using us any more.
+  // Any that haven't been read yet must be read first, so they can be told.
+  load_lazy_eggs();
+
   References::iterator ri;
   References copy_references = _references;
   for (ri = copy_references.begin(); ri != copy_references.end(); ++ri) {
@@ -151,6 +157,34 @@ remove_egg(TextureReference *reference) {
   _references.erase(reference);
 }
 
+/**
+ * Records the fact that a particular egg file is using this placement, when
+ * its references have not been read from the StateJournal.  They will be
+ * read if this placement needs them.
+ */
+void TexturePlacement::
+note_lazy_egg(EggFile *egg_file) {
+  _lazy_eggs.insert(egg_file);
+}
+
+/**
+ * Removes an egg file added by note_lazy_egg(), presumably because its
+ * references are now being read.
+ */
+void TexturePlacement::
+forget_lazy_egg(EggFile *egg_file) {
+  _lazy_eggs.erase(egg_file);
+}
+
+/**
+ * Adds back a reference that has just been read from the StateJournal.
+ * Unlike add_egg(), this does not mark the egg file stale.
+ */
+void TexturePlacement::
+restore_egg(TextureReference *reference) {
+  _references.insert(reference);
+}
+
 /**
  * Marks all the egg files that reference this placement stale.  Presumably
  * this is called after moving the texture around in the palette or something.
@@ -163,6 +197,13 @@ mark_eggs_stale() {
 
     reference->mark_egg_stale();
   }
+
+  // There's no need to read the references of the egg files we haven't read
+  // yet; they will be read along with the egg files themselves.
+  LazyEggs::iterator ei;
+  for (ei = _lazy_eggs.begin(); ei != _lazy_eggs.end(); ++ei) {
+    (*ei)->mark_stale();
+  }
 }
 
 /**
@@ -220,6 +261,8 @@ determine_size() {
 
   LTexCoordd max_uv, min_uv;
 
+  load_lazy_eggs();
+
   References::iterator ri;
   for (ri = _references.begin(); ri != _references.end(); ++ri) {
     TextureReference *reference = (*ri);
@@ -722,24 +765,21 @@ fill_image(PNMImage &image) {
   nassertv(x_size >= 0 && y_size >= 0);
 
   // Now we get a PNMImage that represents the source texture at that size.
-  const PNMImage &source_full = _texture->read_source_image();
-  if (!source_full.is_valid()) {
+  PNMImage source;
+  if (!_texture->read_scaled_source_image(source, x_size, y_size)) {
     flag_error_image(image);
     return;
   }
 
-  PNMImage source(x_size, y_size, source_full.get_num_channels(),
-                  source_full.get_maxval());
-  source.quick_filter_from(source_full);
-
-  bool alpha = image.has_alpha();
-  bool source_alpha = source.has_alpha();
-
   // Now copy the pixels.  We do this by walking through the rectangular
   // region on the palette image that we have reserved for this texture; for
   // each pixel in this region, we determine its appropriate color based on
   // its relation to the actual texture image location (determined above), and
-  // on whether the texture wraps or clamps.
+  // on whether the texture wraps or clamps.  Since the wrap mode treats each
+  // row and each column independently, we work out the source row for each
+  // row, and the source column for each column, just once up front.
+  vector_int sy_map;
+  sy_map.reserve(_placed._y_size);
   for (int y = _placed._y; y < _placed._y + _placed._y_size; y++) {
     int sy = y - top;
 
@@ -760,7 +800,7 @@ fill_image(PNMImage &image) {
 
     case EggTexture::WM_border_color:
       if (sy < 0 || sy >= y_size) {
-        continue;
+        sy = -1;
       }
       break;
 
@@ -770,48 +810,45 @@ fill_image(PNMImage &image) {
       break;
     }
 
-    for (int x = _placed._x; x < _placed._x + _placed._x_size; x++) {
-      int sx = x - left;
+    sy_map.push_back(sy);
+  }
 
-      switch (_placed._wrap_u) {
-      case EggTexture::WM_clamp:
-        // Clamp at [0, x_size).
-        sx = max(min(sx, x_size - 1), 0);
-        break;
+  vector_int sx_map;
+  sx_map.reserve(_placed._x_size);
+  for (int x = _placed._x; x < _placed._x + _placed._x_size; x++) {
+    int sx = x - left;
 
-      case EggTexture::WM_mirror:
-        sx = (sx < 0) ? (x_size * 2) - 1 - ((-sx - 1) % (x_size * 2)) : sx % (x_size * 2);
-        sx = (sx < x_size) ? sx : 2 * x_size - sx - 1;
-        break;
+    switch (_placed._wrap_u) {
+    case EggTexture::WM_clamp:
+      // Clamp at [0, x_size).
+      sx = max(min(sx, x_size - 1), 0);
+      break;
 
-      case EggTexture::WM_mirror_once:
-        sx = (sx >= 0) ? sx : ~sx;
-        // Fall through
+    case EggTexture::WM_mirror:
+      sx = (sx < 0) ? (x_size * 2) - 1 - ((-sx - 1) % (x_size * 2)) : sx % (x_size * 2);
+      sx = (sx < x_size) ? sx : 2 * x_size - sx - 1;
+      break;
 
-      case EggTexture::WM_border_color:
-        if (sx < 0 || sx >= x_size) {
-          continue;
-        }
-        break;
+    case EggTexture::WM_mirror_once:
+      sx = (sx >= 0) ? sx : ~sx;
+      // Fall through
 
-      default:
-        // Wrap: sign-independent modulo.
-        sx = (sx < 0) ? x_size - 1 - ((-sx - 1) % x_size) : sx % x_size;
-        break;
+    case EggTexture::WM_border_color:
+      if (sx < 0 || sx >= x_size) {
+        sx = -1;
       }
+      break;
 
-      image.set_xel(x, y, source.get_xel(sx, sy));
-      if (alpha) {
-        if (source_alpha) {
-          image.set_alpha(x, y, source.get_alpha(sx, sy));
-        } else {
-          image.set_alpha(x, y, 1.0);
-        }
-      }
+    default:
+      // Wrap: sign-independent modulo.
+      sx = (sx < 0) ? x_size - 1 - ((-sx - 1) % x_size) : sx % x_size;
+      break;
     }
+
+    sx_map.push_back(sx);
   }
 
-  _texture->release_source_image();
+  copy_pixels(image, source, sx_map, sy_map);
 }
 
 
@@ -854,24 +891,15 @@ fill_swapped_image(PNMImage &image, int index) {
   TextureSwaps::iterator tsi;
   tsi = _textureSwaps.begin() + index;
   TextureImage *swapTexture = (*tsi);
-  const PNMImage &source_full = swapTexture->read_source_image();
-  if (!source_full.is_valid()) {
+  PNMImage source;
+  if (!swapTexture->read_scaled_source_image(source, x_size, y_size)) {
     flag_error_image(image);
     return;
   }
 
-  PNMImage source(x_size, y_size, source_full.get_num_channels(),
-                  source_full.get_maxval());
-  source.quick_filter_from(source_full);
-
-  bool alpha = image.has_alpha();
-  bool source_alpha = source.has_alpha();
-
-  // Now copy the pixels.  We do this by walking through the rectangular
-  // region on the palette image that we have reserved for this texture; for
-  // each pixel in this region, we determine its appropriate color based on
-  // its relation to the actual texture image location (determined above), and
-  // on whether the texture wraps or clamps.
+  // Now copy the pixels, as in fill_image(), above.
+  vector_int sy_map;
+  sy_map.reserve(_placed._y_size);
   for (int y = _placed._y; y < _placed._y + _placed._y_size; y++) {
     int sy = y - top;
 
@@ -884,30 +912,123 @@ fill_swapped_image(PNMImage &image, int index) {
       sy = (sy < 0) ? y_size - 1 - ((-sy - 1) % y_size) : sy % y_size;
     }
 
-    for (int x = _placed._x; x < _placed._x + _placed._x_size; x++) {
-      int sx = x - left;
+    sy_map.push_back(sy);
+  }
 
-      if (_placed._wrap_u == EggTexture::WM_clamp) {
-        // Clamp at [0, x_size).
-        sx = max(min(sx, x_size - 1), 0);
+  vector_int sx_map;
+  sx_map.reserve(_placed._x_size);
+  for (int x = _placed._x; x < _placed._x + _placed._x_size; x++) {
+    int sx = x - left;
 
-      } else {
-        // Wrap: sign-independent modulo.
-        sx = (sx < 0) ? x_size - 1 - ((-sx - 1) % x_size) : sx % x_size;
+    if (_placed._wrap_u == EggTexture::WM_clamp) {
+      // Clamp at [0, x_size).
+      sx = max(min(sx, x_size - 1), 0);
+
+    } else {
+      // Wrap: sign-independent modulo.
+      sx = (sx < 0) ? x_size - 1 - ((-sx - 1) % x_size) : sx % x_size;
+    }
+
+    sx_map.push_back(sx);
+  }
+
+  copy_pixels(image, source, sx_map, sy_map);
+}
+
+/**
+ * Copies pixels from the source image, already scaled to its placed size,
+ * into the rectangle of the palette image reserved for this texture.  For
+ * each column and row of that rectangle, sx_map and sy_map give the
+ * corresponding column or row of the source image, or -1 to leave that
+ * column or row of the palette untouched.
+ */
+void TexturePlacement::
+copy_pixels(PNMImage &image, const PNMImage &source,
+            const vector_int &sx_map, const vector_int &sy_map) {
+  bool alpha = image.has_alpha();
+  bool source_alpha = source.has_alpha();
+  int num_cols = (int)sx_map.size();
+  int num_rows = (int)sy_map.size();
+
+  if (image.get_maxval() != source.get_maxval() ||
+      image.get_color_space() != source.get_color_space()) {
+    // The two images encode their pixel values differently, so we have to go
+    // through get_xel() and set_xel() to convert each pixel.
+    for (int yi = 0; yi < num_rows; yi++) {
+      int sy = sy_map[yi];
+      if (sy < 0) {
+        continue;
       }
+      int y = _placed._y + yi;
 
-      image.set_xel(x, y, source.get_xel(sx, sy));
-      if (alpha) {
-        if (source_alpha) {
-          image.set_alpha(x, y, source.get_alpha(sx, sy));
-        } else {
-          image.set_alpha(x, y, 1.0);
+      for (int xi = 0; xi < num_cols; xi++) {
+        int sx = sx_map[xi];
+        if (sx < 0) {
+          continue;
+        }
+        int x = _placed._x + xi;
+
+        image.set_xel(x, y, source.get_xel(sx, sy));
+        if (alpha) {
+          if (source_alpha) {
+            image.set_alpha(x, y, source.get_alpha(sx, sy));
+          } else {
+            image.set_alpha(x, y, 1.0);
+          }
         }
       }
     }
+    return;
   }
 
-  swapTexture->release_source_image();
+  // Otherwise, we can copy the raw pixel values directly.  Consecutive
+  // palette columns usually map to consecutive source columns, so we copy
+  // each such run with a single memcpy().
+  xel *dest_array = image.get_array();
+  const xel *src_array = source.get_array();
+  xelval *dest_alpha_array = alpha ? image.get_alpha_array() : nullptr;
+  const xelval *src_alpha_array = source_alpha ? source.get_alpha_array() : nullptr;
+  xelval opaque = image.get_maxval();
+
+  size_t dest_x_size = (size_t)image.get_x_size();
+  size_t src_x_size = (size_t)source.get_x_size();
+
+  for (int yi = 0; yi < num_rows; yi++) {
+    int sy = sy_map[yi];
+    if (sy < 0) {
+      continue;
+    }
+    size_t dest_start = (size_t)(_placed._y + yi) * dest_x_size + _placed._x;
+    size_t src_start = (size_t)sy * src_x_size;
+
+    int xi = 0;
+    while (xi < num_cols) {
+      int sx = sx_map[xi];
+      if (sx < 0) {
+        xi++;
+        continue;
+      }
+
+      int run = 1;
+      while (xi + run < num_cols && sx_map[xi + run] == sx + run) {
+        run++;
+      }
+
+      memcpy(dest_array + dest_start + xi, src_array + src_start + sx,
+             run * sizeof(xel));
+      if (dest_alpha_array != nullptr) {
+        if (src_alpha_array != nullptr) {
+          memcpy(dest_alpha_array + dest_start + xi,
+                 src_alpha_array + src_start + sx, run * sizeof(xelval));
+        } else {
+          std::fill(dest_alpha_array + dest_start + xi,
+                    dest_alpha_array + dest_start + xi + run, opaque);
+        }
+      }
+
+      xi += run;
+    }
+  }
 }
 
 /**
@@ -931,6 +1052,19 @@ flag_error_image(PNMImage &image) {
   }
 }
 
+/**
+ * Reads the references of all the egg files added by note_lazy_egg(), so
+ * that _references is complete.
+ */
+void TexturePlacement::
+load_lazy_eggs() {
+  while (!_lazy_eggs.empty()) {
+    EggFile *egg_file = (*_lazy_eggs.begin());
+    egg_file->load_references();
+    nassertv(_lazy_eggs.count(egg_file) == 0);
+  }
+}
+
 /**
  * A support function for determine_size(), this computes the appropriate size
  * of the texture in pixels based on the UV coverage (as well as on the size
@@ -1010,11 +1144,8 @@ write_datagram(BamWriter *writer, Datagram &datagram) {
   _placed.write_datagram(writer, datagram);
   datagram.add_int32((int)_omit_reason);
 
-  datagram.add_int32(_references.size());
-  References::const_iterator ri;
-  for (ri = _references.begin(); ri != _references.end(); ++ri) {
-    writer->write_pointer(datagram, (*ri));
-  }
+  // We don't write out _references; each EggFile records the placements its
+  // references use, and they are rebuilt from that.
 
   datagram.add_int32(_textureSwaps.size());
   TextureSwaps::const_iterator tsi;
@@ -1109,8 +1240,11 @@ fillin(DatagramIterator &scan, BamReader *manager) {
   _placed.fillin(scan, manager);
   _omit_reason = (OmitReason)scan.get_int32();
 
-  _num_references = scan.get_int32();
-  manager->read_pointers(scan, _num_references);
+  _num_references = 0;
+  if (Palettizer::_read_pi_version < 22) {
+    _num_references = scan.get_int32();
+    manager->read_pointers(scan, _num_references);
+  }
 
   if (Palettizer::_read_pi_version >= 20) {
     _num_textureSwaps = scan.get_int32();
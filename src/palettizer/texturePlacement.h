@@ -23,9 +23,11 @@
 #include "luse.h"
 
 #include "pset.h"
+#include "vector_int.h"
 
 class TextureImage;
 class DestTextureImage;
+class EggFile;
 class PaletteGroup;
 class PaletteImage;
 class PalettePage;
@@ -53,6 +55,9 @@ public:
 
   void add_egg(TextureReference *reference);
   void remove_egg(TextureReference *reference);
+  void note_lazy_egg(EggFile *egg_file);
+  void forget_lazy_egg(EggFile *egg_file);
+  void restore_egg(TextureReference *reference);
   void mark_eggs_stale();
 
   void set_dest(DestTextureImage *dest);
@@ -94,7 +99,10 @@ public:
   TextureSwaps _textureSwaps;
 
 private:
+  void load_lazy_eggs();
   void compute_size_from_uvs(const LTexCoordd &min_uv, const LTexCoordd &max_uv);
+  void copy_pixels(PNMImage &image, const PNMImage &source,
+                   const vector_int &sx_map, const vector_int &sy_map);
 
   TextureImage *_texture;
   PaletteGroup *_group;
@@ -112,6 +120,11 @@ private:
   typedef pset<TextureReference *> References;
   References _references;
 
+  // These are the egg files that use this placement, but whose references
+  // have not yet been read from the StateJournal.
+  typedef pset<EggFile *> LazyEggs;
+  LazyEggs _lazy_eggs;
+
   // The TypedWritable interface follows.
 public:
   static void register_with_read_factory();
@@ -14,6 +14,8 @@
 #include "textureProperties.h"
 #include "palettizer.h"
 #include "pnmFileType.h"
+#include "pnmFileTypeRegistry.h"
+#include "typeRegistry.h"
 #include "datagram.h"
 #include "datagramIterator.h"
 #include "bamReader.h"
@@ -744,6 +746,77 @@ union_quality_level(EggTexture::QualityLevel a, EggTexture::QualityLevel b) {
   }
 }
 
+/**
+ * Writes the properties to the indicated datagram, as part of an egg file's
+ * record in the StateJournal.  This is the same information written by
+ * write_datagram(), but the image file types are written by name, since
+ * there is no BamWriter to share them.
+ */
+void TextureProperties::
+write_record(Datagram &datagram) const {
+  datagram.add_bool(_got_num_channels);
+  datagram.add_int32(_num_channels);
+  datagram.add_int32(_effective_num_channels);
+  datagram.add_int32((int)_format);
+  datagram.add_bool(_force_format);
+  datagram.add_bool(_generic_format);
+  datagram.add_bool(_keep_format);
+  datagram.add_int32((int)_minfilter);
+  datagram.add_int32((int)_magfilter);
+  datagram.add_int32((int)_quality_level);
+  datagram.add_int32(_anisotropic_degree);
+  write_file_type(datagram, _color_type);
+  write_file_type(datagram, _alpha_type);
+}
+
+/**
+ * Reads the properties from the indicated datagram, as written by a previous
+ * call to write_record().
+ */
+void TextureProperties::
+read_record(DatagramIterator &scan) {
+  _got_num_channels = scan.get_bool();
+  _num_channels = scan.get_int32();
+  _effective_num_channels = scan.get_int32();
+  _format = (EggTexture::Format)scan.get_int32();
+  _force_format = scan.get_bool();
+  _generic_format = scan.get_bool();
+  _keep_format = scan.get_bool();
+  _minfilter = (EggTexture::FilterType)scan.get_int32();
+  _magfilter = (EggTexture::FilterType)scan.get_int32();
+  _quality_level = (EggTexture::QualityLevel)scan.get_int32();
+  _anisotropic_degree = scan.get_int32();
+  _color_type = read_file_type(scan);
+  _alpha_type = read_file_type(scan);
+}
+
+/**
+ * Writes the name of the indicated image file type, or the empty string if
+ * it is NULL.
+ */
+void TextureProperties::
+write_file_type(Datagram &datagram, PNMFileType *type) {
+  if (type == nullptr) {
+    datagram.add_string(string());
+  } else {
+    datagram.add_string(type->get_type().get_name());
+  }
+}
+
+/**
+ * Reads the name of an image file type written by write_file_type(), and
+ * returns the corresponding type, or NULL if there is none.
+ */
+PNMFileType *TextureProperties::
+read_file_type(DatagramIterator &scan) {
+  string name = scan.get_string();
+  if (name.empty()) {
+    return nullptr;
+  }
+  TypeHandle handle = TypeRegistry::ptr()->find_type(name);
+  return PNMFileTypeRegistry::get_global_ptr()->get_type_by_handle(handle);
+}
+
 /**
  * Registers the current object as something that can be read from a Bam file.
  */
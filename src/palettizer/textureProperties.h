@@ -53,6 +53,9 @@ public:
   bool operator == (const TextureProperties &other) const;
   bool operator != (const TextureProperties &other) const;
 
+  void write_record(Datagram &datagram) const;
+  void read_record(DatagramIterator &scan);
+
   EggTexture::Format _format;
   bool _force_format;  // true when format has been explicitly specified
   bool _generic_format; // true if 'generic' keyword, meaning rgba8 -> rgba.
@@ -70,6 +73,8 @@ private:
   static std::string get_quality_level_string(EggTexture::QualityLevel quality_level);
   static std::string get_type_string(PNMFileType *color_type,
                                 PNMFileType *alpha_type);
+  static void write_file_type(Datagram &datagram, PNMFileType *type);
+  static PNMFileType *read_file_type(DatagramIterator &scan);
 
   static EggTexture::Format union_format(EggTexture::Format a,
                                          EggTexture::Format b);
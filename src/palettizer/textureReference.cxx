@@ -785,6 +785,63 @@ translate_uv(const LTexCoordd &min_uv, const LTexCoordd &max_uv) {
   return LVector2d(-floor(center[0]), -floor(center[1]));
 }
 
+/**
+ * Writes the reference to the indicated datagram, as part of its egg file's
+ * record in the StateJournal.  The egg file, source texture and placement
+ * are not written; the egg file keeps those in textures.boo, and supplies
+ * them again to read_record().
+ */
+void TextureReference::
+write_record(Datagram &datagram) const {
+  datagram.add_string(_tref_name);
+
+  _tex_mat.write_datagram(datagram);
+  _inv_tex_mat.write_datagram(datagram);
+
+  datagram.add_bool(_uses_alpha);
+  datagram.add_bool(_any_uvs);
+  datagram.add_float64(_min_uv[0]);
+  datagram.add_float64(_min_uv[1]);
+  datagram.add_float64(_max_uv[0]);
+  datagram.add_float64(_max_uv[1]);
+  datagram.add_int32((int)_wrap_u);
+  datagram.add_int32((int)_wrap_v);
+  _properties.write_record(datagram);
+}
+
+/**
+ * Reads the reference from the indicated datagram, as written by a previous
+ * call to write_record(), and adds it back to its placement.  Unlike
+ * set_placement(), this does not mark the egg file stale, since nothing has
+ * changed.
+ */
+void TextureReference::
+read_record(EggFile *egg_file, SourceTextureImage *source,
+            TexturePlacement *placement, DatagramIterator &scan) {
+  _egg_file = egg_file;
+  _source_texture = source;
+  _placement = placement;
+
+  _tref_name = scan.get_string();
+
+  _tex_mat.read_datagram(scan);
+  _inv_tex_mat.read_datagram(scan);
+
+  _uses_alpha = scan.get_bool();
+  _any_uvs = scan.get_bool();
+  _min_uv[0] = scan.get_float64();
+  _min_uv[1] = scan.get_float64();
+  _max_uv[0] = scan.get_float64();
+  _max_uv[1] = scan.get_float64();
+  _wrap_u = (EggTexture::WrapMode)scan.get_int32();
+  _wrap_v = (EggTexture::WrapMode)scan.get_int32();
+  _properties.read_record(scan);
+
+  if (_placement != nullptr) {
+    _placement->restore_egg(this);
+  }
+}
+
 /**
  * Registers the current object as something that can be read from a Bam file.
  */
@@ -74,6 +74,10 @@ public:
   void output(std::ostream &out) const;
   void write(std::ostream &out, int indent_level = 0) const;
 
+  void write_record(Datagram &datagram) const;
+  void read_record(EggFile *egg_file, SourceTextureImage *source,
+                   TexturePlacement *placement, DatagramIterator &scan);
+
 
 private:
   bool get_uv_range(EggGroupNode *group, Palettizer::RemapUV remap);
@@ -16,9 +16,12 @@
 #include "palettizer.h"
 #include "paletteGroup.h"
 #include "textureImage.h"
+#include "eggFile.h"
 
 #include "pnotify.h"
 #include "pnmFileTypeRegistry.h"
+#include "string_utils.h"
+#include "vector_int.h"
 
 using std::string;
 
@@ -101,6 +104,7 @@ read(std::istream &in, const string &filename) {
       TxaLine &txa_line = _lines.back();
 
       okflag = txa_line.parse(line);
+      txa_line.set_source(filename, line_number);
     }
 
     if (!okflag) {
@@ -118,6 +122,7 @@ read(std::istream &in, const string &filename) {
     return false;
   }
 
+  compile_patterns();
   return true;
 }
 
@@ -129,9 +134,17 @@ read(std::istream &in, const string &filename) {
  */
 bool TxaFile::
 match_egg(EggFile *egg_file) const {
-  Lines::const_iterator li;
-  for (li = _lines.begin(); li != _lines.end(); ++li) {
-    if ((*li).match_egg(egg_file)) {
+  const string &name = egg_file->get_name();
+
+  // The index narrows the search down to the few lines that might match; we
+  // still visit those in file order, so the first match wins as before.
+  vector_int candidates;
+  _egg_index.find_candidates(name, candidates);
+
+  vector_int::const_iterator ci;
+  for (ci = candidates.begin(); ci != candidates.end(); ++ci) {
+    const TxaLine &txa_line = _lines[*ci];
+    if (txa_line.matches_egg(name) && txa_line.apply_egg(egg_file)) {
       return true;
     }
   }
@@ -147,10 +160,20 @@ match_egg(EggFile *egg_file) const {
  */
 bool TxaFile::
 match_texture(TextureImage *texture) const {
-  Lines::const_iterator li;
-  for (li = _lines.begin(); li != _lines.end(); ++li) {
-    if ((*li).match_texture(texture)) {
-      return true;
+  const string &name = texture->get_name();
+
+  vector_int candidates;
+  _texture_index.find_candidates(name, candidates);
+
+  vector_int::const_iterator ci;
+  for (ci = candidates.begin(); ci != candidates.end(); ++ci) {
+    const TxaLine &txa_line = _lines[*ci];
+    if (txa_line.matches_texture(name)) {
+      texture->add_txa_match(txa_line.get_filename() + " line " +
+                             format_string(txa_line.get_line_number()));
+      if (txa_line.apply_texture(texture)) {
+        return true;
+      }
     }
   }
 
@@ -169,6 +192,28 @@ write(std::ostream &out) const {
   }
 }
 
+/**
+ * Rebuilds the pattern indexes from the complete set of lines.  This must be
+ * called whenever _lines changes.
+ */
+void TxaFile::
+compile_patterns() {
+  _egg_index.clear();
+  _texture_index.clear();
+
+  for (int i = 0; i < (int)_lines.size(); ++i) {
+    const TxaLine &txa_line = _lines[i];
+    int num_patterns = txa_line.get_num_egg_patterns();
+    for (int pi = 0; pi < num_patterns; ++pi) {
+      _egg_index.add_pattern(txa_line.get_egg_pattern(pi), i);
+    }
+    num_patterns = txa_line.get_num_texture_patterns();
+    for (int pi = 0; pi < num_patterns; ++pi) {
+      _texture_index.add_pattern(txa_line.get_texture_pattern(pi), i);
+    }
+  }
+}
+
 /**
  * Reads the next line, or the next semicolon-delimited phrase, from the
  * indicated input stream.  Returns the character that marks the end of the
@@ -17,6 +17,7 @@
 #include "pandatoolbase.h"
 
 #include "txaLine.h"
+#include "txaPatternIndex.h"
 
 #include "filename.h"
 #include "vector_string.h"
@@ -40,6 +41,7 @@ public:
 
 private:
   static int get_line_or_semicolon(std::istream &in, std::string &line);
+  void compile_patterns();
 
   bool parse_group_line(const vector_string &words);
   bool parse_palette_line(const vector_string &words);
@@ -56,6 +58,11 @@ private:
 
   typedef pvector<TxaLine> Lines;
   Lines _lines;
+
+  // These are rebuilt from _lines after each read(), to quickly find the
+  // lines that might match a given name.
+  TxaPatternIndex _egg_index;
+  TxaPatternIndex _texture_index;
 };
 
 #endif
@@ -49,6 +49,7 @@ TxaLine() {
   _coverage_threshold = 0.0;
   _color_type = nullptr;
   _alpha_type = nullptr;
+  _line_number = 0;
 }
 
 /**
@@ -320,29 +321,103 @@ parse(const string &line) {
 }
 
 /**
- * Compares the patterns on the line to the indicated EggFile.  If they match,
- * updates the egg with the appropriate information.  Returns true if a match
- * is detected and the search for another line should stop, or false if a
- * match is not detected (or if the keyword "cont" is present, which means the
- * search should continue regardless).
+ * Records the file and line number this line was read from, for diagnostic
+ * purposes.
  */
-bool TxaLine::
-match_egg(EggFile *egg_file) const {
-  string name = egg_file->get_name();
+void TxaLine::
+set_source(const string &filename, int line_number) {
+  _filename = filename;
+  _line_number = line_number;
+}
+
+/**
+ * Returns the name of the .txa file this line was read from.
+ */
+const string &TxaLine::
+get_filename() const {
+  return _filename;
+}
+
+/**
+ * Returns the line number within the .txa file this line was read from.
+ */
+int TxaLine::
+get_line_number() const {
+  return _line_number;
+}
+
+/**
+ * Returns the number of egg file patterns on this line.
+ */
+int TxaLine::
+get_num_egg_patterns() const {
+  return _egg_patterns.size();
+}
 
-  bool matched_any = false;
+/**
+ * Returns the nth egg file pattern on this line.
+ */
+const GlobPattern &TxaLine::
+get_egg_pattern(int n) const {
+  nassertr(n >= 0 && n < (int)_egg_patterns.size(), _egg_patterns[0]);
+  return _egg_patterns[n];
+}
+
+/**
+ * Returns the number of texture patterns on this line.
+ */
+int TxaLine::
+get_num_texture_patterns() const {
+  return _texture_patterns.size();
+}
+
+/**
+ * Returns the nth texture pattern on this line.
+ */
+const GlobPattern &TxaLine::
+get_texture_pattern(int n) const {
+  nassertr(n >= 0 && n < (int)_texture_patterns.size(), _texture_patterns[0]);
+  return _texture_patterns[n];
+}
+
+/**
+ * Returns true if any of the egg file patterns on the line matches the
+ * indicated egg file name.
+ */
+bool TxaLine::
+matches_egg(const string &name) const {
   Patterns::const_iterator pi;
-  for (pi = _egg_patterns.begin();
-       pi != _egg_patterns.end() && !matched_any;
-       ++pi) {
-    matched_any = (*pi).matches(name);
+  for (pi = _egg_patterns.begin(); pi != _egg_patterns.end(); ++pi) {
+    if ((*pi).matches(name)) {
+      return true;
+    }
   }
+  return false;
+}
 
-  if (!matched_any) {
-    // No match this line; continue.
-    return false;
+/**
+ * Returns true if any of the texture patterns on the line matches the
+ * indicated texture name.
+ */
+bool TxaLine::
+matches_texture(const string &name) const {
+  Patterns::const_iterator pi;
+  for (pi = _texture_patterns.begin(); pi != _texture_patterns.end(); ++pi) {
+    if ((*pi).matches(name)) {
+      return true;
+    }
   }
+  return false;
+}
 
+/**
+ * Updates the egg file, which has already been determined to match this line,
+ * with the appropriate information.  Returns true if the search for another
+ * line should stop, or false if the keyword "cont" is present, which means
+ * the search should continue regardless.
+ */
+bool TxaLine::
+apply_egg(EggFile *egg_file) const {
   bool got_cont = false;
   Keywords::const_iterator ki;
   for (ki = _keywords.begin(); ki != _keywords.end(); ++ki) {
@@ -378,29 +453,13 @@ match_egg(EggFile *egg_file) const {
 }
 
 /**
- * Compares the patterns on the line to the indicated TextureImage.  If they
- * match, updates the texture with the appropriate information.  Returns true
- * if a match is detected and the search for another line should stop, or
- * false if a match is not detected (or if the keyword "cont" is present,
- * which means the search should continue regardless).
+ * Updates the texture, which has already been determined to match this line,
+ * with the appropriate information.  Returns true if the search for another
+ * line should stop, or false if the keyword "cont" is present, which means
+ * the search should continue regardless.
  */
 bool TxaLine::
-match_texture(TextureImage *texture) const {
-  string name = texture->get_name();
-
-  bool matched_any = false;
-  Patterns::const_iterator pi;
-  for (pi = _texture_patterns.begin();
-       pi != _texture_patterns.end() && !matched_any;
-       ++pi) {
-    matched_any = (*pi).matches(name);
-  }
-
-  if (!matched_any) {
-    // No match this line; continue.
-    return false;
-  }
-
+apply_texture(TextureImage *texture) const {
   SourceTextureImage *source = texture->get_preferred_source();
   TextureRequest &request = texture->_request;
 
@@ -39,8 +39,20 @@ public:
 
   bool parse(const std::string &line);
 
-  bool match_egg(EggFile *egg_file) const;
-  bool match_texture(TextureImage *texture) const;
+  void set_source(const std::string &filename, int line_number);
+  const std::string &get_filename() const;
+  int get_line_number() const;
+
+  int get_num_egg_patterns() const;
+  const GlobPattern &get_egg_pattern(int n) const;
+  int get_num_texture_patterns() const;
+  const GlobPattern &get_texture_pattern(int n) const;
+
+  bool matches_egg(const std::string &name) const;
+  bool matches_texture(const std::string &name) const;
+
+  bool apply_egg(EggFile *egg_file) const;
+  bool apply_texture(TextureImage *texture) const;
 
   void output(std::ostream &out) const;
 
@@ -91,6 +103,9 @@ private:
 
   PNMFileType *_color_type;
   PNMFileType *_alpha_type;
+
+  std::string _filename;
+  int _line_number;
 };
 
 INLINE std::ostream &operator << (std::ostream &out, const TxaLine &line) {
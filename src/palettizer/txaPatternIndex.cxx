@@ -0,0 +1,199 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file txaPatternIndex.cxx
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#include "txaPatternIndex.h"
+#include "string_utils.h"
+
+#include <algorithm>
+
+using std::string;
+
+/**
+ *
+ */
+TxaPatternIndex::
+TxaPatternIndex() {
+  clear();
+}
+
+/**
+ * Empties the index.
+ */
+void TxaPatternIndex::
+clear() {
+  _exact.clear();
+  _prefix_tree.clear();
+  _prefix_tree.push_back(Node());
+  _suffix_tree.clear();
+  _suffix_tree.push_back(Node());
+  _always.clear();
+}
+
+/**
+ * Records that the indicated pattern belongs to the line with the given
+ * index.  Lines should be added in increasing order, although the order of
+ * the candidates returned by find_candidates() does not depend on it.
+ */
+void TxaPatternIndex::
+add_pattern(const GlobPattern &pattern, int line_index) {
+  const string &text = pattern.get_pattern();
+
+  if (pattern.get_case_sensitive()) {
+    // The index keys are all folded to lowercase, so a case-sensitive pattern
+    // cannot be filed by its literal text.
+    _always.push_back(line_index);
+    return;
+  }
+
+  string prefix;
+  get_literal_prefix(text, prefix);
+  if (prefix.length() == text.length()) {
+    // No wildcards at all; this can only match the one name.
+    _exact[downcase(text)].push_back(line_index);
+    return;
+  }
+
+  if (!prefix.empty()) {
+    add_to_tree(_prefix_tree, downcase(prefix), line_index);
+    return;
+  }
+
+  string suffix;
+  get_literal_suffix(text, suffix);
+  if (!suffix.empty()) {
+    string key = downcase(suffix);
+    std::reverse(key.begin(), key.end());
+    add_to_tree(_suffix_tree, key, line_index);
+    return;
+  }
+
+  _always.push_back(line_index);
+}
+
+/**
+ * Fills candidates with the indices of all of the lines that have at least
+ * one pattern that might match the indicated name, in increasing order and
+ * without duplicates.  Lines not listed here are guaranteed not to match.
+ */
+void TxaPatternIndex::
+find_candidates(const string &name, vector_int &candidates) const {
+  candidates = _always;
+
+  string key = downcase(name);
+
+  Exact::const_iterator ei = _exact.find(key);
+  if (ei != _exact.end()) {
+    candidates.insert(candidates.end(), (*ei).second.begin(), (*ei).second.end());
+  }
+
+  // Walk the prefix tree forward along the name, collecting every pattern
+  // whose literal prefix we pass.
+  int node = 0;
+  size_t p = 0;
+  while (true) {
+    const Node &n = _prefix_tree[node];
+    candidates.insert(candidates.end(), n._lines.begin(), n._lines.end());
+    if (p >= key.length()) {
+      break;
+    }
+    Node::Children::const_iterator ci = n._children.find(key[p]);
+    if (ci == n._children.end()) {
+      break;
+    }
+    node = (*ci).second;
+    ++p;
+  }
+
+  // And the suffix tree backward from the end of the name.
+  node = 0;
+  p = key.length();
+  while (true) {
+    const Node &n = _suffix_tree[node];
+    candidates.insert(candidates.end(), n._lines.begin(), n._lines.end());
+    if (p == 0) {
+      break;
+    }
+    Node::Children::const_iterator ci = n._children.find(key[p - 1]);
+    if (ci == n._children.end()) {
+      break;
+    }
+    node = (*ci).second;
+    --p;
+  }
+
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                   candidates.end());
+}
+
+/**
+ * Returns the part of the pattern that precedes the first wildcard or escape
+ * character.  This is the whole pattern if it has no wildcards.
+ */
+void TxaPatternIndex::
+get_literal_prefix(const string &pattern, string &prefix) {
+  size_t p = 0;
+  while (p < pattern.length() && !is_glob_char(pattern[p])) {
+    ++p;
+  }
+  prefix = pattern.substr(0, p);
+}
+
+/**
+ * Returns the part of the pattern that follows the last wildcard or escape
+ * character, if it is certain to be matched literally.
+ */
+void TxaPatternIndex::
+get_literal_suffix(const string &pattern, string &suffix) {
+  size_t p = pattern.length();
+  while (p > 0 && !is_glob_char(pattern[p - 1]) && pattern[p - 1] != ']') {
+    --p;
+  }
+  if (p > 0 && pattern[p - 1] == '[') {
+    // An unterminated character set; we can't be sure how the remaining
+    // characters will be interpreted.
+    suffix = string();
+    return;
+  }
+  suffix = pattern.substr(p);
+}
+
+/**
+ * Returns true if the indicated character has special meaning within a glob
+ * pattern.
+ */
+bool TxaPatternIndex::
+is_glob_char(char ch) {
+  return (ch == '*' || ch == '?' || ch == '[' || ch == '\\');
+}
+
+/**
+ * Adds the line index to the node of the tree reached by following the
+ * indicated key from the root, creating nodes as needed.
+ */
+void TxaPatternIndex::
+add_to_tree(Nodes &tree, const string &key, int line_index) {
+  int node = 0;
+  for (size_t p = 0; p < key.length(); ++p) {
+    Node::Children::const_iterator ci = tree[node]._children.find(key[p]);
+    if (ci != tree[node]._children.end()) {
+      node = (*ci).second;
+    } else {
+      int child = (int)tree.size();
+      tree[node]._children[key[p]] = child;
+      tree.push_back(Node());
+      node = child;
+    }
+  }
+  tree[node]._lines.push_back(line_index);
+}
@@ -0,0 +1,74 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file txaPatternIndex.h
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#ifndef TXAPATTERNINDEX_H
+#define TXAPATTERNINDEX_H
+
+#include "pandatoolbase.h"
+
+#include "globPattern.h"
+#include "vector_int.h"
+#include "pmap.h"
+#include "pvector.h"
+
+/**
+ * This is a compiled index over the name patterns of all the lines in a .txa
+ * file, used to quickly narrow down the set of lines that might match a
+ * particular texture or egg file name.
+ *
+ * Patterns without any wildcard characters are looked up directly by name.
+ * The remaining patterns are filed in a shared prefix tree according to their
+ * literal prefix, or, lacking one, in a shared suffix tree according to their
+ * literal suffix.  A pattern with neither (for instance, "*") is a candidate
+ * for every name.
+ *
+ * The index only returns candidates; each candidate line must still be
+ * checked against its actual patterns.
+ */
+class TxaPatternIndex {
+public:
+  TxaPatternIndex();
+
+  void clear();
+  void add_pattern(const GlobPattern &pattern, int line_index);
+
+  void find_candidates(const std::string &name, vector_int &candidates) const;
+
+private:
+  static void get_literal_prefix(const std::string &pattern,
+                                 std::string &prefix);
+  static void get_literal_suffix(const std::string &pattern,
+                                 std::string &suffix);
+  static bool is_glob_char(char ch);
+
+  // Each node of a prefix or suffix tree lists the lines whose literal prefix
+  // (or suffix) ends at that node.
+  class Node {
+  public:
+    typedef pmap<char, int> Children;
+    Children _children;
+    vector_int _lines;
+  };
+  typedef pvector<Node> Nodes;
+
+  static void add_to_tree(Nodes &tree, const std::string &key, int line_index);
+
+  typedef pmap<std::string, vector_int> Exact;
+  Exact _exact;
+
+  Nodes _prefix_tree;
+  Nodes _suffix_tree;
+  vector_int _always;
+};
+
+#endif
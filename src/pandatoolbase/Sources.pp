@@ -19,15 +19,19 @@
     config_pandatoolbase.cxx config_pandatoolbase.h \
     distanceUnit.cxx distanceUnit.h \
     pandatoolbase.cxx pandatoolbase.h pandatoolsymbols.h \
+    pathLookupCache.cxx pathLookupCache.h \
     pathReplace.cxx pathReplace.I pathReplace.h \
-    pathStore.cxx pathStore.h
+    pathStore.cxx pathStore.h \
+    workerPool.cxx workerPool.I workerPool.h
 
   #define INSTALL_HEADERS \
     animationConvert.h \
     config_pandatoolbase.h \
     distanceUnit.h \
     pandatoolbase.h pandatoolsymbols.h \
+    pathLookupCache.h \
     pathReplace.I pathReplace.h \
-    pathStore.h
+    pathStore.h \
+    workerPool.I workerPool.h
 
 #end ss_lib_target
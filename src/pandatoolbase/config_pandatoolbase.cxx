@@ -15,6 +15,14 @@
 
 NotifyCategoryDef(pandatoolbase, "");
 
+ConfigVariableDouble path_replace_cache_interval
+("path-replace-cache-interval", 2.0,
+ PRC_DESC("The minimum number of seconds between checks of a directory's "
+          "modification time when PathReplace resolves model and texture "
+          "filenames from cached directory listings.  Set this to 0 to check "
+          "the directory on every lookup, or to a negative number to disable "
+          "the cache and ask the file system about every file."));
+
 /**
  * Initializes the library.  This must be called at least once before any of
  * the functions or classes in this library can be used.  Normally it will be
@@ -17,9 +17,12 @@
 #include "pandatoolbase.h"
 
 #include "notifyCategoryProxy.h"
+#include "configVariableDouble.h"
 
 NotifyCategoryDeclNoExport(pandatoolbase);
 
+extern ConfigVariableDouble path_replace_cache_interval;
+
 extern void init_libpandatoolbase();
 
 #endif
@@ -1,6 +1,8 @@
 #include "config_pandatoolbase.cxx"
 #include "pathStore.cxx"
+#include "pathLookupCache.cxx"
 #include "pathReplace.cxx"
 #include "animationConvert.cxx"
 #include "distanceUnit.cxx"
 #include "pandatoolbase.cxx"
+#include "workerPool.cxx"
@@ -0,0 +1,281 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file pathLookupCache.cxx
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#include "pathLookupCache.h"
+#include "config_pandatoolbase.h"
+#include "virtualFileSystem.h"
+#include "virtualFileList.h"
+#include "trueClock.h"
+#include "mutexHolder.h"
+#include "config_express.h"
+#include "string_utils.h"
+
+/**
+ *
+ */
+PathLookupCache::
+PathLookupCache() :
+  _lock("PathLookupCache")
+{
+}
+
+/**
+ * Returns the single cache shared by the whole process.
+ */
+PathLookupCache *PathLookupCache::
+get_global_ptr() {
+  static PathLookupCache *global_ptr = new PathLookupCache;
+  return global_ptr;
+}
+
+/**
+ * Returns true if the indicated file exists, answering from the cached
+ * listing of its directory when possible.  This is equivalent to
+ * VirtualFileSystem::exists().
+ */
+bool PathLookupCache::
+exists(const Filename &filename) {
+  Lookup result = L_unknown;
+  if (path_replace_cache_interval >= 0.0) {
+    MutexHolder holder(_lock);
+    result = lookup(filename);
+  }
+
+  if (result == L_unknown) {
+    VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+    return vfs->exists(filename);
+  }
+  return (result == L_present);
+}
+
+/**
+ * Searches the given search path for the filename, in the same manner as
+ * VirtualFileSystem::resolve_filename().  If it is found, updates the
+ * filename to the full pathname found and returns true; otherwise, returns
+ * false.
+ */
+bool PathLookupCache::
+resolve_filename(Filename &filename, const DSearchPath &searchpath) {
+  if (!filename.is_local()) {
+    return exists(filename);
+  }
+
+  int num_directories = searchpath.get_num_directories();
+  for (int i = 0; i < num_directories; ++i) {
+    const Filename &directory = searchpath.get_directory(i);
+    Filename match(directory, filename);
+    if (directory == "." && filename.is_fully_qualified()) {
+      // A fully-qualified name like "./foo" shouldn't become "././foo".
+      match = filename;
+    }
+    if (exists(match)) {
+      filename = match;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Informs the cache that the indicated file has just been created by this
+ * process, so that it may be found without waiting for the directory's
+ * listing to be refreshed.
+ */
+void PathLookupCache::
+note_created(const Filename &filename) {
+  Filename key = get_key(filename.get_dirname());
+
+  MutexHolder holder(_lock);
+  Listings::iterator li = _listings.find(key);
+  if (li != _listings.end()) {
+    add_name((*li).second, filename.get_basename());
+  }
+}
+
+/**
+ * Discards all of the cached directory listings.
+ */
+void PathLookupCache::
+clear() {
+  MutexHolder holder(_lock);
+  _listings.clear();
+}
+
+/**
+ * Answers whether the indicated file exists from the listing of its
+ * directory, or returns L_unknown if the listing can't be trusted to answer
+ * for this particular name.  Assumes the lock is held.
+ */
+PathLookupCache::Lookup PathLookupCache::
+lookup(const Filename &filename) {
+  std::string basename = filename.get_basename();
+  if (basename.empty() || basename == "." || basename == "..") {
+    return L_unknown;
+  }
+
+  const Listing &listing =
+    get_listing(filename.get_dirname(), path_replace_cache_interval);
+  if (!listing._is_directory) {
+    return L_absent;
+  }
+  if (listing._names.count(basename) != 0) {
+    return L_present;
+  }
+
+  const pset<std::string> *names = &listing._names;
+  if (!vfs_case_sensitive) {
+    // The file system might match this name to a file that differs from it
+    // in case, if the underlying file system is case-insensitive; only it
+    // can say whether it does.  We can rule out names that match nothing
+    // even when case is ignored.
+    std::string folded;
+    if (!fold_name(basename, folded) ||
+        listing._folded_names.count(folded) != 0) {
+      return L_unknown;
+    }
+    basename = folded;
+    names = &listing._folded_names;
+  }
+
+  if (names->count(basename + ".pz") != 0 ||
+      names->count(basename + ".gz") != 0) {
+    // The file system might be configured to find this name implicitly in
+    // its compressed form; let it decide.
+    return L_unknown;
+  }
+  return L_absent;
+}
+
+/**
+ * Returns the listing for the indicated directory, reading it for the first
+ * time, or again if the directory has changed since it was last read.
+ * Assumes the lock is held.
+ */
+PathLookupCache::Listing &PathLookupCache::
+get_listing(const Filename &dirname, double interval) {
+  Filename key = get_key(dirname);
+  double now = TrueClock::get_global_ptr()->get_short_time();
+
+  Listings::iterator li = _listings.find(key);
+  if (li == _listings.end()) {
+    Listing &listing = _listings[key];
+    scan(listing, key, now);
+    return listing;
+  }
+
+  Listing &listing = (*li).second;
+  if (now - listing._checked < interval) {
+    return listing;
+  }
+
+  if (listing._racy) {
+    // The directory was modified within the same second we last read it, so
+    // its timestamp can't tell us whether we saw the final contents.
+    scan(listing, key, now);
+    return listing;
+  }
+
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  PT(VirtualFile) file = vfs->get_file(key, true);
+  bool is_directory = (file != nullptr && file->is_directory());
+  time_t mtime = is_directory ? file->get_timestamp() : 0;
+  if (is_directory != listing._is_directory || mtime != listing._mtime) {
+    scan(listing, key, now);
+  } else {
+    listing._checked = now;
+  }
+  return listing;
+}
+
+/**
+ * Reads the contents of the indicated directory into the listing.
+ */
+void PathLookupCache::
+scan(Listing &listing, const Filename &dirname, double now) {
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+
+  listing._names.clear();
+  listing._folded_names.clear();
+  listing._is_directory = false;
+  listing._mtime = 0;
+  listing._racy = false;
+  listing._checked = now;
+
+  PT(VirtualFile) file = vfs->get_file(dirname, true);
+  if (file == nullptr || !file->is_directory()) {
+    return;
+  }
+
+  listing._is_directory = true;
+  listing._mtime = file->get_timestamp();
+  listing._racy = (listing._mtime + 1 >= time(nullptr));
+
+  PT(VirtualFileList) contents = file->scan_directory();
+  if (contents != nullptr) {
+    size_t num_files = contents->get_num_files();
+    for (size_t i = 0; i < num_files; ++i) {
+      add_name(listing, contents->get_file(i)->get_filename().get_basename());
+    }
+  }
+}
+
+/**
+ * Returns the name under which the listing for the indicated directory is
+ * stored.  Relative directories are made absolute, so that the same directory
+ * reached by different relative paths shares one listing.
+ */
+Filename PathLookupCache::
+get_key(const Filename &dirname) {
+  Filename key = dirname;
+  if (key.empty()) {
+    key = ".";
+  }
+  if (key.is_local()) {
+    VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+    key.make_absolute(vfs->get_cwd());
+  } else {
+    key.standardize();
+  }
+  return key;
+}
+
+/**
+ * Adds the indicated name to the listing, both as it is and case-folded.
+ */
+void PathLookupCache::
+add_name(Listing &listing, const std::string &name) {
+  listing._names.insert(name);
+
+  std::string folded;
+  if (fold_name(name, folded)) {
+    listing._folded_names.insert(folded);
+  }
+}
+
+/**
+ * Stores the case-folded form of the indicated name in folded.  Returns true
+ * on success, or false if the name contains characters outside of ASCII,
+ * which the file system might fold in ways we don't know about.
+ */
+bool PathLookupCache::
+fold_name(const std::string &name, std::string &folded) {
+  std::string::const_iterator si;
+  for (si = name.begin(); si != name.end(); ++si) {
+    if (((*si) & 0x80) != 0) {
+      return false;
+    }
+  }
+  folded = downcase(name);
+  return true;
+}
@@ -0,0 +1,87 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file pathLookupCache.h
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#ifndef PATHLOOKUPCACHE_H
+#define PATHLOOKUPCACHE_H
+
+#include "pandatoolbase.h"
+
+#include "filename.h"
+#include "dSearchPath.h"
+#include "pmutex.h"
+#include "pmap.h"
+#include "pset.h"
+
+#include <time.h>
+
+/**
+ * This is a process-wide cache of the existence checks made while resolving
+ * model and texture filenames, used by PathReplace.  Rather than asking the
+ * filesystem about each candidate file in turn, it reads the listing of each
+ * directory once, and answers later questions about the files in that
+ * directory (including negative answers) from the listing.
+ *
+ * A listing is considered current until its directory's modification time
+ * changes.  To avoid trading one stat per file for one stat per directory,
+ * the modification time is only rechecked after path-replace-cache-interval
+ * seconds have elapsed; files created through note_created() are added to the
+ * listing immediately.
+ *
+ * When vfs-case-sensitive is off, the VirtualFileSystem may find a file under
+ * a name that differs from it only in case, so the listing also keeps its
+ * names case-folded; a name that matches one of those but not exactly is left
+ * to the VirtualFileSystem to decide.
+ */
+class PathLookupCache {
+private:
+  PathLookupCache();
+
+public:
+  static PathLookupCache *get_global_ptr();
+
+  bool exists(const Filename &filename);
+  bool resolve_filename(Filename &filename, const DSearchPath &searchpath);
+
+  void note_created(const Filename &filename);
+  void clear();
+
+private:
+  class Listing {
+  public:
+    bool _is_directory;
+    time_t _mtime;
+    bool _racy;
+    double _checked;
+    pset<std::string> _names;
+    pset<std::string> _folded_names;
+  };
+  typedef pmap<Filename, Listing> Listings;
+
+  enum Lookup {
+    L_absent,
+    L_present,
+    L_unknown,
+  };
+
+  Lookup lookup(const Filename &filename);
+  Listing &get_listing(const Filename &dirname, double interval);
+  static void scan(Listing &listing, const Filename &dirname, double now);
+  static Filename get_key(const Filename &dirname);
+  static void add_name(Listing &listing, const std::string &name);
+  static bool fold_name(const std::string &name, std::string &folded);
+
+  Mutex _lock;
+  Listings _listings;
+};
+
+#endif
@@ -12,16 +12,22 @@
  */
 
 #include "pathReplace.h"
+#include "pathLookupCache.h"
 #include "config_putil.h"
 #include "config_pandatoolbase.h"
 #include "indent.h"
 #include "virtualFileSystem.h"
+#include "mutexHolder.h"
+
+#include <string.h>
 
 /**
  *
  */
 PathReplace::
-PathReplace() {
+PathReplace() :
+  _lock("PathReplace")
+{
   _path_store = PS_keep;
   _copy_files = false;
   _noabs = false;
@@ -45,10 +51,11 @@ PathReplace::
 Filename PathReplace::
 match_path(const Filename &orig_filename,
            const DSearchPath &additional_path) {
+  MutexHolder holder(_lock);
   Filename match;
   bool got_match = false;
 
-  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  PathLookupCache *cache = PathLookupCache::get_global_ptr();
 
   Entries::const_iterator ei;
   for (ei = _entries.begin(); ei != _entries.end(); ++ei) {
@@ -62,16 +69,16 @@ match_path(const Filename &orig_filename,
       if (new_filename.is_fully_qualified()) {
         // If the resulting filename is fully qualified, it's a match if and
         // only if it exists.
-        if (vfs->exists(new_filename)) {
+        if (cache->exists(new_filename)) {
           return new_filename;
         }
 
       } else {
         // Otherwise, if it's a relative filename, attempt to look it up on
         // the search path.
-        if (vfs->resolve_filename(new_filename, _path) ||
-            vfs->resolve_filename(new_filename, additional_path) ||
-            vfs->resolve_filename(new_filename, get_model_path())) {
+        if (cache->resolve_filename(new_filename, _path) ||
+            cache->resolve_filename(new_filename, additional_path) ||
+            cache->resolve_filename(new_filename, get_model_path())) {
           // Found it!
           if (_path_store == PS_keep) {
             // If we asked to "keep" the pathname, we return the matched path,
@@ -119,9 +126,9 @@ match_path(const Filename &orig_filename,
   // Well, we still haven't found it; look it up on the search path as is.
   if (_path_store != PS_keep) {
     Filename new_filename = orig_filename;
-    if (vfs->resolve_filename(new_filename, _path) ||
-        vfs->resolve_filename(new_filename, additional_path) ||
-        vfs->resolve_filename(new_filename, get_model_path())) {
+    if (cache->resolve_filename(new_filename, _path) ||
+        cache->resolve_filename(new_filename, additional_path) ||
+        cache->resolve_filename(new_filename, get_model_path())) {
       // Found it!
       return new_filename;
     }
@@ -151,6 +158,8 @@ store_path(const Filename &orig_filename) {
     return orig_filename;
   }
 
+  MutexHolder holder(_lock);
+
   if (_path_directory.is_local()) {
     _path_directory.make_absolute();
   }
@@ -199,6 +208,7 @@ full_convert_path(const Filename &orig_filename,
                   const DSearchPath &additional_path,
                   Filename &resolved_path,
                   Filename &output_path) {
+  MutexHolder holder(_lock);
   if (_path_directory.is_local()) {
     _path_directory.make_absolute();
   }
@@ -206,7 +216,7 @@ full_convert_path(const Filename &orig_filename,
   Filename match;
   bool got_match = false;
 
-  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  PathLookupCache *cache = PathLookupCache::get_global_ptr();
 
   Entries::const_iterator ei;
   for (ei = _entries.begin(); ei != _entries.end(); ++ei) {
@@ -220,7 +230,7 @@ full_convert_path(const Filename &orig_filename,
       if (new_filename.is_fully_qualified()) {
         // If the resulting filename is fully qualified, it's a match if and
         // only if it exists.
-        if (vfs->exists(new_filename)) {
+        if (cache->exists(new_filename)) {
           resolved_path = new_filename;
           goto calculate_output_path;
         }
@@ -228,9 +238,9 @@ full_convert_path(const Filename &orig_filename,
       } else {
         // Otherwise, if it's a relative filename, attempt to look it up on
         // the search path.
-        if (vfs->resolve_filename(new_filename, _path) ||
-            vfs->resolve_filename(new_filename, additional_path) ||
-            vfs->resolve_filename(new_filename, get_model_path())) {
+        if (cache->resolve_filename(new_filename, _path) ||
+            cache->resolve_filename(new_filename, additional_path) ||
+            cache->resolve_filename(new_filename, get_model_path())) {
           // Found it!
           resolved_path = new_filename;
           goto calculate_output_path;
@@ -273,9 +283,9 @@ full_convert_path(const Filename &orig_filename,
   // Well, we still haven't found it; look it up on the search path as is.
   {
     Filename new_filename = orig_filename;
-    if (vfs->resolve_filename(new_filename, _path) ||
-        vfs->resolve_filename(new_filename, additional_path) ||
-        vfs->resolve_filename(new_filename, get_model_path())) {
+    if (cache->resolve_filename(new_filename, _path) ||
+        cache->resolve_filename(new_filename, additional_path) ||
+        cache->resolve_filename(new_filename, get_model_path())) {
       // Found it!
       match = orig_filename;
       resolved_path = new_filename;
@@ -394,7 +404,7 @@ write(std::ostream &out, int indent_level) const {
 /**
  * Copies the indicated file into the copy_into_directory, and adjusts
  * filename to reference the new location.  Returns true if the copy is made
- * and the filename is changed, false otherwise.
+ * and the filename is changed, false otherwise.  Assumes the lock is held.
  */
 bool PathReplace::
 copy_this_file(Filename &filename) {
@@ -431,6 +441,17 @@ copy_this_file(Filename &filename) {
   _orig_to_target[filename] = target_filename;
   _target_to_orig[target_filename] = filename;
 
+  if (same_contents(filename, target_filename)) {
+    // The target is already an identical copy, presumably from a previous
+    // run; there's no need to write it again.
+    if (pandatoolbase_cat.is_debug()) {
+      pandatoolbase_cat.debug()
+        << target_filename << " is already up-to-date.\n";
+    }
+    filename = target_filename;
+    return true;
+  }
+
   // Make the copy.
   VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
   vfs->make_directory_full(_copy_into_directory);
@@ -442,11 +463,67 @@ copy_this_file(Filename &filename) {
     _orig_to_target[filename] = filename;
     return false;
   }
+  PathLookupCache::get_global_ptr()->note_created(target_filename);
 
   filename = target_filename;
   return true;
 }
 
+/**
+ * Returns true if the two files both exist and have the same size and the
+ * same contents, false otherwise.  The files are compared a block at a time,
+ * so that neither is held in memory all at once, and the comparison stops at
+ * the first difference.
+ */
+bool PathReplace::
+same_contents(const Filename &a, const Filename &b) {
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  PT(VirtualFile) a_file = vfs->get_file(a, true);
+  PT(VirtualFile) b_file = vfs->get_file(b, true);
+  if (a_file == nullptr || b_file == nullptr ||
+      !a_file->is_regular_file() || !b_file->is_regular_file()) {
+    return false;
+  }
+  if (a_file->get_file_size() != b_file->get_file_size()) {
+    return false;
+  }
+
+  std::istream *a_in = a_file->open_read_file(false);
+  if (a_in == nullptr) {
+    return false;
+  }
+  std::istream *b_in = b_file->open_read_file(false);
+  if (b_in == nullptr) {
+    a_file->close_read_file(a_in);
+    return false;
+  }
+
+  static const size_t buffer_size = 65536;
+  pvector<char> a_buffer(buffer_size);
+  pvector<char> b_buffer(buffer_size);
+  bool match = true;
+  while (match) {
+    a_in->read(&a_buffer[0], buffer_size);
+    b_in->read(&b_buffer[0], buffer_size);
+    size_t count = (size_t)a_in->gcount();
+    if (a_in->bad() || b_in->bad() || (size_t)b_in->gcount() != count ||
+        memcmp(&a_buffer[0], &b_buffer[0], count) != 0) {
+      // Any error in reading either file counts as a difference.
+      match = false;
+
+    } else if (count < buffer_size) {
+      // A short read must be the end of both files; anything else is an
+      // error.
+      match = (a_in->eof() && b_in->eof());
+      break;
+    }
+  }
+
+  a_file->close_read_file(a_in);
+  b_file->close_read_file(b_in);
+  return match;
+}
+
 /**
  *
  */
@@ -22,6 +22,7 @@
 #include "dSearchPath.h"
 #include "pvector.h"
 #include "pmap.h"
+#include "pmutex.h"
 
 /**
  * This encapsulates the user's command-line request to replace existing,
@@ -32,6 +33,9 @@
  * This can also go the next step, which is to convert a known file into a
  * suitable form for storing in a model file.  In this capacity, it
  * corresponds to the -ps and -pd options.
+ *
+ * match_path(), store_path() and convert_path() may be called from several
+ * threads at once, e.g.  by converters that read several files in parallel.
  */
 class PathReplace : public ReferenceCount {
 public:
@@ -85,6 +89,7 @@ public:
 
 private:
   bool copy_this_file(Filename &filename);
+  static bool same_contents(const Filename &a, const Filename &b);
 
   class Component {
   public:
@@ -120,6 +125,9 @@ private:
   typedef pmap<Filename, Filename> Copied;
   Copied _orig_to_target;
   Copied _target_to_orig;
+
+  // This protects the error flag and the tables of copied files above.
+  Mutex _lock;
 };
 
 #include "pathReplace.I"
@@ -0,0 +1,115 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file workerPool.cxx
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#include "workerPool.h"
+#include "mutexHolder.h"
+#include "pvector.h"
+#include "string_utils.h"
+
+#include <algorithm>
+
+/**
+ * Creates a pool that will run jobs on the indicated number of threads.  A
+ * value of 1 (or less) means to run all jobs serially on the calling thread.
+ */
+WorkerPool::
+WorkerPool(int num_threads) {
+  _num_threads = std::max(num_threads, 1);
+  if (!Thread::is_threading_supported()) {
+    _num_threads = 1;
+  }
+
+  _next_job = 0;
+  _num_jobs = 0;
+  _func = nullptr;
+  _user_data = nullptr;
+}
+
+/**
+ * Calls func(i, user_data) for each i in the range [0, num_jobs), spreading
+ * the calls across the pool's threads, and returns when all of them have
+ * completed.  The calling thread participates in the work.
+ */
+void WorkerPool::
+run(int num_jobs, JobFunc *func, void *user_data) {
+  if (num_jobs <= 0) {
+    return;
+  }
+
+  _next_job = 0;
+  _num_jobs = num_jobs;
+  _func = func;
+  _user_data = user_data;
+
+  int num_workers = std::min(_num_threads, num_jobs) - 1;
+  pvector<PT(Worker)> workers;
+  workers.reserve(num_workers);
+  for (int i = 0; i < num_workers; ++i) {
+    PT(Worker) worker = new Worker(this, i + 1);
+    if (!worker->start(TP_normal, true)) {
+      // No matter; the remaining threads will take up the slack.
+      break;
+    }
+    workers.push_back(worker);
+  }
+
+  do_jobs();
+
+  pvector<PT(Worker)>::iterator wi;
+  for (wi = workers.begin(); wi != workers.end(); ++wi) {
+    (*wi)->join();
+  }
+
+  _func = nullptr;
+  _user_data = nullptr;
+}
+
+/**
+ * Repeatedly claims the next unclaimed job and runs it, until there are no
+ * jobs left.  This is called by each worker thread, as well as by the thread
+ * that called run().
+ */
+void WorkerPool::
+do_jobs() {
+  while (true) {
+    int job_index;
+    {
+      MutexHolder holder(_lock);
+      if (_next_job >= _num_jobs) {
+        return;
+      }
+      job_index = _next_job;
+      ++_next_job;
+    }
+
+    (*_func)(job_index, _user_data);
+  }
+}
+
+/**
+ *
+ */
+WorkerPool::Worker::
+Worker(WorkerPool *pool, int index) :
+  Thread("worker-" + format_string(index), "worker"),
+  _pool(pool)
+{
+}
+
+/**
+ *
+ */
+void WorkerPool::Worker::
+thread_main() {
+  _pool->do_jobs();
+}
@@ -0,0 +1,67 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file workerPool.h
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include "pandatoolbase.h"
+
+#include "thread.h"
+#include "pmutex.h"
+
+/**
+ * This is a simple pool of worker threads, used by the various converters to
+ * run a number of independent jobs concurrently.  Each job is identified by
+ * its index, from 0 to num_jobs - 1; the job function is called exactly once
+ * for each index, from whichever thread happens to be free.
+ *
+ * If threading is not available in this build of Panda, or only one thread
+ * is requested, the jobs are simply run in order on the calling thread.
+ */
+class WorkerPool {
+public:
+  typedef void JobFunc(int job_index, void *user_data);
+
+  WorkerPool(int num_threads);
+
+  INLINE int get_num_threads() const;
+  INLINE bool is_threaded() const;
+
+  void run(int num_jobs, JobFunc *func, void *user_data);
+
+private:
+  void do_jobs();
+
+  class Worker : public Thread {
+  public:
+    Worker(WorkerPool *pool, int index);
+
+  protected:
+    virtual void thread_main();
+
+  private:
+    WorkerPool *_pool;
+  };
+
+  int _num_threads;
+
+  Mutex _lock;
+  int _next_job;
+  int _num_jobs;
+  JobFunc *_func;
+  void *_user_data;
+};
+
+#include "workerPool.I"
+
+#endif
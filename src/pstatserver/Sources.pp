@@ -28,3 +28,16 @@
     pStatViewLevel.I pStatViewLevel.h
 
 #end ss_lib_target
+
+#begin test_bin_target
+  #define TARGET test_pstatview
+  #define LOCAL_LIBS p3pstatserver p3pandatoolbase
+  #define OTHER_LIBS \
+    p3pstatclient:c p3putil:c p3pipeline:c panda:m \
+    p3pandabase:c p3express:c p3linmath:c pandaexpress:m \
+    p3interrogatedb p3dtoolutil:c p3dtoolbase:c p3prc  p3dtool:m
+
+  #define SOURCES \
+    test_pstatview.cxx
+
+#end test_bin_target
@@ -16,6 +16,8 @@
 
 #include "pStatCollectorDef.h"
 
+#include <algorithm>
+
 using std::string;
 
 PStatCollectorDef PStatClientData::_null_collector(-1, "Unknown");
@@ -240,15 +242,29 @@ get_child_distance(int parent, int child) const {
   if (parent == child) {
     return 0;
   }
-  if (!has_collector(child) || child == 0) {
+  update_ancestry();
+
+  if (child < 0 || child >= (int)_ancestry.size() ||
+      parent < 0 || parent >= (int)_ancestry.size()) {
     return -1;
   }
-  int dist = get_child_distance(parent, get_collector_def(child)._parent_index);
-  if (dist == -1) {
+  const Ancestry &p = _ancestry[parent];
+  const Ancestry &c = _ancestry[child];
+  if (p._begin < 0 || c._begin < p._begin || c._begin >= p._end) {
     return -1;
-  } else {
-    return dist + 1;
   }
+  return c._depth - p._depth;
+}
+
+/**
+ * Returns a sequence number that is incremented each time a collector is
+ * defined or redefined.  This may be used to determine when information
+ * cached from the collector definitions, such as their parent relationships,
+ * must be recomputed.
+ */
+UpdateSeq PStatClientData::
+get_collector_seq() const {
+  return _collector_seq;
 }
 
 /**
@@ -269,6 +285,7 @@ add_collector(PStatCollectorDef *def) {
   }
 
   _collectors[def->_index]._def = def;
+  ++_collector_seq;
   update_toplevel_collectors();
 
   // If we already had the _is_level flag set, it should be immediately
@@ -337,6 +354,93 @@ slot_collector(int collector_index) {
   }
 }
 
+/**
+ * Rebuilds the ancestry table used by get_child_distance(), if any collector
+ * has been defined or redefined since it was last built.  The table is
+ * rebuilt only when it is next needed, since collector definitions usually
+ * arrive in large batches.
+ */
+void PStatClientData::
+update_ancestry() const {
+  if (_ancestry_seq == _collector_seq) {
+    return;
+  }
+
+  // The table must also have an entry for any undefined collector that is
+  // named as a parent.
+  int num_collectors = (int)_collectors.size();
+  Collectors::const_iterator ci;
+  for (ci = _collectors.begin(); ci != _collectors.end(); ++ci) {
+    PStatCollectorDef *def = (*ci)._def;
+    if (def != nullptr) {
+      num_collectors = std::max(num_collectors, def->_parent_index + 1);
+    }
+  }
+
+  // Build a list of children for each collector.  Collector 0 is the root of
+  // everything; it has no parent even if one is given, nor does a collector
+  // that names itself as its own parent.
+  vector_int first_child(num_collectors, -1);
+  vector_int next_sibling(num_collectors, -1);
+  vector_int parent(num_collectors, -1);
+  for (int i = (int)_collectors.size() - 1; i > 0; --i) {
+    PStatCollectorDef *def = _collectors[i]._def;
+    if (def != nullptr && def->_parent_index >= 0 && def->_parent_index != i) {
+      parent[i] = def->_parent_index;
+      next_sibling[i] = first_child[parent[i]];
+      first_child[parent[i]] = i;
+    }
+  }
+
+  _ancestry.clear();
+  Ancestry unvisited;
+  unvisited._begin = -1;
+  unvisited._end = -1;
+  unvisited._depth = 0;
+  _ancestry.resize(num_collectors, unvisited);
+
+  // Now walk each tree in preorder, without recursion.
+  int next_index = 0;
+  for (int root = 0; root < num_collectors; ++root) {
+    if (parent[root] != -1) {
+      continue;
+    }
+    _ancestry[root]._begin = next_index++;
+    _ancestry[root]._depth = 0;
+
+    int node = root;
+    while (node != -1) {
+      int child = first_child[node];
+      if (child != -1) {
+        // Descend to the first child.
+        _ancestry[child]._begin = next_index++;
+        _ancestry[child]._depth = _ancestry[node]._depth + 1;
+        node = child;
+
+      } else {
+        // Close off this node, and any ancestors of which it is the last
+        // child, then move on to the next sibling.
+        while (node != -1) {
+          _ancestry[node]._end = next_index;
+          if (node == root) {
+            node = -1;
+          } else if (next_sibling[node] != -1) {
+            int sibling = next_sibling[node];
+            _ancestry[sibling]._begin = next_index++;
+            _ancestry[sibling]._depth = _ancestry[node]._depth;
+            node = sibling;
+            break;
+          } else {
+            node = parent[node];
+          }
+        }
+      }
+    }
+  }
+
+  _ancestry_seq = _collector_seq;
+}
+
 /**
  * Rebuilds the list of toplevel collectors.
  */
@@ -22,6 +22,7 @@
 #include "referenceCount.h"
 #include "pointerTo.h"
 #include "bitArray.h"
+#include "updateSeq.h"
 
 #include "pvector.h"
 #include "vector_int.h"
@@ -58,6 +59,7 @@ public:
   const PStatThreadData *get_thread_data(int index) const;
 
   int get_child_distance(int parent, int child) const;
+  UpdateSeq get_collector_seq() const;
 
 
   void add_collector(PStatCollectorDef *def);
@@ -68,6 +70,7 @@ public:
 private:
   void slot_collector(int collector_index);
   void update_toplevel_collectors();
+  void update_ancestry() const;
 
 private:
   bool _is_alive;
@@ -81,10 +84,28 @@ private:
 
   typedef pvector<Collector> Collectors;
   Collectors _collectors;
+  UpdateSeq _collector_seq;
 
   typedef vector_int ToplevelCollectors;
   ToplevelCollectors _toplevel_collectors;
 
+  // A flattened copy of the collector tree, used to answer
+  // get_child_distance() without walking up the parent chain.  The
+  // descendants of each collector are numbered consecutively, in the range
+  // [_begin, _end), in a preorder walk of the tree.  A collector whose
+  // parent is not defined is the root of its own tree.  _begin is -1 for a
+  // collector not reached by the walk, which can only happen if the parent
+  // chain contains a cycle.
+  class Ancestry {
+  public:
+    int _begin;
+    int _end;
+    int _depth;
+  };
+  typedef pvector<Ancestry> AncestryTable;
+  mutable AncestryTable _ancestry;
+  mutable UpdateSeq _ancestry_seq;
+
   class Thread {
   public:
     std::string _name;
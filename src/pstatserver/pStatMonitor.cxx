@@ -24,6 +24,7 @@ using std::string;
 PStatMonitor::
 PStatMonitor(PStatServer *server) : _server(server) {
   _client_known = false;
+  _num_dropped_frames = 0;
 }
 
 /**
@@ -72,6 +73,15 @@ set_client_data(PStatClientData *client_data) {
   initialized();
 }
 
+/**
+ * Called by the PStatReader when it has had to discard frames received from
+ * the client, because they arrived faster than they could be processed.
+ */
+void PStatMonitor::
+dropped_frames(int num_frames) {
+  _num_dropped_frames += num_frames;
+}
+
 /**
  * Returns true if the client is alive and connected, false otherwise.
  */
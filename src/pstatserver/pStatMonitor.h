@@ -48,6 +48,7 @@ public:
                    int client_major, int client_minor,
                    int server_major, int server_minor);
   void set_client_data(PStatClientData *client_data);
+  void dropped_frames(int num_frames);
 
 
   // The following functions are for use by user code to determine information
@@ -63,6 +64,7 @@ public:
   INLINE bool is_client_known() const;
   INLINE std::string get_client_hostname() const;
   INLINE std::string get_client_progname() const;
+  INLINE int get_num_dropped_frames() const;
 
   PStatView &get_view(int thread_index);
   PStatView &get_level_view(int collector_index, int thread_index);
@@ -98,6 +100,7 @@ private:
   bool _client_known;
   std::string _client_hostname;
   std::string _client_progname;
+  int _num_dropped_frames;
 
   typedef pmap<int, PStatView> Views;
   Views _views;
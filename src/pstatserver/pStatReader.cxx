@@ -40,6 +40,10 @@ PStatReader(PStatServer *manager, PStatMonitor *monitor) :
   set_tcp_header_size(4);
   _writer.set_tcp_header_size(4);
   _udp_port = 0;
+  _queue_head = 0;
+  _queue_tail = 0;
+  _num_dropped_frames = 0;
+  _num_reported_dropped_frames = 0;
   _client_data = new PStatClientData(this);
   _monitor->set_client_data(_client_data);
 }
@@ -50,6 +54,14 @@ PStatReader(PStatServer *manager, PStatMonitor *monitor) :
 PStatReader::
 ~PStatReader() {
   _manager->release_udp_port(_udp_port);
+
+  // Free any frames that were never dequeued.
+  AtomicAdjust::Integer head = AtomicAdjust::get(_queue_head);
+  AtomicAdjust::Integer tail = AtomicAdjust::get(_queue_tail);
+  while (head != tail) {
+    delete _queued_frame_data[head]._frame_data;
+    head = (head + 1) % queued_frame_records;
+  }
 }
 
 /**
@@ -251,17 +263,24 @@ handle_client_udp_data(const Datagram &datagram) {
     nassertv(initial_byte == 0);
   }
 
-  if (!_queued_frame_data.full()) {
-    FrameData data;
-    data._thread_index = source.get_uint16();
-    data._frame_number = source.get_uint32();
-    data._frame_data = new PStatFrameData;
-    data._frame_data->read_datagram(source, _client_data);
-
-    // Queue up the data till we're ready to handle it in a single-threaded
-    // way.
-    _queued_frame_data.push_back(data);
+  AtomicAdjust::Integer tail = AtomicAdjust::get(_queue_tail);
+  AtomicAdjust::Integer next_tail = (tail + 1) % queued_frame_records;
+  if (next_tail == AtomicAdjust::get(_queue_head)) {
+    // The queue is full; the main thread isn't keeping up.  We have to drop
+    // this frame, but we count it so the monitor can report it.
+    AtomicAdjust::inc(_num_dropped_frames);
+    return;
   }
+
+  FrameData &data = _queued_frame_data[tail];
+  data._thread_index = source.get_uint16();
+  data._frame_number = source.get_uint32();
+  data._frame_data = new PStatFrameData;
+  data._frame_data->read_datagram(source, _client_data);
+
+  // Queue up the data till we're ready to handle it in a single-threaded
+  // way.  Advancing the tail publishes the slot to the main thread.
+  AtomicAdjust::set(_queue_tail, next_tail);
 }
 
 /**
@@ -270,8 +289,9 @@ handle_client_udp_data(const Datagram &datagram) {
  */
 void PStatReader::
 dequeue_frame_data() {
-  while (!_queued_frame_data.empty()) {
-    const FrameData &data = _queued_frame_data.front();
+  AtomicAdjust::Integer head = AtomicAdjust::get(_queue_head);
+  while (head != AtomicAdjust::get(_queue_tail)) {
+    const FrameData &data = _queued_frame_data[head];
     nassertv(_client_data != nullptr);
 
     // Check to see if any new collectors have level data.
@@ -290,6 +310,14 @@ dequeue_frame_data() {
                                    data._frame_data);
     _monitor->new_data(data._thread_index, data._frame_number);
 
-    _queued_frame_data.pop_front();
+    // Advancing the head releases the slot back to the reader thread.
+    head = (head + 1) % queued_frame_records;
+    AtomicAdjust::set(_queue_head, head);
+  }
+
+  int num_dropped_frames = AtomicAdjust::get(_num_dropped_frames);
+  if (num_dropped_frames != _num_reported_dropped_frames) {
+    _monitor->dropped_frames(num_dropped_frames - _num_reported_dropped_frames);
+    _num_reported_dropped_frames = num_dropped_frames;
   }
 }
@@ -22,7 +22,7 @@
 #include "connectionReader.h"
 #include "connectionWriter.h"
 #include "referenceCount.h"
-#include "circBuffer.h"
+#include "atomicAdjust.h"
 
 class PStatServer;
 class PStatMonitor;
@@ -80,8 +80,16 @@ private:
     int _frame_number;
     PStatFrameData *_frame_data;
   };
-  typedef CircBuffer<FrameData, queued_frame_records> QueuedFrameData;
-  QueuedFrameData _queued_frame_data;
+
+  // This is a lock-free queue of frames passed from the reader thread, which
+  // only advances _queue_tail, to the main thread, which only advances
+  // _queue_head.  Frames that arrive while the queue is full are counted in
+  // _num_dropped_frames, and reported to the monitor.
+  FrameData _queued_frame_data[queued_frame_records];
+  AtomicAdjust::Integer _queue_head;
+  AtomicAdjust::Integer _queue_tail;
+  AtomicAdjust::Integer _num_dropped_frames;
+  int _num_reported_dropped_frames;
 };
 
 #endif
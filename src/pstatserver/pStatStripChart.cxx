@@ -39,6 +39,7 @@ PStatStripChart(PStatMonitor *monitor, PStatView &view,
   _scroll_mode = pstats_scroll_mode;
   _average_mode = false;
 
+  _data_first_frame = 0;
   _next_frame = 0;
   _first_data = true;
   _cursor_pixel = 0;
@@ -101,13 +102,15 @@ update() {
       double oldest_time =
         thread_data->get_frame(latest).get_start() - _time_width;
 
-      Data::iterator di;
-      di = _data.begin();
-      while (di != _data.end() &&
-             thread_data->get_frame((*di).first).get_start() < oldest_time) {
-        dec_label_usage((*di).second);
-        _data.erase(di);
-        di = _data.begin();
+      while (!_data.empty() &&
+             (!_data.front()._valid ||
+              thread_data->get_frame(_data_first_frame).get_start() <
+              oldest_time)) {
+        if (_data.front()._valid) {
+          dec_label_usage(_data.front()._fdata);
+        }
+        _data.pop_front();
+        ++_data_first_frame;
       }
     }
   }
@@ -213,8 +216,9 @@ get_collector_under_pixel(int xpoint, int ypoint) {
     int then_i = thread_data->get_frame_number_at_time(start_time - pstats_average_time);
     int now_i = thread_data->get_frame_number_at_time(start_time, then_i);
 
+    AverageWindow window(then_i, now_i);
     FrameData fdata;
-    compute_average_pixel_data(fdata, then_i, now_i, start_time);
+    compute_average_pixel_data(fdata, window, start_time);
     double overall_value = 0.0;
     int y = get_ysize();
 
@@ -403,17 +407,29 @@ scale_frame_data(FrameData &fdata, double factor) {
  */
 const PStatStripChart::FrameData &PStatStripChart::
 get_frame_data(int frame_number) {
-  Data::const_iterator di;
-  di = _data.find(frame_number);
-  if (di != _data.end()) {
-    return (*di).second;
+  // Extend the cache in either direction as needed to include this frame.
+  if (_data.empty()) {
+    _data_first_frame = frame_number;
+  }
+  while (frame_number < _data_first_frame) {
+    _data.push_front(CachedFrame());
+    --_data_first_frame;
+  }
+  size_t index = (size_t)(frame_number - _data_first_frame);
+  if (index >= _data.size()) {
+    _data.resize(index + 1);
+  }
+
+  CachedFrame &cached = _data[index];
+  FrameData &fdata = cached._fdata;
+  if (cached._valid) {
+    return fdata;
   }
+  cached._valid = true;
 
   const PStatThreadData *thread_data = _view.get_thread_data();
   _view.set_to_frame(thread_data->get_frame(frame_number));
 
-  FrameData &fdata = _data[frame_number];
-
   const PStatViewLevel *level = _view.get_level(_collector_index);
   int num_children = level->get_num_children();
   for (int i = 0; i < num_children; i++) {
@@ -446,15 +462,20 @@ get_frame_data(int frame_number) {
  * Fills the indicated FrameData structure with the color data for the
  * indicated pixel, averaged over the past pstats_average_time seconds.
  *
- * now is the timestamp for which we are computing the data; then_i and now_i
- * are the frame numbers that bound (now - pstats_average_time) and now.  At
- * function initialization time, these should be at or below the actual
- * values; they will be incremented as needed by this function.  This allows
- * the function to be called repeatedly for successive pixels.
+ * now is the timestamp for which we are computing the data.  The window's
+ * then_i and now_i are the frame numbers that bound (now -
+ * pstats_average_time) and now; when the window is constructed, these should
+ * be at or below the actual values, and they will be incremented as needed by
+ * this function.  This allows the function to be called repeatedly with the
+ * same window for successive pixels.
+ *
+ * The window also keeps a running sum of the frames wholly within it, so
+ * that each successive pixel need only add the frames that have entered the
+ * window and subtract those that have left it.
  */
 void PStatStripChart::
 compute_average_pixel_data(PStatStripChart::FrameData &result,
-                           int &then_i, int &now_i, double now) {
+                           AverageWindow &window, double now) {
   result.clear();
 
   const PStatThreadData *thread_data = _view.get_thread_data();
@@ -466,33 +487,49 @@ compute_average_pixel_data(PStatStripChart::FrameData &result,
   double then = now - pstats_average_time;
 
   int latest_frame = thread_data->get_latest_frame_number();
-  while (then_i <= latest_frame &&
-         thread_data->get_frame(then_i).get_end() < then) {
-    then_i++;
+  while (window._then_i <= latest_frame &&
+         thread_data->get_frame(window._then_i).get_end() < then) {
+    window._then_i++;
   }
-  while (now_i <= latest_frame &&
-         thread_data->get_frame(now_i).get_end() < now) {
-    now_i++;
+  while (window._now_i <= latest_frame &&
+         thread_data->get_frame(window._now_i).get_end() < now) {
+    window._now_i++;
   }
+  int then_i = window._then_i;
+  int now_i = window._now_i;
 
   then = max(then, thread_data->get_frame(then_i).get_start());
 
-  // Sum up a weighted average of all of the individual frames we pass.
+  // Slide the running sum so that it covers exactly the middle frames, those
+  // after then_i and before now_i.  Each of these contributes its entire
+  // length.
+  int begin_i = then_i + 1;
+  int end_i = max(now_i, begin_i);
+  if (begin_i >= window._end_i) {
+    // None of the frames summed so far are still in the window.
+    window._sum.clear();
+    window._count.clear();
+    window._begin_i = begin_i;
+    window._end_i = begin_i;
+  }
+  for (; window._end_i < end_i; ++window._end_i) {
+    adjust_window(window, window._end_i, 1);
+  }
+  for (; window._begin_i < begin_i; ++window._begin_i) {
+    adjust_window(window, window._begin_i, -1);
+  }
 
-  // We start with just the portion of frame then_i that actually does fall
+  for (size_t i = 0; i < window._sum.size(); ++i) {
+    if (window._count[i] > 0) {
+      result.push_back(window._sum[i]);
+    }
+  }
+
+  // Now add in just the portion of frame then_i that actually does fall
   // within our "then to now" window.
   accumulate_frame_data(result, get_frame_data(then_i),
                         thread_data->get_frame(then_i).get_end() - then);
-  double last = thread_data->get_frame(then_i).get_end();
-
-  // Then we get all of each of the middle frames.
-  for (int frame_number = then_i + 1;
-       frame_number < now_i;
-       frame_number++) {
-    accumulate_frame_data(result, get_frame_data(frame_number),
-                          thread_data->get_frame(frame_number).get_end() - last);
-    last = thread_data->get_frame(frame_number).get_end();
-  }
+  double last = thread_data->get_frame(max(then_i, now_i - 1)).get_end();
 
   // And finally, we get the remainder as now_i.
   if (last <= now) {
@@ -841,12 +878,13 @@ draw_pixels(int first_pixel, int last_pixel) {
     double start_time = pixel_to_timestamp(first_pixel);
     int then_i = thread_data->get_frame_number_at_time(start_time - pstats_average_time);
     int now_i = thread_data->get_frame_number_at_time(start_time, then_i);
+    AverageWindow window(then_i, now_i);
+    FrameData fdata;
     for (int x = first_pixel; x <= last_pixel; x++) {
       if (x == _cursor_pixel && !_scroll_mode) {
         draw_cursor(x);
       } else {
-        FrameData fdata;
-        compute_average_pixel_data(fdata, then_i, now_i, pixel_to_timestamp(x));
+        compute_average_pixel_data(fdata, window, pixel_to_timestamp(x));
         draw_slice(x, 1, fdata);
       }
     }
@@ -886,6 +924,41 @@ draw_pixels(int first_pixel, int last_pixel) {
   end_draw(first_pixel, last_pixel);
 }
 
+/**
+ * Adds the entire length of the indicated frame into the window's running
+ * sum, if delta is 1, or removes it again, if delta is -1.
+ */
+void PStatStripChart::
+adjust_window(AverageWindow &window, int frame_number, int delta) {
+  const PStatThreadData *thread_data = _view.get_thread_data();
+  double weight = delta *
+    (thread_data->get_frame(frame_number).get_end() -
+     thread_data->get_frame(frame_number - 1).get_end());
+
+  const FrameData &fdata = get_frame_data(frame_number);
+  FrameData::const_iterator fi;
+  for (fi = fdata.begin(); fi != fdata.end(); ++fi) {
+    const ColorData &cd = (*fi);
+    if (cd._i >= window._sum.size()) {
+      ColorData zero;
+      zero._collector_index = 0;
+      zero._i = 0;
+      zero._net_value = 0.0;
+      window._sum.resize(cd._i + 1, zero);
+      window._count.resize(cd._i + 1, 0);
+    }
+    ColorData &sum = window._sum[cd._i];
+    sum._collector_index = cd._collector_index;
+    sum._i = cd._i;
+    sum._net_value += cd._net_value * weight;
+    window._count[cd._i] += delta;
+    if (window._count[cd._i] == 0) {
+      // Don't let rounding error accumulate in an entry that has emptied.
+      sum._net_value = 0.0;
+    }
+  }
+}
+
 /**
  * Erases all elements from the label usage data.
  */
@@ -23,7 +23,7 @@
 #include "luse.h"
 #include "vector_int.h"
 
-#include "pmap.h"
+#include "pdeque.h"
 
 class PStatView;
 
@@ -79,7 +79,32 @@ protected:
     double _net_value;
   };
   typedef pvector<ColorData> FrameData;
-  typedef pmap<int, FrameData> Data;
+
+  // The FrameData computed for a particular frame, if _valid is true.
+  class CachedFrame {
+  public:
+    bool _valid;
+    FrameData _fdata;
+  };
+  typedef pdeque<CachedFrame> Data;
+
+  // The running state used to average the data for a series of successive
+  // pixels; see compute_average_pixel_data().
+  class AverageWindow {
+  public:
+    INLINE AverageWindow(int then_i, int now_i);
+
+    int _then_i;
+    int _now_i;
+
+    // The frames from _begin_i up to, but not including, _end_i have been
+    // summed into _sum, which is indexed by ColorData::_i.  _count records
+    // how many of those frames contributed to each entry.
+    int _begin_i;
+    int _end_i;
+    FrameData _sum;
+    vector_int _count;
+  };
 
   static void accumulate_frame_data(FrameData &fdata,
                                     const FrameData &additional, double weight);
@@ -87,7 +112,7 @@ protected:
 
   const FrameData &get_frame_data(int frame_number);
   void compute_average_pixel_data(PStatStripChart::FrameData &result,
-                                  int &then_i, int &now_i, double now);
+                                  AverageWindow &window, double now);
   double get_net_value(int frame_number) const;
   double get_average_net_value() const;
 
@@ -112,6 +137,8 @@ private:
   void draw_frames(int first_frame, int last_frame);
   void draw_pixels(int first_pixel, int last_pixel);
 
+  void adjust_window(AverageWindow &window, int frame_number, int delta);
+
   void clear_label_usage();
   void dec_label_usage(const FrameData &fdata);
   void inc_label_usage(const FrameData &fdata);
@@ -125,7 +152,10 @@ private:
   bool _scroll_mode;
   bool _average_mode;
 
+  // The cached data for each frame, indexed by frame number less
+  // _data_first_frame.
   Data _data;
+  int _data_first_frame;
 
   int _next_frame;
   bool _first_data;
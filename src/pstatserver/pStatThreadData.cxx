@@ -16,7 +16,17 @@
 #include "pStatFrameData.h"
 #include "pStatCollectorDef.h"
 #include "config_pstatclient.h"
+#include "configVariableInt.h"
 
+#include <algorithm>
+
+static ConfigVariableInt pstats_max_history_mb
+("pstats-max-history-mb", 256,
+ PRC_DESC("The maximum amount of memory, in megabytes, that the stats server "
+          "will spend on recent frame data for each thread of each client.  "
+          "When this is exceeded, the oldest frames are discarded even if "
+          "they are still within pstats-history.  Set this to 0 for no "
+          "limit."));
 
 PStatFrameData PStatThreadData::_null_frame;
 
@@ -27,8 +37,12 @@ PStatThreadData::
 PStatThreadData(const PStatClientData *client_data) :
   _client_data(client_data)
 {
+  _head = 0;
+  _num_frames = 0;
   _first_frame_number = 0;
   _history = pstats_history;
+  _history_bytes = 0;
+  set_max_history_bytes((size_t)std::max((int)pstats_max_history_mb, 0) * 1024 * 1024);
   _computed_elapsed_frames = false;
 }
 
@@ -37,6 +51,9 @@ PStatThreadData(const PStatClientData *client_data) :
  */
 PStatThreadData::
 ~PStatThreadData() {
+  while (_num_frames > 0) {
+    pop_front_slot();
+  }
 }
 
 
@@ -45,7 +62,7 @@ PStatThreadData::
  */
 bool PStatThreadData::
 is_empty() const {
-  return _frames.empty();
+  return _num_frames == 0;
 }
 
 /**
@@ -53,8 +70,8 @@ is_empty() const {
  */
 int PStatThreadData::
 get_latest_frame_number() const {
-  nassertr(!_frames.empty(), 0);
-  return _first_frame_number + _frames.size() - 1;
+  nassertr(_num_frames != 0, 0);
+  return _first_frame_number + _num_frames - 1;
 }
 
 /**
@@ -62,7 +79,7 @@ get_latest_frame_number() const {
  */
 int PStatThreadData::
 get_oldest_frame_number() const {
-  nassertr(!_frames.empty(), 0);
+  nassertr(_num_frames != 0, 0);
   return _first_frame_number;
 }
 
@@ -74,8 +91,8 @@ bool PStatThreadData::
 has_frame(int frame_number) const {
   int rel_frame = frame_number - _first_frame_number;
 
-  return (rel_frame >= 0 && rel_frame < (int)_frames.size() &&
-          _frames[rel_frame] != nullptr);
+  return (rel_frame >= 0 && rel_frame < _num_frames &&
+          get_slot(rel_frame) != nullptr);
 }
 
 /**
@@ -86,25 +103,25 @@ has_frame(int frame_number) const {
 const PStatFrameData &PStatThreadData::
 get_frame(int frame_number) const {
   int rel_frame = frame_number - _first_frame_number;
-  int num_frames = _frames.size();
+  int num_frames = _num_frames;
   if (rel_frame >= num_frames) {
     rel_frame = num_frames - 1;
   }
 
-  while (rel_frame >= 0 && _frames[rel_frame] == nullptr) {
+  while (rel_frame >= 0 && get_slot(rel_frame) == nullptr) {
     rel_frame--;
   }
   if (rel_frame < 0) {
     // No frame data that old.  Return the oldest frame we've got.
     rel_frame = 0;
     while (rel_frame < num_frames &&
-           _frames[rel_frame] == nullptr) {
+           get_slot(rel_frame) == nullptr) {
       rel_frame++;
     }
   }
 
   if (rel_frame >= 0 && rel_frame < num_frames) {
-    PStatFrameData *frame = _frames[rel_frame];
+    PStatFrameData *frame = get_slot(rel_frame);
     nassertr(frame != nullptr, _null_frame);
     nassertr(frame->get_start() >= 0.0, _null_frame);
     return *frame;
@@ -120,8 +137,8 @@ get_frame(int frame_number) const {
  */
 double PStatThreadData::
 get_latest_time() const {
-  nassertr(!_frames.empty(), 0.0);
-  return _frames.back()->get_start();
+  nassertr(_num_frames != 0, 0.0);
+  return get_slot(_num_frames - 1)->get_start();
 }
 
 /**
@@ -130,8 +147,8 @@ get_latest_time() const {
  */
 double PStatThreadData::
 get_oldest_time() const {
-  nassertr(!_frames.empty(), 0.0);
-  return _frames.front()->get_start();
+  nassertr(_num_frames != 0, 0.0);
+  return get_slot(0)->get_start();
 }
 
 /**
@@ -153,35 +170,17 @@ get_frame_at_time(double time) const {
 int PStatThreadData::
 get_frame_number_at_time(double time, int hint) const {
   hint -= _first_frame_number;
-  if (hint >= 0 && hint < (int)_frames.size()) {
-    if (_frames[hint] != nullptr &&
-        _frames[hint]->get_start() <= time) {
-      // The hint might be right.  Scan forward from there.
-      int i = hint + 1;
-      while (i < (int)_frames.size() &&
-             (_frames[i] == nullptr ||
-              _frames[i]->get_start() <= time)) {
-        if (_frames[i] != nullptr) {
-          hint = i;
-        }
-        ++i;
-      }
-      return _first_frame_number + hint;
-    }
-  }
-
-  // The hint is totally wrong.  Start from the end and work backwards.
-
-  int i = _frames.size() - 1;
-  while (i >= 0) {
-    const PStatFrameData *frame = _frames[i];
+  int begin = 0;
+  if (hint >= 0 && hint < _num_frames) {
+    const PStatFrameData *frame = get_slot(hint);
     if (frame != nullptr && frame->get_start() <= time) {
-      break;
+      // The hint is not later than the answer, so we only need to search the
+      // frames after it.
+      begin = hint + 1;
     }
-    --i;
   }
 
-  return _first_frame_number + i;
+  return _first_frame_number + find_rel_frame_at_time(time, begin);
 }
 
 /**
@@ -189,8 +188,8 @@ get_frame_number_at_time(double time, int hint) const {
  */
 const PStatFrameData &PStatThreadData::
 get_latest_frame() const {
-  nassertr(!_frames.empty(), _null_frame);
-  return *_frames.back();
+  nassertr(_num_frames != 0, _null_frame);
+  return *get_slot(_num_frames - 1);
 }
 
 /**
@@ -222,8 +221,8 @@ get_frame_rate() const {
   }
 
   int num_frames = now_i - then_i + 1;
-  double now = _frames[now_i - _first_frame_number]->get_end();
-  double elapsed_time = (now - _frames[then_i - _first_frame_number]->get_start());
+  double now = get_slot(now_i - _first_frame_number)->get_end();
+  double elapsed_time = (now - get_slot(then_i - _first_frame_number)->get_start());
   return (double)num_frames / elapsed_time;
 }
 
@@ -248,6 +247,17 @@ get_history() const {
   return _history;
 }
 
+/**
+ * Sets the maximum number of bytes of frame data that will be retained by
+ * the ThreadData structure.  When a new frame is added that would exceed this
+ * limit, the oldest frames are discarded, even if they are still within the
+ * time set by set_history().  0 means no limit.
+ */
+void PStatThreadData::
+set_max_history_bytes(size_t max_bytes) {
+  _max_history_bytes = max_bytes;
+}
+
 
 /**
  * Makes room for and stores a new frame's worth of data.  Calling this
@@ -262,43 +272,140 @@ record_new_frame(int frame_number, PStatFrameData *frame_data) {
   nassertv(frame_data != nullptr);
   nassertv(!frame_data->is_empty());
   double time = frame_data->get_start();
+  size_t frame_size = get_frame_size(frame_data);
 
-  // First, remove all the old frames that fall outside of our history window.
+  // First, remove all the old frames that fall outside of our history window
+  // or our memory budget.
   double oldest_allowable_time = time - _history;
-  while (!_frames.empty() &&
-         (_frames.front() == nullptr ||
-          _frames.front()->is_empty() ||
-          _frames.front()->get_start() < oldest_allowable_time)) {
-    delete _frames.front();
-    _frames.pop_front();
-    _first_frame_number++;
+  while (_num_frames != 0) {
+    const PStatFrameData *front = get_slot(0);
+    if (front == nullptr ||
+        front->is_empty() ||
+        front->get_start() < oldest_allowable_time ||
+        (_max_history_bytes != 0 &&
+         _history_bytes + frame_size > _max_history_bytes)) {
+      pop_front_slot();
+    } else {
+      break;
+    }
   }
 
   // Now, add enough empty frame definitions to account for the latest frame
   // number.  This might involve some skips, since we don't guarantee that we
   // get all the frames in order or even at all.
-  if (_frames.empty()) {
+  if (_num_frames == 0) {
     _first_frame_number = frame_number;
-    _frames.push_back(nullptr);
+    push_back_slot(nullptr);
 
   } else {
-    while (_first_frame_number + (int)_frames.size() <= frame_number) {
-      _frames.push_back(nullptr);
+    while (_first_frame_number + _num_frames <= frame_number) {
+      push_back_slot(nullptr);
     }
   }
 
   int index = frame_number - _first_frame_number;
-  nassertv(index >= 0 && index < (int)_frames.size());
+  nassertv(index >= 0 && index < _num_frames);
 
-  if (_frames[index] != nullptr) {
+  PStatFrameData *old_frame = get_slot(index);
+  if (old_frame != nullptr) {
     nout << "Got repeated frame data for frame " << frame_number << "\n";
-    delete _frames[index];
+    _history_bytes -= get_frame_size(old_frame);
+    delete old_frame;
   }
 
-  _frames[index] = frame_data;
+  set_slot(index, frame_data);
+  _history_bytes += frame_size;
   _computed_elapsed_frames = false;
 }
 
+/**
+ * Appends a new slot to the end of the ring buffer, growing the buffer if
+ * necessary.
+ */
+void PStatThreadData::
+push_back_slot(PStatFrameData *frame_data) {
+  if (_num_frames == (int)_frames.size()) {
+    // The ring is full; double its size, and unwrap the frames so that the
+    // oldest is at the beginning again.
+    Frames new_frames(std::max(_frames.size() * 2, (size_t)64), nullptr);
+    for (int i = 0; i < _num_frames; ++i) {
+      new_frames[i] = get_slot(i);
+    }
+    _frames.swap(new_frames);
+    _head = 0;
+  }
+
+  ++_num_frames;
+  set_slot(_num_frames - 1, frame_data);
+}
+
+/**
+ * Removes and deletes the oldest frame in the ring buffer.
+ */
+void PStatThreadData::
+pop_front_slot() {
+  nassertv(_num_frames != 0);
+  PStatFrameData *frame = get_slot(0);
+  if (frame != nullptr) {
+    _history_bytes -= get_frame_size(frame);
+    delete frame;
+    set_slot(0, nullptr);
+  }
+
+  _head = (_head + 1) & (_frames.size() - 1);
+  --_num_frames;
+  _first_frame_number++;
+}
+
+/**
+ * Returns the index, relative to the oldest frame, of the latest received
+ * frame whose start time is not later than the indicated time, or -1 if
+ * there is no such frame.  All received frames before begin must already be
+ * known to be not later than the time.
+ *
+ * Since frame times increase with frame number, this is a binary search; the
+ * only linear part is skipping over frames that were not received.
+ */
+int PStatThreadData::
+find_rel_frame_at_time(double time, int begin) const {
+  // Every received frame before lo starts at or before the time, and every
+  // received frame at or after hi starts after it.
+  int lo = begin;
+  int hi = _num_frames;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+
+    // Look for the nearest received frame at or before mid.
+    int i = mid;
+    while (i >= lo && get_slot(i) == nullptr) {
+      --i;
+    }
+
+    if (i < lo || get_slot(i)->get_start() <= time) {
+      lo = mid + 1;
+    } else {
+      hi = i;
+    }
+  }
+
+  int i = lo - 1;
+  while (i >= 0 && get_slot(i) == nullptr) {
+    --i;
+  }
+  return i;
+}
+
+/**
+ * Returns the approximate number of bytes of memory consumed by the indicated
+ * frame, for the purposes of enforcing set_max_history_bytes().
+ */
+size_t PStatThreadData::
+get_frame_size(const PStatFrameData *frame_data) {
+  // Each event or level is stored as a collector index and a value.
+  size_t num_points = frame_data->get_num_events() + frame_data->get_num_levels();
+  return sizeof(PStatFrameData) + num_points * (sizeof(int) + sizeof(double));
+}
+
 /**
  * Computes the frame numbers returned by get_elapsed_frames().  This is non-
  * const, but only updates cached values, so may safely be called from a const
@@ -306,42 +413,35 @@ record_new_frame(int frame_number, PStatFrameData *frame_data) {
  */
 void PStatThreadData::
 compute_elapsed_frames() {
-  if (_frames.empty()) {
+  if (_num_frames == 0) {
     // No frames in the data at all.
     _got_elapsed_frames = false;
 
   } else {
-    _now_i = _frames.size() - 1;
-    while (_now_i > 0 && _frames[_now_i] == nullptr) {
+    _now_i = _num_frames - 1;
+    while (_now_i > 0 && get_slot(_now_i) == nullptr) {
       _now_i--;
     }
-    if (_now_i < 0) {
+    if (get_slot(_now_i) == nullptr) {
       // No frames have any real data.
       _got_elapsed_frames = false;
 
     } else {
-      nassertv(_frames[_now_i] != nullptr);
-
-      double now = _frames[_now_i]->get_end();
+      double now = get_slot(_now_i)->get_end();
       double then = now - pstats_average_time;
 
-      int old_i = _now_i;
-      _then_i = _now_i;
-
-      while (old_i >= 0) {
-        const PStatFrameData *frame = _frames[old_i];
-        if (frame != nullptr) {
-          if (frame->get_start() > then) {
-            _then_i = old_i;
-          } else {
-            break;
-          }
-        }
-        old_i--;
+      // The oldest frame that starts after then is the next received frame
+      // after the latest one that starts at or before then.
+      _then_i = find_rel_frame_at_time(then, 0) + 1;
+      while (_then_i < _now_i && get_slot(_then_i) == nullptr) {
+        _then_i++;
+      }
+      if (_then_i > _now_i) {
+        _then_i = _now_i;
       }
 
       nassertv(_then_i >= 0);
-      nassertv(_frames[_then_i] != nullptr);
+      nassertv(get_slot(_then_i) != nullptr);
       _got_elapsed_frames = true;
 
       _now_i += _first_frame_number;
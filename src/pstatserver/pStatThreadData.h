@@ -18,7 +18,7 @@
 
 #include "referenceCount.h"
 
-#include "pdeque.h"
+#include "pvector.h"
 
 class PStatCollectorDef;
 class PStatFrameData;
@@ -30,6 +30,11 @@ class PStatClientData;
  * it automatically handles frames received out-of-order or skipped.  You can
  * ask for a particular frame by frame number or time and receive the data for
  * the nearest frame.
+ *
+ * The frames are kept in a ring buffer indexed by frame number.  Since frame
+ * times increase with frame number, a frame may be looked up by time with a
+ * binary search.  The number of frames retained is limited by set_history(),
+ * and also by the pstats-max-history-mb config variable.
  */
 class PStatThreadData : public ReferenceCount {
 public:
@@ -59,17 +64,37 @@ public:
   void set_history(double time);
   double get_history() const;
 
+  void set_max_history_bytes(size_t max_bytes);
+  INLINE size_t get_max_history_bytes() const;
+  INLINE size_t get_history_bytes() const;
+
   void record_new_frame(int frame_number, PStatFrameData *frame_data);
 
 private:
+  INLINE PStatFrameData *get_slot(int rel_frame) const;
+  INLINE void set_slot(int rel_frame, PStatFrameData *frame_data);
+  void push_back_slot(PStatFrameData *frame_data);
+  void pop_front_slot();
+  int find_rel_frame_at_time(double time, int begin) const;
+
+  static size_t get_frame_size(const PStatFrameData *frame_data);
+
   void compute_elapsed_frames();
   const PStatClientData *_client_data;
 
-  typedef pdeque<PStatFrameData *> Frames;
+  // The frames are stored in a ring buffer, whose size is always a power of
+  // two.  The slot for frame number _first_frame_number is at _head; frames
+  // that have not been received are stored as NULL.
+  typedef pvector<PStatFrameData *> Frames;
   Frames _frames;
+  int _head;
+  int _num_frames;
   int _first_frame_number;
   double _history;
 
+  size_t _history_bytes;
+  size_t _max_history_bytes;
+
   bool _computed_elapsed_frames;
   bool _got_elapsed_frames;
   int _then_i;
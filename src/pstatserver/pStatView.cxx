@@ -15,109 +15,9 @@
 
 #include "pStatFrameData.h"
 #include "pStatCollectorDef.h"
-#include "vector_int.h"
-#include "plist.h"
-#include "pset.h"
 
 #include <algorithm>
 
-
-
-/**
- * This class is used within this module only--in fact, within
- * PStatView::set_to_frame() only--to help collect event data out of the
- * PStatFrameData object and boil it down to a list of elapsed times.
- */
-class FrameSample {
-public:
-  typedef plist<FrameSample *> Started;
-
-  FrameSample() {
-    _touched = false;
-    _is_started = false;
-    _pushed = false;
-    _net_time = 0.0;
-  }
-  void data_point(double time, bool is_start, Started &started) {
-    _touched = true;
-
-    // We only consider events that change the startstop state.  With two
-    // consecutive 'start' events, for instance, we ignore the second one.
-
-/*
- * *** That's not quite the right thing to do.  We should keep track of the
- * nesting level and bracket things correctly, so that we ignore the second
- * start and the *first* stop, but respect the outer startstop.  For the short
- * term, this works, because the client is already doing this logic and won't
- * send us nested startstop pairs, but we'd like to generalize this in the
- * future so we can deal with these nested pairs properly.
- */
-    nassertv(is_start != _is_started);
-
-    _is_started = is_start;
-
-    if (_pushed) {
-      nassertv(!_is_started);
-      Started::iterator si = find(started.begin(), started.end(), this);
-      nassertv(si != started.end());
-      started.erase(si);
-
-    } else {
-      if (_is_started) {
-        _net_time -= time;
-        push_all(time, started);
-        started.push_back(this);
-      } else {
-        _net_time += time;
-        Started::iterator si = find(started.begin(), started.end(), this);
-        nassertv(si != started.end());
-        started.erase(si);
-        pop_one(time, started);
-      }
-    }
-  }
-  void push(double time) {
-    if (!_pushed) {
-      _pushed = true;
-      if (_is_started) {
-        _net_time += time;
-      }
-    }
-  }
-  void pop(double time) {
-    if (_pushed) {
-      _pushed = false;
-      if (_is_started) {
-        _net_time -= time;
-      }
-    }
-  }
-
-  void push_all(double time, Started &started) {
-    Started::iterator si;
-    for (si = started.begin(); si != started.end(); ++si) {
-      (*si)->push(time);
-    }
-  }
-
-  void pop_one(double time, Started &started) {
-    Started::reverse_iterator si;
-    for (si = started.rbegin(); si != started.rend(); ++si) {
-      if ((*si)->_pushed) {
-        (*si)->pop(time);
-        return;
-      }
-    }
-  }
-
-  bool _touched;
-  bool _is_started;
-  bool _pushed;
-  double _net_time;
-};
-
-
-
 /**
  *
  */
@@ -127,6 +27,9 @@ PStatView() {
   _show_level = false;
   _all_collectors_known = false;
   _level_index = 0;
+  _last_frame = nullptr;
+  _last_frame_start = 0.0;
+  _last_frame_num_events = 0;
 }
 
 /**
@@ -158,6 +61,7 @@ constrain(int collector, bool show_level) {
   _constraint = collector;
   _show_level = show_level;
   clear_levels();
+  _constraint_members.clear();
 }
 
 /**
@@ -177,6 +81,7 @@ set_thread_data(const PStatThreadData *thread_data) {
   _thread_data = thread_data;
   _client_data = thread_data->get_client_data();
   clear_levels();
+  _constraint_members.clear();
   _all_collectors_known = false;
 }
 
@@ -189,17 +94,35 @@ set_thread_data(const PStatThreadData *thread_data) {
  * levels (for instance, if this frame introduced a new collector that hadn't
  * been active previously).  In this case, the caller must update its display
  * or whatever to account for the new level.
+ *
+ * If this is the same frame most recently applied, and no collector
+ * definitions have changed since, this does nothing, since the levels already
+ * reflect the frame's data.
  */
 void PStatView::
 set_to_frame(const PStatFrameData &frame_data) {
   nassertv(!_thread_data.is_null());
   nassertv(!_client_data.is_null());
 
+  UpdateSeq seq = _client_data->get_collector_seq();
+  if (&frame_data == _last_frame &&
+      frame_data.get_start() == _last_frame_start &&
+      frame_data.get_num_events() == _last_frame_num_events &&
+      seq == _last_frame_seq) {
+    return;
+  }
+  _last_frame = nullptr;
+
   if (_show_level) {
     update_level_data(frame_data);
   } else {
     update_time_data(frame_data);
   }
+
+  _last_frame = &frame_data;
+  _last_frame_start = frame_data.get_start();
+  _last_frame_num_events = frame_data.get_num_events();
+  _last_frame_seq = seq;
 }
 
 
@@ -280,18 +203,22 @@ void PStatView::
 update_time_data(const PStatFrameData &frame_data) {
   int num_events = frame_data.get_num_events();
 
-  typedef pvector<FrameSample> Samples;
-  Samples samples(_client_data->get_num_collectors());
+  // Reset the samples that were touched by the previous frame.
+  vector_int::const_iterator ti;
+  for (ti = _touched_samples.begin(); ti != _touched_samples.end(); ++ti) {
+    _samples[*ti].clear();
+  }
+  _touched_samples.clear();
+  _started.clear();
 
-  FrameSample::Started started;
+  int num_collectors = _client_data->get_num_collectors();
+  if ((int)_samples.size() < num_collectors) {
+    _samples.resize(num_collectors);
+  }
+  update_constraint_members();
 
   _all_collectors_known = true;
 
-
-  // This tracks the set of samples we actually care about.
-  typedef pset<int> GotSamples;
-  GotSamples got_samples;
-
   int i;
   for (i = 0; i < num_events; i++) {
     int collector_index = frame_data.get_time_collector(i);
@@ -301,17 +228,23 @@ update_time_data(const PStatFrameData &frame_data) {
       _all_collectors_known = false;
 
     } else {
-      nassertv(collector_index >= 0 && collector_index < (int)samples.size());
+      nassertv(collector_index >= 0 && collector_index < (int)_samples.size());
 
-      if (_client_data->get_child_distance(_constraint, collector_index) >= 0) {
+      if (_constraint_members[collector_index]) {
         // Here's a data point we care about: anything at constraint level or
         // below.
-        if (is_start == samples[collector_index]._is_started) {
+        FrameSample &sample = _samples[collector_index];
+        if (!sample._touched) {
+          sample._touched = true;
+          _touched_samples.push_back(collector_index);
+        }
+
+        if (is_start == sample._is_started) {
           if (!is_start) {
             // A "stop" in the middle of a frame implies a "start" since time
             // 0 (that is, since the first data point in the frame).
-            samples[collector_index].data_point(frame_data.get_time(0), true, started);
-            samples[collector_index].data_point(frame_data.get_time(i), is_start, started);
+            sample.data_point(frame_data.get_time(0), true, _started);
+            sample.data_point(frame_data.get_time(i), is_start, _started);
           } else {
             // An extra "start" for a collector that's already started is an
             // error.
@@ -320,23 +253,24 @@ update_time_data(const PStatFrameData &frame_data) {
                  << "\n";
           }
         } else {
-          samples[collector_index].data_point(frame_data.get_time(i), is_start, started);
-          got_samples.insert(collector_index);
+          sample.data_point(frame_data.get_time(i), is_start, _started);
+          sample._got_sample = true;
         }
       }
     }
   }
 
-  // Make sure everything is stopped.
-
-  Samples::iterator si;
-  for (i = 0, si = samples.begin(); si != samples.end(); ++i, ++si) {
-    if ((*si)._is_started) {
-      (*si).data_point(frame_data.get_end(), false, started);
+  // Make sure everything is stopped.  We visit the samples in order by
+  // collector index.
+  std::sort(_touched_samples.begin(), _touched_samples.end());
+  for (ti = _touched_samples.begin(); ti != _touched_samples.end(); ++ti) {
+    FrameSample &sample = _samples[*ti];
+    if (sample._is_started) {
+      sample.data_point(frame_data.get_end(), false, _started);
     }
   }
 
-  nassertv(started.empty());
+  nassertv(_started.empty());
 
   bool any_new_levels = false;
 
@@ -356,26 +290,26 @@ update_time_data(const PStatFrameData &frame_data) {
     }
 
     int collector_index = level->_collector;
-    GotSamples::iterator gi;
-    gi = got_samples.find(collector_index);
-    if (gi != got_samples.end()) {
-      level->_value_alone = samples[collector_index]._net_time;
-      got_samples.erase(gi);
+    if (collector_index >= 0 && collector_index < (int)_samples.size()) {
+      FrameSample &sample = _samples[collector_index];
+      if (sample._got_sample) {
+        level->_value_alone = sample._net_time;
+        sample._got_sample = false;
+      }
     }
 
     li = lnext;
   }
 
-  // Finally, any samples left over in the got_samples set are new collectors
+  // Finally, any samples we got that weren't matched up are new collectors
   // that we need to add to the Levels list.
-  if (!got_samples.empty()) {
-    any_new_levels = true;
-
-    GotSamples::const_iterator gi;
-    for (gi = got_samples.begin(); gi != got_samples.end(); ++gi) {
-      int collector_index = (*gi);
-      PStatViewLevel *level = get_level(collector_index);
-      level->_value_alone = samples[*gi]._net_time;
+  for (ti = _touched_samples.begin(); ti != _touched_samples.end(); ++ti) {
+    FrameSample &sample = _samples[*ti];
+    if (sample._got_sample) {
+      any_new_levels = true;
+      PStatViewLevel *level = get_level(*ti);
+      level->_value_alone = sample._net_time;
+      sample._got_sample = false;
     }
   }
 
@@ -396,6 +330,8 @@ update_level_data(const PStatFrameData &frame_data) {
   typedef pmap<int, double> GotValues;
   GotValues net_values;
 
+  update_constraint_members();
+
   int i;
   int num_levels = frame_data.get_num_levels();
   for (i = 0; i < num_levels; i++) {
@@ -406,7 +342,7 @@ update_level_data(const PStatFrameData &frame_data) {
       _all_collectors_known = false;
 
     } else {
-      if (_client_data->get_child_distance(_constraint, collector_index) >= 0) {
+      if (_constraint_members[collector_index]) {
         net_values[collector_index] = value;
       }
     }
@@ -484,6 +420,28 @@ update_level_data(const PStatFrameData &frame_data) {
   }
 }
 
+/**
+ * Recomputes _constraint_members, if the constraint or the collector
+ * definitions have changed since it was last computed.
+ */
+void PStatView::
+update_constraint_members() {
+  int num_collectors = _client_data->get_num_collectors();
+  UpdateSeq seq = _client_data->get_collector_seq();
+  if ((int)_constraint_members.size() == num_collectors &&
+      _constraint_members_seq == seq) {
+    return;
+  }
+
+  _constraint_members.assign(num_collectors, 0);
+  for (int i = 0; i < num_collectors; ++i) {
+    if (_client_data->get_child_distance(_constraint, i) >= 0) {
+      _constraint_members[i] = 1;
+    }
+  }
+  _constraint_members_seq = seq;
+}
+
 /**
  * Resets all the levels that have been defined so far.
  */
@@ -494,6 +452,7 @@ clear_levels() {
     delete (*li).second;
   }
   _levels.clear();
+  _last_frame = nullptr;
 }
 
 /**
@@ -556,3 +515,96 @@ reset_level(PStatViewLevel *level) {
 
   return any_changed;
 }
+
+/**
+ * Records a start or stop event for this sample's collector at the indicated
+ * time.
+ */
+void PStatView::FrameSample::
+data_point(double time, bool is_start, Started &started) {
+  // We only consider events that change the startstop state.  With two
+  // consecutive 'start' events, for instance, we ignore the second one.
+
+/*
+ * *** That's not quite the right thing to do.  We should keep track of the
+ * nesting level and bracket things correctly, so that we ignore the second
+ * start and the *first* stop, but respect the outer startstop.  For the short
+ * term, this works, because the client is already doing this logic and won't
+ * send us nested startstop pairs, but we'd like to generalize this in the
+ * future so we can deal with these nested pairs properly.
+ */
+  nassertv(is_start != _is_started);
+
+  _is_started = is_start;
+
+  if (_pushed) {
+    nassertv(!_is_started);
+    Started::iterator si = find(started.begin(), started.end(), this);
+    nassertv(si != started.end());
+    started.erase(si);
+
+  } else {
+    if (_is_started) {
+      _net_time -= time;
+      push_all(time, started);
+      started.push_back(this);
+    } else {
+      _net_time += time;
+      Started::iterator si = find(started.begin(), started.end(), this);
+      nassertv(si != started.end());
+      started.erase(si);
+      pop_one(time, started);
+    }
+  }
+}
+
+/**
+ *
+ */
+void PStatView::FrameSample::
+push(double time) {
+  if (!_pushed) {
+    _pushed = true;
+    if (_is_started) {
+      _net_time += time;
+    }
+  }
+}
+
+/**
+ *
+ */
+void PStatView::FrameSample::
+pop(double time) {
+  if (_pushed) {
+    _pushed = false;
+    if (_is_started) {
+      _net_time -= time;
+    }
+  }
+}
+
+/**
+ *
+ */
+void PStatView::FrameSample::
+push_all(double time, Started &started) {
+  Started::iterator si;
+  for (si = started.begin(); si != started.end(); ++si) {
+    (*si)->push(time);
+  }
+}
+
+/**
+ *
+ */
+void PStatView::FrameSample::
+pop_one(double time, Started &started) {
+  Started::reverse_iterator si;
+  for (si = started.rbegin(); si != started.rend(); ++si) {
+    if ((*si)->_pushed) {
+      (*si)->pop(time);
+      return;
+    }
+  }
+}
@@ -20,7 +20,11 @@
 #include "pStatThreadData.h"
 #include "pStatViewLevel.h"
 #include "pmap.h"
+#include "pvector.h"
 #include "pointerTo.h"
+#include "updateSeq.h"
+#include "vector_int.h"
+#include "vector_uchar.h"
 
 /**
  * A View boils down the frame data to a linear list of times spent in a
@@ -58,10 +62,33 @@ public:
 private:
   void update_time_data(const PStatFrameData &frame_data);
   void update_level_data(const PStatFrameData &frame_data);
+  void update_constraint_members();
 
   void clear_levels();
   bool reset_level(PStatViewLevel *level);
 
+  // This is used within update_time_data() to collect event data out of the
+  // PStatFrameData object and boil it down to a list of elapsed times.
+  class FrameSample {
+  public:
+    typedef pvector<FrameSample *> Started;
+
+    INLINE FrameSample();
+    INLINE void clear();
+
+    void data_point(double time, bool is_start, Started &started);
+    void push(double time);
+    void pop(double time);
+    void push_all(double time, Started &started);
+    void pop_one(double time, Started &started);
+
+    bool _touched;
+    bool _is_started;
+    bool _pushed;
+    bool _got_sample;
+    double _net_time;
+  };
+
   int _constraint;
   bool _show_level;
   bool _all_collectors_known;
@@ -73,6 +100,27 @@ private:
 
   CPT(PStatClientData) _client_data;
   CPT(PStatThreadData) _thread_data;
+
+  // The frame most recently applied by set_to_frame(), so that we can skip
+  // the work if we are asked to apply it again.
+  const PStatFrameData *_last_frame;
+  double _last_frame_start;
+  int _last_frame_num_events;
+  UpdateSeq _last_frame_seq;
+
+  // This is scratch space for update_time_data(), kept from frame to frame
+  // so that it does not need to be reallocated, and only the samples that
+  // were touched need to be reset.
+  typedef pvector<FrameSample> Samples;
+  Samples _samples;
+  vector_int _touched_samples;
+  FrameSample::Started _started;
+
+  // This caches the result of get_child_distance(_constraint, collector) >=
+  // 0 for each collector, indexed by collector.  It is recomputed when the
+  // collector definitions change.
+  vector_uchar _constraint_members;
+  UpdateSeq _constraint_members_seq;
 };
 
 #include "pStatView.I"
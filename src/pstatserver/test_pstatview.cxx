@@ -0,0 +1,149 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_pstatview.cxx
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#include "pandatoolbase.h"
+#include "pStatClientData.h"
+#include "pStatThreadData.h"
+#include "pStatView.h"
+#include "pStatFrameData.h"
+#include "pStatCollectorDef.h"
+#include "trueClock.h"
+#include "string_utils.h"
+
+#include <stdlib.h>
+#include <algorithm>
+
+// This program times the replay of a synthetic pstats capture through
+// PStatView, the way a strip chart steps through the frames as they arrive.
+// The collectors form a tree, four children to a parent; each frame starts
+// and stops most of them, nested properly, and leaves out a few subtrees at
+// random so that different frames touch different collectors.
+
+/**
+ * Appends the start and stop events for the indicated collector and its
+ * descendants, spread over the time from start to end.
+ */
+static void
+add_events(PStatFrameData *frame_data, int collector, int num_collectors,
+           double start, double end) {
+  frame_data->add_start(collector, start);
+
+  int first_child = collector * 4 + 1;
+  int num_children = std::max(std::min(num_collectors - first_child, 4), 0);
+  if (num_children != 0) {
+    double slice = (end - start) / (num_children + 1);
+    for (int i = 0; i < num_children; ++i) {
+      if (rand() % 8 != 0) {
+        double child_start = start + slice * (i + 0.5);
+        add_events(frame_data, first_child + i, num_collectors,
+                   child_start, child_start + slice);
+      }
+    }
+  }
+
+  frame_data->add_stop(collector, end);
+}
+
+/**
+ * Steps the view through every frame in the thread, the indicated number of
+ * times over, and returns the elapsed time in seconds.
+ */
+static double
+replay(PStatView &view, const PStatThreadData *thread_data, int num_passes) {
+  TrueClock *clock = TrueClock::get_global_ptr();
+  int oldest = thread_data->get_oldest_frame_number();
+  int latest = thread_data->get_latest_frame_number();
+
+  double start = clock->get_short_time();
+  for (int pass = 0; pass < num_passes; ++pass) {
+    for (int n = oldest; n <= latest; ++n) {
+      view.set_to_frame(n);
+    }
+  }
+  return clock->get_short_time() - start;
+}
+
+int
+main(int argc, char *argv[]) {
+  if (argc > 4) {
+    nout << "test_pstatview [num_collectors [num_frames [num_passes]]]\n";
+    exit(1);
+  }
+
+  int num_collectors = (argc > 1) ? atoi(argv[1]) : 2000;
+  int num_frames = (argc > 2) ? atoi(argv[2]) : 600;
+  int num_passes = (argc > 3) ? atoi(argv[3]) : 10;
+  if (num_collectors < 2 || num_frames < 1 || num_passes < 1) {
+    nout << "Invalid parameters.\n";
+    exit(1);
+  }
+
+  PT(PStatClientData) client_data = new PStatClientData(nullptr);
+  for (int i = 0; i < num_collectors; ++i) {
+    std::string name = (i == 0) ? "Frame" : "c" + format_string(i);
+    PStatCollectorDef *def = new PStatCollectorDef(i, name);
+    def->_parent_index = (i == 0) ? 0 : (i - 1) / 4;
+    client_data->add_collector(def);
+  }
+  client_data->define_thread(0, "Main");
+
+  // Frames are a 60th of a second apart, so all of them fit within the
+  // default history.
+  srand(1);
+  int num_events = 0;
+  for (int f = 0; f < num_frames; ++f) {
+    PStatFrameData *frame_data = new PStatFrameData;
+    double start = f / 60.0;
+    add_events(frame_data, 0, num_collectors, start, start + 1.0 / 60.0);
+    num_events += frame_data->get_num_events();
+    client_data->record_new_frame(0, f, frame_data);
+  }
+
+  const PStatThreadData *thread_data = client_data->get_thread_data(0);
+  int num_kept = thread_data->get_latest_frame_number() -
+    thread_data->get_oldest_frame_number() + 1;
+  nout << "Replaying " << num_kept << " frames of " << num_collectors
+       << " collectors, " << num_events / num_frames
+       << " events per frame, " << num_passes << " times.\n";
+
+  int num_updates = num_kept * num_passes;
+
+  // The whole tree, as the main strip chart shows it.
+  PStatView frame_view;
+  frame_view.set_thread_data(thread_data);
+  double frame_time = replay(frame_view, thread_data, num_passes);
+  nout << "  unconstrained: " << frame_time << " s, "
+       << frame_time * 1000000.0 / num_updates << " us per frame\n";
+
+  // One subtree, as a strip chart opened on a single collector shows it.
+  PStatView sub_view;
+  sub_view.set_thread_data(thread_data);
+  sub_view.constrain(1, false);
+  double sub_time = replay(sub_view, thread_data, num_passes);
+  nout << "  constrained:   " << sub_time << " s, "
+       << sub_time * 1000000.0 / num_updates << " us per frame\n";
+
+  // The same frame over and over, as when a chart is redrawn without any
+  // new data arriving.
+  TrueClock *clock = TrueClock::get_global_ptr();
+  int latest = thread_data->get_latest_frame_number();
+  double start = clock->get_short_time();
+  for (int i = 0; i < num_updates; ++i) {
+    frame_view.set_to_frame(latest);
+  }
+  double repeat_time = clock->get_short_time() - start;
+  nout << "  same frame:    " << repeat_time << " s, "
+       << repeat_time * 1000000.0 / num_updates << " us per frame\n";
+
+  return (0);
+}
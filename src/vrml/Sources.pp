@@ -18,6 +18,6 @@
     vrmlLexer.lxx \
     vrmlParser.yxx \
     vrmlNode.cxx vrmlNode.h \
-    vrmlNodeType.cxx vrmlNodeType.h
+    vrmlNodeType.cxx vrmlNodeType.I vrmlNodeType.h
 
 #end ss_lib_target
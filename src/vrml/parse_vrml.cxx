@@ -34,25 +34,12 @@ using std::istream;
 using std::istringstream;
 using std::string;
 
-extern int vrmlyyparse();
-extern void vrmlyyResetLineNumber();
-extern int vrmlyydebug;
-extern int vrmlyy_flex_debug;
-
-extern VrmlScene *parsed_scene;
-
 /**
- * Loads the set of standard VRML node definitions into the parser, if it has
- * not already been loaded.
+ * Parses the set of standard VRML node definitions, and returns the list of
+ * node types it defines, or NULL if it could not be parsed.
  */
-static bool
-get_standard_nodes() {
-  static bool got_standard_nodes = false;
-  static bool read_ok = true;
-  if (got_standard_nodes) {
-    return read_ok;
-  }
-
+static const VrmlParseContext::NodeTypes *
+load_standard_nodes() {
   // The standardNodes.wrl file has been compiled into this binary.  Extract
   // it out.
 
@@ -68,14 +55,35 @@ get_standard_nodes() {
   istringstream in(data);
 #endif  // HAVE_ZLIB
 
-  vrml_init_parser(in, "standardNodes.wrl");
-  if (vrmlyyparse() != 0) {
-    read_ok = false;
+  VrmlParseContext context(in, "standardNodes.wrl", nullptr);
+  vrml_init_parser(context);
+  int result = vrmlyyparse(context._scanner, &context);
+  vrml_cleanup_parser(context);
+
+  if (result != 0) {
+    return nullptr;
   }
-  vrml_cleanup_parser();
 
-  got_standard_nodes = true;
-  return read_ok;
+  // Keep the node types it defined; they are never modified again, and are
+  // shared by all subsequent parses.
+  VrmlParseContext::NodeTypes *standard_types =
+    new VrmlParseContext::NodeTypes;
+  standard_types->swap(context._node_types);
+  delete context._parsed_scene;
+  return standard_types;
+}
+
+/**
+ * Returns the set of standard VRML node definitions, parsing them the first
+ * time this is called, or NULL if they could not be parsed.
+ */
+static const VrmlParseContext::NodeTypes *
+get_standard_nodes() {
+  // The initialization of a local static is thread-safe; a thread that calls
+  // this while another is still parsing the standard nodes waits for it.
+  static const VrmlParseContext::NodeTypes *standard_types =
+    load_standard_nodes();
+  return standard_types;
 }
 
 /**
@@ -98,25 +106,25 @@ parse_vrml(Filename filename) {
 
 /**
  * Reads the indicated input stream and returns a corresponding VrmlScene, or
- * NULL if there is a parse error.
+ * NULL if there is a parse error.  This may be called from several threads
+ * at once, to parse several files in parallel.
  */
 VrmlScene *
 parse_vrml(istream &in, const string &filename) {
-  if (!get_standard_nodes()) {
+  const VrmlParseContext::NodeTypes *standard_types = get_standard_nodes();
+  if (standard_types == nullptr) {
     std::cerr << "Internal error--unable to parse VRML.\n";
     return nullptr;
   }
 
   VrmlScene *scene = nullptr;
-  VrmlNodeType::pushNameSpace();
+  VrmlParseContext context(in, filename, standard_types);
 
-  vrml_init_parser(in, filename);
-  if (vrmlyyparse() == 0) {
-    scene = parsed_scene;
+  vrml_init_parser(context);
+  if (vrmlyyparse(context._scanner, &context) == 0) {
+    scene = context._parsed_scene;
   }
-  vrml_cleanup_parser();
-
-  VrmlNodeType::popNameSpace();
+  vrml_cleanup_parser(context);
 
   return scene;
 }
@@ -16,13 +16,9 @@
 
 #include "pandatoolbase.h"
 
-void vrml_init_lexer(std::istream &in, const std::string &filename);
-int vrml_error_count();
-int vrml_warning_count();
+class VrmlParseContext;
 
-void vrmlyyerror(const std::string &msg);
-void vrmlyywarning(const std::string &msg);
-
-int vrmlyylex();
+void vrml_init_lexer(VrmlParseContext &context);
+void vrml_cleanup_lexer(VrmlParseContext &context);
 
 #endif
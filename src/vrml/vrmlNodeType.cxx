@@ -22,12 +22,6 @@
 
 using std::ostream;
 
-
-//
-// Static list of node types.
-//
-plist<VrmlNodeType*> VrmlNodeType::typeList;
-
 static ostream &
 output_array(ostream &out, const MFArray *mf,
              int type, int indent_level, int items_per_row) {
@@ -35,14 +29,41 @@ output_array(ostream &out, const MFArray *mf,
     out << "[ ]";
   } else {
     out << "[";
-    MFArray::const_iterator mi;
     int col = 0;
-    for (mi = mf->begin(); mi != mf->end(); ++mi) {
+    for (size_t i = 0; i < mf->size(); ++i) {
       if (col == 0) {
         out << "\n";
         indent(out, indent_level + 2);
       }      
-      output_value(out, (*mi), type, indent_level + 2);
+
+      // Unpack the element into a single-valued field for output.
+      VrmlFieldValue v;
+      switch (type) {
+      case SFFLOAT:
+        v._sffloat = mf->get_float(i);
+        break;
+
+      case SFINT32:
+        v._sfint32 = mf->get_int32(i);
+        break;
+
+      case SFSTRING:
+        v._sfstring = (char *)mf->get_string(i);
+        break;
+
+      case SFNODE:
+        v._sfnode = mf->get_node(i);
+        break;
+
+      default:
+        {
+          const float *vec = mf->get_vec(i);
+          for (int c = 0; c < mf->get_num_components(); ++c) {
+            v._sfvec[c] = vec[c];
+          }
+        }
+      }
+      output_value(out, v, type, indent_level + 2);
       if (++col >= items_per_row) {
         col = 0;
       } else {
@@ -175,64 +196,6 @@ VrmlNodeType::~VrmlNodeType()
     }
 }
 
-void
-VrmlNodeType::addToNameSpace(VrmlNodeType *_type)
-{
-    if (find(_type->getName()) != nullptr) {
-      std::cerr << "PROTO " << _type->getName() << " already defined\n";
-      return;
-    }
-    typeList.push_front(_type);
-}
-
-//
-// One list is used to store all the node types.  Nested namespaces are
-// separated by NULL elements.
-// This isn't terribly efficient, but it is nice and simple.
-//
-void
-VrmlNodeType::pushNameSpace()
-{
-    typeList.push_front(nullptr);
-}
-
-void
-VrmlNodeType::popNameSpace()
-{
-    // Remove everything up to and including the next NULL marker:
-    plist<VrmlNodeType*>::iterator i;
-    for (i = typeList.begin(); i != typeList.end();) {
-        VrmlNodeType *nodeType = *i;
-        ++i;
-        typeList.pop_front();
-
-        if (nodeType == nullptr) {
-            break;
-        }
-        else {
-            // NOTE:  Instead of just deleting the VrmlNodeTypes, you will
-            // probably want to reference count or garbage collect them, since
-            // any nodes created as part of the PROTO implementation will
-            // probably point back to their VrmlNodeType structure.
-            delete nodeType;
-        }
-    }
-}
-
-const VrmlNodeType *
-VrmlNodeType::find(const char *_name)
-{
-    // Look through the type stack:
-    plist<VrmlNodeType*>::iterator i;
-    for (i = typeList.begin(); i != typeList.end(); i++) {
-        const VrmlNodeType *nt = *i;
-        if (nt != nullptr && strcmp(nt->getName(),_name) == 0) {
-            return nt;
-        }
-    }
-    return nullptr;
-}
-
 void
 VrmlNodeType::addEventIn(const char *name, int type,
                          const VrmlFieldValue *dflt)
@@ -22,6 +22,7 @@
 #include "pvector.h"
 
 class VrmlNode;
+class MFArray;
 
 struct SFNodeRef {
   VrmlNode *_p;
@@ -36,10 +37,48 @@ union VrmlFieldValue {
   char *_sfstring;
   double _sfvec[4];
   SFNodeRef _sfnode;
-  pvector<VrmlFieldValue> *_mf;
+  MFArray *_mf;
 };
 
-typedef pvector<VrmlFieldValue> MFArray;
+//
+// The values of a multiple-valued field.  Rather than storing a
+// VrmlFieldValue union for each element, the values are packed into a
+// contiguous array of the appropriate type: MFFloat, MFVec2f, MFVec3f,
+// MFColor and MFRotation values are stored as single-precision floats
+// (which is all the VRML spec promises), num_components per element;
+// MFInt32 values as 32-bit ints; and MFString and MFNode values in arrays
+// of their own.  Only one of the arrays is used by any given field.
+//
+class MFArray {
+public:
+  INLINE MFArray();
+
+  INLINE size_t size() const;
+  INLINE bool empty() const;
+
+  INLINE int get_num_components() const;
+
+  INLINE const float *get_vec(size_t n) const;
+  INLINE float get_float(size_t n) const;
+  INLINE int32_t get_int32(size_t n) const;
+  INLINE const char *get_string(size_t n) const;
+  INLINE const SFNodeRef &get_node(size_t n) const;
+  INLINE SFNodeRef &modify_node(size_t n);
+
+  INLINE void add_vec(const double *v, int num_components);
+  INLINE void add_float(double v);
+  INLINE void add_int32(int32_t v);
+  INLINE void add_string(char *v);
+  INLINE void add_node(const SFNodeRef &v);
+
+private:
+  int _num_components;
+  size_t _size;
+  pvector<float> _floats;
+  pvector<int32_t> _ints;
+  pvector<char *> _strings;
+  pvector<SFNodeRef> _nodes;
+};
 
 
 std::ostream &output_value(std::ostream &out, const VrmlFieldValue &value, int type,
@@ -55,19 +94,9 @@ public:
   // Destructor exists mainly to deallocate storage for name
   ~VrmlNodeType();
   
-  // Namespace management functions.  PROTO definitions add node types
-  // to the namespace.  PROTO implementations are a separate node
-  // namespace, and require that any nested PROTOs NOT be available
-  // outside the PROTO implementation.
-  // addToNameSpace will print an error to stderr if the given type
-  // is already defined.
-  static void addToNameSpace(VrmlNodeType *);
-  static void pushNameSpace();
-  static void popNameSpace();
-  
-  // Find a node type, given its name.  Returns NULL if type is not defined.
-  static const VrmlNodeType *find(const char *nm);
-  
+  // The namespace of node types that are defined while parsing a file is
+  // kept by the VrmlParseContext for that parse; see vrmlParserDefs.h.
+
   // Routines for adding/getting eventIns/Outs/fields
   void addEventIn(const char *name, int type, 
                   const VrmlFieldValue *dflt = nullptr);
@@ -97,12 +126,11 @@ private:
   
   char *name;
   
-  // Node types are stored in this data structure:
-  static plist<VrmlNodeType*> typeList;
-  
   plist<NameTypeRec*> eventIns;
   plist<NameTypeRec*> eventOuts;
   plist<NameTypeRec*> fields;
 };
 
+#include "vrmlNodeType.I"
+
 #endif
@@ -15,9 +15,83 @@
 #define VRMLPARSERDEFS_H
 
 #include "pandatoolbase.h"
+#include "vrmlNodeType.h"
+#include "vrmlNode.h"
+#include "plist.h"
 
-void vrml_init_parser(std::istream &in, const std::string &filename);
-void vrml_cleanup_parser();
-int vrmlyyparse();
+#include <stack>
+
+/**
+ * This holds all of the state of a single parse of a VRML file: the state of
+ * the reentrant lexer, the stacks the parser keeps while it descends into
+ * protos, nodes and fields, and the namespace of node types defined by the
+ * file.  Since nothing is kept in globals, any number of files may be parsed
+ * at once, in different threads, each with its own context.
+ */
+class VrmlParseContext {
+public:
+  typedef plist<VrmlNodeType *> NodeTypes;
+
+  VrmlParseContext(std::istream &in, const std::string &filename,
+                   const NodeTypes *standard_types);
+  ~VrmlParseContext();
+
+  void error(const std::string &msg);
+  void warning(const std::string &msg);
+
+  // Namespace management functions.  PROTO definitions add node types to
+  // the namespace.  PROTO implementations are a separate node namespace,
+  // and require that any nested PROTOs NOT be available outside the PROTO
+  // implementation.  Nested namespaces are separated by NULL elements in
+  // _node_types; the standard node types, which are shared by all parses,
+  // are searched last.
+  void push_name_space();
+  void pop_name_space();
+  void add_to_name_space(VrmlNodeType *type);
+  const VrmlNodeType *find_node_type(const char *name) const;
+
+  // This is used to keep track of which field in which type of node is
+  // being parsed.
+  class FieldRec {
+  public:
+    const VrmlNodeType *nodeType;
+    const char *fieldName;
+    const VrmlNodeType::NameTypeRec *typeRec;
+  };
+
+  static const int max_error_width = 1024;
+
+  // The lexer's state.  _scanner is the flex yyscan_t handle.
+  void *_scanner;
+  std::istream *_input;
+  std::string _filename;
+  int _line_number;
+  char _current_line[max_error_width + 1];
+  int _error_count;
+  int _warning_count;
+
+  // The parser sets this to a token to direct the lexer in cases where just
+  // syntax isn't enough.
+  int _expect_token;
+  bool _parsing_mf;
+  int _sf_image_ints_parsed;
+  int _sf_image_ints_expected;
+  std::string _quoted_string;
+  MFArray *_mfarray;
+
+  // The parser's state.  Prototypes, fields and nodes may all be nested, so
+  // a stack of each is needed.
+  VrmlScene *_parsed_scene;
+  std::stack<VrmlNodeType *, plist<VrmlNodeType *> > _proto_stack;
+  std::stack<FieldRec *, plist<FieldRec *> > _field_stack;
+  std::stack<VrmlNode *, plist<VrmlNode *> > _node_stack;
+
+  NodeTypes _node_types;
+  const NodeTypes *_standard_types;
+};
+
+void vrml_init_parser(VrmlParseContext &context);
+void vrml_cleanup_parser(VrmlParseContext &context);
+int vrmlyyparse(void *scanner, VrmlParseContext *context);
 
 #endif
@@ -69,9 +69,8 @@ get_coord_values() {
 
   if (coord != nullptr) {
     const MFArray *point = coord->get_value("point")._mf;
-    MFArray::const_iterator ci;
-    for (ci = point->begin(); ci != point->end(); ++ci) {
-      const double *p = (*ci)._sfvec;
+    for (size_t i = 0; i < point->size(); ++i) {
+      const float *p = point->get_vec(i);
       _coord_values.push_back(LVertexd(p[0], p[1], p[2]));
     }
   }
@@ -86,15 +85,15 @@ get_polys() {
   const MFArray *coordIndex = _geometry->get_value("coordIndex")._mf;
   VrmlPolygon poly;
 
-  MFArray::const_iterator ci;
-  for (ci = coordIndex->begin(); ci != coordIndex->end(); ++ci) {
-    if ((*ci)._sfint32 < 0) {
+  for (size_t i = 0; i < coordIndex->size(); ++i) {
+    int32_t index = coordIndex->get_int32(i);
+    if (index < 0) {
       _polys.push_back(poly);
       poly._verts.clear();
     } else {
-      const LVertexd &p = _coord_values[(*ci)._sfint32];
+      const LVertexd &p = _coord_values[index];
       VrmlVertex vert;
-      vert._index = (*ci)._sfint32;
+      vert._index = index;
       vert._pos = p;
       poly._verts.push_back(vert);
     }
@@ -108,9 +107,8 @@ void IndexedFaceSet::
 get_vrml_colors(const VrmlNode *color_node, double transparency,
                 pvector<UnalignedLVecBase4> &color_list) {
   const MFArray *color = color_node->get_value("color")._mf;
-  MFArray::const_iterator ci;
-  for (ci = color->begin(); ci != color->end(); ++ci) {
-    const double *p = (*ci)._sfvec;
+  for (size_t i = 0; i < color->size(); ++i) {
+    const float *p = color->get_vec(i);
     LColor color(p[0], p[1], p[2], 1.0 - transparency);
     color_list.push_back(color);
   }
@@ -124,9 +122,8 @@ void IndexedFaceSet::
 get_vrml_normals(const VrmlNode *normal_node,
                  pvector<LNormald> &normal_list) {
   const MFArray *point = normal_node->get_value("vector")._mf;
-  MFArray::const_iterator ci;
-  for (ci = point->begin(); ci != point->end(); ++ci) {
-    const double *p = (*ci)._sfvec;
+  for (size_t i = 0; i < point->size(); ++i) {
+    const float *p = point->get_vec(i);
     LNormald normal(p[0], p[1], p[2]);
     normal_list.push_back(normal);
   }
@@ -140,9 +137,8 @@ void IndexedFaceSet::
 get_vrml_uvs(const VrmlNode *texCoord_node,
              pvector<LTexCoordd> &uv_list) {
   const MFArray *point = texCoord_node->get_value("point")._mf;
-  MFArray::const_iterator ci;
-  for (ci = point->begin(); ci != point->end(); ++ci) {
-    const double *p = (*ci)._sfvec;
+  for (size_t i = 0; i < point->size(); ++i) {
+    const float *p = point->get_vec(i);
     LTexCoordd uv(p[0], p[1]);
     uv_list.push_back(uv);
   }
@@ -163,11 +159,11 @@ get_colors() {
     bool colorPerVertex = _geometry->get_value("colorPerVertex")._sfbool;
     MFArray *colorIndex = _geometry->get_value("colorIndex")._mf;
     if (colorPerVertex) {
-      MFArray::const_iterator ci;
       size_t pi = 0;
       size_t pv = 0;
-      for (ci = colorIndex->begin(); ci != colorIndex->end(); ++ci) {
-        if ((*ci)._sfint32 < 0) {
+      for (size_t i = 0; i < colorIndex->size(); ++i) {
+        int32_t index = colorIndex->get_int32(i);
+        if (index < 0) {
           // End of poly.
           if (pv != _polys[pi]._verts.size()) {
             cerr << "Color indices don't match up!\n";
@@ -180,7 +176,7 @@ get_colors() {
             cerr << "Color indices don't match up!\n";
             return false;
           }
-          _polys[pi]._verts[pv]._attrib.set_color(color_list[(*ci)._sfint32]);
+          _polys[pi]._verts[pv]._attrib.set_color(color_list[index]);
           pv++;
         }
       }
@@ -190,18 +186,18 @@ get_colors() {
       }
     } else {
       if (!colorIndex->empty()) {
-        MFArray::const_iterator ci;
         size_t pi = 0;
         if (colorIndex->size() != _polys.size()) {
           cerr << "Wrong number of color indices!\n";
           return false;
         }
-        for (ci = colorIndex->begin(); ci != colorIndex->end(); ++ci) {
-          if ((*ci)._sfint32 < 0 || (*ci)._sfint32 >= (int)color_list.size()) {
+        for (size_t i = 0; i < colorIndex->size(); ++i) {
+          int32_t index = colorIndex->get_int32(i);
+          if (index < 0 || index >= (int)color_list.size()) {
             cerr << "Invalid color index!\n";
             return false;
           }
-          _polys[pi]._attrib.set_color(color_list[(*ci)._sfint32]);
+          _polys[pi]._attrib.set_color(color_list[index]);
           pi++;
         }
       } else {
@@ -232,7 +228,6 @@ get_normals() {
 
     bool normalPerVertex = _geometry->get_value("normalPerVertex")._sfbool;
     MFArray *normalIndex = _geometry->get_value("normalIndex")._mf;
-    MFArray::const_iterator ci;
 
     if (normalPerVertex &&
         normal_list.size() == _polys.size() &&
@@ -251,9 +246,7 @@ get_normals() {
         // normals, assume the VRML writer meant to imply a one-to-one
         // mapping.  This works around a broken formZ VRML file writer.
         for (size_t i = 0; i < normal_list.size(); i++) {
-          VrmlFieldValue fv;
-          fv._sfint32 = i;
-          (*normalIndex).push_back(fv);
+          normalIndex->add_int32((int32_t)i);
         }
       }
 
@@ -263,10 +256,8 @@ get_normals() {
       // exactly matches the number of vertices, and none of the indices is
       // -1.
       bool linear_list = (normalIndex->size() == _coord_values.size());
-      for (ci = normalIndex->begin();
-           ci != normalIndex->end() && linear_list;
-           ++ci) {
-        linear_list = ((*ci)._sfint32 >= 0);
+      for (size_t i = 0; i < normalIndex->size() && linear_list; ++i) {
+        linear_list = (normalIndex->get_int32(i) >= 0);
       }
 
       if (linear_list) {
@@ -275,8 +266,8 @@ get_normals() {
         // vertex.
         _per_vertex_normals.reserve(_coord_values.size());
 
-        for (ci = normalIndex->begin(); ci != normalIndex->end(); ++ci) {
-          size_t vi = (*ci)._sfint32;
+        for (size_t i = 0; i < normalIndex->size(); ++i) {
+          size_t vi = normalIndex->get_int32(i);
           nassertr(vi >= 0, false);
           if (vi >= normal_list.size()) {
             cerr << "Invalid normal index: " << vi << "\n";
@@ -292,11 +283,11 @@ get_normals() {
         // different normal values in differing polygons (meaning it's not
         // actually shared).
 
-        MFArray::const_iterator ci;
         size_t pi = 0;
         size_t pv = 0;
-        for (ci = normalIndex->begin(); ci != normalIndex->end(); ++ci) {
-          if ((*ci)._sfint32 < 0) {
+        for (size_t i = 0; i < normalIndex->size(); ++i) {
+          int32_t index = normalIndex->get_int32(i);
+          if (index < 0) {
             // End of poly.
             if (pv != _polys[pi]._verts.size()) {
               cerr << "Normal indices don't match up!\n";
@@ -309,7 +300,7 @@ get_normals() {
               cerr << "Normal indices don't match up!\n";
               return false;
             }
-            const LNormald &d = normal_list[(*ci)._sfint32];
+            const LNormald &d = normal_list[index];
             _polys[pi]._verts[pv]._attrib.set_normal(d);
             pv++;
           }
@@ -326,12 +317,13 @@ get_normals() {
           cerr << "Wrong number of normal indices!\n";
           return false;
         }
-        for (ci = normalIndex->begin(); ci != normalIndex->end(); ++ci) {
-          if ((*ci)._sfint32 < 0 || (*ci)._sfint32 >= (int)normal_list.size()) {
+        for (size_t i = 0; i < normalIndex->size(); ++i) {
+          int32_t index = normalIndex->get_int32(i);
+          if (index < 0 || index >= (int)normal_list.size()) {
             cerr << "Invalid normal index!\n";
             return false;
           }
-          const LNormald &d = normal_list[(*ci)._sfint32];
+          const LNormald &d = normal_list[index];
           _polys[pi]._attrib.set_normal(d);
           pi++;
         }
@@ -383,16 +375,13 @@ get_uvs() {
     get_vrml_uvs(texCoord, uv_list);
 
     MFArray *texCoordIndex = _geometry->get_value("texCoordIndex")._mf;
-    MFArray::const_iterator ci;
 
     if (texCoordIndex->empty()) {
       // If we have *no* texture coordinate index array, but we do have
       // texture coordinates, assume the VRML writer meant to imply a one-to-
       // one mapping.  This works around a broken formZ VRML file writer.
       for (size_t i = 0; i < uv_list.size(); i++) {
-        VrmlFieldValue fv;
-        fv._sfint32 = i;
-        (*texCoordIndex).push_back(fv);
+        texCoordIndex->add_int32((int32_t)i);
       }
     }
 
@@ -402,10 +391,8 @@ get_uvs() {
     // coordinate indices exactly matches the number of vertices, and none of
     // the indices is -1.
     bool linear_list = (texCoordIndex->size() == _coord_values.size());
-    for (ci = texCoordIndex->begin();
-         ci != texCoordIndex->end() && linear_list;
-         ++ci) {
-      linear_list = ((*ci)._sfint32 >= 0);
+    for (size_t i = 0; i < texCoordIndex->size() && linear_list; ++i) {
+      linear_list = (texCoordIndex->get_int32(i) >= 0);
     }
 
     if (linear_list) {
@@ -414,8 +401,8 @@ get_uvs() {
       // vertex.
       _per_vertex_uvs.reserve(_coord_values.size());
 
-      for (ci = texCoordIndex->begin(); ci != texCoordIndex->end(); ++ci) {
-        size_t vi = (*ci)._sfint32;
+      for (size_t i = 0; i < texCoordIndex->size(); ++i) {
+        size_t vi = texCoordIndex->get_int32(i);
         nassertr(vi >= 0, false);
         if (vi >= uv_list.size()) {
           cerr << "Invalid texCoord index: " << vi << "\n";
@@ -433,8 +420,9 @@ get_uvs() {
 
       size_t pi = 0;
       size_t pv = 0;
-      for (ci = texCoordIndex->begin(); ci != texCoordIndex->end(); ++ci) {
-        if ((*ci)._sfint32 < 0) {
+      for (size_t i = 0; i < texCoordIndex->size(); ++i) {
+        int32_t index = texCoordIndex->get_int32(i);
+        if (index < 0) {
           // End of poly.
           if (pv != _polys[pi]._verts.size()) {
             cerr << "texCoord indices don't match up!\n";
@@ -447,7 +435,7 @@ get_uvs() {
             cerr << "texCoord indices don't match up!\n";
             return false;
           }
-          _polys[pi]._verts[pv]._attrib.set_uv(uv_list[(*ci)._sfint32]);
+          _polys[pi]._verts[pv]._attrib.set_uv(uv_list[index]);
           pv++;
         }
       }
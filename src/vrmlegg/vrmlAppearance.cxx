@@ -50,7 +50,7 @@ VRMLAppearance(const VrmlNode *appearance) {
       if (strcmp(texture->_type->getName(), "ImageTexture") == 0) {
         MFArray *url = texture->get_value("url")._mf;
         if (!url->empty()) {
-          const char *filename = (*url->begin())._sfstring;
+          const char *filename = url->get_string(0);
           _tex = new EggTexture("tref", filename);
 
           if (_has_tex_transform) {
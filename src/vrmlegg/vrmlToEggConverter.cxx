@@ -168,9 +168,8 @@ get_all_defs(SFNodeRef &vrml, VRMLToEggConverter::Nodes &nodes) {
         get_all_defs((*fi)._value._sfnode, nodes);
       } else if ((*fi)._type->type == MFNODE) {
         MFArray *children = (*fi)._value._mf;
-        MFArray::iterator ci;
-        for (ci = children->begin(); ci != children->end(); ++ci) {
-          get_all_defs((*ci)._sfnode, nodes);
+        for (size_t i = 0; i < children->size(); ++i) {
+          get_all_defs(children->modify_node(i), nodes);
         }
       }
     }
@@ -261,9 +260,8 @@ void VRMLToEggConverter::
 vrml_group(const VrmlNode *node, EggGroup *group,
            const LMatrix4d &net_transform) {
   const MFArray *children = node->get_value("children")._mf;
-  MFArray::const_iterator ci;
-  for (ci = children->begin(); ci != children->end(); ++ci) {
-    vrml_node((*ci)._sfnode, group, net_transform);
+  for (size_t i = 0; i < children->size(); ++i) {
+    vrml_node(children->get_node(i), group, net_transform);
   }
 }
 
@@ -354,9 +352,8 @@ vrml_transform(const VrmlNode *node, EggGroup *group,
   LMatrix4d next_transform = local_transform * net_transform;
 
   const MFArray *children = node->get_value("children")._mf;
-  MFArray::const_iterator ci;
-  for (ci = children->begin(); ci != children->end(); ++ci) {
-    vrml_node((*ci)._sfnode, group, next_transform);
+  for (size_t i = 0; i < children->size(); ++i) {
+    vrml_node(children->get_node(i), group, next_transform);
   }
 }
 
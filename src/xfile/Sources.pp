@@ -20,6 +20,7 @@
      windowsGuid.h \
      xFile.I xFile.h \
      xFileArrayDef.I xFileArrayDef.h \
+     xFileBinaryWriter.I xFileBinaryWriter.h \
      xFileDataDef.I xFileDataDef.h \
      xFileDataNode.I xFileDataNode.h \
      xFileDataNodeReference.I xFileDataNodeReference.h \
@@ -28,6 +29,7 @@
      xFileDataObjectArray.I xFileDataObjectArray.h \
      xFileDataObjectDouble.I xFileDataObjectDouble.h \
      xFileDataObjectInteger.I xFileDataObjectInteger.h \
+     xFileDataObjectPackedArray.I xFileDataObjectPackedArray.h \
      xFileDataObjectString.I xFileDataObjectString.h \
      xFileNode.I xFileNode.h \
      xFileParseData.I xFileParseData.h \
@@ -41,6 +43,7 @@
      windowsGuid.cxx\
      xFile.cxx \
      xFileArrayDef.cxx \
+     xFileBinaryWriter.cxx \
      xFileDataDef.cxx \
      xFileDataNode.cxx \
      xFileDataNodeReference.cxx \
@@ -49,6 +52,7 @@
      xFileDataObjectArray.cxx \
      xFileDataObjectDouble.cxx \
      xFileDataObjectInteger.cxx \
+     xFileDataObjectPackedArray.cxx \
      xFileDataObjectString.cxx \
      xFileNode.cxx \
      xFileParseData.cxx \
@@ -56,3 +60,19 @@
 
 
 #end ss_lib_target
+
+#begin test_bin_target
+  #define TARGET test_xfile
+  #define LOCAL_LIBS p3xfile p3pandatoolbase
+  #define OTHER_LIBS \
+    p3event:c p3putil:c p3pipeline:c p3mathutil:c p3linmath:c panda:m \
+    p3pandabase:c p3express:c pandaexpress:m \
+    p3interrogatedb p3prc  \
+    p3dtoolutil:c p3dtoolbase:c p3dtool:m
+
+  #define USE_PACKAGES zlib
+
+  #define SOURCES \
+    test_xfile.cxx
+
+#end test_bin_target
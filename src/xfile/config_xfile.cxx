@@ -18,6 +18,7 @@
 #include "xFileDataObjectArray.h"
 #include "xFileDataObjectDouble.h"
 #include "xFileDataObjectInteger.h"
+#include "xFileDataObjectPackedArray.h"
 #include "xFileDataObjectString.h"
 #include "xFileDataNode.h"
 #include "xFileDataNodeReference.h"
@@ -59,6 +60,7 @@ init_libxfile() {
   XFileDataObjectArray::init_type();
   XFileDataObjectDouble::init_type();
   XFileDataObjectInteger::init_type();
+  XFileDataObjectPackedArray::init_type();
   XFileDataObjectString::init_type();
   XFileDataNode::init_type();
   XFileDataNodeReference::init_type();
@@ -3,6 +3,7 @@
 #include "windowsGuid.cxx"
 #include "xFile.cxx"
 #include "xFileArrayDef.cxx"
+#include "xFileBinaryWriter.cxx"
 #include "xFileDataDef.cxx"
 #include "xFileDataNode.cxx"
 #include "xFileDataNodeReference.cxx"
@@ -11,6 +12,7 @@
 #include "xFileDataObjectArray.cxx"
 #include "xFileDataObjectDouble.cxx"
 #include "xFileDataObjectInteger.cxx"
+#include "xFileDataObjectPackedArray.cxx"
 #include "xFileDataObjectString.cxx"
 #include "xFileNode.cxx"
 #include "xFileParseData.cxx"
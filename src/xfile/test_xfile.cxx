@@ -0,0 +1,162 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_xfile.cxx
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#include "pandatoolbase.h"
+#include "xFile.h"
+#include "config_xfile.h"
+#include "filename.h"
+
+#include <sstream>
+
+// This program checks that an .x file survives a round trip through each of
+// the formats XFile can write: it is written out in that format, read back
+// in, and the result is compared, as text, with the original.  If no file is
+// named, a small mesh is used; its values are all exactly representable as
+// 32-bit floats, so it is also checked with -f32 binary output.
+
+static const char *const sample_x_file =
+  "xof 0303txt 0032\n"
+  "Frame Root {\n"
+  "  FrameTransformMatrix {\n"
+  "    1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0,\n"
+  "    0.0, 0.0, 1.0, 0.0, 0.5, -0.25, 2.0, 1.0;;\n"
+  "  }\n"
+  "  Mesh square {\n"
+  "    4;\n"
+  "    0.0; 0.0; 0.0;,\n"
+  "    1.0; 0.0; 0.0;,\n"
+  "    1.0; 1.0; 0.0;,\n"
+  "    0.0; 1.0; 0.0;;\n"
+  "    2;\n"
+  "    3; 0, 1, 2;,\n"
+  "    3; 0, 2, 3;;\n"
+  "    MeshNormals {\n"
+  "      1;\n"
+  "      0.0; 0.0; 1.0;;\n"
+  "      2;\n"
+  "      3; 0, 0, 0;,\n"
+  "      3; 0, 0, 0;;\n"
+  "    }\n"
+  "    MeshTextureCoords {\n"
+  "      4;\n"
+  "      0.0; 1.0;,\n"
+  "      1.0; 1.0;,\n"
+  "      1.0; 0.0;,\n"
+  "      0.0; 0.0;;\n"
+  "    }\n"
+  "    MeshMaterialList {\n"
+  "      1;\n"
+  "      2;\n"
+  "      0,\n"
+  "      0;\n"
+  "      Material red {\n"
+  "        1.0; 0.0; 0.0; 1.0;;\n"
+  "        8.0;\n"
+  "        0.5; 0.5; 0.5;;\n"
+  "        0.0; 0.0; 0.0;;\n"
+  "        TextureFilename {\n"
+  "          \"red.png\";\n"
+  "        }\n"
+  "      }\n"
+  "    }\n"
+  "  }\n"
+  "}\n";
+
+/**
+ * Writes the file in the indicated format, reads it back, and compares the
+ * result with the expected text.  Returns true if they match.
+ */
+static bool
+round_trip(XFile *source, XFile::FormatType format_type,
+           XFile::FloatSize float_size, const std::string &expected) {
+  source->set_format_type(format_type);
+  source->set_float_size(float_size);
+
+  std::ostringstream out;
+  if (!source->write(out)) {
+    nout << "write failed.\n";
+    return false;
+  }
+
+  std::istringstream in(out.str());
+  PT(XFile) result = new XFile(true);
+  if (!result->read(in, "round trip")) {
+    nout << "read failed.\n";
+    return false;
+  }
+
+  std::ostringstream text;
+  result->write_text(text, 0);
+  if (text.str() != expected) {
+    nout << "contents differ.\n";
+    return false;
+  }
+
+  nout << out.str().size() << " bytes, ok.\n";
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  if (argc > 2) {
+    nout << "test_xfile [filename.x]\n";
+    exit(1);
+  }
+
+  init_libxfile();
+
+  PT(XFile) source = new XFile(true);
+  bool use_sample = (argc < 2);
+  if (use_sample) {
+    std::istringstream in(sample_x_file);
+    if (!source->read(in, "sample")) {
+      nout << "Unable to read sample file.\n";
+      exit(1);
+    }
+  } else {
+    Filename filename = Filename::from_os_specific(argv[1]);
+    if (!source->read(filename)) {
+      nout << "Unable to read " << filename << "\n";
+      exit(1);
+    }
+  }
+
+  std::ostringstream expected;
+  source->write_text(expected, 0);
+
+  bool okflag = true;
+  nout << "text: ";
+  okflag = round_trip(source, XFile::FT_text, XFile::FS_64,
+                      expected.str()) && okflag;
+  nout << "binary: ";
+  okflag = round_trip(source, XFile::FT_binary, XFile::FS_64,
+                      expected.str()) && okflag;
+  nout << "compressed binary: ";
+  okflag = round_trip(source, XFile::FT_compressed, XFile::FS_64,
+                      expected.str()) && okflag;
+  nout << "compressed text: ";
+  okflag = round_trip(source, XFile::FT_compressed_text, XFile::FS_64,
+                      expected.str()) && okflag;
+
+  if (use_sample) {
+    nout << "binary, 32-bit floats: ";
+    okflag = round_trip(source, XFile::FT_binary, XFile::FS_32,
+                        expected.str()) && okflag;
+  }
+
+  if (!okflag) {
+    nout << "Round trip failed.\n";
+    return 1;
+  }
+  return 0;
+}
@@ -13,6 +13,8 @@
 
 #include "windowsGuid.h"
 #include "pnotify.h"
+#include "datagram.h"
+#include "datagramIterator.h"
 
 #include <stdio.h>  // for sscanf, sprintf
 
@@ -51,6 +53,44 @@ parse_string(const string &str) {
   return true;
 }
 
+/**
+ * Writes the GUID to the datagram in the 16-byte little-endian layout used by
+ * binary .x files.
+ */
+void WindowsGuid::
+write_datagram(Datagram &dg) const {
+  dg.add_uint32(_data1);
+  dg.add_uint16(_data2);
+  dg.add_uint16(_data3);
+  dg.add_uint8(_b1);
+  dg.add_uint8(_b2);
+  dg.add_uint8(_b3);
+  dg.add_uint8(_b4);
+  dg.add_uint8(_b5);
+  dg.add_uint8(_b6);
+  dg.add_uint8(_b7);
+  dg.add_uint8(_b8);
+}
+
+/**
+ * Reads the GUID from the datagram, as written by write_datagram().  The
+ * caller is responsible for ensuring that 16 bytes remain.
+ */
+void WindowsGuid::
+read_datagram(DatagramIterator &scan) {
+  _data1 = scan.get_uint32();
+  _data2 = scan.get_uint16();
+  _data3 = scan.get_uint16();
+  _b1 = scan.get_uint8();
+  _b2 = scan.get_uint8();
+  _b3 = scan.get_uint8();
+  _b4 = scan.get_uint8();
+  _b5 = scan.get_uint8();
+  _b6 = scan.get_uint8();
+  _b7 = scan.get_uint8();
+  _b8 = scan.get_uint8();
+}
+
 /**
  * Returns a hex representation of the GUID.
  */
@@ -16,17 +16,28 @@
 #include "xLexerDefs.h"
 #include "xFileTemplate.h"
 #include "xFileDataNodeTemplate.h"
+#include "xFileBinaryWriter.h"
 #include "config_xfile.h"
 #include "standard_templates.h"
 #include "zStream.h"
 #include "virtualFileSystem.h"
+#include "datagram.h"
 #include "dcast.h"
 
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 using std::istream;
 using std::istringstream;
 using std::ostream;
+using std::ostringstream;
 using std::string;
 
+// The size of the blocks in which MSZIP compresses the data.  Each block
+// is compressed separately, using the previous block as its dictionary.
+static const size_t mszip_block_size = 32768;
+
 TypeHandle XFile::_type_handle;
 PT(XFile) XFile::_standard_templates;
 
@@ -71,7 +82,7 @@ clear() {
  */
 bool XFile::
 read(Filename filename) {
-  filename.set_text();
+  filename.set_binary();
   VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
   istream *in = vfs->open_read_file(filename, true);
   if (in == nullptr) {
@@ -100,22 +111,43 @@ read(istream &in, const string &filename) {
     return false;
   }
 
-  if (_format_type != FT_text) {
-    // Does anyone actually use the binary format?  It wouldn't be too hard to
-    // support it if there were any reason at all to do so.
-    xfile_cat.error()
-      << "Cannot read binary .x files at this time.\n";
-    return false;
-  }
-
   // We must call this first so the standard templates file will be parsed and
   // available by the time we need it--it's tricky to invoke the parser from
   // within another parser instance.
   get_standard_templates();
 
-  x_init_parser(in, filename, *this);
-  xyyparse();
-  x_cleanup_parser();
+  if (_format_type == FT_text) {
+    x_init_parser(in, filename, *this);
+    xyyparse();
+    x_cleanup_parser();
+
+    return (x_error_count() == 0);
+  }
+
+  // The other formats are read into memory first.
+  Datagram data;
+  if (_format_type == FT_binary) {
+    char buffer[4096];
+    while (in) {
+      in.read(buffer, sizeof(buffer));
+      data.append_data(buffer, in.gcount());
+    }
+
+  } else if (!read_compressed_data(in, data)) {
+    return false;
+  }
+
+  if (_format_type == FT_compressed_text) {
+    istringstream text(data.get_message());
+    x_init_parser(text, filename, *this);
+    xyyparse();
+    x_cleanup_parser();
+
+  } else {
+    x_init_binary_parser(data, filename, _float_size == FS_64, *this);
+    xyyparse();
+    x_cleanup_parser();
+  }
 
   return (x_error_count() == 0);
 }
@@ -165,9 +197,31 @@ write(ostream &out) const {
     return false;
   }
 
-  write_text(out, 0);
+  if (_format_type == FT_text) {
+    write_text(out, 0);
+    return true;
+  }
+
+  Datagram data;
+  if (_format_type == FT_compressed_text) {
+    ostringstream text;
+    write_text(text, 0);
+    string str = text.str();
+    data.append_data(str.data(), str.length());
 
-  return true;
+  } else {
+    XFileBinaryWriter writer(data, _float_size == FS_64);
+    write_binary(writer);
+    writer.flush_data();
+  }
+
+  if (_format_type == FT_binary) {
+    out.write((const char *)data.get_data(), data.get_length());
+  } else if (!write_compressed_data(out, data)) {
+    return false;
+  }
+
+  return !out.fail();
 }
 
 /**
@@ -333,22 +387,18 @@ read_header(istream &in) {
   } else if (memcmp(format, "bin ", 4) == 0) {
     _format_type = FT_binary;
 
-  } else if (memcmp(format, "com ", 4) == 0) {
+  } else if (memcmp(format, "bzip", 4) == 0) {
     _format_type = FT_compressed;
 
+  } else if (memcmp(format, "tzip", 4) == 0) {
+    _format_type = FT_compressed_text;
+
   } else {
     xfile_cat.error()
       << "Unknown format type: " << string(format, 4) << "\n";
     return false;
   }
 
-  if (_format_type == FT_compressed) {
-    // Read and ignore the compression type, since we don't support
-    // compression anyway.
-    char compression_type[4];
-    in.read(compression_type, 4);
-  }
-
   char float_size[4];
   if (!in.read(float_size, 4)) {
     xfile_cat.error()
@@ -400,7 +450,11 @@ write_header(ostream &out) const {
     break;
 
   case FT_compressed:
-    out.write("cmp ", 4);
+    out.write("bzip", 4);
+    break;
+
+  case FT_compressed_text:
+    out.write("tzip", 4);
     break;
 
   default:
@@ -409,11 +463,6 @@ write_header(ostream &out) const {
     return false;
   }
 
-  if (_format_type == FT_compressed) {
-    // Write a bogus compression type, just so we have a valid header.
-    out.write("xxx ", 4);
-  }
-
   switch (_float_size) {
   case FS_32:
     out.write("0032", 4);
@@ -437,6 +486,154 @@ write_header(ostream &out) const {
   return true;
 }
 
+/**
+ * Reads the remainder of an MSZIP-compressed file, which follows the header,
+ * and stores the decompressed data in the indicated datagram.  Returns true
+ * on success, false otherwise.
+ */
+bool XFile::
+read_compressed_data(istream &in, Datagram &data) {
+#ifdef HAVE_ZLIB
+  // The compressed data begins with the size of the decompressed file,
+  // including the 16-byte header.  We don't need it.
+  char file_size[4];
+  if (!in.read(file_size, 4)) {
+    xfile_cat.error()
+      << "Truncated file.\n";
+    return false;
+  }
+
+  z_stream z;
+  memset(&z, 0, sizeof(z));
+  if (inflateInit2(&z, -MAX_WBITS) != Z_OK) {
+    xfile_cat.error()
+      << "Unable to initialize zlib.\n";
+    return false;
+  }
+
+  // Each block is preceded by its decompressed and compressed sizes.  The
+  // compressed size includes the two-byte "CK" signature that begins the
+  // block.
+  pvector<unsigned char> compressed(65536);
+  pvector<unsigned char> decompressed(65536);
+  bool okflag = true;
+  unsigned char block_header[4];
+  while (okflag && in.read((char *)block_header, 4)) {
+    size_t decompressed_size = block_header[0] | (block_header[1] << 8);
+    size_t compressed_size = block_header[2] | (block_header[3] << 8);
+    if (compressed_size < 2 ||
+        !in.read((char *)&compressed[0], compressed_size)) {
+      xfile_cat.error()
+        << "Truncated file.\n";
+      okflag = false;
+
+    } else if (compressed[0] != 'C' || compressed[1] != 'K') {
+      xfile_cat.error()
+        << "Invalid MSZIP block.\n";
+      okflag = false;
+
+    } else {
+      // Each block uses the data decompressed so far as its dictionary.
+      inflateReset(&z);
+      size_t dict_size = std::min(data.get_length(), mszip_block_size);
+      if (dict_size != 0) {
+        const unsigned char *dict = (const unsigned char *)data.get_data() +
+          data.get_length() - dict_size;
+        inflateSetDictionary(&z, dict, dict_size);
+      }
+
+      z.next_in = &compressed[2];
+      z.avail_in = compressed_size - 2;
+      z.next_out = &decompressed[0];
+      z.avail_out = decompressed_size;
+      if (inflate(&z, Z_FINISH) != Z_STREAM_END || z.avail_out != 0) {
+        xfile_cat.error()
+          << "Corrupt MSZIP block.\n";
+        okflag = false;
+      } else {
+        data.append_data(&decompressed[0], decompressed_size);
+      }
+    }
+  }
+
+  inflateEnd(&z);
+  return okflag;
+
+#else  // HAVE_ZLIB
+  xfile_cat.error()
+    << "Cannot read compressed .x files without zlib.\n";
+  return false;
+#endif  // HAVE_ZLIB
+}
+
+/**
+ * Writes the indicated data, which follows the header, to the stream with
+ * MSZIP compression.  Returns true on success, false otherwise.
+ */
+bool XFile::
+write_compressed_data(ostream &out, const Datagram &data) {
+#ifdef HAVE_ZLIB
+  z_stream z;
+  memset(&z, 0, sizeof(z));
+  if (deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    xfile_cat.error()
+      << "Unable to initialize zlib.\n";
+    return false;
+  }
+
+  // The size of the decompressed file includes the 16-byte header.
+  Datagram file_size;
+  file_size.add_uint32(data.get_length() + 16);
+  out.write((const char *)file_size.get_data(), file_size.get_length());
+
+  const unsigned char *source = (const unsigned char *)data.get_data();
+  size_t length = data.get_length();
+  pvector<unsigned char> compressed(deflateBound(&z, mszip_block_size) + 2);
+  compressed[0] = 'C';
+  compressed[1] = 'K';
+
+  bool okflag = true;
+  for (size_t start = 0; okflag && start < length; start += mszip_block_size) {
+    size_t block_size = std::min(length - start, mszip_block_size);
+
+    // Each block uses the previous block as its dictionary.
+    deflateReset(&z);
+    if (start != 0) {
+      deflateSetDictionary(&z, source + start - mszip_block_size,
+                           mszip_block_size);
+    }
+
+    z.next_in = (Bytef *)(source + start);
+    z.avail_in = block_size;
+    z.next_out = &compressed[2];
+    z.avail_out = compressed.size() - 2;
+    if (deflate(&z, Z_FINISH) != Z_STREAM_END) {
+      xfile_cat.error()
+        << "Unable to compress data.\n";
+      okflag = false;
+
+    } else {
+      size_t compressed_size = compressed.size() - z.avail_out;
+      Datagram block_header;
+      block_header.add_uint16(block_size);
+      block_header.add_uint16(compressed_size);
+      out.write((const char *)block_header.get_data(),
+                block_header.get_length());
+      out.write((const char *)&compressed[0], compressed_size);
+    }
+  }
+
+  deflateEnd(&z);
+  return okflag;
+
+#else  // HAVE_ZLIB
+  xfile_cat.error()
+    << "Cannot write compressed .x files without zlib.\n";
+  return false;
+#endif  // HAVE_ZLIB
+}
+
 /**
  * Returns a global XFile object that contains the standard list of Direct3D
  * template definitions that may be assumed to be at the head of every file.
@@ -24,6 +24,7 @@
 
 class XFileTemplate;
 class XFileDataNodeTemplate;
+class Datagram;
 
 /**
  * This represents the complete contents of an X file (file.x) in memory.  It
@@ -56,17 +57,26 @@ public:
   enum FormatType {
     FT_text,
     FT_binary,
-    FT_compressed,
+    FT_compressed,       // MSZIP-compressed binary
+    FT_compressed_text,  // MSZIP-compressed text
   };
   enum FloatSize {
     FS_32,
     FS_64,
   };
 
+  INLINE void set_format_type(FormatType format_type);
+  INLINE FormatType get_format_type() const;
+  INLINE void set_float_size(FloatSize float_size);
+  INLINE FloatSize get_float_size() const;
+
 private:
   bool read_header(std::istream &in);
   bool write_header(std::ostream &out) const;
 
+  static bool read_compressed_data(std::istream &in, Datagram &data);
+  static bool write_compressed_data(std::ostream &out, const Datagram &data);
+
   static const XFile *get_standard_templates();
 
   int _major_version, _minor_version;
@@ -14,6 +14,9 @@
 #include "xFileArrayDef.h"
 #include "xFileDataDef.h"
 #include "xFileDataObject.h"
+#include "xFileBinaryWriter.h"
+#include "xParserDefs.h"
+#include "xParser.h"
 
 /**
  * Returns the size of the array dimension.  If this is a fixed array, the
@@ -46,6 +49,20 @@ output(std::ostream &out) const {
   }
 }
 
+/**
+ * Writes the array dimension to a binary .x file.
+ */
+void XFileArrayDef::
+write_binary(XFileBinaryWriter &writer) const {
+  writer.write_token(TOKEN_OBRACKET);
+  if (is_fixed_size()) {
+    writer.write_integer(_fixed_size);
+  } else {
+    writer.write_name(_dynamic_size->get_name());
+  }
+  writer.write_token(TOKEN_CBRACKET);
+}
+
 /**
  * Returns true if the node, particularly a template node, is structurally
  * equivalent to the other node (which must be of the same type).  This checks
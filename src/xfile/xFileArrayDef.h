@@ -19,6 +19,7 @@
 #include "xFileNode.h"
 
 class XFileDataDef;
+class XFileBinaryWriter;
 
 /**
  * Defines one level of array bounds for an associated XFileDataDef element.
@@ -35,6 +36,7 @@ public:
   int get_size(const XFileNode::PrevData &prev_data) const;
 
   void output(std::ostream &out) const;
+  void write_binary(XFileBinaryWriter &writer) const;
 
   bool matches(const XFileArrayDef &other, const XFileDataDef *parent,
                const XFileDataDef *other_parent) const;
@@ -0,0 +1,129 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file xFileBinaryWriter.cxx
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#include "xFileBinaryWriter.h"
+#include "xParserDefs.h"
+#include "xParser.h"
+#include "windowsGuid.h"
+
+/**
+ * The tokens are appended to the indicated datagram, which must persist for
+ * the lifetime of the XFileBinaryWriter.  If double_floats is true, floating-
+ * point values are written as 64-bit doubles; otherwise as 32-bit floats.
+ */
+XFileBinaryWriter::
+XFileBinaryWriter(Datagram &dg, bool double_floats) :
+  _dg(dg),
+  _double_floats(double_floats)
+{
+}
+
+/**
+ *
+ */
+XFileBinaryWriter::
+~XFileBinaryWriter() {
+  flush_data();
+}
+
+/**
+ * Writes a TOKEN_NAME with the indicated name.
+ */
+void XFileBinaryWriter::
+write_name(const std::string &name) {
+  flush_data();
+  _dg.add_uint16(TOKEN_NAME);
+  _dg.add_uint32(name.length());
+  _dg.append_data(name.data(), name.length());
+}
+
+/**
+ * Writes a TOKEN_INTEGER with the indicated value.  This is used for array
+ * dimensions within a template definition, not for data values.
+ */
+void XFileBinaryWriter::
+write_integer(int value) {
+  flush_data();
+  _dg.add_uint16(TOKEN_INTEGER);
+  _dg.add_int32(value);
+}
+
+/**
+ * Writes a TOKEN_GUID with the indicated value.
+ */
+void XFileBinaryWriter::
+write_guid(const WindowsGuid &guid) {
+  flush_data();
+  _dg.add_uint16(TOKEN_GUID);
+  guid.write_datagram(_dg);
+}
+
+/**
+ * Writes a string data value.  In the binary format, the string token carries
+ * its own separator.
+ */
+void XFileBinaryWriter::
+add_string(const std::string &str) {
+  flush_data();
+  _dg.add_uint16(TOKEN_STRING);
+  _dg.add_uint32(str.length());
+  _dg.append_data(str.data(), str.length());
+  _dg.add_uint32(TOKEN_SEMICOLON);
+}
+
+/**
+ * Writes out any integer or floating-point values that have been added since
+ * the last token.
+ */
+void XFileBinaryWriter::
+flush_data() {
+  if (!_ints.empty()) {
+    flush_ints();
+  }
+  if (!_doubles.empty()) {
+    flush_doubles();
+  }
+}
+
+/**
+ * Writes the pending integer values as a TOKEN_INTEGER_LIST.
+ */
+void XFileBinaryWriter::
+flush_ints() {
+  _dg.add_uint16(TOKEN_INTEGER_LIST);
+  _dg.add_uint32(_ints.size());
+  for (size_t i = 0; i < _ints.size(); ++i) {
+    _dg.add_int32(_ints[i]);
+  }
+  _ints.clear();
+}
+
+/**
+ * Writes the pending floating-point values as a TOKEN_FLOAT_LIST, which the
+ * parser calls TOKEN_REALNUM_LIST.
+ */
+void XFileBinaryWriter::
+flush_doubles() {
+  _dg.add_uint16(TOKEN_REALNUM_LIST);
+  _dg.add_uint32(_doubles.size());
+  if (_double_floats) {
+    for (size_t i = 0; i < _doubles.size(); ++i) {
+      _dg.add_float64(_doubles[i]);
+    }
+  } else {
+    for (size_t i = 0; i < _doubles.size(); ++i) {
+      _dg.add_float32((PN_float32)_doubles[i]);
+    }
+  }
+  _doubles.clear();
+}
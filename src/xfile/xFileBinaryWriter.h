@@ -0,0 +1,58 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file xFileBinaryWriter.h
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#ifndef XFILEBINARYWRITER_H
+#define XFILEBINARYWRITER_H
+
+#include "pandatoolbase.h"
+#include "datagram.h"
+#include "pvector.h"
+
+class WindowsGuid;
+
+/**
+ * This class accumulates the token stream of a binary .x file into a
+ * Datagram.  Consecutive integer and floating-point data values are gathered
+ * up into a single list token, the way the DirectX runtime writes them.
+ */
+class XFileBinaryWriter {
+public:
+  XFileBinaryWriter(Datagram &dg, bool double_floats);
+  ~XFileBinaryWriter();
+
+  INLINE void write_token(int token);
+  void write_name(const std::string &name);
+  void write_integer(int value);
+  void write_guid(const WindowsGuid &guid);
+
+  INLINE void add_int(int value);
+  INLINE void add_double(double value);
+  void add_string(const std::string &str);
+  void flush_data();
+
+private:
+  void flush_ints();
+  void flush_doubles();
+
+  Datagram &_dg;
+  bool _double_floats;
+
+  typedef pvector<int> Ints;
+  Ints _ints;
+  typedef pvector<double> Doubles;
+  Doubles _doubles;
+};
+
+#include "xFileBinaryWriter.I"
+
+#endif
@@ -20,7 +20,13 @@
 #include "xFileDataObjectString.h"
 #include "xFileDataNodeTemplate.h"
 #include "xFileDataObjectArray.h"
+#include "xFileDataObjectPackedArray.h"
 #include "string_utils.h"
+#include "xFileBinaryWriter.h"
+#include "xParserDefs.h"
+#include "xParser.h"
+
+#include <algorithm>
 
 TypeHandle XFileDataDef::_type_handle;
 
@@ -122,6 +128,78 @@ write_text(std::ostream &out, int indent_level) const {
   out << ";\n";
 }
 
+/**
+ * Writes a suitable representation of this node to an .x file in binary
+ * mode.
+ */
+void XFileDataDef::
+write_binary(XFileBinaryWriter &writer) const {
+  if (!_array_def.empty()) {
+    writer.write_token(TOKEN_ARRAY);
+  }
+
+  switch (_type) {
+  case T_word:
+    writer.write_token(TOKEN_WORD);
+    break;
+
+  case T_dword:
+    writer.write_token(TOKEN_DWORD);
+    break;
+
+  case T_float:
+    writer.write_token(TOKEN_FLOAT);
+    break;
+
+  case T_double:
+    writer.write_token(TOKEN_DOUBLE);
+    break;
+
+  case T_char:
+    writer.write_token(TOKEN_CHAR);
+    break;
+
+  case T_uchar:
+    writer.write_token(TOKEN_UCHAR);
+    break;
+
+  case T_sword:
+    writer.write_token(TOKEN_SWORD);
+    break;
+
+  case T_sdword:
+    writer.write_token(TOKEN_SDWORD);
+    break;
+
+  case T_string:
+    writer.write_token(TOKEN_LPSTR);
+    break;
+
+  case T_cstring:
+    writer.write_token(TOKEN_CSTRING);
+    break;
+
+  case T_unicode:
+    writer.write_token(TOKEN_UNICODE);
+    break;
+
+  case T_template:
+    writer.write_name(_template->get_name());
+    break;
+  }
+
+  if (has_name()) {
+    writer.write_name(get_name());
+  }
+
+  ArrayDef::const_iterator ai;
+  for (ai = _array_def.begin(); ai != _array_def.end(); ++ai) {
+    (*ai).write_binary(writer);
+  }
+
+  writer.write_token(TOKEN_SEMICOLON);
+}
+
 /**
  * This is called on the template that defines an object, once the data for
  * the object has been parsed.  It is responsible for identifying which
@@ -399,6 +477,12 @@ unpack_value(const XFileParseDataList &parse_data_list, int array_index,
     data_value = (this->*unpack_method)(parse_data_list, prev_data,
                                         index, sub_index);
 
+  } else if (array_index + 1 == (int)_array_def.size() &&
+             XFileDataObjectPackedArray::can_pack(this)) {
+    // The innermost dimension of an array of numbers is unpacked all at once.
+    data_value = unpack_packed_array(parse_data_list, array_index,
+                                     prev_data, index, sub_index);
+
   } else {
     data_value = new XFileDataObjectArray(this);
     int array_size = _array_def[array_index].get_size(prev_data);
@@ -424,6 +508,115 @@ unpack_value(const XFileParseDataList &parse_data_list, int array_index,
   return data_value;
 }
 
+/**
+ * Unpacks all of the elements of the innermost dimension of an array of
+ * numbers (or of templates of numbers) into an XFileDataObjectPackedArray.
+ * The values are copied a run at a time from the parse_data_list, rather than
+ * creating a separate object for each one.
+ */
+PT(XFileDataObject) XFileDataDef::
+unpack_packed_array(const XFileParseDataList &parse_data_list,
+                    int array_index, const XFileDataDef::PrevData &prev_data,
+                    size_t &index, size_t &sub_index) const {
+  PT(XFileDataObjectPackedArray) data_value =
+    new XFileDataObjectPackedArray(this);
+  int array_size = _array_def[array_index].get_size(prev_data);
+  if (array_size <= 0) {
+    return data_value.p();
+  }
+  int num_components = data_value->get_num_components();
+  bool is_integer = data_value->is_integer();
+  size_t num_values = (size_t)array_size * num_components;
+
+  // The array size comes from the file, so it might be wildly wrong.  Rather
+  // than trusting it, we reserve room only for the values that are actually
+  // present in the current run of data.
+  if (index < parse_data_list._list.size()) {
+    const XFileParseData &parse_data = parse_data_list._list[index];
+    size_t available = 0;
+    if (!is_integer &&
+        (parse_data._parse_flags & XFileParseData::PF_double) != 0) {
+      available = parse_data._double_list.size();
+    } else if ((parse_data._parse_flags & XFileParseData::PF_int) != 0) {
+      available = parse_data._int_list.size();
+    }
+    if (available > sub_index) {
+      available = std::min(num_values, available - sub_index);
+      data_value->reserve((int)(available / num_components));
+    }
+  }
+
+  size_t count = 0;
+  while (count < num_values) {
+    // In an array of templates, this is the member that receives the next
+    // value.
+    const XFileDataDef *member = this;
+    if (_type == T_template) {
+      member = DCAST(XFileDataDef,
+                     _template->get_child((int)(count % num_components)));
+    }
+
+    if (index >= parse_data_list._list.size()) {
+      if (count % num_components == 0) {
+        xyyerror(std::string("Expected ") + format_string(array_size)
+                 + " array elements, found "
+                 + format_string(count / num_components));
+      } else {
+        xyyerror("Not enough data elements in structure at " +
+                 member->get_name());
+      }
+      data_value->truncate();
+      return data_value.p();
+    }
+
+    const XFileParseData &parse_data = parse_data_list._list[index];
+    size_t num_remaining = num_values - count;
+
+    if (!is_integer &&
+        (parse_data._parse_flags & XFileParseData::PF_double) != 0) {
+      size_t list_size = parse_data._double_list.size();
+      nassertr(sub_index <= list_size, nullptr);
+      size_t num_copy = std::min(num_remaining, list_size - sub_index);
+      if (num_copy != 0) {
+        data_value->append_doubles(&parse_data._double_list[sub_index],
+                                   num_copy);
+      }
+      count += num_copy;
+      sub_index += num_copy;
+      if (sub_index >= list_size) {
+        index++;
+        sub_index = 0;
+      }
+
+    } else if ((parse_data._parse_flags & XFileParseData::PF_int) != 0) {
+      size_t list_size = parse_data._int_list.size();
+      nassertr(sub_index <= list_size, nullptr);
+      size_t num_copy = std::min(num_remaining, list_size - sub_index);
+      if (num_copy != 0) {
+        data_value->append_ints(&parse_data._int_list[sub_index], num_copy);
+      }
+      count += num_copy;
+      sub_index += num_copy;
+      if (sub_index >= list_size) {
+        index++;
+        sub_index = 0;
+      }
+
+    } else {
+      if (is_integer) {
+        parse_data.yyerror("Expected integer data for " + member->get_name());
+      } else {
+        parse_data.yyerror("Expected floating-point data for " +
+                           member->get_name());
+      }
+      data_value->truncate();
+      return data_value.p();
+    }
+  }
+
+  return data_value.p();
+}
+
 /**
  * Returns a newly-allocated zero integer value.
  */
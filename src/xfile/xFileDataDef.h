@@ -59,6 +59,7 @@ public:
   INLINE const XFileArrayDef &get_array_def(int i) const;
 
   virtual void write_text(std::ostream &out, int indent_level) const;
+  virtual void write_binary(XFileBinaryWriter &writer) const;
 
   virtual bool repack_data(XFileDataObject *object,
                            const XFileParseDataList &parse_data_list,
@@ -99,6 +100,10 @@ private:
                  const PrevData &prev_data,
                  size_t &index, size_t &sub_index,
                  UnpackMethod unpack_method) const;
+  PT(XFileDataObject)
+    unpack_packed_array(const XFileParseDataList &parse_data_list,
+                        int array_index, const PrevData &prev_data,
+                        size_t &index, size_t &sub_index) const;
 
   PT(XFileDataObject) zero_fill_integer_value() const;
   PT(XFileDataObject) zero_fill_double_value() const;
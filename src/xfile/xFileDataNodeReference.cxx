@@ -13,6 +13,9 @@
 
 #include "xFileDataNodeReference.h"
 #include "indent.h"
+#include "xFileBinaryWriter.h"
+#include "xParserDefs.h"
+#include "xParser.h"
 
 TypeHandle XFileDataNodeReference::_type_handle;
 
@@ -67,6 +70,17 @@ write_text(std::ostream &out, int indent_level) const {
     << "{ " << _object->get_name() << " }\n";
 }
 
+/**
+ * Writes a suitable representation of this node to an .x file in binary
+ * mode.
+ */
+void XFileDataNodeReference::
+write_binary(XFileBinaryWriter &writer) const {
+  writer.write_token(TOKEN_OBRACE);
+  writer.write_name(_object->get_name());
+  writer.write_token(TOKEN_CBRACE);
+}
+
 /**
  * Returns the number of nested data elements within the object.  This may be,
  * e.g.  the size of the array, if it is an array.
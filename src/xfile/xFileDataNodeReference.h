@@ -37,6 +37,7 @@ public:
   virtual bool is_complex_object() const;
 
   virtual void write_text(std::ostream &out, int indent_level) const;
+  virtual void write_binary(XFileBinaryWriter &writer) const;
 
 protected:
   virtual int get_num_elements() const;
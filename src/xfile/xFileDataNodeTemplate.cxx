@@ -12,6 +12,9 @@
  */
 
 #include "xFileDataNodeTemplate.h"
+#include "xFileBinaryWriter.h"
+#include "xParserDefs.h"
+#include "xParser.h"
 #include "indent.h"
 #include "xFileParseData.h"
 #include "xLexerDefs.h"
@@ -147,6 +150,24 @@ write_text(std::ostream &out, int indent_level) const {
     << "}\n";
 }
 
+/**
+ * Writes a suitable representation of this node to an .x file in binary
+ * mode.
+ */
+void XFileDataNodeTemplate::
+write_binary(XFileBinaryWriter &writer) const {
+  writer.write_name(_template->get_name());
+  if (has_name()) {
+    writer.write_name(get_name());
+  }
+  writer.write_token(TOKEN_OBRACE);
+
+  write_binary_data(writer);
+
+  XFileNode::write_binary(writer);
+  writer.write_token(TOKEN_CBRACE);
+}
+
 /**
  * Writes a suitable representation of this node to an .x file in text mode.
  */
@@ -193,6 +214,18 @@ write_data(std::ostream &out, int indent_level, const char *separator) const {
   }
 }
 
+/**
+ * Appends the data values of this object to the token stream of a binary .x
+ * file.
+ */
+void XFileDataNodeTemplate::
+write_binary_data(XFileBinaryWriter &writer) const {
+  NestedElements::const_iterator ni;
+  for (ni = _nested_elements.begin(); ni != _nested_elements.end(); ++ni) {
+    (*ni)->write_binary_data(writer);
+  }
+}
+
 /**
  * Returns the number of nested data elements within the object.  This may be,
  * e.g.  the size of the array, if it is an array.
@@ -44,8 +44,10 @@ public:
   virtual bool add_element(XFileDataObject *element);
 
   virtual void write_text(std::ostream &out, int indent_level) const;
+  virtual void write_binary(XFileBinaryWriter &writer) const;
   virtual void write_data(std::ostream &out, int indent_level,
                           const char *separator) const;
+  virtual void write_binary_data(XFileBinaryWriter &writer) const;
 
 protected:
   virtual int get_num_elements() const;
@@ -183,6 +183,14 @@ write_data(std::ostream &out, int indent_level, const char *) const {
     << "(" << get_type() << "::write_data() not implemented.)\n";
 }
 
+/**
+ * Appends the data values of this object to the token stream of a binary .x
+ * file.
+ */
+void XFileDataObject::
+write_binary_data(XFileBinaryWriter &) const {
+}
+
 /**
  * Sets the object's value as an integer, if this is legal.
  */
@@ -273,6 +281,43 @@ get_double_array(int num_elements, double *values) const {
   }
 }
 
+/**
+ * Fills the indicated vector with the integer value of each of the nested
+ * elements within this object, e.g.  the elements of a DWORD array.
+ */
+void XFileDataObject::
+extract_int_array(vector_int &values) const {
+  int num_elements = get_num_elements();
+  values.clear();
+  values.reserve(num_elements);
+  for (int i = 0; i < num_elements; i++) {
+    XFileDataObject *element = ((XFileDataObject *)this)->get_element(i);
+    values.push_back(element->get_int_value());
+  }
+}
+
+/**
+ * Fills the indicated vector with the floating-point values of each of the
+ * nested elements within this object, one after the other.  If num_components
+ * is 1, each element should be a single value, e.g.  the elements of a FLOAT
+ * array; otherwise, each element should contain exactly num_components
+ * values, e.g.  the elements of an array of Vectors.
+ */
+void XFileDataObject::
+extract_double_array(int num_components, vector_double &values) const {
+  int num_elements = get_num_elements();
+  values.clear();
+  values.resize((size_t)num_elements * num_components, 0.0);
+  for (int i = 0; i < num_elements; i++) {
+    XFileDataObject *element = ((XFileDataObject *)this)->get_element(i);
+    if (num_components == 1) {
+      values[i] = element->get_double_value();
+    } else {
+      element->get_double_array(num_components, &values[i * num_components]);
+    }
+  }
+}
+
 /**
  * Returns the number of nested data elements within the object.  This may be,
  * e.g.  the size of the array, if it is an array.
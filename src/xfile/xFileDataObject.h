@@ -19,9 +19,12 @@
 #include "pointerTo.h"
 #include "dcast.h"
 #include "luse.h"
+#include "vector_int.h"
+#include "vector_double.h"
 
 class XFile;
 class XFileDataDef;
+class XFileBinaryWriter;
 
 /**
  * The abstract base class for a number of different types of data elements
@@ -68,6 +71,13 @@ public:
   INLINE XFileDataObject &operator [] (int n);
   INLINE XFileDataObject &operator [] (const std::string &name);
 
+  // The following methods retrieve all of the values of a numeric array at
+  // once, which is much faster than indexing the elements individually.
+
+  virtual void extract_int_array(vector_int &values) const;
+  virtual void extract_double_array(int num_components,
+                                    vector_double &values) const;
+
   // The following methods can be used to add elements of a specific type to a
   // complex object, e.g.  an array or a template object.
 
@@ -90,6 +100,7 @@ public:
   virtual void output_data(std::ostream &out) const;
   virtual void write_data(std::ostream &out, int indent_level,
                           const char *separator) const;
+  virtual void write_binary_data(XFileBinaryWriter &writer) const;
 
 protected:
   virtual void set_int_value(int int_value);
@@ -100,7 +111,7 @@ protected:
   virtual int get_int_value() const;
   virtual double get_double_value() const;
   virtual std::string get_string_value() const;
-  void get_double_array(int num_elements, double *values) const;
+  virtual void get_double_array(int num_elements, double *values) const;
 
   virtual int get_num_elements() const;
   virtual XFileDataObject *get_element(int n);
@@ -12,6 +12,7 @@
  */
 
 #include "xFileDataObjectArray.h"
+#include "xFileBinaryWriter.h"
 #include "string_utils.h"
 #include "indent.h"
 
@@ -42,12 +43,13 @@ add_element(XFileDataObject *element) {
  */
 void XFileDataObjectArray::
 write_data(std::ostream &out, int indent_level, const char *separator) const {
-  if (!_nested_elements.empty()) {
+  int num_elements = get_num_elements();
+  if (num_elements != 0) {
     bool indented = false;
-    for (size_t i = 0; i < _nested_elements.size() - 1; i++) {
-      XFileDataObject *object = _nested_elements[i];
+    for (int i = 0; i < num_elements - 1; i++) {
+      PT(XFileDataObject) object = get_output_element(i);
       if (object->is_complex_object() ||
-          _nested_elements.size() > 16) {
+          num_elements > 16) {
         // If we have a "complex" nested object, or more than 16 elements in
         // the array, output it on its own line.
         if (indented) {
@@ -68,7 +70,7 @@ write_data(std::ostream &out, int indent_level, const char *separator) const {
 
     // The last object in the set is different, because it gets separator
     // instead of a semicolon, and it always gets a newline.
-    XFileDataObject *object = _nested_elements.back();
+    PT(XFileDataObject) object = get_output_element(num_elements - 1);
     if (object->is_complex_object()) {
       if (indented) {
         out << "\n";
@@ -84,6 +86,18 @@ write_data(std::ostream &out, int indent_level, const char *separator) const {
   }
 }
 
+/**
+ * Appends the data values of this object to the token stream of a binary .x
+ * file.
+ */
+void XFileDataObjectArray::
+write_binary_data(XFileBinaryWriter &writer) const {
+  NestedElements::const_iterator ni;
+  for (ni = _nested_elements.begin(); ni != _nested_elements.end(); ++ni) {
+    (*ni)->write_binary_data(writer);
+  }
+}
+
 /**
  * Returns the number of nested data elements within the object.  This may be,
  * e.g.  the size of the array, if it is an array.
@@ -101,3 +115,14 @@ get_element(int n) {
   nassertr(n >= 0 && n < (int)_nested_elements.size(), nullptr);
   return _nested_elements[n];
 }
+
+/**
+ * Returns the nth nested data element within the object, for the purpose of
+ * writing it out.  Unlike get_element(), this may return a temporary copy of
+ * the element.
+ */
+PT(XFileDataObject) XFileDataObjectArray::
+get_output_element(int n) const {
+  nassertr(n >= 0 && n < (int)_nested_elements.size(), nullptr);
+  return _nested_elements[n];
+}
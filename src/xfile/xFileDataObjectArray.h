@@ -30,12 +30,13 @@ public:
 
   virtual void write_data(std::ostream &out, int indent_level,
                           const char *separator) const;
+  virtual void write_binary_data(XFileBinaryWriter &writer) const;
 
 protected:
   virtual int get_num_elements() const;
   virtual XFileDataObject *get_element(int n);
+  virtual PT(XFileDataObject) get_output_element(int n) const;
 
-private:
   typedef pvector< PT(XFileDataObject) > NestedElements;
   NestedElements _nested_elements;
 
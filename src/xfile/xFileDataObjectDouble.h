@@ -28,6 +28,7 @@ public:
   virtual void output_data(std::ostream &out) const;
   virtual void write_data(std::ostream &out, int indent_level,
                           const char *separator) const;
+  virtual void write_binary_data(XFileBinaryWriter &writer) const;
 
 protected:
   virtual void set_int_value(int int_value);
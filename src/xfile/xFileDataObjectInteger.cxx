@@ -12,6 +12,7 @@
  */
 
 #include "xFileDataObjectInteger.h"
+#include "xFileBinaryWriter.h"
 #include "string_utils.h"
 #include "indent.h"
 
@@ -44,6 +45,15 @@ write_data(std::ostream &out, int indent_level, const char *separator) const {
     << _value << separator << "\n";
 }
 
+/**
+ * Appends the data values of this object to the token stream of a binary .x
+ * file.
+ */
+void XFileDataObjectInteger::
+write_binary_data(XFileBinaryWriter &writer) const {
+  writer.add_int(_value);
+}
+
 /**
  * Sets the object's value as an integer, if this is legal.
  */
@@ -0,0 +1,297 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file xFileDataObjectPackedArray.cxx
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#include "xFileDataObjectPackedArray.h"
+#include "xFileDataDef.h"
+#include "xFileTemplate.h"
+#include "xFileDataNodeTemplate.h"
+#include "xFileDataObjectInteger.h"
+#include "xFileDataObjectDouble.h"
+#include "xFileBinaryWriter.h"
+
+TypeHandle XFileDataObjectPackedArray::_type_handle;
+
+/**
+ * Creates an empty array for elements of the indicated definition, which must
+ * be one for which can_pack() returns true.
+ */
+XFileDataObjectPackedArray::
+XFileDataObjectPackedArray(const XFileDataDef *data_def) :
+  XFileDataObjectArray(data_def),
+  _packed(true),
+  _is_integer(false),
+  _num_components(1)
+{
+  switch (data_def->get_data_type()) {
+  case XFileDataDef::T_float:
+  case XFileDataDef::T_double:
+    break;
+
+  case XFileDataDef::T_template:
+    _num_components = data_def->get_template()->get_num_children();
+    break;
+
+  default:
+    _is_integer = true;
+    break;
+  }
+}
+
+/**
+ * Returns true if an array of elements of the indicated definition can be
+ * stored in packed form: that is, if the elements are integers or
+ * floating-point numbers, or templates whose members are all single
+ * floating-point numbers.
+ */
+bool XFileDataObjectPackedArray::
+can_pack(const XFileDataDef *data_def) {
+  switch (data_def->get_data_type()) {
+  case XFileDataDef::T_word:
+  case XFileDataDef::T_dword:
+  case XFileDataDef::T_float:
+  case XFileDataDef::T_double:
+  case XFileDataDef::T_char:
+  case XFileDataDef::T_uchar:
+  case XFileDataDef::T_sword:
+  case XFileDataDef::T_sdword:
+    return true;
+
+  case XFileDataDef::T_template:
+    break;
+
+  default:
+    return false;
+  }
+
+  XFileTemplate *xtemplate = data_def->get_template();
+  if (xtemplate == nullptr || xtemplate->get_open() ||
+      xtemplate->get_num_options() != 0 ||
+      xtemplate->get_num_children() == 0) {
+    return false;
+  }
+
+  int num_children = xtemplate->get_num_children();
+  for (int i = 0; i < num_children; i++) {
+    XFileNode *child = xtemplate->get_child(i);
+    if (!child->is_of_type(XFileDataDef::get_class_type())) {
+      return false;
+    }
+    XFileDataDef *member = DCAST(XFileDataDef, child);
+    if ((member->get_data_type() != XFileDataDef::T_float &&
+         member->get_data_type() != XFileDataDef::T_double) ||
+        member->get_num_array_defs() != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Discards any values at the end of the table that do not make up a complete
+ * element.  This is called by the parser when it runs out of data partway
+ * through an element.
+ */
+void XFileDataObjectPackedArray::
+truncate() {
+  if (_is_integer) {
+    _ints.resize(_ints.size() - _ints.size() % _num_components);
+  } else {
+    _doubles.resize(_doubles.size() - _doubles.size() % _num_components);
+  }
+}
+
+/**
+ * Adds the indicated element as a nested data element, if this data object
+ * type supports it.  Returns true if added successfully, false if the data
+ * object type does not support nested data elements.
+ */
+bool XFileDataObjectPackedArray::
+add_element(XFileDataObject *element) {
+  unpack();
+  return XFileDataObjectArray::add_element(element);
+}
+
+/**
+ * Fills the indicated vector with the integer value of each of the nested
+ * elements within this object, e.g.  the elements of a DWORD array.
+ */
+void XFileDataObjectPackedArray::
+extract_int_array(vector_int &values) const {
+  if (!_packed || _num_components != 1) {
+    XFileDataObjectArray::extract_int_array(values);
+    return;
+  }
+
+  if (_is_integer) {
+    values.assign(_ints.begin(), _ints.end());
+  } else {
+    values.resize(_doubles.size());
+    for (size_t i = 0; i < _doubles.size(); i++) {
+      values[i] = (int)_doubles[i];
+    }
+  }
+}
+
+/**
+ * Fills the indicated vector with the floating-point values of each of the
+ * nested elements within this object, one after the other.
+ */
+void XFileDataObjectPackedArray::
+extract_double_array(int num_components, vector_double &values) const {
+  if (!_packed || num_components != _num_components) {
+    XFileDataObjectArray::extract_double_array(num_components, values);
+    return;
+  }
+
+  if (_is_integer) {
+    values.assign(_ints.begin(), _ints.end());
+  } else {
+    values = _doubles;
+  }
+}
+
+/**
+ * Appends the data values of this object to the token stream of a binary .x
+ * file.
+ */
+void XFileDataObjectPackedArray::
+write_binary_data(XFileBinaryWriter &writer) const {
+  if (!_packed) {
+    XFileDataObjectArray::write_binary_data(writer);
+    return;
+  }
+
+  if (_is_integer) {
+    vector_int::const_iterator ii;
+    for (ii = _ints.begin(); ii != _ints.end(); ++ii) {
+      writer.add_int(*ii);
+    }
+  } else {
+    vector_double::const_iterator di;
+    for (di = _doubles.begin(); di != _doubles.end(); ++di) {
+      writer.add_double(*di);
+    }
+  }
+}
+
+/**
+ * Fills the indicated array of doubles with the values from the nested
+ * elements within this object.  There must be exactly the indicated number of
+ * nested values, and they must all return a double.
+ */
+void XFileDataObjectPackedArray::
+get_double_array(int num_elements, double *values) const {
+  if (!_packed || _num_components != 1 || get_num_elements() != num_elements) {
+    XFileDataObjectArray::get_double_array(num_elements, values);
+    return;
+  }
+
+  if (_is_integer) {
+    for (int i = 0; i < num_elements; i++) {
+      values[i] = (double)_ints[i];
+    }
+  } else {
+    for (int i = 0; i < num_elements; i++) {
+      values[i] = _doubles[i];
+    }
+  }
+}
+
+/**
+ * Returns the number of nested data elements within the object.  This may be,
+ * e.g.  the size of the array, if it is an array.
+ */
+int XFileDataObjectPackedArray::
+get_num_elements() const {
+  if (!_packed) {
+    return XFileDataObjectArray::get_num_elements();
+  }
+  if (_is_integer) {
+    return (int)(_ints.size() / _num_components);
+  } else {
+    return (int)(_doubles.size() / _num_components);
+  }
+}
+
+/**
+ * Returns the nth nested data element within the object.  This converts the
+ * whole array to individual element objects first.
+ */
+XFileDataObject *XFileDataObjectPackedArray::
+get_element(int n) {
+  unpack();
+  return XFileDataObjectArray::get_element(n);
+}
+
+/**
+ * Returns the nth nested data element within the object, for the purpose of
+ * writing it out.  While the array is packed, this is a temporary object
+ * constructed for the purpose.
+ */
+PT(XFileDataObject) XFileDataObjectPackedArray::
+get_output_element(int n) const {
+  if (!_packed) {
+    return XFileDataObjectArray::get_output_element(n);
+  }
+  nassertr(n >= 0 && n < get_num_elements(), nullptr);
+  return make_element(n);
+}
+
+/**
+ * Constructs a new object to represent the nth element of the packed array,
+ * of the same type the parser would have created for it.
+ */
+PT(XFileDataObject) XFileDataObjectPackedArray::
+make_element(int n) const {
+  if (_data_def->get_data_type() == XFileDataDef::T_template) {
+    XFileTemplate *xtemplate = _data_def->get_template();
+    PT(XFileDataNodeTemplate) node =
+      new XFileDataNodeTemplate(_data_def->get_x_file(), _data_def->get_name(),
+                                xtemplate);
+    const double *values = &_doubles[(size_t)n * _num_components];
+    for (int i = 0; i < _num_components; i++) {
+      XFileDataDef *member = DCAST(XFileDataDef, xtemplate->get_child(i));
+      node->add_element(new XFileDataObjectDouble(member, values[i]));
+    }
+    return node.p();
+  }
+
+  if (_is_integer) {
+    return new XFileDataObjectInteger(_data_def, _ints[n]);
+  } else {
+    return new XFileDataObjectDouble(_data_def, _doubles[n]);
+  }
+}
+
+/**
+ * Converts the packed table into individual element objects, so that they may
+ * be returned by get_element().  Once this is done, the array behaves just
+ * like an ordinary XFileDataObjectArray.
+ */
+void XFileDataObjectPackedArray::
+unpack() {
+  if (!_packed) {
+    return;
+  }
+
+  int num_elements = get_num_elements();
+  _nested_elements.reserve(_nested_elements.size() + num_elements);
+  for (int i = 0; i < num_elements; i++) {
+    _nested_elements.push_back(make_element(i));
+  }
+
+  _packed = false;
+  vector_int().swap(_ints);
+  vector_double().swap(_doubles);
+}
@@ -0,0 +1,96 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file xFileDataObjectPackedArray.h
+ * @author agent
+ * @date 2026-10-16
+ */
+
+#ifndef XFILEDATAOBJECTPACKEDARRAY_H
+#define XFILEDATAOBJECTPACKEDARRAY_H
+
+#include "pandatoolbase.h"
+#include "xFileDataObjectArray.h"
+#include "vector_int.h"
+#include "vector_double.h"
+
+class XFileDataDef;
+
+/**
+ * An array of numeric data elements, stored as one contiguous table of values
+ * rather than as a separate XFileDataObject per element.  The parser creates
+ * one of these for each array of integers or floating-point numbers, and for
+ * each array of templates that contain nothing but floating-point members
+ * (e.g.  Vector or Coords2d).
+ *
+ * The values may be retrieved in bulk with extract_int_array() or
+ * extract_double_array().  If an individual element is requested, the array
+ * is converted in its entirety to the ordinary per-element representation of
+ * XFileDataObjectArray, so that the element may be safely modified.
+ */
+class XFileDataObjectPackedArray : public XFileDataObjectArray {
+public:
+  XFileDataObjectPackedArray(const XFileDataDef *data_def);
+
+  static bool can_pack(const XFileDataDef *data_def);
+
+  INLINE bool is_packed() const;
+  INLINE bool is_integer() const;
+  INLINE int get_num_components() const;
+
+  INLINE void reserve(int num_elements);
+  INLINE void append_ints(const int *values, size_t num_values);
+  INLINE void append_doubles(const double *values, size_t num_values);
+  void truncate();
+
+  virtual bool add_element(XFileDataObject *element);
+
+  virtual void extract_int_array(vector_int &values) const;
+  virtual void extract_double_array(int num_components,
+                                    vector_double &values) const;
+
+  virtual void write_binary_data(XFileBinaryWriter &writer) const;
+
+protected:
+  virtual void get_double_array(int num_elements, double *values) const;
+
+  virtual int get_num_elements() const;
+  virtual XFileDataObject *get_element(int n);
+  virtual PT(XFileDataObject) get_output_element(int n) const;
+
+private:
+  PT(XFileDataObject) make_element(int n) const;
+  void unpack();
+
+  bool _packed;
+  bool _is_integer;
+  int _num_components;
+  vector_int _ints;
+  vector_double _doubles;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    XFileDataObjectArray::init_type();
+    register_type(_type_handle, "XFileDataObjectPackedArray",
+                  XFileDataObjectArray::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "xFileDataObjectPackedArray.I"
+
+#endif
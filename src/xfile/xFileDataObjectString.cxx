@@ -12,6 +12,7 @@
  */
 
 #include "xFileDataObjectString.h"
+#include "xFileBinaryWriter.h"
 #include "string_utils.h"
 #include "indent.h"
 
@@ -47,6 +48,15 @@ write_data(std::ostream &out, int indent_level, const char *separator) const {
   out << separator << "\n";
 }
 
+/**
+ * Appends the data values of this object to the token stream of a binary .x
+ * file.
+ */
+void XFileDataObjectString::
+write_binary_data(XFileBinaryWriter &writer) const {
+  writer.add_string(_value);
+}
+
 /**
  * Sets the object's value as a string, if this is legal.
  */
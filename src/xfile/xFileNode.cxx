@@ -18,6 +18,7 @@
 #include "xFileParseData.h"
 #include "xFile.h"
 #include "xFileDataNodeTemplate.h"
+#include "xFileBinaryWriter.h"
 #include "filename.h"
 #include "string_utils.h"
 
@@ -223,6 +224,18 @@ write_text(std::ostream &out, int indent_level) const {
   }
 }
 
+/**
+ * Writes a suitable representation of this node to an .x file in binary
+ * mode.
+ */
+void XFileNode::
+write_binary(XFileBinaryWriter &writer) const {
+  Children::const_iterator ci;
+  for (ci = _children.begin(); ci != _children.end(); ++ci) {
+    (*ci)->write_binary(writer);
+  }
+}
+
 /**
  * This is called on the template that defines an object, once the data for
  * the object has been parsed.  It is responsible for identifying which
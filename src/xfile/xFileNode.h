@@ -32,6 +32,7 @@ class XFileDataObject;
 class XFileDataNode;
 class XFileDataNodeTemplate;
 class Filename;
+class XFileBinaryWriter;
 
 /**
  * A single node of an X file.  This may be either a template or a data node.
@@ -69,6 +70,7 @@ public:
   virtual void clear();
 
   virtual void write_text(std::ostream &out, int indent_level) const;
+  virtual void write_binary(XFileBinaryWriter &writer) const;
 
   typedef pmap<const XFileDataDef *, XFileDataObject *> PrevData;
 
@@ -13,6 +13,9 @@
 
 #include "xFileTemplate.h"
 #include "indent.h"
+#include "xFileBinaryWriter.h"
+#include "xParserDefs.h"
+#include "xParser.h"
 
 TypeHandle XFileTemplate::_type_handle;
 
@@ -112,6 +115,42 @@ write_text(std::ostream &out, int indent_level) const {
     << "}\n";
 }
 
+/**
+ * Writes a suitable representation of this node to an .x file in binary
+ * mode.
+ */
+void XFileTemplate::
+write_binary(XFileBinaryWriter &writer) const {
+  writer.write_token(TOKEN_TEMPLATE);
+  writer.write_name(get_name());
+  writer.write_token(TOKEN_OBRACE);
+  writer.write_guid(_guid);
+
+  XFileNode::write_binary(writer);
+
+  if (get_open()) {
+    // An open template
+    writer.write_token(TOKEN_OBRACKET);
+    writer.write_token(TOKEN_DOT);
+    writer.write_token(TOKEN_DOT);
+    writer.write_token(TOKEN_DOT);
+    writer.write_token(TOKEN_CBRACKET);
+
+  } else if (!_options.empty()) {
+    // A restricted template
+    writer.write_token(TOKEN_OBRACKET);
+    Options::const_iterator ri;
+    for (ri = _options.begin(); ri != _options.end(); ++ri) {
+      XFileTemplate *option = (*ri);
+      writer.write_name(option->get_name());
+      writer.write_guid(option->get_guid());
+    }
+    writer.write_token(TOKEN_CBRACKET);
+  }
+
+  writer.write_token(TOKEN_CBRACE);
+}
+
 /**
  * Returns true if the node, particularly a template node, is structurally
  * equivalent to the other node (which must be of the same type).  This checks
@@ -36,6 +36,7 @@ public:
 
   virtual void clear();
   virtual void write_text(std::ostream &out, int indent_level) const;
+  virtual void write_binary(XFileBinaryWriter &writer) const;
 
   INLINE bool is_standard() const;
 
@@ -16,7 +16,12 @@
 
 #include "pandatoolbase.h"
 
+class Datagram;
+
 void x_init_lexer(std::istream &in, const std::string &filename);
+void x_init_binary_lexer(const Datagram &data, const std::string &filename,
+                         bool double_floats);
+void x_cleanup_lexer();
 int x_error_count();
 int x_warning_count();
 
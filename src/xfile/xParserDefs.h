@@ -23,7 +23,11 @@
 class XFile;
 class XFileNode;
 
+class Datagram;
+
 void x_init_parser(std::istream &in, const std::string &filename, XFile &file);
+void x_init_binary_parser(const Datagram &data, const std::string &filename,
+                          bool double_floats, XFile &file);
 void x_cleanup_parser();
 int xyyparse();
 
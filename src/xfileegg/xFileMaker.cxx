@@ -46,6 +46,15 @@ XFileMaker::
 ~XFileMaker() {
 }
 
+/**
+ * Specifies the format in which the .x file will be written by write().
+ */
+void XFileMaker::
+set_format(XFile::FormatType format_type, XFile::FloatSize float_size) {
+  _x_file->set_format_type(format_type);
+  _x_file->set_float_size(float_size);
+}
+
 /**
  * Writes the .x file data to the indicated filename; returns true on success,
  * false otherwise.
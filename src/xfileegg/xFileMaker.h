@@ -38,6 +38,7 @@ public:
   XFileMaker();
   ~XFileMaker();
 
+  void set_format(XFile::FormatType format_type, XFile::FloatSize float_size);
   bool write(const Filename &filename);
 
   bool add_tree(EggData *egg_data);
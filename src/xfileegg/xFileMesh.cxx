@@ -619,24 +619,27 @@ bool XFileMesh::
 fill_mesh(XFileDataNode *obj) {
   clear();
 
-  int i, j;
+  int i;
+  size_t j;
 
-  const XFileDataObject &vertices = (*obj)["vertices"];
-  for (i = 0; i < vertices.size(); i++) {
+  vector_double points;
+  (*obj)["vertices"].extract_double_array(3, points);
+  for (j = 0; j + 2 < points.size(); j += 3) {
     XFileVertex *vertex = new XFileVertex;
-    vertex->_point = vertices[i].vec3();
+    vertex->_point.set(points[j], points[j + 1], points[j + 2]);
     add_vertex(vertex);
   }
 
+  vector_int faceIndices;
   const XFileDataObject &faces = (*obj)["faces"];
   for (i = 0; i < faces.size(); i++) {
     XFileFace *face = new XFileFace;
 
-    const XFileDataObject &faceIndices = faces[i]["faceVertexIndices"];
+    faces[i]["faceVertexIndices"].extract_int_array(faceIndices);
 
     for (j = 0; j < faceIndices.size(); j++) {
       XFileFace::Vertex vertex;
-      vertex._vertex_index = faceIndices[j].i();
+      vertex._vertex_index = faceIndices[j];
       vertex._normal_index = -1;
 
       face->_vertices.push_back(vertex);
@@ -706,10 +709,11 @@ bool XFileMesh::
 fill_normals(XFileDataNode *obj) {
   int i, j;
 
-  const XFileDataObject &normals = (*obj)["normals"];
-  for (i = 0; i < normals.size(); i++) {
+  vector_double normals;
+  (*obj)["normals"].extract_double_array(3, normals);
+  for (size_t ni = 0; ni + 2 < normals.size(); ni += 3) {
     XFileNormal *normal = new XFileNormal;
-    normal->_normal = normals[i].vec3();
+    normal->_normal.set(normals[ni], normals[ni + 1], normals[ni + 2]);
     normal->_has_normal = true;
     add_normal(normal);
   }
@@ -721,21 +725,22 @@ fill_normals(XFileDataNode *obj) {
       << get_name() << "\n";
   }
 
+  vector_int faceIndices;
   int num_normals = min(faceNormals.size(), (int)_faces.size());
   for (i = 0; i < num_normals; i++) {
     XFileFace *face = _faces[i];
 
-    const XFileDataObject &faceIndices = faceNormals[i]["faceVertexIndices"];
+    faceNormals[i]["faceVertexIndices"].extract_int_array(faceIndices);
 
-    if (faceIndices.size() != (int)face->_vertices.size()) {
+    if (faceIndices.size() != face->_vertices.size()) {
       xfile_cat.warning()
         << "Incorrect number of vertices for face in MeshNormals within "
         << get_name() << "\n";
     }
 
-    int num_vertices = min(faceIndices.size(), (int)face->_vertices.size());
+    int num_vertices = (int)min(faceIndices.size(), face->_vertices.size());
     for (j = 0; j < num_vertices; j++) {
-      face->_vertices[j]._normal_index = faceIndices[j].i();
+      face->_vertices[j]._normal_index = faceIndices[j];
     }
   }
 
@@ -772,17 +777,18 @@ fill_colors(XFileDataNode *obj) {
  */
 bool XFileMesh::
 fill_uvs(XFileDataNode *obj) {
-  const XFileDataObject &textureCoords = (*obj)["textureCoords"];
-  if (textureCoords.size() != (int)_vertices.size()) {
+  vector_double textureCoords;
+  (*obj)["textureCoords"].extract_double_array(2, textureCoords);
+  if (textureCoords.size() / 2 != _vertices.size()) {
     xfile_cat.warning()
       << "Wrong number of vertices in MeshTextureCoords within "
       << get_name() << "\n";
   }
 
-  int num_texcoords = min(textureCoords.size(), (int)_vertices.size());
-  for (int i = 0; i < num_texcoords; i++) {
+  size_t num_texcoords = min(textureCoords.size() / 2, _vertices.size());
+  for (size_t i = 0; i < num_texcoords; i++) {
     XFileVertex *vertex = _vertices[i];
-    vertex->_uv = textureCoords[i].vec2();
+    vertex->_uv.set(textureCoords[i * 2], textureCoords[i * 2 + 1]);
     vertex->_has_uv = true;
   }
 
@@ -801,8 +807,10 @@ fill_skin_weights(XFileDataNode *obj) {
 
   data._joint_name = (*obj)["transformNodeName"].s();
 
-  const XFileDataObject &vertexIndices = (*obj)["vertexIndices"];
-  const XFileDataObject &weights = (*obj)["weights"];
+  vector_int vertexIndices;
+  vector_double weights;
+  (*obj)["vertexIndices"].extract_int_array(vertexIndices);
+  (*obj)["weights"].extract_double_array(1, weights);
 
   if (weights.size() != vertexIndices.size()) {
     xfile_cat.warning()
@@ -812,8 +820,8 @@ fill_skin_weights(XFileDataNode *obj) {
   // Unpack the weight for each vertex.
   size_t num_weights = min(weights.size(), vertexIndices.size());
   for (size_t i = 0; i < num_weights; i++) {
-    int vindex = vertexIndices[i].i();
-    double weight = weights[i].d();
+    int vindex = vertexIndices[i];
+    double weight = weights[i];
 
     if (vindex < 0 || vindex > (int)_vertices.size()) {
       xfile_cat.warning()
@@ -835,17 +843,18 @@ fill_skin_weights(XFileDataNode *obj) {
  */
 bool XFileMesh::
 fill_material_list(XFileDataNode *obj) {
-  const XFileDataObject &faceIndexes = (*obj)["faceIndexes"];
-  if (faceIndexes.size() > (int)_faces.size()) {
+  vector_int faceIndexes;
+  (*obj)["faceIndexes"].extract_int_array(faceIndexes);
+  if (faceIndexes.size() > _faces.size()) {
     xfile_cat.warning()
       << "Too many faces in MeshMaterialList within " << get_name() << "\n";
   }
 
   int material_index = -1;
   int i = 0;
-  while (i < faceIndexes.size() && i < (int)_faces.size()) {
+  while (i < (int)faceIndexes.size() && i < (int)_faces.size()) {
     XFileFace *face = _faces[i];
-    material_index = faceIndexes[i].i();
+    material_index = faceIndexes[i];
     face->_material_index = material_index;
     i++;
   }
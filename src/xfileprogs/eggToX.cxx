@@ -35,6 +35,23 @@ EggToX() : EggToSomething("DirectX", ".x", true, false) {
      "preserving the normal egg hierarchy.",
      &EggToX::dispatch_none, &xfile_one_mesh);
 
+  add_option
+    ("bin", "", 0,
+     "Write a binary .x file instead of a text file.",
+     &EggToX::dispatch_none, &_binary);
+
+  add_option
+    ("zip", "", 0,
+     "Compress the .x file with MSZIP compression, as supported by the "
+     "DirectX runtime.",
+     &EggToX::dispatch_none, &_compressed);
+
+  add_option
+    ("f32", "", 0,
+     "Write floating-point numbers to a binary .x file with 32-bit "
+     "precision, instead of the default 64-bit precision.",
+     &EggToX::dispatch_none, &_float32);
+
   // X files are always y-up-left.
   remove_option("cs");
   _got_coordinate_system = true;
@@ -44,6 +61,10 @@ EggToX() : EggToSomething("DirectX", ".x", true, false) {
   // external references.
   remove_option("f");
   _force_complete = true;
+
+  _binary = false;
+  _compressed = false;
+  _float32 = false;
 }
 
 
@@ -56,6 +77,14 @@ run() {
     exit(1);
   }
 
+  if (_binary) {
+    _x.set_format(_compressed ? XFile::FT_compressed : XFile::FT_binary,
+                  _float32 ? XFile::FS_32 : XFile::FS_64);
+  } else {
+    _x.set_format(_compressed ? XFile::FT_compressed_text : XFile::FT_text,
+                  _float32 ? XFile::FS_32 : XFile::FS_64);
+  }
+
   if (!_x.add_tree(_data)) {
     nout << "Unable to define egg structure.\n";
     exit(1);
@@ -39,6 +39,9 @@ private:
 
   Filename _input_filename;
   XFileMaker _x;
+  bool _binary;
+  bool _compressed;
+  bool _float32;
 };
 
 #endif
@@ -41,6 +41,27 @@ XFileTrans() :
      "If this option is omitted, the last parameter name is taken to be the "
      "name of the output file.",
      &XFileTrans::dispatch_filename, &_got_output_filename, &_output_filename);
+
+  add_option
+    ("bin", "", 0,
+     "Write a binary .x file instead of a text file.",
+     &XFileTrans::dispatch_none, &_binary);
+
+  add_option
+    ("zip", "", 0,
+     "Compress the .x file with MSZIP compression, as supported by the "
+     "DirectX runtime.",
+     &XFileTrans::dispatch_none, &_compressed);
+
+  add_option
+    ("f32", "", 0,
+     "Write floating-point numbers to a binary .x file with 32-bit "
+     "precision, instead of the default 64-bit precision.",
+     &XFileTrans::dispatch_none, &_float32);
+
+  _binary = false;
+  _compressed = false;
+  _float32 = false;
 }
 
 
@@ -57,6 +78,13 @@ run() {
     exit(1);
   }
 
+  if (_binary) {
+    file.set_format_type(_compressed ? XFile::FT_compressed : XFile::FT_binary);
+  } else {
+    file.set_format_type(_compressed ? XFile::FT_compressed_text : XFile::FT_text);
+  }
+  file.set_float_size(_float32 ? XFile::FS_32 : XFile::FS_64);
+
   if (!file.write(get_output())) {
     nout << "Unable to write.\n";
     exit(1);
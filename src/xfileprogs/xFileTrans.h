@@ -33,6 +33,9 @@ protected:
   virtual bool handle_args(Args &args);
 
   Filename _input_filename;
+  bool _binary;
+  bool _compressed;
+  bool _float32;
 };
 
 #endif